@@ -0,0 +1,347 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Microbenchmarks of the littlelstm network operations over a matrix of
+ * network sizes, each built from LSTM blocks and from forget gate blocks. The
+ * results are printed as JSON so that runs can be diffed.
+ *
+ * Usage: lstm_benchmark [--seed <n>]
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <atomic>
+
+#include "littlelstm/lstm_network.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "littlelstm/binary_exporter.hpp"
+#include "littlelstm/binary_importer.hpp"
+#include "littlelstm/json_exporter.hpp"
+#include "littlelstm/json_importer.hpp"
+#include "json/json.hpp"
+#include "memory_usage.hpp"
+
+using namespace std;
+using namespace littlelstm;
+using namespace larasynth;
+
+// the number of connection updates each timed operation is repeated for, so
+// that small and large networks take similar amounts of time
+static const size_t STEP_CONNECTION_BUDGET = 5000000;
+static const size_t COPY_CONNECTION_BUDGET = 500000;
+static const size_t MIN_REPETITIONS = 3;
+static const size_t WARMUP_REPETITIONS = 3;
+
+static const double LEARNING_RATE = 0.01;
+static const double MOMENTUM = 0.8;
+
+// bytes requested from operator new since the program started, which the step
+// worker pool's threads update too
+static atomic<size_t> allocated_bytes( 0 );
+
+void* operator new( size_t size ) {
+  allocated_bytes += size;
+
+  void* p = malloc( size == 0 ? 1 : size );
+  if( p == nullptr )
+    throw bad_alloc();
+
+  return p;
+}
+
+void operator delete( void* p ) noexcept {
+  free( p );
+}
+
+struct BenchmarkCase {
+  size_t input_count;
+  size_t output_count;
+  vector<size_t> block_counts;
+  lstm_block_t block_type;
+};
+
+/**
+ * Times repetitions of an operation and counts what it allocates between
+ * start() and stop().
+ */
+class OperationTimer {
+public:
+  OperationTimer()
+    : _nanoseconds( 0 ), _repetitions( 0 ), _first_allocated_bytes( 0 ),
+      _allocated_bytes( 0 ) {}
+
+  void start() {
+    _first_allocated_bytes = allocated_bytes;
+  }
+
+  void stop() {
+    _allocated_bytes = allocated_bytes - _first_allocated_bytes;
+  }
+
+  template <typename F>
+  void time( F operation ) {
+    auto begin = chrono::steady_clock::now();
+    operation();
+    auto end = chrono::steady_clock::now();
+
+    _nanoseconds +=
+      chrono::duration_cast<chrono::nanoseconds>( end - begin ).count();
+    ++_repetitions;
+  }
+
+  nlohmann::json get_json() const {
+    nlohmann::json json;
+
+    json["repetitions"] = _repetitions;
+    json["ns_per_step"] = double( _nanoseconds ) / _repetitions;
+    json["bytes_allocated_per_step"] =
+      double( _allocated_bytes ) / _repetitions;
+
+    return json;
+  }
+
+private:
+  uint64_t _nanoseconds;
+  size_t _repetitions;
+  size_t _first_allocated_bytes;
+  size_t _allocated_bytes;
+};
+
+static size_t get_repetitions( size_t budget, size_t connection_count ) {
+  return max( MIN_REPETITIONS, budget / max<size_t>( connection_count, 1 ) );
+}
+
+static vector<double> random_vector( size_t size, mt19937& rand_engine ) {
+  uniform_real_distribution<double> dist( 0.0, 1.0 );
+  vector<double> v( size );
+
+  for( auto& value : v )
+    value = dist( rand_engine );
+
+  return v;
+}
+
+/**
+ * Replace a new network's random weights with ones drawn from rand_engine so
+ * that every run benchmarks the same network.
+ */
+static void set_seeded_weights( LstmNetwork& network, mt19937& rand_engine ) {
+  uniform_real_distribution<double> dist( -0.5, 0.5 );
+  ConnectionWeights_t weights = network.get_connection_weights();
+
+  for( auto& weight : weights )
+    weight = dist( rand_engine );
+
+  network.set_connection_weights( weights );
+}
+
+static nlohmann::json run_case( const BenchmarkCase& bench_case,
+                                unsigned int seed ) {
+  mt19937 rand_engine( seed );
+
+  LstmArchitecture arch( bench_case.input_count, bench_case.output_count,
+                         bench_case.block_counts,
+                         vector<lstm_block_t>( bench_case.block_counts.size(),
+                                               bench_case.block_type ) );
+
+  size_t connection_count = arch.get_connections().size();
+  size_t step_repetitions = get_repetitions( STEP_CONNECTION_BUDGET,
+                                             connection_count );
+  size_t copy_repetitions = get_repetitions( COPY_CONNECTION_BUDGET,
+                                             connection_count );
+
+  nlohmann::json operations;
+
+  OperationTimer construct_timer;
+  construct_timer.start();
+  for( size_t i = 0; i < copy_repetitions; ++i )
+    construct_timer.time( [&]() { LstmNetwork network( arch ); } );
+  construct_timer.stop();
+  operations["construct"] = construct_timer.get_json();
+
+  LstmNetwork network( arch );
+  set_seeded_weights( network, rand_engine );
+
+  vector< vector<double> > inputs;
+  vector< vector<double> > targets;
+  for( size_t i = 0; i < 64; ++i ) {
+    inputs.push_back( random_vector( bench_case.input_count, rand_engine ) );
+    targets.push_back( random_vector( bench_case.output_count,
+                                      rand_engine ) );
+  }
+
+  for( size_t i = 0; i < WARMUP_REPETITIONS; ++i ) {
+    network.feed_forward( inputs[i] );
+    network.backpropagate( targets[i], LEARNING_RATE, MOMENTUM );
+  }
+
+  OperationTimer feed_forward_timer;
+  feed_forward_timer.start();
+  for( size_t i = 0; i < step_repetitions; ++i ) {
+    const vector<double>& input = inputs[i % inputs.size()];
+    feed_forward_timer.time( [&]() { network.feed_forward( input ); } );
+  }
+  feed_forward_timer.stop();
+  operations["feed_forward"] = feed_forward_timer.get_json();
+
+  network.set_act_impl( FAST_ACT_FUNCS );
+  OperationTimer feed_forward_fast_timer;
+  feed_forward_fast_timer.start();
+  for( size_t i = 0; i < step_repetitions; ++i ) {
+    const vector<double>& input = inputs[i % inputs.size()];
+    feed_forward_fast_timer.time( [&]() { network.feed_forward( input ); } );
+  }
+  feed_forward_fast_timer.stop();
+  operations["feed_forward_fast"] = feed_forward_fast_timer.get_json();
+  network.set_act_impl( EXACT_ACT_FUNCS );
+
+  // backpropagate must follow a feed forward, which is not timed
+  OperationTimer backpropagate_timer;
+  backpropagate_timer.start();
+  for( size_t i = 0; i < step_repetitions; ++i ) {
+    network.feed_forward( inputs[i % inputs.size()] );
+    const vector<double>& target = targets[i % targets.size()];
+    backpropagate_timer.time( [&]() {
+        network.backpropagate( target, LEARNING_RATE, MOMENTUM );
+      } );
+  }
+  backpropagate_timer.stop();
+  operations["backpropagate"] = backpropagate_timer.get_json();
+
+  OperationTimer zero_timer;
+  zero_timer.start();
+  for( size_t i = 0; i < step_repetitions; ++i )
+    zero_timer.time( [&]() { network.zero_network(); } );
+  zero_timer.stop();
+  operations["zero_network"] = zero_timer.get_json();
+
+  string bytes;
+  OperationTimer binary_export_timer;
+  binary_export_timer.start();
+  for( size_t i = 0; i < copy_repetitions; ++i ) {
+    binary_export_timer.time( [&]() {
+        BinaryExporter exporter;
+        network.export_network( exporter );
+        bytes = exporter.get_bytes();
+      } );
+  }
+  binary_export_timer.stop();
+  operations["export_binary"] = binary_export_timer.get_json();
+
+  OperationTimer binary_import_timer;
+  binary_import_timer.start();
+  for( size_t i = 0; i < copy_repetitions; ++i ) {
+    binary_import_timer.time( [&]() {
+        BinaryImporter importer( bytes.data(), bytes.size() );
+        LstmNetwork imported( importer );
+      } );
+  }
+  binary_import_timer.stop();
+  operations["import_binary"] = binary_import_timer.get_json();
+
+  string json_string;
+  OperationTimer json_export_timer;
+  json_export_timer.start();
+  for( size_t i = 0; i < copy_repetitions; ++i ) {
+    json_export_timer.time( [&]() {
+        JsonExporter exporter;
+        network.export_network( exporter );
+        json_string = exporter.get_json_string();
+      } );
+  }
+  json_export_timer.stop();
+  operations["export_json"] = json_export_timer.get_json();
+
+  OperationTimer json_import_timer;
+  json_import_timer.start();
+  for( size_t i = 0; i < copy_repetitions; ++i ) {
+    json_import_timer.time( [&]() {
+        JsonImporter importer;
+        importer.set_json( json_string );
+        LstmNetwork imported( importer );
+      } );
+  }
+  json_import_timer.stop();
+  operations["import_json"] = json_import_timer.get_json();
+
+  nlohmann::json json;
+  json["input_count"] = bench_case.input_count;
+  json["output_count"] = bench_case.output_count;
+  json["block_counts"] = bench_case.block_counts;
+  json["block_type"] = block_type_to_string( bench_case.block_type );
+  json["connection_count"] = connection_count;
+  json["operations"] = operations;
+
+  return json;
+}
+
+static void print_usage_and_exit( char** argv ) {
+  cerr << "Usage: " << argv[0] << " [--seed <n>]" << endl;
+  exit( EXIT_FAILURE );
+}
+
+int main( int argc, char** argv ) {
+  unsigned int seed = 1;
+
+  for( int i = 1; i < argc; ++i ) {
+    if( strcmp( argv[i], "--seed" ) == 0 && i + 1 < argc )
+      seed = strtoul( argv[++i], nullptr, 10 );
+    else
+      print_usage_and_exit( argv );
+  }
+
+  vector< pair<size_t, size_t> > io_counts = { { 3, 1 }, { 16, 8 } };
+
+  vector< vector<size_t> > block_counts = {
+    { 2 }, { 16 }, { 64 },
+    { 16, 16 }, { 64, 64 },
+    { 4, 4, 4 }, { 32, 32, 32 }
+  };
+
+  nlohmann::json results;
+  results["seed"] = seed;
+  results["cases"] = nlohmann::json::array();
+
+  for( auto& io : io_counts ) {
+    for( auto& blocks : block_counts ) {
+      for( auto block_type : { LSTM_BLOCK, FORGET_GATE_BLOCK } ) {
+        BenchmarkCase bench_case = { io.first, io.second, blocks,
+                                     block_type };
+        results["cases"].push_back( run_case( bench_case, seed ) );
+
+        cerr << "." << flush;
+      }
+    }
+  }
+
+  cerr << endl;
+
+  // ru_maxrss only grows, so it can only be reported for the whole run
+  results["peak_rss_bytes"] = get_peak_rss_bytes();
+
+  cout << results.dump( 2 ) << endl;
+
+  return EXIT_SUCCESS;
+}
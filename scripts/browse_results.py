@@ -23,6 +23,8 @@ import os
 import matplotlib.pyplot as plt
 import json
 import argparse
+import struct
+from array import array
 from pathlib import Path
 
 # plt.ion()
@@ -36,6 +38,58 @@ plt.rcParams.update({
     "font.family": "serif",
 })
 
+TRACES_MAGIC = b'LARATRCS'
+TRACES_VERSION = 1
+TRACES_HEADER = struct.Struct('=8sII6Q')
+
+
+def read_traces(traces_filename):
+    """Read a columnar validation traces file written by larasynth.
+
+    Returns (ctrls, cell_ids, targets, outputs, cell_states) where targets and
+    outputs map each controller to a list of values and cell_states is a list
+    with one list of states per cell.
+    """
+    with open(traces_filename, 'rb') as f:
+        data = f.read()
+
+    (magic, version, byte_order, header_size, total_sample_count,
+     sample_count, sample_stride, ctrl_count,
+     cell_count) = TRACES_HEADER.unpack_from(data, 0)
+
+    if magic != TRACES_MAGIC or byte_order != 0x01020304:
+        raise ValueError(traces_filename + ' is not a validation traces file')
+    if version != TRACES_VERSION:
+        raise ValueError('unsupported traces version ' + str(version))
+
+    offset = header_size
+    ctrls = list(struct.unpack_from('={}Q'.format(ctrl_count), data, offset))
+    offset += 8 * ctrl_count
+    cell_ids = list(struct.unpack_from('={}Q'.format(cell_count), data,
+                                       offset))
+    offset += 8 * cell_count
+
+    targets = {}
+    outputs = {}
+
+    for columns in (targets, outputs):
+        for ctrl in ctrls:
+            columns[ctrl] = list(data[offset:offset + sample_count])
+            offset += sample_count
+
+    offset = (offset + 7) & ~7
+
+    cell_states = []
+
+    for _ in range(cell_count):
+        column = array('d')
+        column.frombytes(data[offset:offset + 8 * sample_count])
+        cell_states.append(column.tolist())
+        offset += 8 * sample_count
+
+    return ctrls, cell_ids, targets, outputs, cell_states
+
+
 class Result:
     def __init__(self, json_filename):
         self.json_filename = json_filename
@@ -58,6 +112,26 @@ class Result:
 
         self.sample_count = data['sample_count']
 
+        if 'traces_file' in data:
+            traces_filename = os.path.join(os.path.dirname(json_filename),
+                                           data['traces_file'])
+            self.read_traces(traces_filename)
+        else:
+            self.read_json_traces(data)
+
+    def read_traces(self, traces_filename):
+        if not os.path.exists(traces_filename):
+            print('no validation traces:', traces_filename, 'is missing')
+            self.all_targets = {ctrl: [] for ctrl in self.ctrls}
+            self.all_outputs = {ctrl: [] for ctrl in self.ctrls}
+            self.all_cell_states = []
+            return
+
+        (self.ctrls, _, self.all_targets, self.all_outputs,
+         self.all_cell_states) = read_traces(traces_filename)
+
+    def read_json_traces(self, data):
+        """Read traces stored in the JSON by older versions of larasynth."""
         self.all_targets = {}
         self.all_outputs = {}
         self.all_cell_states = [[] for _ in range(self.cell_count)]
@@ -0,0 +1,119 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace larasynth {
+
+/**
+ * Helpers for the binary formats larasynth writes itself: training
+ * checkpoints, the messages between training processes and the user data of
+ * model files. Values are appended in native byte order, and vectors and
+ * strings are prefixed with their size.
+ */
+inline void append_u64( std::string& bytes, uint64_t value ) {
+  bytes.append( reinterpret_cast<const char*>( &value ), sizeof( value ) );
+}
+
+inline void append_double( std::string& bytes, double value ) {
+  bytes.append( reinterpret_cast<const char*>( &value ), sizeof( value ) );
+}
+
+inline void append_string( std::string& bytes, const std::string& value ) {
+  append_u64( bytes, value.size() );
+  bytes.append( value );
+}
+
+inline void append_doubles( std::string& bytes,
+                            const std::vector<double>& values ) {
+  append_u64( bytes, values.size() );
+  if( !values.empty() )
+    bytes.append( reinterpret_cast<const char*>( values.data() ),
+                  values.size() * sizeof( double ) );
+}
+
+/**
+ * Reads the values written by the append functions, checking that they are
+ * within the data. Exception_t is thrown with truncated_message when they
+ * are not, so each format reports errors with its own exception type.
+ */
+template <typename Exception_t>
+class ByteReader {
+public:
+  ByteReader( const char* data, size_t size,
+              const std::string& truncated_message )
+    : _data( data ), _size( size ), _pos( 0 )
+    , _truncated_message( truncated_message ) {}
+
+  void read( void* dest, size_t count ) {
+    if( count > _size - _pos )
+      throw Exception_t( _truncated_message );
+
+    if( count > 0 )
+      memcpy( dest, _data + _pos, count );
+    _pos += count;
+  }
+
+  uint64_t read_u64() {
+    uint64_t value;
+    read( &value, sizeof( value ) );
+    return value;
+  }
+
+  double read_double() {
+    double value;
+    read( &value, sizeof( value ) );
+    return value;
+  }
+
+  std::string read_string() {
+    uint64_t size = read_u64();
+    if( size > _size - _pos )
+      throw Exception_t( _truncated_message );
+
+    std::string value( _data + _pos, size );
+    _pos += size;
+    return value;
+  }
+
+  std::vector<double> read_doubles() {
+    uint64_t count = read_u64();
+    if( count > ( _size - _pos ) / sizeof( double ) )
+      throw Exception_t( _truncated_message );
+
+    std::vector<double> values( count );
+    read( values.data(), count * sizeof( double ) );
+    return values;
+  }
+
+  size_t get_remaining_size() const { return _size - _pos; }
+  bool at_end() const { return _pos == _size; }
+
+protected:
+  const char* _data;
+  size_t _size;
+  size_t _pos;
+  std::string _truncated_message;
+};
+
+}
@@ -0,0 +1,192 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+
+#include "compiled_model.hpp"
+#include "filesystem_operations.hpp"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+string CompiledModel::get_header_filename( const string& results_filename ) {
+  return replace_extension( results_filename, ".hpp" );
+}
+
+string CompiledModel::get_source_filename( const string& results_filename ) {
+  return replace_extension( results_filename, ".cpp" );
+}
+
+string CompiledModel::get_library_filename( const string& results_filename ) {
+  return replace_extension( results_filename, ".so" );
+}
+
+/**
+ * The namespace of the generated code, which is the results filename without
+ * its directory and extension, made into an identifier.
+ */
+string CompiledModel::get_namespace_name( const string& results_filename ) {
+  string name = "lara_" + get_basename( replace_extension( results_filename,
+                                                           "" ) );
+
+  for( char& c : name ) {
+    if( !isalnum( c ) )
+      c = '_';
+  }
+
+  return name;
+}
+
+CodeExporter CompiledModel::export_network( const string& results_filename,
+                                            const LstmNetwork& net ) {
+  CodeExporter exporter( get_namespace_name( results_filename ),
+                         net.get_act_impl(), net.get_levels() );
+
+  try {
+    net.export_network( exporter );
+  }
+  catch( const CodeExporterException& e ) {
+    throw CompiledModelException( e.what() );
+  }
+
+  return exporter;
+}
+
+static void write_file( const string& filename, const string& contents ) {
+  ofstream out( filename );
+  out << contents;
+  out.close();
+
+  if( !out )
+    throw CompiledModelException( "Error writing " + filename );
+}
+
+/**
+ * Write the header and the library source for a network.
+ */
+void CompiledModel::write( const string& results_filename,
+                           const LstmNetwork& net ) {
+  CodeExporter exporter = export_network( results_filename, net );
+
+  string header_filename = get_header_filename( results_filename );
+
+  try {
+    string source =
+      exporter.get_library_source( get_basename( header_filename ) );
+
+    write_file( header_filename, exporter.get_header() );
+    write_file( get_source_filename( results_filename ), source );
+  }
+  catch( const CodeExporterException& e ) {
+    throw CompiledModelException( e.what() );
+  }
+}
+
+static string shell_quote( const string& str ) {
+  string quoted = "'";
+
+  for( char c : str ) {
+    if( c == '\'' )
+      quoted += "'\\''";
+    else
+      quoted += c;
+  }
+
+  return quoted + "'";
+}
+
+/**
+ * Compile the library source written by write(). The library is compiled to
+ * a temporary file and then renamed, so lara perform never loads a partly
+ * written library. Throws with the compiler's output if it fails.
+ */
+void CompiledModel::build( const string& results_filename ) {
+  const char* compiler = getenv( "CXX" );
+  const char* flags = getenv( "LARA_CXXFLAGS" );
+
+  string library_filename = get_library_filename( results_filename );
+  string temp_filename = library_filename + ".tmp";
+
+  string command = string( compiler ? compiler : "c++" ) + " " +
+    ( flags ? flags : COMPILED_MODEL_DEFAULT_CXXFLAGS ) +
+    " -std=c++11 -fPIC -shared -o " + shell_quote( temp_filename ) + " " +
+    shell_quote( get_source_filename( results_filename ) ) + " 2>&1";
+
+  FILE* pipe = popen( command.c_str(), "r" );
+
+  if( pipe == nullptr )
+    throw CompiledModelException( "Error running " + command );
+
+  string output;
+  char buffer[256];
+
+  while( fgets( buffer, sizeof( buffer ), pipe ) != nullptr )
+    output += buffer;
+
+  int status = pclose( pipe );
+
+  if( status != 0 ) {
+    remove( temp_filename.c_str() );
+    throw CompiledModelException( "Error compiling " +
+                                  get_source_filename( results_filename ) +
+                                  ":\n" + command + "\n" + output );
+  }
+
+  if( rename( temp_filename.c_str(), library_filename.c_str() ) != 0 )
+    throw CompiledModelException( "Error writing " + library_filename );
+}
+
+/**
+ * Load the compiled library for a network. Throws if there is no library,
+ * or if it was generated from a different network or with different
+ * settings than net has now.
+ */
+unique_ptr<CompiledNetwork>
+CompiledModel::load( const string& results_filename,
+                     const LstmNetwork& net ) {
+  string library_filename = get_library_filename( results_filename );
+
+  if( !is_regular_file( library_filename ) )
+    throw CompiledModelException( library_filename + " does not exist" );
+
+  unique_ptr<CompiledNetwork> compiled;
+
+  try {
+    // dlopen() searches the library path for names without a slash
+    string path = library_filename.find( '/' ) == string::npos
+      ? "./" + library_filename : library_filename;
+
+    compiled.reset( new CompiledNetwork( path ) );
+  }
+  catch( const CompiledNetworkException& e ) {
+    throw CompiledModelException( e.what() );
+  }
+
+  CodeExporter exporter = export_network( results_filename, net );
+
+  if( compiled->get_fingerprint() != exporter.get_fingerprint() )
+    throw CompiledModelException( library_filename + " was compiled from a "
+                                  "different network or [lstm] settings" );
+
+  return compiled;
+}
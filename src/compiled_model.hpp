@@ -0,0 +1,80 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <stdexcept>
+
+#include "littlelstm/lstm_network.hpp"
+#include "littlelstm/code_exporter.hpp"
+#include "littlelstm/compiled_network.hpp"
+
+namespace larasynth {
+
+class CompiledModelException : public std::runtime_error {
+public:
+  explicit CompiledModelException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+static const char* const COMPILED_MODEL_DEFAULT_CXXFLAGS = "-O2";
+
+/**
+ * A trained network compiled to native code by lara compile. Three files are
+ * written next to the JSON training results:
+ *
+ *   results-....hpp - a standalone header (see CodeExporter::get_header())
+ *   results-....cpp - the source of the shared library
+ *   results-....so  - the shared library that lara perform loads
+ *
+ * The generated code follows the network's activation function
+ * implementation and step order, so the network should be configured from
+ * the [lstm] section before it is written or loaded.
+ *
+ * The compiler is $CXX, or c++ if CXX is not set, and its flags are
+ * $LARA_CXXFLAGS, or COMPILED_MODEL_DEFAULT_CXXFLAGS.
+ */
+class CompiledModel {
+public:
+  static void write( const std::string& results_filename,
+                     const littlelstm::LstmNetwork& net );
+  static void build( const std::string& results_filename );
+
+  static std::unique_ptr<littlelstm::CompiledNetwork>
+  load( const std::string& results_filename,
+        const littlelstm::LstmNetwork& net );
+
+  static std::string get_header_filename( const std::string&
+                                          results_filename );
+  static std::string get_source_filename( const std::string&
+                                          results_filename );
+  static std::string get_library_filename( const std::string&
+                                           results_filename );
+  static std::string get_namespace_name( const std::string&
+                                         results_filename );
+
+private:
+  static littlelstm::CodeExporter
+  export_network( const std::string& results_filename,
+                  const littlelstm::LstmNetwork& net );
+};
+
+}
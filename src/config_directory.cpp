@@ -114,18 +114,38 @@ bool ConfigDirectory::is_valid_training_results_filename( const string&
   return regex_match( filename, m, results_re );
 }
 
+/**
+ * Get a filename for a new training example. The filename is based on the
+ * current time; if a file with that name already exists (e.g. when importing
+ * many files in quick succession), a new timestamp is taken.
+ */
 string ConfigDirectory::get_new_training_example_filename() {
+  string filename;
+
+  do {
+    ostringstream oss;
+    oss << _examples_dir_name << "example-" << get_timestamp_string()
+        << ".seq";
+    filename = oss.str();
+  } while( is_regular_file( filename ) );
+
+  return filename;
+}
+
+string ConfigDirectory::get_new_training_results_filename( const string&
+                                                           suffix ) {
   ostringstream oss;
 
-  oss << _examples_dir_name << "example-" << get_timestamp_string() << ".seq";
+  oss << _results_dir_name << "results-" << get_timestamp_string() << suffix
+      << ".json";
 
   return oss.str();
 }
 
-string ConfigDirectory::get_new_training_results_filename() {
+string ConfigDirectory::get_new_search_leaderboard_filename() {
   ostringstream oss;
 
-  oss << _results_dir_name << "results-" << get_timestamp_string() << ".json";
+  oss << _results_dir_name << "search-" << get_timestamp_string() << ".tsv";
 
   return oss.str();
 }
@@ -60,13 +60,17 @@ public:
   { return _training_example_filenames; }
   std::vector<std::string> get_training_results_filenames()
   { return _training_results_filenames; }
+  std::string get_training_results_directory_name()
+  { return _results_dir_name; }
   bool training_examples_exist()
   { return _training_example_filenames.size() > 0; }
   bool training_results_exist()
   { return _training_results_filenames.size() > 0; }
 
   std::string get_new_training_example_filename();
-  std::string get_new_training_results_filename();
+  std::string get_new_training_results_filename( const std::string& suffix =
+                                                 "" );
+  std::string get_new_search_leaderboard_filename();
   
 private:
   bool is_valid_training_example_filename( const std::string& filename );
@@ -0,0 +1,113 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <limits>
+
+#include "distillation_config.hpp"
+#include "config_variable_to_set.hpp"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+DistillationConfig::DistillationConfig( ConfigParameters& config_params )
+  : _teacher_results_filename( "" )
+{
+  try {
+    config_params.set_var( "teacher_results", _teacher_results_filename );
+  }
+  catch( UndefinedParameterException& e ) {
+  }
+  catch( ConfigParameterException& e ) {
+    throw DistillationConfigException( e.what() );
+  }
+
+  try {
+    config_params.set_var( "block_counts", _block_counts );
+  }
+  catch( UndefinedParameterException& e ) {
+    throw DistillationConfigException( "block_counts for the student network "
+                                       "must be defined" );
+  }
+  catch( ConfigParameterException& e ) {
+    throw DistillationConfigException( e.what() );
+  }
+
+  if( _block_counts.empty() )
+    throw DistillationConfigException( "block_counts must not be empty" );
+
+  for( size_t block_count : _block_counts ) {
+    if( block_count == 0 )
+      throw DistillationConfigException( "block_counts must all be at least "
+                                         "1" );
+  }
+
+  vector<string> block_type_strings;
+
+  try {
+    config_params.set_var( "block_types", block_type_strings );
+  }
+  catch( UndefinedParameterException& e ) {
+    block_type_strings.assign( _block_counts.size(), "lstm" );
+  }
+  catch( ConfigParameterException& e ) {
+    throw DistillationConfigException( e.what() );
+  }
+
+  if( block_type_strings.size() != _block_counts.size() )
+    throw DistillationConfigException( "block_types must have one type for "
+                                       "each hidden layer in block_counts" );
+
+  for( auto& block_type_string : block_type_strings ) {
+    lstm_block_t block_type = string_to_block_type( block_type_string );
+
+    if( block_type == NO_BLOCK_TYPE )
+      throw DistillationConfigException( "Unknown block type " +
+                                         block_type_string +
+                                         ". Use lstm or forget_gate." );
+
+    _block_types.push_back( block_type );
+  }
+
+  vector<ConfigVariableToSet<double> > optional_doubles;
+
+  optional_doubles.emplace_back( "min_agreement", &_min_agreement,
+                                 DEFAULT_MIN_AGREEMENT, 0.0, 1.0 );
+  optional_doubles.emplace_back( "max_mse_ratio", &_max_mse_ratio,
+                                 DEFAULT_MAX_MSE_RATIO, 0.0,
+                                 numeric_limits<double>::max() );
+  optional_doubles.emplace_back( "soft_target_weight", &_soft_target_weight,
+                                 DEFAULT_SOFT_TARGET_WEIGHT, 0.0, 1.0 );
+
+  for( auto& var_to_set : optional_doubles ) {
+    try {
+      config_params.set_var( var_to_set.name, *var_to_set.var_ptr,
+                             var_to_set.min, var_to_set.max );
+    }
+    catch( UndefinedParameterException& e ) {
+      *var_to_set.var_ptr = var_to_set.default_value;
+    }
+    catch( ConfigParameterException& e ) {
+      throw DistillationConfigException( e.what() );
+    }
+  }
+
+  for( const string& name : config_params.get_unset_params() )
+    throw DistillationConfigException( "Unknown parameter " + name );
+}
@@ -0,0 +1,68 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "config_parameters.hpp"
+#include "littlelstm/lstm_types.hpp"
+
+namespace larasynth {
+
+static const double DEFAULT_MIN_AGREEMENT = 0.95;
+static const double DEFAULT_MAX_MSE_RATIO = 1.1;
+static const double DEFAULT_SOFT_TARGET_WEIGHT = 1.0;
+
+class DistillationConfigException : public std::runtime_error {
+public:
+  DistillationConfigException( const std::string& message )
+    : runtime_error( "Error in configuration section [distillation]:\n"
+                     + message ) {};
+};
+
+/**
+ * The [distillation] section, which is only read by lara distill.
+ */
+class DistillationConfig {
+public:
+  DistillationConfig( ConfigParameters& config_params );
+
+  std::string get_teacher_results_filename() const
+  { return _teacher_results_filename; }
+  const std::vector<size_t>& get_block_counts() const
+  { return _block_counts; }
+  const std::vector<littlelstm::lstm_block_t>& get_block_types() const
+  { return _block_types; }
+  double get_min_agreement() const { return _min_agreement; }
+  double get_max_mse_ratio() const { return _max_mse_ratio; }
+  double get_soft_target_weight() const { return _soft_target_weight; }
+
+private:
+  std::string _teacher_results_filename;
+  std::vector<size_t> _block_counts;
+  std::vector<littlelstm::lstm_block_t> _block_types;
+  double _min_agreement;
+  double _max_mse_ratio;
+  double _soft_target_weight;
+};
+
+}
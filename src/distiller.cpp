@@ -0,0 +1,230 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+#include <limits>
+
+#include "distiller.hpp"
+#include "distillation_config.hpp"
+#include "config_parser.hpp"
+#include "midi_config.hpp"
+#include "midi_translator.hpp"
+#include "representation_config.hpp"
+#include "training_config.hpp"
+#include "training_event_stream.hpp"
+#include "training_results.hpp"
+#include "model_file.hpp"
+#include "results_index.hpp"
+#include "lstm_config.hpp"
+#include "lstm_trainer.hpp"
+#include "trainer.hpp"
+#include "filesystem_operations.hpp"
+#include "time_utilities.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+/**
+ * The student results are named after the teacher's results and the
+ * student's block counts, with an f after the counts of forget gate blocks,
+ * e.g. results-....-distilled-8f-4.json.
+ */
+string Distiller::get_student_results_filename( const string&
+                                                teacher_results_filename,
+                                                const vector<size_t>&
+                                                block_counts,
+                                                const vector<lstm_block_t>&
+                                                block_types ) {
+  string suffix = "-distilled";
+
+  for( size_t h = 0; h < block_counts.size(); ++h ) {
+    suffix += "-" + to_string( block_counts[h] );
+
+    if( h < block_types.size() && block_types[h] == FORGET_GATE_BLOCK )
+      suffix += "f";
+  }
+
+  return replace_extension( teacher_results_filename, suffix + ".json" );
+}
+
+Distiller::Distiller( const string& config_directory_path,
+                      const string& teacher_results_filename,
+                      volatile sig_atomic_t* shutdown_flag,
+                      DistillationCallback_t callback ) {
+  ConfigDirectory dir( config_directory_path );
+  dir.process_directory();
+
+  if( !dir.training_examples_exist() )
+    throw DistillerException( "There are no training examples in the "
+                              "directory " + config_directory_path );
+
+  Trainer::seed_random_numbers( dir.get_config_file_path() );
+
+  ConfigParser cp( dir.get_config_file_path() );
+
+  ConfigParameters lstm_params = cp.get_section_params( "lstm" );
+  ConfigParameters midi_params = cp.get_section_params( "midi" );
+  ConfigParameters training_params = cp.get_section_params( "training" );
+  ConfigParameters distillation_params =
+    cp.get_section_params( "distillation" );
+
+  LstmConfig lstm_config( lstm_params );
+  MidiConfig midi_config( midi_params );
+  TrainingConfig training_config( training_params );
+  DistillationConfig distillation_config( distillation_params );
+
+  _student_results_filename =
+    get_student_results_filename( teacher_results_filename,
+                                  distillation_config.get_block_counts(),
+                                  distillation_config.get_block_types() );
+
+  TrainingResults teacher_results( teacher_results_filename, READ_RESULTS );
+
+  // the teacher is read from the binary model file if there is one, since
+  // that is faster
+  string model_filename =
+    ModelFile::get_model_filename( teacher_results_filename );
+
+  unique_ptr<ModelFile> model;
+
+  if( is_regular_file( model_filename ) )
+    model.reset( new ModelFile( model_filename ) );
+
+  // the student uses the teacher's inputs and outputs, so it also uses the
+  // teacher's representation and min/max rather than the project's
+  MidiMinMax min_max = model ? model->get_min_max()
+                             : teacher_results.get_min_max();
+  RepresentationConfig repr_config = model ? model->get_repr_config()
+                                           : teacher_results.get_repr_config();
+  LstmNetwork teacher = model ? model->get_trained_network()
+                              : teacher_results.get_trained_network();
+
+  teacher.set_step_thread_count( lstm_config.get_step_thread_count() );
+
+  size_t update_period =
+    MICROSECONDS_PER_SECOND / repr_config.get_update_rate();
+
+  TrainingEventStream stream( update_period,
+                              training_config.get_tempo_adjustment_factor(),
+                              training_config.get_tempo_jitter_factor(),
+                              training_config.get_mean_padding(),
+                              training_config.get_padding_stddev(),
+                              midi_config.get_ctrl_defaults() );
+  stream.add_examples( dir.get_training_example_filenames() );
+
+  MidiTranslator translator( repr_config.get_ctrl_output_counts(),
+                             repr_config.get_input_feature_config(),
+                             midi_config.get_ctrl_defaults(), min_max,
+                             TRAIN );
+
+  lstm_config.set_input_count( translator.get_input_count() );
+  lstm_config.set_output_count( translator.get_output_count() );
+  lstm_config.set_block_counts( distillation_config.get_block_counts(),
+                                distillation_config.get_block_types() );
+
+  LstmArchitecture arch( lstm_config.get_input_count(),
+                         lstm_config.get_output_count(),
+                         lstm_config.get_block_counts(),
+                         lstm_config.get_block_types() );
+
+  LstmNetwork student( arch );
+
+  LstmTrainer trainer( student, stream, training_config, lstm_config,
+                       translator, update_period );
+  trainer.set_teacher( &teacher, distillation_config.get_soft_target_weight() );
+
+  ExamplePlayer player( dir.get_training_example_filenames(), midi_config,
+                        repr_config, min_max );
+
+  _report.teacher_connection_count = teacher.get_connection_weights().size();
+  _report.student_connection_count = student.get_connection_weights().size();
+
+  size_t max_epoch_count = numeric_limits<size_t>::max();
+
+  if( training_config.get_max_epoch_count() > 0 )
+    max_epoch_count = training_config.get_max_epoch_count();
+
+  ConnectionWeights_t best_weights = student.get_connection_weights();
+  bool compared = false;
+
+  while( !_report.thresholds_met && trainer.get_epoch() < max_epoch_count &&
+         !*shutdown_flag ) {
+    trainer.run_training_epoch();
+    _report.epoch_count = trainer.get_epoch();
+
+    // the last epoch is always compared so that the report is complete
+    if( !trainer.should_validate() &&
+        _report.epoch_count < max_epoch_count && !*shutdown_flag )
+      continue;
+
+    NetworkComparison comparison = player.compare( teacher, student );
+
+    if( callback )
+      callback( _report.epoch_count, comparison );
+
+    _report.thresholds_met =
+      comparison.all_ctrls_agreement >=
+      distillation_config.get_min_agreement() &&
+      comparison.mse <=
+      distillation_config.get_max_mse_ratio() * comparison.reference_mse;
+
+    const NetworkComparison& best = _report.comparison;
+
+    if( !compared || _report.thresholds_met ||
+        comparison.all_ctrls_agreement > best.all_ctrls_agreement ||
+        ( comparison.all_ctrls_agreement == best.all_ctrls_agreement &&
+          comparison.mse < best.mse ) ) {
+      _report.comparison = comparison;
+      _report.best_epoch = _report.epoch_count;
+      best_weights = student.get_connection_weights();
+      compared = true;
+    }
+  }
+
+  if( !compared )
+    throw DistillerException( "Distillation stopped before the student was "
+                              "trained" );
+
+  student.set_connection_weights( best_weights );
+
+  LstmResult result( _report.best_epoch,
+                     training_config.get_validation_trace_sample_limit() );
+  player.calculate_mse( student, &result );
+
+  TrainingResults student_results( _student_results_filename, WRITE_RESULTS );
+
+  student_results.add_network( student );
+  student_results.add_lstm_config( lstm_config );
+  student_results.add_repr_config( repr_config );
+  student_results.add_training_config( training_config );
+  student_results.add_min_max( min_max );
+  student_results.add_result( std::move( result ),
+                              training_config
+                              .get_validation_trace_sample_limit() );
+
+  student_results.write();
+
+  ModelFile::write( ModelFile::get_model_filename( _student_results_filename ),
+                    student, min_max, repr_config );
+
+  ResultsIndex::add_entry( dir.get_training_results_directory_name(),
+                           student_results.get_index_entry() );
+}
@@ -0,0 +1,95 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <csignal>
+#include <functional>
+#include <stdexcept>
+
+#include "config_directory.hpp"
+#include "example_player.hpp"
+#include "littlelstm/lstm_types.hpp"
+
+namespace larasynth {
+
+class DistillerException : public std::runtime_error {
+public:
+  explicit DistillerException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+struct DistillationReport {
+  size_t teacher_connection_count = 0;
+  size_t student_connection_count = 0;
+
+  size_t epoch_count = 0;
+  // the epoch of the kept student weights
+  size_t best_epoch = 0;
+
+  // the student compared with the teacher at best_epoch
+  NetworkComparison comparison;
+  bool thresholds_met = false;
+};
+
+typedef std::function<void( size_t epoch,
+                            const NetworkComparison& comparison )>
+  DistillationCallback_t;
+
+/**
+ * Trains a student network, with the block counts of the project's
+ * [distillation] section, to follow a trained teacher network. The student
+ * trains with LstmTrainer on the same augmented training epochs as lara
+ * train, using the project's [lstm] and [training] sections, but its targets
+ * are blended with the teacher's outputs (see LstmTrainer::set_teacher).
+ *
+ * Whenever the trainer would validate, the student and the teacher play the
+ * training examples (see ExamplePlayer) and training stops once the
+ * student's controller values agree with the teacher's at least
+ * min_agreement of the time and its MSE is at most max_mse_ratio times the
+ * teacher's. It also stops at max_epoch_count or on shutdown, keeping the
+ * student weights with the best agreement, or the lowest MSE among equal
+ * agreements. The student is written as new training results, next to the
+ * teacher's, that perform, compile, quantize and prune can use like any
+ * other.
+ */
+class Distiller {
+public:
+  Distiller( const std::string& config_directory_path,
+             const std::string& teacher_results_filename,
+             volatile sig_atomic_t* shutdown_flag,
+             DistillationCallback_t callback = nullptr );
+
+  const DistillationReport& get_report() const { return _report; }
+  const std::string& get_student_results_filename() const
+  { return _student_results_filename; }
+
+  static std::string get_student_results_filename(
+    const std::string& teacher_results_filename,
+    const std::vector<size_t>& block_counts,
+    const std::vector<littlelstm::lstm_block_t>& block_types );
+
+private:
+  DistillationReport _report;
+  std::string _student_results_filename;
+};
+
+}
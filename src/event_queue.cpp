@@ -18,6 +18,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "event_queue.hpp"
+#include "trace.hpp"
 
 using namespace std;
 using namespace larasynth;
@@ -28,11 +29,15 @@ EventQueue::EventQueue( size_t capacity )
 {}
 
 void EventQueue::push( Event* new_event ) {
+  TRACE_SCOPE( "EventQueue::push" );
+
   Event* ev = _event_pool.copy_event( new_event );
   RWQLockFreeQueue<Event*>::push( ev );
 }
 
 void EventQueue::push( vector<event_data_t>* message ) {
+  TRACE_SCOPE( "EventQueue::push" );
+
   Event* ev = _event_pool.get_unused_event();
   ev->set_event( message );
   RWQLockFreeQueue<Event*>::push( ev );
@@ -58,6 +58,12 @@ controller_output_counts =
    1, 10,
    2, 10
 
+# Pairs of controllers and group numbers. Each group of controllers gets its
+# own smaller network, and the networks are trained at the same time
+# controller_groups =
+#    1, 1,
+#    2, 2
+
 # The update rate is the number of times per second the input is passed through
 # the neural network and the controller values are re-calculated
 update_rate = 75
@@ -81,10 +87,27 @@ input_features =
 # sufficient
 block_counts = 43
 
+# The kind of memory block in each hidden layer: "lstm", or "forget_gate" for
+# a cheaper block with only a forget gate
+# block_types = "lstm"
+
 # Controls the rate at which the weights in the network are updated
 learning_rate = 0.05
 momentum = 0.8
 
+# How the weight updates are computed: "momentum", "rmsprop" or "adam". The
+# adaptive optimizers usually want a smaller learning_rate, such as 0.01
+optimizer = "momentum"
+
+# With the momentum optimizer, the weights into the output units change by
+# their raw gradient ("gradient") unless this is "scaled", which applies the
+# learning_rate and momentum to them too
+# output_updates = "gradient"
+
+# How the learning rate changes during training: "constant", "step",
+# "cosine" or "plateau"
+learning_rate_schedule = "constant"
+
 
 [training]
 
@@ -150,5 +173,38 @@ mse_threshold = 0.0
 # this is not defined you will be presented with a choice of results files when
 # performing.
 # training_results = "results-2017-05-29-10:56:45.763129.json"
+
+# Perform with the network's weights quantized to 8 or 16 bit integers, which
+# requires running lara quantize first. 0 performs with the trained weights.
+# weight_bits = 0
+
+
+# The [distillation] section is only read by lara distill, which trains a
+# smaller student network to follow a trained teacher network.
+
+# [distillation]
+
+# Specifies the training results file that contains the teacher network. If
+# this is not defined you will be presented with a choice of results files.
+# teacher_results = "results-2017-05-29-10:56:45.763129.json"
+
+# The number of memory blocks in each of the student's hidden layers. This
+# must be defined to distill.
+# block_counts = 8
+
+# The kind of memory block in each of the student's hidden layers. All layers
+# use "lstm" blocks if this is not defined.
+# block_types = "forget_gate"
+
+# Distillation stops once the student's controller values agree with the
+# teacher's at least this fraction of the time, and the student's mean
+# squared error is at most max_mse_ratio times the teacher's. It also stops
+# at max_epoch_count from the [training] section.
+# min_agreement = 0.95
+# max_mse_ratio = 1.1
+
+# How much the student trains toward the teacher's outputs rather than the
+# training examples' controller values. 1.0 uses only the teacher's outputs.
+# soft_target_weight = 1.0
 )";
 }
@@ -0,0 +1,223 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "example_player.hpp"
+#include "time_utilities.hpp"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+ExamplePlayer::ExamplePlayer( const vector<string>& example_filenames,
+                              MidiConfig& midi_config,
+                              RepresentationConfig& repr_config,
+                              const MidiMinMax& min_max )
+  : _stream( MICROSECONDS_PER_SECOND / repr_config.get_update_rate(), 0.0,
+             0.0, 0.0, 0.0, midi_config.get_ctrl_defaults() )
+  , _repr_config( repr_config )
+  , _ctrl_defaults( midi_config.get_ctrl_defaults() )
+  , _min_max( min_max )
+  , _update_period( MICROSECONDS_PER_SECOND / repr_config.get_update_rate() )
+  , _next_update_time( 0 )
+{
+  _stream.add_examples( example_filenames );
+  _stream_rand_state = _stream.get_rand_state();
+}
+
+/**
+ * Play every example once to the zeroed networks, calling step_callback
+ * after each update with one step per network. Returns the number of
+ * updates.
+ */
+size_t ExamplePlayer::play( const vector<FeedForwardNetwork*>& networks,
+                            StepCallback_t step_callback ) {
+  vector<MidiTranslator> translators;
+  translators.reserve( networks.size() );
+
+  for( FeedForwardNetwork* network : networks ) {
+    network->zero_network();
+    translators.emplace_back( _repr_config.get_ctrl_output_counts(),
+                              _repr_config.get_input_feature_config(),
+                              _ctrl_defaults, _min_max, TRAIN );
+  }
+
+  vector<ExampleStep> steps( networks.size() );
+
+  // the examples are shuffled by reset(), so they are shuffled the same way
+  // every time for the results of each play to be comparable
+  _stream.set_rand_state( _stream_rand_state );
+  _stream.reset( 1 );
+  _next_update_time = 0;
+
+  size_t update_count = 0;
+
+  while( _stream.has_next() ) {
+    advance_stream_until_update_time( translators );
+
+    for( size_t i = 0; i < networks.size(); ++i ) {
+      steps[i].input = translators[i].get_input( OUTPUT_SOURCE );
+
+      networks[i]->feed_forward( steps[i].input );
+
+      steps[i].output = networks[i]->get_output();
+      translators[i].report_output( steps[i].output );
+
+      steps[i].target_ctrl_values = translators[i].get_target_ctrl_values();
+      steps[i].output_ctrl_values = translators[i].get_output_ctrl_values();
+    }
+
+    step_callback( steps );
+
+    ++update_count;
+  }
+
+  return update_count;
+}
+
+NetworkComparison ExamplePlayer::compare( FeedForwardNetwork& reference,
+                                          FeedForwardNetwork& network ) {
+  NetworkComparison comparison;
+
+  map<event_data_t, size_t> agreement_counts;
+  size_t all_agreement_count = 0;
+  double reference_sse = 0.0;
+  double sse = 0.0;
+
+  comparison.update_count =
+    play( { &reference, &network }, [&]( const vector<ExampleStep>& steps ) {
+      const ExampleStep& expected = steps[0];
+      const ExampleStep& actual = steps[1];
+
+      bool all_agree = true;
+
+      for( auto& kv : expected.output_ctrl_values ) {
+        bool agree = actual.output_ctrl_values.at( kv.first ) == kv.second;
+
+        agreement_counts[kv.first] += agree ? 1 : 0;
+        all_agree = all_agree && agree;
+      }
+
+      all_agreement_count += all_agree ? 1 : 0;
+
+      for( size_t i = 0; i < expected.output.size(); ++i )
+        comparison.max_output_error = max( comparison.max_output_error,
+                                           fabs( expected.output[i] -
+                                                 actual.output[i] ) );
+
+      reference_sse += calculate_squared_error( expected );
+      sse += calculate_squared_error( actual );
+    } );
+
+  if( comparison.update_count == 0 )
+    return comparison;
+
+  for( auto& kv : agreement_counts )
+    comparison.ctrl_agreement[kv.first] =
+      (double)kv.second / comparison.update_count;
+
+  comparison.all_ctrls_agreement =
+    (double)all_agreement_count / comparison.update_count;
+  comparison.reference_mse = reference_sse / comparison.update_count;
+  comparison.mse = sse / comparison.update_count;
+
+  return comparison;
+}
+
+/**
+ * Play the examples to net and return the mean of the squared differences
+ * between its controller values and the targets, like validation does. If
+ * result is given, the targets, outputs and cell states are added to it.
+ */
+double ExamplePlayer::calculate_mse( LstmNetwork& net, LstmResult* result ) {
+  double sse = 0.0;
+
+  size_t update_count =
+    play( { &net }, [&]( const vector<ExampleStep>& steps ) {
+      sse += calculate_squared_error( steps[0] );
+
+      if( result ) {
+        result->add_sample( steps[0].target_ctrl_values,
+                            steps[0].output_ctrl_values,
+                            net.get_cell_states() );
+      }
+    } );
+
+  double mse = update_count == 0 ? 0.0 : sse / update_count;
+
+  if( result )
+    result->set_mse( mse );
+
+  return mse;
+}
+
+double ExamplePlayer::calculate_squared_error( const ExampleStep& step ) {
+  double sse = 0.0;
+
+  for( auto& kv : step.output_ctrl_values ) {
+    double error = (double)kv.second - step.target_ctrl_values.at( kv.first );
+    sse += error * error;
+  }
+
+  return sse;
+}
+
+/**
+ * Present the events up to the next update to every translator, the same
+ * way LstmTrainer does.
+ */
+void ExamplePlayer::advance_stream_until_update_time(
+  vector<MidiTranslator>& translators ) {
+  bool time_to_update = false;
+
+  while( !time_to_update ) {
+    size_t next_time = _stream.get_next_time();
+    event_data_t next_type = _stream.get_next_type();
+
+    if( next_time > _next_update_time ) {
+      _next_update_time += _update_period;
+
+      time_to_update = true;
+    }
+    else if( next_type == NOTE_ON || next_type == NOTE_OFF ) {
+      Event event = _stream.get_next();
+
+      for( auto& translator : translators )
+        translator.report_note_event( &event );
+
+      _next_update_time = event.time() + _update_period;
+
+      time_to_update = true;
+    }
+    else {
+      Event event = _stream.get_next();
+
+      assert( event.type() == CTRL_CHANGE );
+
+      for( auto& translator : translators )
+        translator.update_ctrl_value( event.controller(), event.value() );
+
+      if( !_stream.has_next() )
+        time_to_update = true;
+    }
+  }
+}
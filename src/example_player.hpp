@@ -0,0 +1,106 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <map>
+
+#include "midi_config.hpp"
+#include "midi_translator.hpp"
+#include "representation_config.hpp"
+#include "training_event_stream.hpp"
+#include "lstm_result.hpp"
+#include "littlelstm/feed_forward_network.hpp"
+#include "littlelstm/lstm_network.hpp"
+
+namespace larasynth {
+
+/**
+ * What one network did in one update of an example.
+ */
+struct ExampleStep {
+  std::vector<double> input;
+  std::vector<double> output;
+  ctrl_values_t target_ctrl_values;
+  ctrl_values_t output_ctrl_values;
+};
+
+/**
+ * How closely a network follows a reference network over the examples. Both
+ * networks run free, each fed its own previous output, so a disagreement can
+ * carry over to later updates just like it would during performance.
+ */
+struct NetworkComparison {
+  size_t update_count = 0;
+
+  // fraction of the updates where the controller values (the argmax of each
+  // controller's outputs) agree
+  std::map<event_data_t, double> ctrl_agreement;
+  double all_ctrls_agreement = 0.0;
+
+  double max_output_error = 0.0;
+
+  // the MSE of each network's controller values against the targets
+  double reference_mse = 0.0;
+  double mse = 0.0;
+};
+
+/**
+ * Plays the training examples, without any of the training variations, to
+ * networks the way validation does: each network's previous output is fed
+ * back to it as input. Several networks can be played side by side, each with
+ * its own translator, so that they can be compared update by update.
+ */
+class ExamplePlayer {
+public:
+  typedef std::function<void( const std::vector<ExampleStep>& )>
+  StepCallback_t;
+
+  ExamplePlayer( const std::vector<std::string>& example_filenames,
+                 MidiConfig& midi_config, RepresentationConfig& repr_config,
+                 const MidiMinMax& min_max );
+
+  size_t play( const std::vector<littlelstm::FeedForwardNetwork*>& networks,
+               StepCallback_t step_callback );
+
+  NetworkComparison compare( littlelstm::FeedForwardNetwork& reference,
+                             littlelstm::FeedForwardNetwork& network );
+  double calculate_mse( littlelstm::LstmNetwork& net,
+                        LstmResult* result = nullptr );
+
+private:
+  static double calculate_squared_error( const ExampleStep& step );
+
+  void advance_stream_until_update_time(
+    std::vector<MidiTranslator>& translators );
+
+  TrainingEventStream _stream;
+  std::string _stream_rand_state;
+  RepresentationConfig& _repr_config;
+  ctrl_values_t _ctrl_defaults;
+  MidiMinMax _min_max;
+  size_t _update_period;
+
+  size_t _next_update_time;
+};
+
+}
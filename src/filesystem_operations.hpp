@@ -22,7 +22,11 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #include <string>
 #include <vector>
 #include <sstream>
+#include <stdexcept>
 #include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 
 namespace larasynth {
@@ -38,6 +42,35 @@ inline void append_slash_if_necessary( std::string& dirpath ) {
     dirpath.append( "/" );
 }
 
+/**
+ * Replace the extension of a filename (everything from the last '.' in the
+ * final path component) with extension, which should include its leading
+ * '.'. If the filename has no extension, extension is appended.
+ */
+inline std::string replace_extension( const std::string& filename,
+                                      const std::string& extension ) {
+  size_t slash = filename.rfind( '/' );
+  size_t dot = filename.rfind( '.' );
+
+  if( dot == std::string::npos || ( slash != std::string::npos &&
+                                    dot < slash ) )
+    return filename + extension;
+
+  return filename.substr( 0, dot ) + extension;
+}
+
+/**
+ * Get the final path component of a filename.
+ */
+inline std::string get_basename( const std::string& filename ) {
+  size_t slash = filename.rfind( '/' );
+
+  if( slash == std::string::npos )
+    return filename;
+
+  return filename.substr( slash + 1 );
+}
+
 inline bool is_regular_file( const std::string& filename ) {
   struct stat statbuf;
 
@@ -104,4 +137,61 @@ inline void get_directory_filenames_and_subdirs( std::string path,
   closedir( dir );
 }
 
+/**
+ * Read-only memory mapping of an entire file. The mapping is released when the
+ * object is destroyed. Empty files are not mapped and have a null data
+ * pointer.
+ */
+class MappedFile {
+public:
+  explicit MappedFile( const std::string& filename )
+    : _data( nullptr )
+    , _size( 0 )
+  {
+    int fd = open( filename.c_str(), O_RDONLY );
+
+    if( fd == -1 )
+      throw FilesystemException( "Error opening " + filename );
+
+    struct stat statbuf;
+
+    if( fstat( fd, &statbuf ) == -1 || !S_ISREG( statbuf.st_mode ) ) {
+      close( fd );
+      throw FilesystemException( "Error opening " + filename );
+    }
+
+    _size = statbuf.st_size;
+
+    if( _size > 0 ) {
+      void* addr = mmap( nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+      if( addr == MAP_FAILED ) {
+        close( fd );
+        throw FilesystemException( "Error mapping " + filename );
+      }
+
+      madvise( addr, _size, MADV_SEQUENTIAL );
+
+      _data = static_cast<const char*>( addr );
+    }
+
+    close( fd );
+  }
+
+  ~MappedFile() {
+    if( _data != nullptr )
+      munmap( const_cast<char*>( _data ), _size );
+  }
+
+  MappedFile( const MappedFile& ) = delete;
+  MappedFile& operator=( const MappedFile& ) = delete;
+
+  const char* data() const { return _data; }
+  size_t size() const { return _size; }
+
+private:
+  const char* _data;
+  size_t _size;
+};
+
 }
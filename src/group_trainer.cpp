@@ -0,0 +1,177 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "group_trainer.hpp"
+#include "model_file.hpp"
+#include "trace.hpp"
+
+using namespace std;
+using namespace larasynth;
+
+GroupTrainer::GroupTrainer( const string& config_directory_path,
+                            volatile sig_atomic_t* shutdown_flag )
+  : _shutdown_flag( shutdown_flag )
+{
+  ConfigDirectory dir( config_directory_path );
+  dir.process_directory();
+
+  _results_filename = dir.get_new_training_results_filename();
+  _results_dir_name = dir.get_training_results_directory_name();
+
+  Trainer::seed_random_numbers( dir.get_config_file_path() );
+
+  ConfigParser cp( dir.get_config_file_path() );
+
+  ConfigParameters repr_params = cp.get_section_params( "representation" );
+  RepresentationConfig repr_config( repr_params );
+
+  _ctrl_groups = repr_config.get_ctrl_groups();
+
+  if( _ctrl_groups.empty() )
+    throw GroupTrainerException( "There are no controller groups in the "
+                                 "configuration.\nCould not train the "
+                                 "groups." );
+
+  // the trainers are created in order, so that seeded runs are reproducible
+  for( auto& ctrl_group : _ctrl_groups )
+    _trainers.emplace_back( new Trainer( dir, cp, "", _shutdown_flag, false,
+                                         0, 1, ctrl_group ) );
+
+  print_configuration( repr_config );
+
+  train();
+
+  write_results();
+}
+
+/**
+ * Check whether the project's configuration puts the controllers in more
+ * than one group.
+ */
+bool GroupTrainer::has_ctrl_groups( const string& config_directory_path ) {
+  ConfigDirectory dir( config_directory_path );
+  dir.process_directory();
+
+  ConfigParser cp( dir.get_config_file_path() );
+
+  ConfigParameters repr_params = cp.get_section_params( "representation" );
+  RepresentationConfig repr_config( repr_params );
+
+  return !repr_config.get_ctrl_groups().empty();
+}
+
+void GroupTrainer::print_configuration( RepresentationConfig& repr_config ) {
+  cout << "Training a network for each of " << _ctrl_groups.size()
+       << " controller groups." << endl << endl;
+
+  // every group has the same hidden layers and training parameters
+  LstmConfig lstm_config = _trainers[0]->get_lstm_config();
+
+  cout << "Network configuration:" << endl << endl;
+  lstm_config.print_network_configuration();
+  cout << endl;
+
+  cout << "Representation configuration:" << endl << endl;
+  repr_config.print_representation_configuration();
+  cout << endl;
+
+  for( size_t i = 0; i < _trainers.size(); ++i ) {
+    const LstmConfig& group_config = _trainers[i]->get_lstm_config();
+
+    cout << "Group " << i + 1 << ": " << group_config.get_input_count()
+         << " inputs, " << group_config.get_output_count() << " outputs"
+         << endl;
+  }
+
+  cout << endl;
+}
+
+/**
+ * Train every group's network on its own thread until all of them are
+ * finished or the shutdown flag is set. Each group stops on its own at the
+ * maximum epoch count or the MSE threshold of the training configuration.
+ */
+void GroupTrainer::train() {
+  TRACE_SCOPE( "GroupTrainer::train" );
+
+  Timer training_timer;
+  mutex output_mutex;
+
+  vector<thread> threads;
+  vector<exception_ptr> errors( _trainers.size() );
+
+  for( size_t i = 0; i < _trainers.size(); ++i ) {
+    threads.emplace_back( [this, i, &output_mutex, &errors]() {
+        TRACE_THREAD_NAME( "group trainer" );
+
+        try {
+          Trainer& trainer = *_trainers[i];
+
+          trainer.train();
+
+          lock_guard<mutex> lock( output_mutex );
+
+          cout << "Group " << i + 1 << " finished with a best MSE of "
+               << trainer.get_best_mse() << endl;
+        }
+        catch( ... ) {
+          errors[i] = current_exception();
+        }
+      } );
+  }
+
+  for( auto& t : threads )
+    t.join();
+
+  for( auto& error : errors ) {
+    if( error )
+      rethrow_exception( error );
+  }
+
+  cout << endl << "Trained " << _trainers.size() << " networks in "
+       << training_timer.get_elapsed_seconds() << " seconds" << endl;
+}
+
+/**
+ * Write the best network of every group to one results file, and add it to
+ * the results index.
+ */
+void GroupTrainer::write_results() {
+  TRACE_SCOPE( "GroupTrainer::write_results" );
+
+  TrainingResults results( _results_filename, WRITE_RESULTS );
+
+  for( auto& trainer : _trainers ) {
+    TrainingResults group_results( "", WRITE_RESULTS );
+    trainer->add_results( group_results );
+    results.add_group( group_results );
+  }
+
+  cout << endl << "Writing results to " << results.get_filename() << endl;
+
+  // the group models are written first, so that every group has a model once
+  // the results exist
+  for( size_t i = 0; i < _trainers.size(); ++i )
+    _trainers[i]->write_model(
+      ModelFile::get_group_model_filename( _results_filename, i ) );
+
+  results.write();
+
+  ResultsIndex::add_entry( _results_dir_name, results.get_index_entry() );
+}
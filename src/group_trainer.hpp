@@ -0,0 +1,86 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <exception>
+#include <csignal>
+#include <stdexcept>
+
+#include "midi_types.hpp"
+#include "trainer.hpp"
+
+namespace larasynth {
+
+class GroupTrainerException : public std::runtime_error {
+public:
+  explicit GroupTrainerException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * Trains a separate network for each group of controllers in the
+ * representation's controller_groups, which is what `lara train` does when
+ * controller groups are configured.
+ *
+ * Every group's network has the hidden layers of the [lstm] section and the
+ * note input features of the [representation] section, but only feeds back
+ * and predicts the controllers in its group, so it is much smaller than one
+ * network for all of the controllers. Each group is set up as a Trainer and
+ * trained on its own thread, and the best network of every group is written
+ * to one results file (see TrainingResults::add_group()) and to a model file
+ * of its own (see ModelFile::get_group_model_filename()), which the performer
+ * runs side by side.
+ *
+ * Grouped training does not write checkpoints and cannot be coordinated with
+ * worker processes.
+ */
+class GroupTrainer {
+public:
+  GroupTrainer( const std::string& config_directory_path,
+                volatile sig_atomic_t* shutdown_flag );
+
+  static bool has_ctrl_groups( const std::string& config_directory_path );
+
+  const std::string& get_results_filename() const
+  { return _results_filename; }
+  size_t get_group_count() const { return _trainers.size(); }
+  const Trainer& get_trainer( size_t group_i ) const
+  { return *_trainers.at( group_i ); }
+
+private:
+  void print_configuration( RepresentationConfig& repr_config );
+  void train();
+  void write_results();
+
+  volatile sig_atomic_t* _shutdown_flag;
+
+  std::string _results_filename;
+  std::string _results_dir_name;
+
+  std::vector< std::vector<event_data_t> > _ctrl_groups;
+  std::vector< std::unique_ptr<Trainer> > _trainers;
+};
+
+}
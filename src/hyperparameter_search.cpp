@@ -0,0 +1,279 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "hyperparameter_search.hpp"
+
+using namespace std;
+using namespace larasynth;
+
+HyperparameterSearch::HyperparameterSearch( const string&
+                                            config_directory_path,
+                                            volatile sig_atomic_t*
+                                            shutdown_flag )
+  : _shutdown_flag( shutdown_flag )
+{
+  ConfigDirectory dir( config_directory_path );
+  dir.process_directory();
+
+  if( !dir.training_examples_exist() ) {
+    string error = "There are no training examples in the directory " +
+      config_directory_path + ".\nCould not search.";
+    throw HyperparameterSearchException( error );
+  }
+
+  Trainer::seed_random_numbers( dir.get_config_file_path() );
+
+  ConfigParser cp( dir.get_config_file_path() );
+  ConfigParameters search_params = cp.get_section_params( "search" );
+
+  _search_config.reset( new SearchConfig( search_params ) );
+
+  _leaderboard_filename = dir.get_new_search_leaderboard_filename();
+
+  cout << "Searching hyperparameters." << endl << endl;
+  cout << "Search configuration:" << endl << endl;
+  _search_config->print_search_configuration();
+  cout << endl;
+
+  create_trials( dir );
+
+  vector<size_t> survivors;
+  for( size_t i = 0; i < _trials.size(); ++i )
+    survivors.push_back( i );
+
+  size_t epoch_budget = _search_config->get_initial_epoch_budget();
+  size_t rung = 0;
+
+  while( true ) {
+    cout << "Rung " << rung << ": training " << survivors.size()
+         << " trial(s) to " << epoch_budget << " epochs" << endl;
+
+    for( size_t i : survivors )
+      _trials[i].rung = rung;
+
+    run_rung( survivors, epoch_budget );
+
+    survivors = rank_trials( survivors );
+
+    const SearchTrial& best = _trials[survivors.front()];
+    cout << "Best MSE: " << best.best_mse << " (trial " << best.number << ")"
+         << endl;
+
+    bool all_finished = true;
+    for( size_t i : survivors ) {
+      if( !_trials[i].trainer->is_finished() )
+        all_finished = false;
+    }
+
+    if( survivors.size() == 1 || all_finished || *_shutdown_flag )
+      break;
+
+    size_t survivor_count =
+      get_survivor_count( survivors.size(),
+                          _search_config->get_reduction_factor() );
+
+    // free the networks and training sequences of eliminated trials
+    for( size_t j = survivor_count; j < survivors.size(); ++j )
+      _trials[survivors[j]].trainer.reset();
+
+    survivors.resize( survivor_count );
+
+    epoch_budget *= _search_config->get_reduction_factor();
+    ++rung;
+  }
+
+  cout << endl;
+
+  for( size_t i : survivors ) {
+    SearchTrial& trial = _trials[i];
+
+    if( trial.epoch == 0 )
+      continue;
+
+    cout << "Writing results for trial " << trial.number << " to "
+         << trial.trainer->get_results_filename() << endl;
+
+    trial.trainer->write_results();
+    trial.results_filename =
+      get_basename( trial.trainer->get_results_filename() );
+  }
+
+  write_leaderboard();
+}
+
+/**
+ * Get the number of trials that survive a rung of successive halving.
+ */
+size_t HyperparameterSearch::get_survivor_count( size_t trial_count,
+                                                 size_t reduction_factor ) {
+  return max( (size_t)1, trial_count / reduction_factor );
+}
+
+/**
+ * Describe the sampled parameters of a trial on one line.
+ */
+string HyperparameterSearch::describe_parameters( const LstmConfig&
+                                                  lstm_config,
+                                                  const RepresentationConfig&
+                                                  repr_config ) {
+  ostringstream oss;
+
+  oss << "learning_rate=" << lstm_config.get_learning_rate()
+      << " momentum=" << lstm_config.get_momentum() << " block_counts=";
+
+  const vector<size_t>& block_counts = lstm_config.get_block_counts();
+  for( size_t i = 0; i < block_counts.size(); ++i )
+    oss << ( i > 0 ? "," : "" ) << block_counts[i];
+
+  vector<pair<size_t,size_t> > output_counts;
+  for( auto& kv : repr_config.get_ctrl_output_counts() )
+    output_counts.emplace_back( kv.first, kv.second );
+  sort( output_counts.begin(), output_counts.end() );
+
+  oss << " output_counts=";
+  for( size_t i = 0; i < output_counts.size(); ++i )
+    oss << ( i > 0 ? "," : "" ) << output_counts[i].first << ":"
+        << output_counts[i].second;
+
+  oss << " update_rate=" << repr_config.get_update_rate();
+
+  return oss.str();
+}
+
+/**
+ * Parse the configuration file once for each trial so that each trial gets
+ * its own sample of the random parameters, and set up a Trainer for each.
+ * The trials are set up in parallel, so each one creates its random number
+ * generators in its own stream, numbered after the trial, to get the same
+ * random numbers however the threads are scheduled.
+ */
+void HyperparameterSearch::create_trials( ConfigDirectory& dir ) {
+  _trials.resize( _search_config->get_trial_count() );
+
+  for( size_t i = 0; i < _trials.size(); ++i ) {
+    _trials[i].number = i + 1;
+    _trials[i].rung = 0;
+    _trials[i].epoch = 0;
+    _trials[i].best_mse = INFINITY;
+    _trials[i].minutes = 0.0;
+  }
+
+  string config_file_path = dir.get_config_file_path();
+
+  run_in_parallel( _trials.size(), [&]( size_t i ) {
+      SearchTrial& trial = _trials[i];
+
+      RandGen::StreamScope stream( trial.number );
+
+      ConfigParser cp( config_file_path );
+
+      string results_filename =
+        dir.get_new_training_results_filename( "-trial-" +
+                                               to_string( trial.number ) );
+
+      trial.trainer.reset( new Trainer( dir, cp, results_filename,
+                                        _shutdown_flag, false ) );
+
+      trial.parameters =
+        describe_parameters( trial.trainer->get_lstm_config(),
+                             trial.trainer->get_repr_config() );
+    }, _search_config->get_thread_count() );
+
+  for( auto& trial : _trials )
+    cout << "Trial " << trial.number << ": " << trial.parameters << endl;
+  cout << endl;
+}
+
+/**
+ * Train each surviving trial until it has run epoch_budget epochs in total,
+ * it finishes, or it runs out of time for this rung.
+ */
+void HyperparameterSearch::run_rung( const vector<size_t>& survivors,
+                                     size_t epoch_budget ) {
+  run_in_parallel( survivors.size(), [&]( size_t i ) {
+      SearchTrial& trial = _trials[survivors[i]];
+
+      trial.trainer->train( epoch_budget,
+                            _search_config->get_trial_minutes() );
+
+      trial.epoch = trial.trainer->get_epoch();
+      trial.best_mse = trial.trainer->get_best_mse();
+      trial.minutes = trial.trainer->get_training_minutes();
+    }, _search_config->get_thread_count() );
+}
+
+/**
+ * Sort trial indexes by how far the trials got and then by best validation
+ * MSE. Ties go to the trial that trained fewer epochs.
+ */
+vector<size_t> HyperparameterSearch::rank_trials( vector<size_t> trial_is ) {
+  stable_sort( trial_is.begin(), trial_is.end(), [&]( size_t a, size_t b ) {
+      const SearchTrial& ta = _trials[a];
+      const SearchTrial& tb = _trials[b];
+
+      if( ta.rung != tb.rung )
+        return ta.rung > tb.rung;
+      if( ta.best_mse != tb.best_mse )
+        return ta.best_mse < tb.best_mse;
+      return ta.epoch < tb.epoch;
+    } );
+
+  return trial_is;
+}
+
+void HyperparameterSearch::write_leaderboard() {
+  vector<size_t> trial_is;
+  for( size_t i = 0; i < _trials.size(); ++i )
+    trial_is.push_back( i );
+
+  trial_is = rank_trials( trial_is );
+
+  ofstream out( _leaderboard_filename );
+
+  if( !out )
+    throw HyperparameterSearchException( "Could not write " +
+                                         _leaderboard_filename );
+
+  out << "rank\ttrial\trung\tepochs\tminutes\tbest_mse\tparameters\tresults"
+      << endl;
+
+  cout << "Leaderboard:" << endl << endl;
+
+  for( size_t rank = 0; rank < trial_is.size(); ++rank ) {
+    const SearchTrial& trial = _trials[trial_is[rank]];
+
+    out << rank + 1 << "\t" << trial.number << "\t" << trial.rung << "\t"
+        << trial.epoch << "\t" << trial.minutes << "\t" << trial.best_mse
+        << "\t" << trial.parameters << "\t"
+        << ( trial.results_filename.empty() ? "-" : trial.results_filename )
+        << endl;
+
+    cout << rank + 1 << ". trial " << trial.number << " MSE "
+         << trial.best_mse << " after " << trial.epoch << " epochs: "
+         << trial.parameters << endl;
+  }
+
+  out.close();
+
+  if( !out )
+    throw HyperparameterSearchException( "Could not write " +
+                                         _leaderboard_filename );
+
+  cout << endl << "Wrote leaderboard to " << _leaderboard_filename << endl;
+}
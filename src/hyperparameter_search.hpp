@@ -0,0 +1,107 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <stdexcept>
+
+#include "config_directory.hpp"
+#include "config_parser.hpp"
+#include "lstm_config.hpp"
+#include "rand_gen.hpp"
+#include "representation_config.hpp"
+#include "search_config.hpp"
+#include "trainer.hpp"
+#include "worker_pool.hpp"
+
+namespace larasynth {
+
+class HyperparameterSearchException : public std::runtime_error {
+public:
+  explicit HyperparameterSearchException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * One sampled configuration in a hyperparameter search.
+ */
+struct SearchTrial {
+  size_t number;
+  std::unique_ptr<Trainer> trainer;
+  std::string parameters;
+  size_t rung;
+  size_t epoch;
+  double best_mse;
+  double minutes;
+  std::string results_filename;
+};
+
+/**
+ * Searches for good hyperparameters using the random parameters in the
+ * configuration file, which is what `lara search` does.
+ *
+ * The configuration file is parsed once per trial, so every random value such
+ * as `learning_rate = [0.01, 0.2]` or `block_counts = [5, 30]` is sampled
+ * independently for each trial. The trials are trained in parallel using
+ * successive halving: every surviving trial trains until it reaches the
+ * epoch budget of the current rung, the best 1 / reduction_factor of them by
+ * validation MSE survive, and the budget is multiplied by reduction_factor for
+ * the next rung. This repeats until one trial is left.
+ *
+ * Results are written for every trial in the final rung, and a leaderboard of
+ * all trials is written to a search-<timestamp>.tsv file in the training
+ * results directory.
+ */
+class HyperparameterSearch {
+public:
+  HyperparameterSearch( const std::string& config_directory_path,
+                        volatile sig_atomic_t* shutdown_flag );
+
+  const std::string& get_leaderboard_filename() const
+  { return _leaderboard_filename; }
+
+  static size_t get_survivor_count( size_t trial_count,
+                                    size_t reduction_factor );
+  static std::string describe_parameters( const LstmConfig& lstm_config,
+                                          const RepresentationConfig&
+                                          repr_config );
+
+private:
+  void create_trials( ConfigDirectory& dir );
+  void run_rung( const std::vector<size_t>& survivors, size_t epoch_budget );
+  std::vector<size_t> rank_trials( std::vector<size_t> trial_is );
+  void write_leaderboard();
+
+  volatile sig_atomic_t* _shutdown_flag;
+
+  std::unique_ptr<SearchConfig> _search_config;
+  std::vector<SearchTrial> _trials;
+  std::string _leaderboard_filename;
+};
+
+}
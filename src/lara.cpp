@@ -9,8 +9,17 @@
 
 #include <iostream>
 #include <string>
+#include <sstream>
 #include <signal.h>
 #include <map>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
 
 #include "config_directory.hpp"
 #include "interactive_prompt.hpp"
@@ -22,8 +31,22 @@
 #include "performing_config.hpp"
 #include "recorder.hpp"
 #include "trainer.hpp"
+#include "hyperparameter_search.hpp"
+#include "training_benchmark.hpp"
 #include "performer.hpp"
 #include "midi_file_reader.hpp"
+#include "model_file.hpp"
+#include "compiled_model.hpp"
+#include "quantized_model.hpp"
+#include "model_pruner.hpp"
+#include "distillation_config.hpp"
+#include "distiller.hpp"
+#include "group_trainer.hpp"
+#include "example_player.hpp"
+#include "results_index.hpp"
+#include "filesystem_operations.hpp"
+#include "worker_pool.hpp"
+#include "trace.hpp"
 
 using namespace std;
 using namespace larasynth;
@@ -42,11 +65,35 @@ void print_usage_and_exit( int argc, char** argv ) {
        << " config                 - create the project directory if it does not exist and" << endl
        << "                          create a larasynth.conf file in the project directory" << endl
        << " record                 - record a training example via a MIDI port" << endl
-       << " import <MIDI filename> - create a training example from a MIDI file" << endl
-       << " train                  - train a model using the current training example(s)" << endl
+       << " import <MIDI file or directory>" << endl
+       << "                        - create training examples from MIDI files" << endl
+       << " train [--resume]       - train a model using the current training example(s)," << endl
+       << "                          or resume an interrupted training run" << endl
+       << " train [--resume] --coordinate <n>" << endl
+       << "                        - train one model with n worker processes" << endl
+       << " train --worker         - train as a worker for a running coordinator" << endl
+       << " search                 - train several models with sampled parameters and" << endl
+       << "                          keep the best ones" << endl
+       << " compile                - compile one of the trained models to native code," << endl
+       << "                          which perform uses in place of the model" << endl
+       << " quantize               - calibrate one of the trained models for integer" << endl
+       << "                          weights and report how closely the 8 and 16 bit" << endl
+       << "                          networks follow it" << endl
+       << " prune <sparsity> [--per-layer] [--fine-tune <epochs>]" << endl
+       << "                        - remove the given fraction of the smallest weights" << endl
+       << "                          from one of the trained models and write it as new" << endl
+       << "                          training results" << endl
+       << " distill                - train a smaller network to follow one of the trained" << endl
+       << "                          models and write it as new training results" << endl
        << " perform [-v]           - use one of the trained models to control a" << endl
        << "                          synthesizer's continuous controllers during" << endl
-       << "                          performance" << endl;
+       << "                          performance" << endl
+       << " bench train [options]  - write a synthetic project to a new project directory" << endl
+       << "                          and measure how fast it trains. Options:" << endl
+       << "                          --examples <n> --seconds <s> --notes-per-second <x>" << endl
+       << "                          --controllers <n> --blocks <n,...> --epochs <n>" << endl
+       << "                          --block-types <lstm|forget_gate,...>" << endl
+       << "                          --validate-every <n> --seed <n>" << endl;
   exit( EXIT_FAILURE );
 }
 
@@ -111,9 +158,43 @@ void record( const string& directory_name ) {
 }
 
 /**
- * Import a training example from a MIDI file.
+ * Get the MIDI files in a directory, sorted by name.
  */
-void import( const string& directory_name, const string& midi_filename ) {
+vector<string> get_midi_filenames( string midi_dir_name ) {
+  append_slash_if_necessary( midi_dir_name );
+
+  vector<string> filenames;
+  vector<string> subdirs;
+
+  get_directory_filenames_and_subdirs( midi_dir_name, filenames, subdirs );
+
+  vector<string> midi_filenames;
+
+  for( const string& filename : filenames ) {
+    size_t dot = filename.rfind( '.' );
+
+    if( dot == string::npos )
+      continue;
+
+    string extension = filename.substr( dot );
+    transform( extension.begin(), extension.end(), extension.begin(),
+               ::tolower );
+
+    if( extension == ".mid" || extension == ".midi" )
+      midi_filenames.push_back( midi_dir_name + filename );
+  }
+
+  sort( midi_filenames.begin(), midi_filenames.end() );
+
+  return midi_filenames;
+}
+
+/**
+ * Import training examples from a MIDI file or from every MIDI file in a
+ * directory. The MIDI files are read in parallel, and the examples are written
+ * in filename order.
+ */
+void import( const string& directory_name, const string& midi_path ) {
   ConfigDirectory dir( directory_name );
   dir.process_directory();
 
@@ -121,48 +202,166 @@ void import( const string& directory_name, const string& midi_filename ) {
   ConfigParameters params = cp.get_section_params( "midi" );
   MidiConfig mc( params );
 
-  MidiFileReader reader( midi_filename, mc.get_ctrls() );
-  vector<Event> events = reader.get_events();
+  vector<string> midi_filenames;
 
-  cout << "Read events from " << reader.get_track_count() << " tracks in "
-       << midi_filename << ": " << endl
-       << "  " << reader.get_note_on_count() << " notes" << endl
-       << "  " << reader.get_ctrl_change_count() << " controller events"
-       << endl;
+  if( is_directory( midi_path ) ) {
+    midi_filenames = get_midi_filenames( midi_path );
+
+    if( midi_filenames.empty() )
+      throw MidiFileReaderException( "No MIDI files found in " + midi_path );
+  }
+  else {
+    midi_filenames.push_back( midi_path );
+  }
+
+  vector<unique_ptr<MidiFileReader>> readers( midi_filenames.size() );
+  vector<event_data_t> ctrls = mc.get_ctrls();
+
+  run_in_parallel( midi_filenames.size(), [&]( size_t i ) {
+      readers[i].reset( new MidiFileReader( midi_filenames[i], ctrls ) );
+    } );
+
+  for( size_t i = 0; i < readers.size(); ++i ) {
+    const MidiFileReader& reader = *readers[i];
+    const vector<Event>& events = reader.get_events_ref();
 
-  string training_example_filename = dir.get_new_training_example_filename();
+    cout << "Read events from " << reader.get_track_count() << " tracks in "
+         << midi_filenames[i] << ": " << endl
+         << "  " << reader.get_note_on_count() << " notes" << endl
+         << "  " << reader.get_ctrl_change_count() << " controller events"
+         << endl;
 
-  write_events( events, training_example_filename );
+    string training_example_filename =
+      dir.get_new_training_example_filename();
 
-  cout << "Wrote " << events.size() << " events to "
-       << training_example_filename << endl;
+    write_events( events, training_example_filename );
+
+    cout << "Wrote " << events.size() << " events to "
+         << training_example_filename << endl;
+  }
 }
 
 /**
- * Train a model.
+ * Train a model, or a model for each controller group.
  */
-void train( const string& directory_name ) {
-  Trainer( directory_name, &lara_shutdown_flag );
+void train( const string& directory_name, bool resume,
+            size_t worker_process_count ) {
+  if( !GroupTrainer::has_ctrl_groups( directory_name ) ) {
+    Trainer( directory_name, &lara_shutdown_flag, resume,
+             worker_process_count );
+    return;
+  }
+
+  if( resume || worker_process_count > 0 ) {
+    cerr << "Controller groups cannot be trained with --resume or "
+         << "--coordinate" << endl;
+    exit( EXIT_FAILURE );
+  }
+
+  GroupTrainer( directory_name, &lara_shutdown_flag );
 }
 
 /**
- * Perform using a trained model.
+ * Search for good training parameters.
  */
-void perform( const string& directory_name, bool verbose ) {
-  ConfigDirectory dir( directory_name );
-  dir.process_directory();
+void search( const string& directory_name ) {
+  HyperparameterSearch( directory_name, &lara_shutdown_flag );
+}
 
-  ConfigParser cp( dir.get_config_file_path() );
+/**
+ * Parse a comma separated list of block counts such as 16,16.
+ */
+bool parse_block_counts( const string& s, vector<size_t>& block_counts ) {
+  block_counts.clear();
 
-  ConfigParameters lstm_params = cp.get_section_params( "lstm" );
-  ConfigParameters seq_params = cp.get_section_params( "representation" );
-  ConfigParameters midi_params = cp.get_section_params( "midi" );
-  ConfigParameters perform_params = cp.get_section_params( "performing" );
+  istringstream iss( s );
+  string count;
 
-  PerformingConfig perform_config( perform_params );
+  while( getline( iss, count, ',' ) ) {
+    size_t block_count = strtoul( count.c_str(), nullptr, 10 );
+    if( block_count == 0 )
+      return false;
+    block_counts.push_back( block_count );
+  }
 
-  MidiConfig midi_config( midi_params );
+  return !block_counts.empty();
+}
+
+bool parse_block_types( const string& s, vector<lstm_block_t>& block_types ) {
+  block_types.clear();
+
+  istringstream iss( s );
+  string type;
+
+  while( getline( iss, type, ',' ) ) {
+    lstm_block_t block_type = string_to_block_type( type );
+    if( block_type == NO_BLOCK_TYPE )
+      return false;
+    block_types.push_back( block_type );
+  }
+
+  return !block_types.empty();
+}
 
+/**
+ * Generate a synthetic project and measure training throughput. The options
+ * start at argv[4].
+ */
+void bench_train( const string& directory_name, int argc, char** argv ) {
+  TrainingBenchmarkConfig config;
+
+  for( int i = 4; i + 1 < argc; i += 2 ) {
+    string option = argv[i];
+    string value = argv[i + 1];
+
+    size_t count = strtoul( value.c_str(), nullptr, 10 );
+    double number = strtod( value.c_str(), nullptr );
+
+    bool valid = true;
+
+    if( option == "--examples" )
+      valid = ( config.example_count = count ) > 0;
+    else if( option == "--seconds" )
+      valid = ( config.example_seconds = number ) > 0.0;
+    else if( option == "--notes-per-second" )
+      valid = ( config.notes_per_second = number ) > 0.0;
+    else if( option == "--controllers" )
+      valid = ( config.controller_count = count ) > 0;
+    else if( option == "--blocks" )
+      valid = parse_block_counts( value, config.block_counts );
+    else if( option == "--block-types" )
+      valid = parse_block_types( value, config.block_types );
+    else if( option == "--epochs" )
+      valid = ( config.epoch_count = count ) > 0;
+    else if( option == "--validate-every" )
+      valid = ( config.epoch_count_before_validating = count ) > 0;
+    else if( option == "--seed" )
+      config.seed = count;
+    else
+      valid = false;
+
+    if( !valid ) {
+      cerr << "Invalid benchmark option " << option << " " << value << endl;
+      print_usage_and_exit( argc, argv );
+    }
+  }
+
+  if( !config.block_types.empty() &&
+      config.block_types.size() != config.block_counts.size() ) {
+    cerr << "--block-types needs a type for each hidden layer" << endl;
+    print_usage_and_exit( argc, argv );
+  }
+
+  TrainingBenchmark( directory_name, config, &lara_shutdown_flag );
+}
+
+/**
+ * Choose the training results to use: the configured file, such as the one
+ * named in the [performing] section, or one that the user picks from the list
+ * of results.
+ */
+string choose_results_filename( ConfigDirectory& dir,
+                                const string& configured_filename ) {
   vector<string> results_filenames = dir.get_training_results_filenames();
 
   map<string, string> filenames_by_display_filename;
@@ -182,7 +381,7 @@ void perform( const string& directory_name, bool verbose ) {
       filenames_by_display_filename[display_filename] = filename;
   }
 
-  string results_filename = perform_config.get_training_results_filename();
+  string results_filename = configured_filename;
 
   if( results_filename != "" ) {
     if( filenames_by_display_filename.count( results_filename ) == 0 ) {
@@ -194,7 +393,7 @@ void perform( const string& directory_name, bool verbose ) {
     results_filename = filenames_by_display_filename[results_filename];
   }
   else {
-    vector<TrainingResults> training_results;
+    ResultsIndex index( dir.get_training_results_directory_name() );
 
     vector<ip_choice_t> choices;
 
@@ -203,11 +402,27 @@ void perform( const string& directory_name, bool verbose ) {
       string display_filename = kv.first;
       string filename = kv.second;
 
-      training_results.emplace_back( filename, READ_RESULTS );
+      double mse;
+
+      if( index.has_entry( filename ) ) {
+        mse = index.get_entry( filename ).mse;
+      }
+      else {
+        // results from before the index existed are parsed once and added
+        TrainingResults results( filename, READ_RESULTS );
+        mse = results.get_mse();
+
+        try {
+          ResultsIndex::add_entry( dir.get_training_results_directory_name(),
+                                   results.get_index_entry() );
+        }
+        catch( const runtime_error& e ) {
+          // the index is only a cache, so carry on without it
+        }
+      }
 
       ostringstream description;
-      description << "MSE: " << training_results.back().get_mse() << " - "
-                  << display_filename;
+      description << "MSE: " << mse << " - " << display_filename;
 
       choices.emplace_back( to_string( choice_number ), description.str() );
       ++choice_number;
@@ -226,27 +441,472 @@ void perform( const string& directory_name, bool verbose ) {
     cout << endl;
   }
 
+  return results_filename;
+}
+
+/**
+ * Compile a trained model to native code, which perform uses instead of
+ * the network in the model file.
+ */
+void compile( const string& directory_name ) {
+  ConfigDirectory dir( directory_name );
+  dir.process_directory();
+
+  ConfigParser cp( dir.get_config_file_path() );
+
+  ConfigParameters perform_params = cp.get_section_params( "performing" );
+
+  PerformingConfig perform_config( perform_params );
+
+  string results_filename =
+    choose_results_filename( dir,
+                             perform_config.get_training_results_filename() );
+
+  try {
+    string model_filename = ModelFile::get_model_filename( results_filename );
+
+    littlelstm::LstmNetwork net = is_regular_file( model_filename )
+      ? ModelFile( model_filename ).get_trained_network()
+      : TrainingResults( results_filename,
+                         READ_RESULTS ).get_trained_network();
+
+    // the compiled code follows the activation functions and step order
+    // the network was trained with, and perform checks them
+    CompiledModel::write( results_filename, net );
+
+    cout << "Wrote " << CompiledModel::get_header_filename( results_filename )
+         << endl
+         << "Compiling "
+         << CompiledModel::get_source_filename( results_filename ) << endl;
+
+    CompiledModel::build( results_filename );
+
+    cout << "Wrote " << CompiledModel::get_library_filename( results_filename )
+         << endl;
+  }
+  catch( const TrainingResultsException& e ) {
+    cerr << "Error reading " << results_filename << ": " << e.what() << endl;
+    exit( EXIT_FAILURE );
+  }
+  catch( const ModelFileException& e ) {
+    cerr << "Error reading model: " << e.what() << endl;
+    exit( EXIT_FAILURE );
+  }
+}
+
+/**
+ * Print the size of a quantized network's weights and how often it agreed
+ * with the trained network.
+ */
+void print_quantization_report( const QuantizationReport& report,
+                                size_t double_weight_bytes ) {
+  cout << report.weight_bits << " bit weights: " << report.weight_bytes
+       << " bytes (" << double_weight_bytes << " as doubles)" << endl;
+
+  for( auto& kv : report.comparison.ctrl_agreement )
+    cout << "  Controller " << (int)kv.first << " agreement: "
+         << kv.second * 100.0 << "%" << endl;
+
+  cout << "  All controllers agreement: "
+       << report.comparison.all_ctrls_agreement * 100.0 << "%" << endl
+       << "  Max output error: " << report.comparison.max_output_error
+       << endl;
+}
+
+/**
+ * Calibrate a trained model for quantized weights over the training
+ * examples, and report how closely the quantized networks follow it.
+ */
+void quantize( const string& directory_name ) {
+  ConfigDirectory dir( directory_name );
+  dir.process_directory();
+
+  if( !dir.training_examples_exist() ) {
+    cerr << "There are no training examples to calibrate with" << endl;
+    exit( EXIT_FAILURE );
+  }
+
+  ConfigParser cp( dir.get_config_file_path() );
+
+  ConfigParameters lstm_params = cp.get_section_params( "lstm" );
+  ConfigParameters midi_params = cp.get_section_params( "midi" );
+  ConfigParameters perform_params = cp.get_section_params( "performing" );
+
+  PerformingConfig perform_config( perform_params );
+
+  MidiConfig midi_config( midi_params );
+
+  LstmConfig lstm_config( lstm_params );
+
+  string results_filename =
+    choose_results_filename( dir,
+                             perform_config.get_training_results_filename() );
+
   try {
-    TrainingResults results( results_filename, READ_RESULTS );
+    string model_filename = ModelFile::get_model_filename( results_filename );
+
+    unique_ptr<ModelFile> model;
+    unique_ptr<TrainingResults> results;
+
+    if( is_regular_file( model_filename ) )
+      model.reset( new ModelFile( model_filename ) );
+    else
+      results.reset( new TrainingResults( results_filename, READ_RESULTS ) );
+
+    MidiMinMax min_max = model ? model->get_min_max()
+                               : results->get_min_max();
+
+    RepresentationConfig repr_config = model ? model->get_repr_config()
+                                             : results->get_repr_config();
+
+    littlelstm::LstmNetwork net = model ? model->get_trained_network()
+                                        : results->get_trained_network();
 
-    MidiMinMax min_max = results.get_min_max();
+    net.set_step_thread_count( lstm_config.get_step_thread_count() );
 
-    littlelstm::LstmNetwork net = results.get_trained_network();
+    ExamplePlayer player( dir.get_training_example_filenames(), midi_config,
+                          repr_config, min_max );
 
-    RepresentationConfig repr_config = results.get_repr_config();
+    QuantizationCalibration calibration =
+      QuantizedModel::calibrate( player, net );
+
+    cout << "Calibrated over " << calibration.update_count << " updates"
+         << endl << endl;
+
+    size_t double_weight_bytes =
+      net.get_connection_weights().size() * sizeof( double );
+
+    for( size_t weight_bits : { 16, 8 } ) {
+      QuantizedNetwork quantized_net( net, calibration, weight_bits );
+
+      print_quantization_report( QuantizedModel::compare( player, net,
+                                                          quantized_net ),
+                                 double_weight_bytes );
+      cout << endl;
+    }
+
+    QuantizedModel::write_calibration( results_filename, calibration );
+
+    cout << "Wrote "
+         << QuantizedModel::get_calibration_filename( results_filename )
+         << endl
+         << "Set weight_bits in the [performing] section to perform with "
+         << "quantized weights" << endl;
+  }
+  catch( const TrainingResultsException& e ) {
+    cerr << "Error reading " << results_filename << ": " << e.what() << endl;
+    exit( EXIT_FAILURE );
+  }
+  catch( const ModelFileException& e ) {
+    cerr << "Error reading model: " << e.what() << endl;
+    exit( EXIT_FAILURE );
+  }
+  catch( const QuantizedModelException& e ) {
+    cerr << e.what() << endl;
+    exit( EXIT_FAILURE );
+  }
+}
+
+/**
+ * Prune one of the trained models and write the pruned model as new training
+ * results. The options start at argv[4].
+ */
+void prune( const string& directory_name, int argc, char** argv ) {
+  PruningConfig config;
+
+  char* end;
+  config.sparsity = strtod( argv[3], &end );
+
+  if( *end != '\0' || config.sparsity < 0.0 || config.sparsity >= 1.0 ) {
+    cerr << "The sparsity must be at least 0 and less than 1" << endl;
+    print_usage_and_exit( argc, argv );
+  }
+
+  for( int i = 4; i < argc; ++i ) {
+    string option = argv[i];
+
+    if( option == "--per-layer" ) {
+      config.per_layer = true;
+    }
+    else if( option == "--fine-tune" && i + 1 < argc ) {
+      config.fine_tune_epoch_count = strtoul( argv[++i], nullptr, 10 );
+
+      if( config.fine_tune_epoch_count == 0 ) {
+        cerr << "Invalid value for --fine-tune" << endl;
+        print_usage_and_exit( argc, argv );
+      }
+    }
+    else {
+      cerr << "Unknown prune option " << option << endl;
+      print_usage_and_exit( argc, argv );
+    }
+  }
+
+  ConfigDirectory dir( directory_name );
+  dir.process_directory();
+
+  ConfigParser cp( dir.get_config_file_path() );
+  ConfigParameters perform_params = cp.get_section_params( "performing" );
+  PerformingConfig perform_config( perform_params );
+
+  string results_filename =
+    choose_results_filename( dir,
+                             perform_config.get_training_results_filename() );
+
+  try {
+    ModelPruner pruner( directory_name, results_filename, config,
+                        &lara_shutdown_flag );
+
+    const PruningReport& report = pruner.get_report();
+
+    cout << "Connections: " << report.connection_count << " -> "
+         << report.remaining_connection_count << " (sparsity "
+         << report.get_sparsity() * 100.0 << "%)" << endl
+         << "MSE before pruning: " << report.mse << endl
+         << "MSE after pruning:  " << report.pruned_mse << " ("
+         << showpos << report.pruned_mse - report.mse << noshowpos << ")"
+         << endl;
+
+    if( report.fine_tune_epoch_count > 0 )
+      cout << "MSE after " << report.fine_tune_epoch_count
+           << " fine-tuning epochs: " << report.fine_tuned_mse << " ("
+           << showpos << report.fine_tuned_mse - report.mse << noshowpos
+           << ")" << endl;
+
+    cout << "Wrote " << pruner.get_pruned_results_filename() << endl;
+  }
+  catch( const TrainingResultsException& e ) {
+    cerr << "Error reading " << results_filename << ": " << e.what() << endl;
+    exit( EXIT_FAILURE );
+  }
+  catch( const ModelFileException& e ) {
+    cerr << "Error reading model: " << e.what() << endl;
+    exit( EXIT_FAILURE );
+  }
+}
+
+/**
+ * Train a network with the block counts in [distillation] to follow one of
+ * the trained models, the teacher, and write it as new training results.
+ */
+void distill( const string& directory_name ) {
+  ConfigDirectory dir( directory_name );
+  dir.process_directory();
+
+  ConfigParser cp( dir.get_config_file_path() );
+  ConfigParameters distillation_params =
+    cp.get_section_params( "distillation" );
+  DistillationConfig distillation_config( distillation_params );
+
+  string results_filename =
+    choose_results_filename( dir,
+                             distillation_config
+                             .get_teacher_results_filename() );
+
+  cout << "Distilling " << results_filename << endl
+       << "Press Ctrl-C to stop and keep the best student so far" << endl;
+
+  auto print_progress = [&]( size_t epoch,
+                             const NetworkComparison& comparison ) {
+    cout << "Epoch " << epoch << ": agreement "
+         << comparison.all_ctrls_agreement * 100.0 << "%, MSE "
+         << comparison.mse << " (teacher " << comparison.reference_mse << ")"
+         << endl;
+  };
+
+  try {
+    Distiller distiller( directory_name, results_filename,
+                         &lara_shutdown_flag, print_progress );
+
+    const DistillationReport& report = distiller.get_report();
+
+    cout << endl
+         << "Connections: " << report.teacher_connection_count << " -> "
+         << report.student_connection_count << endl
+         << "Kept the student from epoch " << report.best_epoch << " of "
+         << report.epoch_count << endl;
+
+    for( auto& kv : report.comparison.ctrl_agreement )
+      cout << "  Controller " << (int)kv.first << " agreement: "
+           << kv.second * 100.0 << "%" << endl;
+
+    cout << "  All controllers agreement: "
+         << report.comparison.all_ctrls_agreement * 100.0 << "%" << endl
+         << "  Teacher MSE: " << report.comparison.reference_mse << endl
+         << "  Student MSE: " << report.comparison.mse << endl;
+
+    if( !report.thresholds_met )
+      cout << "The student did not reach min_agreement and max_mse_ratio"
+           << endl;
+
+    cout << "Wrote " << distiller.get_student_results_filename() << endl;
+  }
+  catch( const TrainingResultsException& e ) {
+    cerr << "Error reading " << results_filename << ": " << e.what() << endl;
+    exit( EXIT_FAILURE );
+  }
+  catch( const ModelFileException& e ) {
+    cerr << "Error reading model: " << e.what() << endl;
+    exit( EXIT_FAILURE );
+  }
+}
+
+/**
+ * Perform using a trained model.
+ */
+void perform( const string& directory_name, bool verbose ) {
+  ConfigDirectory dir( directory_name );
+  dir.process_directory();
+
+  ConfigParser cp( dir.get_config_file_path() );
+
+  ConfigParameters lstm_params = cp.get_section_params( "lstm" );
+  ConfigParameters seq_params = cp.get_section_params( "representation" );
+  ConfigParameters midi_params = cp.get_section_params( "midi" );
+  ConfigParameters perform_params = cp.get_section_params( "performing" );
+
+  PerformingConfig perform_config( perform_params );
+
+  MidiConfig midi_config( midi_params );
+
+  LstmConfig lstm_config( lstm_params );
+
+  string results_filename =
+    choose_results_filename( dir,
+                             perform_config.get_training_results_filename() );
+
+  try {
+    string model_filename = ModelFile::get_model_filename( results_filename );
+
+    size_t group_model_count =
+      ModelFile::get_group_model_count( results_filename );
+
+    // results written before binary models existed only have the JSON file
+    unique_ptr<ModelFile> model;
+    unique_ptr<TrainingResults> results;
+
+    if( is_regular_file( model_filename ) )
+      model.reset( new ModelFile( model_filename ) );
+    else if( group_model_count == 0 )
+      results.reset( new TrainingResults( results_filename, READ_RESULTS ) );
+
+    // results trained for controller groups have a network for each group,
+    // which are performed side by side with their trained weights
+    if( !model && ( group_model_count > 0 || results->is_grouped() ) ) {
+      vector< unique_ptr<littlelstm::LstmNetwork> > group_nets;
+      vector<PerformingNetwork> networks;
+
+      size_t group_count = results ? results->get_group_count()
+                                   : group_model_count;
+
+      for( size_t i = 0; i < group_count; ++i ) {
+        if( results ) {
+          TrainingResults group_results = results->get_group( i );
+
+          group_nets.emplace_back(
+            new littlelstm::LstmNetwork( group_results.get_trained_network() )
+            );
+          networks.push_back( { group_nets.back().get(),
+                                group_results.get_repr_config(),
+                                group_results.get_min_max() } );
+        }
+        else {
+          ModelFile group_model(
+            ModelFile::get_group_model_filename( results_filename, i ) );
+
+          group_nets.emplace_back(
+            new littlelstm::LstmNetwork( group_model.get_trained_network() ) );
+          networks.push_back( { group_nets.back().get(),
+                                group_model.get_repr_config(),
+                                group_model.get_min_max() } );
+        }
+
+        group_nets.back()->set_step_thread_count(
+          lstm_config.get_step_thread_count() );
+      }
+
+      if( perform_config.get_weight_bits() != 0 )
+        cout << "Quantized weights are not available for controller groups"
+             << endl;
+
+      cout << "Performing with a network for each of " << networks.size()
+           << " controller groups" << endl;
+
+      RtMidiClient midi_client( "larasynth",
+                                midi_config.get_performing_source_port(),
+                                midi_config.get_performing_destination_port(),
+                                PERFORM );
+
+      Performer p( &midi_client, networks, midi_config, &lara_shutdown_flag,
+                   verbose );
+
+      return;
+    }
+
+    MidiMinMax min_max = model ? model->get_min_max()
+                               : results->get_min_max();
+
+    littlelstm::LstmNetwork net = model ? model->get_trained_network()
+                                        : results->get_trained_network();
+
+    net.set_step_thread_count( lstm_config.get_step_thread_count() );
+
+    // quantized weights are used if the [performing] section asks for them,
+    // otherwise a network compiled with lara compile is used if it is up to
+    // date
+    unique_ptr<littlelstm::QuantizedNetwork> quantized_net;
+    unique_ptr<littlelstm::CompiledNetwork> compiled_net;
+
+    if( perform_config.get_weight_bits() != 0 ) {
+      try {
+        quantized_net = QuantizedModel::load( results_filename, net,
+                                              perform_config.get_weight_bits()
+                                              );
+        cout << "Performing with " << perform_config.get_weight_bits()
+             << " bit weights" << endl;
+      }
+      catch( const QuantizedModelException& e ) {
+        cerr << e.what() << endl;
+        exit( EXIT_FAILURE );
+      }
+    }
+    else if( is_regular_file( CompiledModel::get_library_filename(
+                                results_filename ) ) ) {
+      try {
+        compiled_net = CompiledModel::load( results_filename, net );
+        cout << "Performing with the compiled network" << endl;
+      }
+      catch( const CompiledModelException& e ) {
+        cout << e.what() << endl
+             << "Performing without the compiled network. Run compile "
+             << "again to update it." << endl;
+      }
+    }
+
+    RepresentationConfig repr_config = model ? model->get_repr_config()
+                                             : results->get_repr_config();
 
     RtMidiClient midi_client( "larasynth",
                               midi_config.get_performing_source_port(),
                               midi_config.get_performing_destination_port(),
                               PERFORM );
 
-    Performer p( &midi_client, net, midi_config, repr_config, min_max,
-                 &lara_shutdown_flag, verbose );
+    littlelstm::FeedForwardNetwork* performing_net =
+      quantized_net ? (littlelstm::FeedForwardNetwork*)quantized_net.get()
+      : compiled_net ? (littlelstm::FeedForwardNetwork*)compiled_net.get()
+      : (littlelstm::FeedForwardNetwork*)&net;
+
+    Performer p( &midi_client, { { performing_net, repr_config, min_max } },
+                 midi_config, &lara_shutdown_flag, verbose );
   }
   catch( const TrainingResultsException& e ) {
     cerr << "Error reading " << results_filename << endl
          << "Please choose a different file or re-train" << endl;
   }
+  catch( const ModelFileException& e ) {
+    cerr << "Error reading model: " << e.what() << endl
+         << "Please choose a different file or re-train" << endl;
+  }
   catch( const MidiException& e ) {
     cerr << "Midi client error: " << e.what() << endl;
   }
@@ -271,8 +931,14 @@ int main( int argc, char** argv ) {
     { "config", { 3 } },
     { "record", { 3 } },
     { "import", { 4 } },
-    { "train", { 3 } },
-    { "perform", { 3, 4 } }
+    { "train", { 3, 4, 5, 6 } },
+    { "search", { 3 } },
+    { "compile", { 3 } },
+    { "quantize", { 3 } },
+    { "prune", { 4, 5, 6, 7 } },
+    { "distill", { 3 } },
+    { "perform", { 3, 4 } },
+    { "bench", { 4, 6, 8, 10, 12, 14, 16, 18, 20, 22 } }
   };
 
   if( action_argc.count( action ) == 0 ) {
@@ -288,6 +954,12 @@ int main( int argc, char** argv ) {
   }
 
   try {
+    // only does anything in builds configured with --enable-tracing. config
+    // and bench may be creating the directory
+    if( is_directory( directory_name ) )
+      TRACE_START( directory_name + "/trace-" + to_string( time( nullptr ) ) +
+                   "-" + to_string( getpid() ) + ".json" );
+
     if( action == "config" ) {
       config( directory_name );
     }
@@ -299,7 +971,51 @@ int main( int argc, char** argv ) {
       import( directory_name, midi_filename );
     }
     else if( action == "train" ) {
-      train( directory_name );
+      bool resume = false;
+      bool worker = false;
+      size_t worker_process_count = 0;
+
+      for( int i = 3; i < argc; ++i ) {
+        if( strcmp( argv[i], "--resume" ) == 0 ) {
+          resume = true;
+        }
+        else if( strcmp( argv[i], "--worker" ) == 0 ) {
+          worker = true;
+        }
+        else if( strcmp( argv[i], "--coordinate" ) == 0 && i + 1 < argc &&
+                 atoi( argv[i + 1] ) > 0 ) {
+          worker_process_count = atoi( argv[++i] );
+        }
+        else {
+          cerr << "Unknown argument " << argv[i] << endl;
+          print_usage_and_exit( argc, argv );
+        }
+      }
+
+      if( worker && ( resume || worker_process_count > 0 ) ) {
+        cerr << "--worker cannot be combined with other arguments" << endl;
+        print_usage_and_exit( argc, argv );
+      }
+
+      if( worker )
+        Trainer::train_as_worker( directory_name );
+      else
+        train( directory_name, resume, worker_process_count );
+    }
+    else if( action == "search" ) {
+      search( directory_name );
+    }
+    else if( action == "compile" ) {
+      compile( directory_name );
+    }
+    else if( action == "quantize" ) {
+      quantize( directory_name );
+    }
+    else if( action == "prune" ) {
+      prune( directory_name, argc, argv );
+    }
+    else if( action == "distill" ) {
+      distill( directory_name );
     }
     else if( action == "perform" ) {
       bool verbose = false;
@@ -316,12 +1032,23 @@ int main( int argc, char** argv ) {
 
       perform( directory_name, verbose );
     }
+    else if( action == "bench" ) {
+      if( strcmp( argv[3], "train" ) != 0 ) {
+        cerr << "Unknown benchmark " << argv[3] << endl;
+        print_usage_and_exit( argc, argv );
+      }
+
+      bench_train( directory_name, argc, argv );
+    }
   }
   catch( runtime_error& e ) {
+    TRACE_STOP();
     cerr << e.what() << endl;
     exit( EXIT_FAILURE );
   }
 
+  TRACE_STOP();
+
   exit( EXIT_SUCCESS );
 }
 
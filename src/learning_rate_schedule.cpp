@@ -0,0 +1,116 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "learning_rate_schedule.hpp"
+
+using namespace std;
+using namespace larasynth;
+
+string larasynth::schedule_type_to_string( lr_schedule_t type ) {
+  switch( type ) {
+  case CONSTANT_SCHEDULE:
+    return "constant";
+  case STEP_SCHEDULE:
+    return "step";
+  case COSINE_SCHEDULE:
+    return "cosine";
+  case PLATEAU_SCHEDULE:
+    return "plateau";
+  default:
+    return "";
+  }
+}
+
+lr_schedule_t larasynth::string_to_schedule_type( const string& str ) {
+  if( str == "constant" )
+    return CONSTANT_SCHEDULE;
+  else if( str == "step" )
+    return STEP_SCHEDULE;
+  else if( str == "cosine" )
+    return COSINE_SCHEDULE;
+  else if( str == "plateau" )
+    return PLATEAU_SCHEDULE;
+  else
+    return NO_SCHEDULE;
+}
+
+LearningRateSchedule::LearningRateSchedule( lr_schedule_t type,
+                                            double learning_rate,
+                                            double min_learning_rate,
+                                            double decay,
+                                            size_t schedule_epochs,
+                                            size_t plateau_patience )
+  : _type( type )
+  , _learning_rate( learning_rate )
+  , _min_learning_rate( min_learning_rate )
+  , _decay( decay )
+  , _schedule_epochs( schedule_epochs )
+  , _plateau_patience( plateau_patience )
+{}
+
+/**
+ * Get the learning rate for an epoch. Epochs are counted from 1.
+ */
+double LearningRateSchedule::get_learning_rate( size_t epoch ) const {
+  size_t epochs_done = epoch > 0 ? epoch - 1 : 0;
+  double learning_rate;
+
+  switch( _type ) {
+  case STEP_SCHEDULE:
+    learning_rate = _learning_rate *
+      pow( _decay, (double)( epochs_done / _schedule_epochs ) );
+    break;
+  case COSINE_SCHEDULE: {
+    double progress =
+      (double)( epochs_done % _schedule_epochs ) / _schedule_epochs;
+    learning_rate = _min_learning_rate + 0.5 *
+      ( _learning_rate - _min_learning_rate ) *
+      ( 1.0 + cos( M_PI * progress ) );
+    break;
+  }
+  case PLATEAU_SCHEDULE:
+    learning_rate = _learning_rate * _state.plateau_scale;
+    break;
+  default:
+    learning_rate = _learning_rate;
+    break;
+  }
+
+  return max( learning_rate, _min_learning_rate );
+}
+
+/**
+ * Tell the schedule the MSE of a validation run. Only the plateau schedule
+ * uses it.
+ */
+void LearningRateSchedule::report_validation_mse( double mse ) {
+  if( mse < _state.best_mse ) {
+    _state.best_mse = mse;
+    _state.stale_validation_count = 0;
+    return;
+  }
+
+  ++_state.stale_validation_count;
+
+  if( _type == PLATEAU_SCHEDULE &&
+      _state.stale_validation_count >= _plateau_patience ) {
+    _state.plateau_scale *= _decay;
+    _state.stale_validation_count = 0;
+  }
+}
@@ -0,0 +1,83 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+namespace larasynth {
+
+enum lr_schedule_t {
+  CONSTANT_SCHEDULE,
+  STEP_SCHEDULE,
+  COSINE_SCHEDULE,
+  PLATEAU_SCHEDULE,
+  NO_SCHEDULE
+};
+
+std::string schedule_type_to_string( lr_schedule_t type );
+lr_schedule_t string_to_schedule_type( const std::string& str );
+
+/**
+ * The part of a schedule that depends on the validation results rather than
+ * on the epoch, saved in checkpoints.
+ */
+struct LearningRateScheduleState {
+  double plateau_scale = 1.0;
+  double best_mse = INFINITY;
+  size_t stale_validation_count = 0;
+};
+
+/**
+ * Decides the learning rate for each training epoch.
+ *
+ * CONSTANT_SCHEDULE always uses the base learning rate. STEP_SCHEDULE
+ * multiplies it by the decay every schedule_epochs epochs. COSINE_SCHEDULE
+ * anneals it down to the minimum learning rate along half a cosine over
+ * schedule_epochs epochs and then starts over. PLATEAU_SCHEDULE multiplies it
+ * by the decay whenever the validation MSE has not improved for
+ * plateau_patience validations in a row. No schedule goes below the minimum
+ * learning rate.
+ */
+class LearningRateSchedule {
+public:
+  LearningRateSchedule( lr_schedule_t type, double learning_rate,
+                        double min_learning_rate, double decay,
+                        size_t schedule_epochs, size_t plateau_patience );
+
+  double get_learning_rate( size_t epoch ) const;
+  void report_validation_mse( double mse );
+
+  LearningRateScheduleState get_state() const { return _state; }
+  void set_state( const LearningRateScheduleState& state ) { _state = state; }
+
+private:
+  lr_schedule_t _type;
+  double _learning_rate;
+  double _min_learning_rate;
+  double _decay;
+  size_t _schedule_epochs;
+  size_t _plateau_patience;
+
+  LearningRateScheduleState _state;
+};
+
+}
@@ -24,149 +24,228 @@ using namespace larasynth;
 
 Lexer::Lexer( const string& filename, vector<string> reserved_strings )
   : _filename( filename ),
-    _reserved_strings( reserved_strings )
+    _reserved_strings( reserved_strings ),
+    _source_name( make_shared<const string>( filename ) )
 {
   read_file();
   tokenize();
 }
 
 void Lexer::read_file() {
-  ifstream file( _filename.c_str() );
-
-  if( !file )
+  try {
+    _buffer = make_shared<const MappedFile>( _filename );
+  }
+  catch( FilesystemException& e ) {
     throw LexerException( "Error opening " + _filename );
+  }
 
-  string line;
-  while( getline( file, line ) )
-    _lines.push_back( line );
+  _tokens.set_source( _source_name, _buffer );
+}
+
+vector<string> Lexer::get_lines() {
+  vector<string> lines;
+
+  const char* p = _buffer->data();
+  const char* end = p + _buffer->size();
+
+  while( p < end ) {
+    const char* newline =
+      static_cast<const char*>( memchr( p, '\n', end - p ) );
+    const char* line_end = ( newline == nullptr ) ? end : newline;
+
+    lines.emplace_back( p, line_end );
+
+    p = line_end + 1;
+  }
+
+  return lines;
 }
 
 void Lexer::tokenize() {
+  const char* p = _buffer->data();
+  const char* end = p + _buffer->size();
+
   size_t line_number = 0;
-  for( string line : _lines ) {
+
+  while( p < end ) {
     ++line_number;
-    tokenize_line( line, line_number );
+
+    const char* newline =
+      static_cast<const char*>( memchr( p, '\n', end - p ) );
+    const char* line_end = ( newline == nullptr ) ? end : newline;
+
+    tokenize_line( p, line_end, line_number );
+
+    p = line_end + 1;
   }
 }
 
-void Lexer::tokenize_line( string line, size_t line_number ) {
-  ostringstream loc_oss;
-  loc_oss << _filename << ":" << line_number;
-  string location = loc_oss.str();
+void Lexer::add_token( token_t type, const char* begin, const char* end,
+                       size_t line_number ) {
+  _tokens.add( Token( type, StringRef( begin, end - begin ),
+                      _source_name.get(), line_number ) );
+}
+
+static inline bool is_space( char c ) {
+  return isspace( static_cast<unsigned char>( c ) );
+}
 
-  size_t pos = line.find( '#' );
-  if( pos != string::npos )
-    line.erase( pos );
+static inline bool is_digit( char c ) {
+  return isdigit( static_cast<unsigned char>( c ) );
+}
 
-  regex beginning_whitespace_re( "^\\s+" );
-  regex integer_re( "^(\\d+)" );
-  regex quoted_string_re( "^\"(([^\"\\\\]|\\\\.)*)\"" );
-  regex alphanumeric_re( "^(\\w+)" );
+static inline bool is_word( char c ) {
+  return isalnum( static_cast<unsigned char>( c ) ) || c == '_';
+}
 
-  smatch m;
+void Lexer::tokenize_line( const char* p, const char* end,
+                           size_t line_number ) {
+  // everything after a '#' is a comment
+  const char* comment = static_cast<const char*>( memchr( p, '#', end - p ) );
+  if( comment != nullptr )
+    end = comment;
+
+  while( p < end ) {
+    // skip whitespace
+    if( is_space( *p ) ) {
+      ++p;
+      continue;
+    }
 
-  size_t token_count = 0;
-  while( line.length() > 0 ) {
-    // erase leading whitespace
-    line = regex_replace( line, beginning_whitespace_re, "" );
-    if( line.length() == 0 )
-      break;
+    const char* token_begin = p;
 
     // check for an integer
-    if( regex_search( line, m, integer_re ) ) {
-      _tokens.add( INTEGER, m[1], location );
-      line = regex_replace( line, integer_re, "" );
+    if( is_digit( *p ) ) {
+      while( p < end && is_digit( *p ) )
+        ++p;
+
+      add_token( INTEGER, token_begin, p, line_number );
       continue;
     }
 
-    // check for symbols
-    switch( line[0] ) {
+    // check for symbols. the values point to static strings since curly
+    // brackets have always been reported as square ones
+    token_t symbol_type = END_OF_FILE;
+    const char* symbol_value = nullptr;
+
+    switch( *p ) {
     case ',':
-      _tokens.add( COMMA, ",", location );
-      line.erase( 0, 1 );
+      symbol_type = COMMA;
+      symbol_value = ",";
       break;
     case '.':
-      _tokens.add( DOT, ".", location );
-      line.erase( 0, 1 );
+      symbol_type = DOT;
+      symbol_value = ".";
       break;
     case '-':
-      _tokens.add( MINUS, "-", location );
-      line.erase( 0, 1 );
+      symbol_type = MINUS;
+      symbol_value = "-";
       break;
     case '[':
-      _tokens.add( L_SQUARE, "[", location );
-      line.erase( 0, 1 );
+      symbol_type = L_SQUARE;
+      symbol_value = "[";
       break;
     case ']':
-      _tokens.add( R_SQUARE, "]", location );
-      line.erase( 0, 1 );
+      symbol_type = R_SQUARE;
+      symbol_value = "]";
       break;
     case '{':
-      _tokens.add( L_CURLY, "[", location );
-      line.erase( 0, 1 );
+      symbol_type = L_CURLY;
+      symbol_value = "[";
       break;
     case '}':
-      _tokens.add( R_CURLY, "]", location );
-      line.erase( 0, 1 );
+      symbol_type = R_CURLY;
+      symbol_value = "]";
       break;
     case '=':
-      _tokens.add( EQUALS, "=", location );
-      line.erase( 0, 1 );
+      symbol_type = EQUALS;
+      symbol_value = "=";
       break;
     case ':':
-      _tokens.add( COLON, ":", location );
-      line.erase( 0, 1 );
+      symbol_type = COLON;
+      symbol_value = ":";
       break;
     default:
       break;
     }
 
-    if( _tokens.size() > token_count ) {
-      token_count = _tokens.size();
+    if( symbol_value != nullptr ) {
+      _tokens.add( Token( symbol_type, StringRef( symbol_value, 1 ),
+                          _source_name.get(), line_number ) );
+      ++p;
       continue;
     }
 
     // check for reserved string
-    for( string& str : _reserved_strings ) {
-      if( line.find( str ) == 0 ) {
-        _tokens.add( RESERVED_STRING, str, location );
-        line.erase( 0, str.length() );
+    StringRef rest( p, end - p );
+    bool reserved = false;
+
+    for( const string& str : _reserved_strings ) {
+      if( rest.starts_with( str ) ) {
+        p += str.length();
+        add_token( RESERVED_STRING, token_begin, p, line_number );
+        reserved = true;
         break;
       }
     }
 
-    if( _tokens.size() > token_count ) {
-      token_count = _tokens.size();
+    if( reserved )
       continue;
-    }
 
-    // check for quoted string
-    if( regex_search( line, m, quoted_string_re ) ) {
-      string quoted = m[1];
+    // check for quoted string. a backslash escapes the character after it
+    if( *p == '"' ) {
+      const char* q = p + 1;
+      bool has_escape = false;
+
+      while( q < end && *q != '"' ) {
+        if( *q == '\\' ) {
+          if( q + 1 >= end || q[1] == '\r' )
+            break;
+
+          has_escape = true;
+          q += 2;
+        }
+        else {
+          ++q;
+        }
+      }
 
-      while( true ) {
-        size_t pos = quoted.find( "\\\"" );
+      if( q < end && *q == '"' ) {
+        if( has_escape ) {
+          string quoted( p + 1, q );
 
-        if( pos == string::npos )
-          break;
+          while( true ) {
+            size_t pos = quoted.find( "\\\"" );
 
-        quoted.replace( pos, 2, "\"" );
-      }
+            if( pos == string::npos )
+              break;
 
-      _tokens.add( QUOTED_STRING, quoted, location );
-      line = regex_replace( line, quoted_string_re, "" );
-      continue;
+            quoted.replace( pos, 2, "\"" );
+          }
+
+          _tokens.add( Token( QUOTED_STRING, quoted, _source_name.get(),
+                              line_number ) );
+        }
+        else {
+          add_token( QUOTED_STRING, p + 1, q, line_number );
+        }
+
+        p = q + 1;
+        continue;
+      }
     }
 
     // check for alphanumeric string
-    if( regex_search( line, m, alphanumeric_re ) ) {
-      _tokens.add( ALPHANUMERIC, m[1], location );
-      line = regex_replace( line, alphanumeric_re, "" );
+    if( is_word( *p ) ) {
+      while( p < end && is_word( *p ) )
+        ++p;
+
+      add_token( ALPHANUMERIC, token_begin, p, line_number );
       continue;
     }
 
     ostringstream oss;
-    oss << "Unexpected symbol '" << line[0] << "'";
+    oss << "Unexpected symbol '" << *p << "'";
     throw TokenException( oss.str() );
   }
 }
@@ -21,12 +21,15 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <sstream>
-#include <fstream>
-#include <regex>
+#include <cstring>
+#include <cctype>
 #include <stdexcept>
 
 #include "tokens.hpp"
+#include "string_ref.hpp"
+#include "filesystem_operations.hpp"
 
 namespace larasynth {
 
@@ -36,6 +39,11 @@ public:
     : runtime_error( message ) {};
 };
 
+/**
+ * Splits a file into tokens. The file is memory mapped and tokenized in a
+ * single pass, and the resulting tokens refer directly into the mapping
+ * rather than holding copies of their text.
+ */
 class Lexer {
 public:
   Lexer( const std::string& filename,
@@ -43,17 +51,22 @@ public:
          std::vector<std::string>() );
 
   Tokens get_tokens() { return _tokens; }
-  std::vector<std::string> get_lines() { return _lines; }
+  std::vector<std::string> get_lines();
 
 private:
   void read_file();
   void tokenize();
-  void tokenize_line( std::string line, size_t location );
+  void tokenize_line( const char* begin, const char* end,
+                      size_t line_number );
+
+  void add_token( token_t type, const char* begin, const char* end,
+                  size_t line_number );
 
   std::string _filename;
   std::vector<std::string> _reserved_strings;
 
-  std::vector<std::string> _lines;
+  std::shared_ptr<const std::string> _source_name;
+  std::shared_ptr<const MappedFile> _buffer;
 
   Tokens _tokens;
 };
@@ -0,0 +1,156 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+
+#include "binary_exporter.hpp"
+
+using namespace std;
+using namespace littlelstm;
+
+BinaryExporter::BinaryExporter()
+  : _input_count( 0 )
+  , _output_count( 0 )
+  , _unit_count( 0 )
+  , _connections_set( false )
+{}
+
+void BinaryExporter::set_input_count( size_t input_count ) {
+  _input_count = input_count;
+}
+
+void BinaryExporter::set_output_count( size_t output_count ) {
+  _output_count = output_count;
+}
+
+void BinaryExporter::set_unit_count( size_t unit_count ) {
+  _unit_count = unit_count;
+}
+
+void BinaryExporter::set_connections( const vector< pair<Id_t, Id_t> >&
+                                      connections ) {
+  _connections.clear();
+  _connections.reserve( connections.size() * 2 );
+
+  for( auto& connection : connections ) {
+    _connections.push_back( connection.first );
+    _connections.push_back( connection.second );
+  }
+
+  _connections_set = true;
+}
+
+void BinaryExporter::set_units_properties( const vector<LstmUnitProperties>&
+                                           units_properties ) {
+  _units.clear();
+  _gated_conns.clear();
+
+  for( auto& unit_properties : units_properties ) {
+    _units.push_back( unit_properties.get_id() );
+    _units.push_back( unit_properties.get_type() );
+    _units.push_back( unit_properties.get_act_func_type() );
+    _units.push_back( unit_properties.get_self_conn_gater() );
+
+    for( auto& gated_conn : unit_properties.get_gated_conns() ) {
+      _gated_conns.push_back( gated_conn.gater_id );
+      _gated_conns.push_back( gated_conn.in_id );
+      _gated_conns.push_back( gated_conn.out_id );
+    }
+  }
+}
+
+void BinaryExporter::set_connection_weights( const ConnectionWeights_t&
+                                             weights ) {
+  if( !_connections_set ) {
+    string error = "connections must be exported before weights";
+    throw BinaryExporterException( error );
+  }
+
+  if( weights.size() * 2 != _connections.size() ) {
+    string error = "weight count does not match connection count";
+    throw BinaryExporterException( error );
+  }
+
+  _weights = weights;
+}
+
+/**
+ * Get the complete binary file contents.
+ */
+string BinaryExporter::get_bytes() const {
+  if( _weights.size() * 2 != _connections.size() ) {
+    string error = "weights must be exported before the network is written";
+    throw BinaryExporterException( error );
+  }
+
+  BinaryNetworkHeader header;
+  memset( &header, 0, sizeof( header ) );
+
+  memcpy( header.magic, BINARY_NETWORK_MAGIC, sizeof( header.magic ) );
+  header.version = BINARY_NETWORK_VERSION;
+  header.byte_order = BINARY_NETWORK_BYTE_ORDER;
+  header.header_size = sizeof( header );
+
+  header.input_count = _input_count;
+  header.output_count = _output_count;
+  header.unit_count = _unit_count;
+
+  header.connection_count = _connections.size() / 2;
+  header.unit_properties_count = _units.size() / 4;
+  header.gated_conn_count = _gated_conns.size() / 3;
+
+  uint64_t offset = binary_network_align( sizeof( header ) );
+
+  header.connections_offset = offset;
+  offset = binary_network_align( offset +
+                                 _connections.size() * sizeof( uint64_t ) );
+  header.units_offset = offset;
+  offset = binary_network_align( offset + _units.size() * sizeof( uint64_t ) );
+  header.gated_conns_offset = offset;
+  offset = binary_network_align( offset +
+                                 _gated_conns.size() * sizeof( uint64_t ) );
+  header.weights_offset = offset;
+  offset = binary_network_align( offset + _weights.size() * sizeof( double ) );
+  header.user_data_offset = offset;
+  header.user_data_size = _user_data.size();
+  offset = binary_network_align( offset + _user_data.size() );
+  header.file_size = offset;
+
+  string bytes( header.file_size, '\0' );
+
+  memcpy( &bytes[0], &header, sizeof( header ) );
+
+  if( !_connections.empty() )
+    memcpy( &bytes[header.connections_offset], _connections.data(),
+            _connections.size() * sizeof( uint64_t ) );
+  if( !_units.empty() )
+    memcpy( &bytes[header.units_offset], _units.data(),
+            _units.size() * sizeof( uint64_t ) );
+  if( !_gated_conns.empty() )
+    memcpy( &bytes[header.gated_conns_offset], _gated_conns.data(),
+            _gated_conns.size() * sizeof( uint64_t ) );
+  if( !_weights.empty() )
+    memcpy( &bytes[header.weights_offset], _weights.data(),
+            _weights.size() * sizeof( double ) );
+  if( !_user_data.empty() )
+    memcpy( &bytes[header.user_data_offset], _user_data.data(),
+            _user_data.size() );
+
+  return bytes;
+}
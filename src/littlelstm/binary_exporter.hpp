@@ -0,0 +1,77 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "binary_format.hpp"
+#include "network_exporter.hpp"
+
+namespace littlelstm {
+
+class BinaryExporterException : public std::runtime_error {
+public:
+  explicit BinaryExporterException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * Exports a network in the binary format described in binary_format.hpp.
+ *
+ * Applications can store their own data alongside the network with
+ * set_user_data(). It is stored verbatim and can be retrieved with
+ * BinaryImporter::get_user_data().
+ */
+class BinaryExporter : public NetworkExporter {
+public:
+  BinaryExporter();
+
+  std::string get_bytes() const;
+
+  void set_input_count( size_t input_count );
+  void set_output_count( size_t output_count );
+  void set_unit_count( size_t unit_count );
+  void set_connections( const std::vector< std::pair<Id_t, Id_t> >&
+                        connections );
+  void set_units_properties( const std::vector<LstmUnitProperties>&
+                             units_properties );
+  void set_connection_weights( const ConnectionWeights_t& weights );
+
+  void set_user_data( const std::string& user_data )
+  { _user_data = user_data; }
+
+private:
+  uint64_t _input_count;
+  uint64_t _output_count;
+  uint64_t _unit_count;
+
+  std::vector<uint64_t> _connections;
+  std::vector<uint64_t> _units;
+  std::vector<uint64_t> _gated_conns;
+  std::vector<double> _weights;
+
+  bool _connections_set;
+
+  std::string _user_data;
+};
+
+}
@@ -0,0 +1,81 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace littlelstm {
+
+/**
+ * Layout of a binary network file. All integers are 64 bits wide and stored
+ * in the byte order of the machine that wrote the file; the byte_order field
+ * lets a reader on a different machine reject the file rather than
+ * misinterpret it.
+ *
+ * The header is followed by these sections, each starting on an 8 byte
+ * boundary at the offset given in the header:
+ *
+ *   connections   connection_count x { in_id, out_id }
+ *   units         unit_properties_count x
+ *                   { id, type, act_func, self_conn_gater }
+ *   gated conns   gated_conn_count x { gater_id, in_id, out_id }
+ *   weights       connection_count doubles, in connection order
+ *   user data     user_data_size bytes, not interpreted by littlelstm
+ *
+ * Because the weights are a contiguous array in connection order, loading
+ * them is a single copy out of the (possibly memory mapped) file.
+ */
+
+static const char BINARY_NETWORK_MAGIC[8] = { 'L', 'L', 'S', 'T',
+                                              'M', 'B', 'I', 'N' };
+static const uint32_t BINARY_NETWORK_VERSION = 1;
+static const uint32_t BINARY_NETWORK_BYTE_ORDER = 0x01020304;
+
+struct BinaryNetworkHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t header_size;
+  uint64_t file_size;
+
+  uint64_t input_count;
+  uint64_t output_count;
+  uint64_t unit_count;
+
+  uint64_t connection_count;
+  uint64_t unit_properties_count;
+  uint64_t gated_conn_count;
+
+  uint64_t connections_offset;
+  uint64_t units_offset;
+  uint64_t gated_conns_offset;
+  uint64_t weights_offset;
+  uint64_t user_data_offset;
+  uint64_t user_data_size;
+};
+
+/**
+ * Round offset up to the next multiple of 8.
+ */
+inline uint64_t binary_network_align( uint64_t offset ) {
+  return ( offset + 7 ) & ~(uint64_t)7;
+}
+
+}
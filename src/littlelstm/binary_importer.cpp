@@ -0,0 +1,196 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+#include <unordered_map>
+
+#include "binary_importer.hpp"
+
+using namespace std;
+using namespace littlelstm;
+
+BinaryImporter::BinaryImporter( const char* data, size_t size )
+  : _data( data )
+  , _size( size )
+{
+  if( _data == nullptr || _size < sizeof( _header ) )
+    throw BinaryImporterException( "Binary network is too small" );
+
+  memcpy( &_header, _data, sizeof( _header ) );
+
+  if( memcmp( _header.magic, BINARY_NETWORK_MAGIC,
+              sizeof( _header.magic ) ) != 0 )
+    throw BinaryImporterException( "Not a binary network" );
+
+  if( _header.byte_order != BINARY_NETWORK_BYTE_ORDER )
+    throw BinaryImporterException( "Binary network has the wrong byte order" );
+
+  if( _header.version != BINARY_NETWORK_VERSION ) {
+    string error = "Unsupported binary network version " +
+      to_string( _header.version );
+    throw BinaryImporterException( error );
+  }
+
+  if( _header.header_size < sizeof( _header ) || _header.file_size > _size )
+    throw BinaryImporterException( "Binary network is truncated" );
+
+  // the counts are of records, not of words, so that a huge count can not
+  // wrap around when multiplied by the record size
+  check_section( _header.connections_offset, _header.connection_count,
+                 2 * sizeof( uint64_t ), "connections" );
+  check_section( _header.units_offset, _header.unit_properties_count,
+                 4 * sizeof( uint64_t ), "units" );
+  check_section( _header.gated_conns_offset, _header.gated_conn_count,
+                 3 * sizeof( uint64_t ), "gated connections" );
+  check_section( _header.weights_offset, _header.connection_count,
+                 sizeof( double ), "weights" );
+  check_section( _header.user_data_offset, _header.user_data_size, 1,
+                 "user data" );
+
+  // units are indexed by ID, so every unit needs its properties
+  if( _header.unit_properties_count != _header.unit_count ||
+      _header.input_count + _header.output_count > _header.unit_count )
+    throw BinaryImporterException( "Invalid unit counts in binary network" );
+}
+
+/**
+ * Check that count records of record_size bytes each fit in the file after
+ * offset.
+ */
+void BinaryImporter::check_section( uint64_t offset, uint64_t count,
+                                    uint64_t record_size,
+                                    const string& name ) const {
+  if( offset < sizeof( _header ) || offset > _header.file_size ||
+      count > ( _header.file_size - offset ) / record_size ) {
+    throw BinaryImporterException( "Invalid " + name +
+                                   " section in binary network" );
+  }
+}
+
+void BinaryImporter::check_id( uint64_t id, const string& name ) const {
+  if( id >= _header.unit_count )
+    throw BinaryImporterException( "Invalid unit ID in binary network " +
+                                   name );
+}
+
+uint64_t BinaryImporter::read_u64( uint64_t offset, size_t i ) const {
+  uint64_t value;
+  memcpy( &value, _data + offset + i * sizeof( uint64_t ), sizeof( value ) );
+  return value;
+}
+
+size_t BinaryImporter::get_input_count() {
+  return _header.input_count;
+}
+
+size_t BinaryImporter::get_output_count() {
+  return _header.output_count;
+}
+
+size_t BinaryImporter::get_unit_count() {
+  return _header.unit_count;
+}
+
+vector< pair<Id_t, Id_t> > BinaryImporter::get_connections() {
+  vector< pair<Id_t, Id_t> > connections;
+  connections.reserve( _header.connection_count );
+
+  for( size_t i = 0; i < _header.connection_count; ++i ) {
+    Id_t in_id = read_u64( _header.connections_offset, i * 2 );
+    Id_t out_id = read_u64( _header.connections_offset, i * 2 + 1 );
+
+    check_id( in_id, "connections" );
+    check_id( out_id, "connections" );
+
+    connections.emplace_back( in_id, out_id );
+  }
+
+  return connections;
+}
+
+const vector<LstmUnitProperties> BinaryImporter::get_units_properties() {
+  unordered_map<Id_t, vector<LstmGatedConn> > gated_conns;
+
+  for( size_t i = 0; i < _header.gated_conn_count; ++i ) {
+    Id_t gater_id = read_u64( _header.gated_conns_offset, i * 3 );
+    Id_t in_id = read_u64( _header.gated_conns_offset, i * 3 + 1 );
+    Id_t out_id = read_u64( _header.gated_conns_offset, i * 3 + 2 );
+
+    check_id( gater_id, "gated connections" );
+    check_id( in_id, "gated connections" );
+    check_id( out_id, "gated connections" );
+
+    gated_conns[gater_id].emplace_back( gater_id, in_id, out_id );
+  }
+
+  vector<LstmUnitProperties> properties;
+  properties.reserve( _header.unit_properties_count );
+
+  for( size_t i = 0; i < _header.unit_properties_count; ++i ) {
+    Id_t id = read_u64( _header.units_offset, i * 4 );
+    uint64_t type = read_u64( _header.units_offset, i * 4 + 1 );
+    uint64_t act_func_type = read_u64( _header.units_offset, i * 4 + 2 );
+    Id_t self_conn_gater = read_u64( _header.units_offset, i * 4 + 3 );
+
+    if( id != i )
+      throw BinaryImporterException( "Units out of order in binary network" );
+
+    if( self_conn_gater != NO_UNIT )
+      check_id( self_conn_gater, "units" );
+
+    if( type >= UNIT_ERROR || act_func_type > NO_ACTIVATION_FUNCTION )
+      throw BinaryImporterException( "Invalid unit in binary network" );
+
+    properties.emplace_back( id, (lstm_unit_t)type,
+                             (lstm_act_func_t)act_func_type, self_conn_gater,
+                             gated_conns[id] );
+  }
+
+  return properties;
+}
+
+WeightsMap_t BinaryImporter::get_weights() {
+  WeightsMap_t weights_map;
+
+  vector< pair<Id_t, Id_t> > connections = get_connections();
+  ConnectionWeights_t weights = get_connection_weights();
+
+  for( size_t i = 0; i < connections.size(); ++i )
+    weights_map[connections[i].second][connections[i].first] = weights[i];
+
+  return weights_map;
+}
+
+/**
+ * The weights are stored contiguously in connection order, so this is a
+ * single copy out of the buffer.
+ */
+ConnectionWeights_t BinaryImporter::get_connection_weights() {
+  ConnectionWeights_t weights( _header.connection_count );
+
+  if( !weights.empty() )
+    memcpy( weights.data(), _data + _header.weights_offset,
+            weights.size() * sizeof( Real_t ) );
+
+  return weights;
+}
+
+string BinaryImporter::get_user_data() const {
+  return string( _data + _header.user_data_offset, _header.user_data_size );
+}
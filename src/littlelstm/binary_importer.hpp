@@ -0,0 +1,70 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "binary_format.hpp"
+#include "network_importer.hpp"
+
+namespace littlelstm {
+
+class BinaryImporterException : public std::runtime_error {
+public:
+  explicit BinaryImporterException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * Imports a network in the binary format described in binary_format.hpp.
+ *
+ * The importer reads directly from the buffer it is given and does not copy
+ * it, so the buffer (typically a memory mapped file) must outlive the
+ * importer. The header and section bounds are validated on construction.
+ */
+class BinaryImporter : public NetworkImporter {
+public:
+  BinaryImporter( const char* data, size_t size );
+
+  size_t get_input_count();
+  size_t get_output_count();
+  size_t get_unit_count();
+  std::vector< std::pair<Id_t, Id_t> > get_connections();
+  const std::vector<LstmUnitProperties> get_units_properties();
+  WeightsMap_t get_weights();
+  ConnectionWeights_t get_connection_weights();
+
+  std::string get_user_data() const;
+
+private:
+  void check_section( uint64_t offset, uint64_t count, uint64_t record_size,
+                      const std::string& name ) const;
+  void check_id( uint64_t id, const std::string& name ) const;
+  uint64_t read_u64( uint64_t offset, size_t i ) const;
+
+  const char* _data;
+  size_t _size;
+
+  BinaryNetworkHeader _header;
+};
+
+}
@@ -0,0 +1,548 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <map>
+
+#include "code_exporter.hpp"
+
+using namespace std;
+using namespace littlelstm;
+
+/**
+ * Format a double so that it reads back as the same double.
+ */
+static string format_double( double value ) {
+  ostringstream formatted;
+  formatted << setprecision( 17 ) << value;
+
+  string str = formatted.str();
+
+  if( str.find_first_of( ".e" ) == string::npos )
+    str += ".0";
+
+  return str;
+}
+
+static void hash_value( uint64_t& hash, uint64_t value ) {
+  // FNV-1a, a byte at a time
+  for( size_t i = 0; i < sizeof( value ); ++i ) {
+    hash ^= ( value >> ( i * 8 ) ) & 0xff;
+    hash *= 1099511628211ULL;
+  }
+}
+
+CodeExporter::CodeExporter( const string& name, lstm_act_impl_t act_impl,
+                            const vector< vector<Id_t> >& levels )
+  : _name( name )
+  , _act_impl( act_impl )
+  , _levels( levels )
+  , _input_count( 0 )
+  , _output_count( 0 )
+  , _unit_count( 0 )
+  , _units_properties_set( false )
+{
+  bool valid = !name.empty() && !isdigit( name[0] );
+
+  for( char c : name )
+    valid = valid && ( isalnum( c ) || c == '_' );
+
+  if( !valid )
+    throw CodeExporterException( name + " is not a valid C++ identifier" );
+
+  if( act_impl != EXACT_ACT_FUNCS && act_impl != FAST_ACT_FUNCS )
+    throw CodeExporterException( "unknown activation function "
+                                 "implementation" );
+}
+
+void CodeExporter::set_input_count( size_t input_count ) {
+  _input_count = input_count;
+}
+
+void CodeExporter::set_output_count( size_t output_count ) {
+  _output_count = output_count;
+}
+
+void CodeExporter::set_unit_count( size_t unit_count ) {
+  _unit_count = unit_count;
+}
+
+void CodeExporter::set_connections( const vector< pair<Id_t, Id_t> >&
+                                    connections ) {
+  _connections = connections;
+  _weights.clear();
+}
+
+void CodeExporter::set_units_properties( const vector<LstmUnitProperties>&
+                                         units_properties ) {
+  _act_func_types.assign( units_properties.size(), IDENTITY );
+  _self_conn_gaters.assign( units_properties.size(), NO_UNIT );
+  _gated_conns.clear();
+
+  for( auto& unit_properties : units_properties ) {
+    Id_t id = unit_properties.get_id();
+
+    if( id >= units_properties.size() )
+      throw CodeExporterException( "unit ID out of range" );
+
+    _act_func_types[id] = unit_properties.get_act_func_type();
+    _self_conn_gaters[id] = unit_properties.get_self_conn_gater();
+
+    for( auto& gated_conn : unit_properties.get_gated_conns() )
+      _gated_conns.push_back( gated_conn );
+  }
+
+  _units_properties_set = true;
+}
+
+void CodeExporter::set_connection_weights( const ConnectionWeights_t&
+                                           weights ) {
+  if( weights.size() != _connections.size() ) {
+    string error = "weight count does not match connection count";
+    throw CodeExporterException( error );
+  }
+
+  for( double weight : weights ) {
+    if( !isfinite( weight ) )
+      throw CodeExporterException( "the network has a weight that is not "
+                                   "a finite number" );
+  }
+
+  _weights = weights;
+}
+
+void CodeExporter::check_complete() const {
+  if( !_units_properties_set || _weights.size() != _connections.size() ||
+      _act_func_types.size() != _unit_count ) {
+    string error = "the network must be exported before the code is written";
+    throw CodeExporterException( error );
+  }
+
+  if( _unit_count < _input_count + 1 + _output_count )
+    throw CodeExporterException( "too few units for the inputs and outputs" );
+
+  for( auto& conn : _connections ) {
+    if( conn.first >= _unit_count || conn.second >= _unit_count ||
+        conn.second <= _input_count )
+      throw CodeExporterException( "connection out of range" );
+  }
+
+  if( _levels.empty() )
+    return;
+
+  // every unit after the bias must be in exactly one level
+  vector<size_t> level_counts( _unit_count, 0 );
+
+  for( auto& level : _levels ) {
+    for( Id_t id : level ) {
+      if( id <= _input_count || id >= _unit_count )
+        throw CodeExporterException( "level unit out of range" );
+
+      ++level_counts[id];
+    }
+  }
+
+  for( Id_t id = _input_count + 1; id < _unit_count; ++id ) {
+    if( level_counts[id] != 1 )
+      throw CodeExporterException( "levels do not cover the units" );
+  }
+}
+
+/**
+ * Describe the incoming connections of every unit as runs, in the order of
+ * the connections. The weights of a run are consecutive in the weight table
+ * and multiply the activations of evenly spaced units, such as the cells of
+ * a layer.
+ */
+vector< vector<CodeExporter::ConnectionRun> >
+CodeExporter::get_connection_runs() const {
+  map< pair<Id_t, Id_t>, Id_t > gaters;
+
+  for( auto& gated_conn : _gated_conns )
+    gaters[make_pair( gated_conn.out_id, gated_conn.in_id )] =
+      gated_conn.gater_id;
+
+  vector< vector<ConnectionRun> > runs( _unit_count );
+
+  for( Index_t i = 0; i < _connections.size(); ++i ) {
+    Id_t in_id = _connections[i].first;
+    Id_t out_id = _connections[i].second;
+
+    auto gater = gaters.find( make_pair( out_id, in_id ) );
+    Id_t gater_id = gater == gaters.end() ? NO_UNIT : gater->second;
+
+    vector<ConnectionRun>& unit_runs = runs[out_id];
+
+    if( !unit_runs.empty() ) {
+      ConnectionRun& run = unit_runs.back();
+
+      if( run.first_conn + run.length == i && run.gater_id == gater_id ) {
+        if( run.length == 1 && in_id > run.first_in_id ) {
+          run.stride = in_id - run.first_in_id;
+          ++run.length;
+          continue;
+        }
+
+        if( run.length > 1 &&
+            run.first_in_id + run.length * run.stride == in_id ) {
+          ++run.length;
+          continue;
+        }
+      }
+    }
+
+    unit_runs.push_back( { i, in_id, 1, 1, gater_id } );
+  }
+
+  return runs;
+}
+
+/**
+ * A hash of everything that the generated code depends on. Two exporters
+ * that were given the same network and settings have the same fingerprint.
+ */
+uint64_t CodeExporter::get_fingerprint() const {
+  check_complete();
+
+  uint64_t hash = 14695981039346656037ULL;
+
+  hash_value( hash, _input_count );
+  hash_value( hash, _output_count );
+  hash_value( hash, _unit_count );
+  hash_value( hash, _act_impl );
+
+  for( Index_t i = 0; i < _connections.size(); ++i ) {
+    uint64_t weight_bits;
+    memcpy( &weight_bits, &_weights[i], sizeof( weight_bits ) );
+
+    hash_value( hash, _connections[i].first );
+    hash_value( hash, _connections[i].second );
+    hash_value( hash, weight_bits );
+  }
+
+  for( Id_t id = 0; id < _unit_count; ++id ) {
+    hash_value( hash, _act_func_types[id] );
+    hash_value( hash, _self_conn_gaters[id] );
+  }
+
+  for( auto& gated_conn : _gated_conns ) {
+    hash_value( hash, gated_conn.gater_id );
+    hash_value( hash, gated_conn.in_id );
+    hash_value( hash, gated_conn.out_id );
+  }
+
+  for( auto& level : _levels ) {
+    hash_value( hash, level.size() );
+
+    for( Id_t id : level )
+      hash_value( hash, id );
+  }
+
+  return hash;
+}
+
+void CodeExporter::write_activation_functions( ostream& out ) const {
+  if( _act_impl == EXACT_ACT_FUNCS ) {
+    out << "inline double logistic( double x ) {\n"
+        << "  return 1.0 / ( 1.0 + std::exp( x * -1.0 ) );\n"
+        << "}\n\n";
+  }
+  else {
+    // the same table and arithmetic as logistic_fast()
+    size_t table_size = LOGISTIC_TABLE_INTERVALS * 4;
+
+    out << "static const double LOGISTIC_TABLE[" << table_size << "] = {\n";
+
+    for( size_t i = 0; i < table_size; ++i )
+      out << "  " << format_double( logistic_table_t::coefficients[i] )
+          << ",\n";
+
+    out << "};\n\n"
+        << "inline double logistic( double x ) {\n"
+        << "  double u = ( x - " << format_double( LOGISTIC_TABLE_MIN )
+        << " ) * " << format_double( 1.0 / LOGISTIC_TABLE_STEP ) << ";\n"
+        << "  u = u > 0.0 ? u : 0.0;\n"
+        << "  u = u < " << LOGISTIC_TABLE_INTERVALS << " ? u : "
+        << LOGISTIC_TABLE_INTERVALS << ";\n"
+        << "  int i = (int)u;\n"
+        << "  i = i < " << LOGISTIC_TABLE_INTERVALS - 1 << " ? i : "
+        << LOGISTIC_TABLE_INTERVALS - 1 << ";\n"
+        << "  double t = u - i;\n"
+        << "  const double* c = LOGISTIC_TABLE + i * 4;\n"
+        << "  return c[0] + t * ( c[1] + t * ( c[2] + t * c[3] ) );\n"
+        << "}\n\n";
+  }
+
+  out << "inline double logistic_centered( double x ) {\n"
+      << "  return logistic( x ) * 2.0 - 1.0;\n"
+      << "}\n\n";
+}
+
+/**
+ * Write the statements that calculate a unit's state and store its
+ * activation in destination.
+ */
+void CodeExporter::write_unit( ostream& out, Id_t id,
+                               const vector<ConnectionRun>& runs,
+                               const string& destination ) const {
+  string state = "s[" + to_string( id ) + "]";
+
+  vector<string> terms;
+
+  if( _self_conn_gaters[id] != NO_UNIT )
+    terms.push_back( "a[" + to_string( _self_conn_gaters[id] ) + "] * " +
+                     state );
+
+  for( auto& run : runs ) {
+    string sum;
+
+    if( run.length >= CODE_EXPORTER_MIN_LOOP_LENGTH ) {
+      sum = "detail::dot( w + " + to_string( run.first_conn ) + ", a + " +
+        to_string( run.first_in_id ) + ", " + to_string( run.length ) +
+        ", " + to_string( run.stride ) + " )";
+    }
+    else {
+      for( size_t i = 0; i < run.length; ++i ) {
+        string weight = format_double( _weights[run.first_conn + i] );
+
+        if( i > 0 ) {
+          if( weight[0] == '-' )
+            sum += " - " + weight.substr( 1 );
+          else
+            sum += " + " + weight;
+        }
+        else {
+          sum += weight;
+        }
+
+        sum += " * a[" + to_string( run.first_in_id + i * run.stride ) + "]";
+      }
+    }
+
+    if( run.gater_id == NO_UNIT )
+      terms.push_back( sum );
+    else if( run.length == 1 || run.length >= CODE_EXPORTER_MIN_LOOP_LENGTH )
+      terms.push_back( "a[" + to_string( run.gater_id ) + "] * " + sum );
+    else
+      terms.push_back( "a[" + to_string( run.gater_id ) + "] * ( " + sum +
+                       " )" );
+  }
+
+  out << "    " << state << " = ";
+
+  if( terms.empty() )
+    out << "0.0";
+
+  for( size_t i = 0; i < terms.size(); ++i ) {
+    if( i > 0 )
+      out << "\n      + ";
+    out << terms[i];
+  }
+
+  out << ";\n    " << destination << " = ";
+
+  switch( _act_func_types[id] ) {
+  case LOGISTIC:
+    out << "detail::logistic( " << state << " );\n";
+    break;
+  case LOGISTIC_CENTERED:
+    out << "detail::logistic_centered( " << state << " );\n";
+    break;
+  default:
+    out << state << ";\n";
+    break;
+  }
+}
+
+/**
+ * Get a standalone header defining <name>::Network.
+ */
+string CodeExporter::get_header() const {
+  check_complete();
+
+  vector< vector<ConnectionRun> > runs = get_connection_runs();
+
+  ostringstream out;
+
+  out << "// Generated by larasynth from a trained network. Do not edit.\n"
+      << "//\n"
+      << "// " << _name << "::Network performs the network one step at a "
+      << "time:\n"
+      << "//\n"
+      << "//   " << _name << "::Network net;\n"
+      << "//   net.feed_forward( input, output );\n"
+      << "//\n"
+      << "// input holds INPUT_COUNT values and output receives OUTPUT_COUNT "
+      << "values.\n"
+      << "// reset() returns the network to the state it starts in.\n\n"
+      << "#pragma once\n\n"
+      << "#include <cmath>\n"
+      << "#include <cstddef>\n\n"
+      << "namespace " << _name << " {\n\n"
+      << "static const std::size_t INPUT_COUNT = " << _input_count << ";\n"
+      << "static const std::size_t OUTPUT_COUNT = " << _output_count << ";\n"
+      << "static const std::size_t UNIT_COUNT = " << _unit_count << ";\n"
+      << "static const unsigned long long FINGERPRINT = 0x" << hex
+      << get_fingerprint() << dec << "ULL;\n\n"
+      << "namespace detail {\n\n";
+
+  out << "static const double WEIGHTS[" << max( _weights.size(), size_t( 1 ) )
+      << "] = {\n";
+
+  for( double weight : _weights )
+    out << "  " << format_double( weight ) << ",\n";
+
+  if( _weights.empty() )
+    out << "  0.0\n";
+
+  out << "};\n\n"
+      << "inline double dot( const double* w, const double* x, "
+      << "std::size_t n,\n"
+      << "                   std::size_t stride ) {\n"
+      << "  double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;\n"
+      << "  std::size_t i = 0;\n"
+      << "  for( ; i + 4 <= n; i += 4 ) {\n"
+      << "    s0 += w[i] * x[i * stride];\n"
+      << "    s1 += w[i + 1] * x[( i + 1 ) * stride];\n"
+      << "    s2 += w[i + 2] * x[( i + 2 ) * stride];\n"
+      << "    s3 += w[i + 3] * x[( i + 3 ) * stride];\n"
+      << "  }\n"
+      << "  for( ; i < n; ++i )\n"
+      << "    s0 += w[i] * x[i * stride];\n"
+      << "  return ( s0 + s1 ) + ( s2 + s3 );\n"
+      << "}\n\n";
+
+  write_activation_functions( out );
+
+  out << "}\n\n"
+      << "class Network {\n"
+      << "public:\n"
+      << "  Network() { reset(); }\n\n"
+      << "  void reset() {\n"
+      << "    for( std::size_t i = 0; i < UNIT_COUNT; ++i ) {\n"
+      << "      _a[i] = 0.0;\n"
+      << "      _s[i] = 0.0;\n"
+      << "    }\n"
+      << "    _a[INPUT_COUNT] = 1.0;\n"
+      << "  }\n\n"
+      << "  void feed_forward( const double* input, double* output ) {\n"
+      << "    double* a = _a;\n"
+      << "    double* s = _s;\n"
+      << "    const double* w = detail::WEIGHTS;\n";
+
+  if( !_levels.empty() )
+    out << "    double* n = _n;\n";
+
+  out << "    (void)w;\n\n"
+      << "    for( std::size_t i = 0; i < INPUT_COUNT; ++i )\n"
+      << "      a[i] = input[i];\n";
+
+  if( _levels.empty() ) {
+    for( Id_t id = _input_count + 1; id < _unit_count; ++id ) {
+      out << "\n";
+      write_unit( out, id, runs[id], "a[" + to_string( id ) + "]" );
+    }
+  }
+  else {
+    // each level sees the activations of its own units from the last step,
+    // so they are only stored once the whole level is calculated
+    for( size_t l = 0; l < _levels.size(); ++l ) {
+      const vector<Id_t>& level = _levels[l];
+
+      out << "\n    // level " << l << "\n";
+
+      for( size_t i = 0; i < level.size(); ++i )
+        write_unit( out, level[i], runs[level[i]],
+                    "n[" + to_string( i ) + "]" );
+
+      for( size_t i = 0; i < level.size(); ++i )
+        out << "    a[" << level[i] << "] = n[" << i << "];\n";
+    }
+  }
+
+  size_t max_level_size = 1;
+
+  for( auto& level : _levels )
+    max_level_size = max( max_level_size, level.size() );
+
+  out << "\n"
+      << "    for( std::size_t i = 0; i < OUTPUT_COUNT; ++i )\n"
+      << "      output[i] = a[UNIT_COUNT - OUTPUT_COUNT + i];\n"
+      << "  }\n\n"
+      << "private:\n"
+      << "  double _a[UNIT_COUNT];\n"
+      << "  double _s[UNIT_COUNT];\n";
+
+  if( !_levels.empty() )
+    out << "  double _n[" << max_level_size << "];\n";
+
+  out << "};\n\n"
+      << "}\n";
+
+  return out.str();
+}
+
+/**
+ * Get the source of a shared library for CompiledNetwork, which includes the
+ * header from get_header() as header_filename.
+ */
+string CodeExporter::get_library_source( const string& header_filename )
+  const {
+  check_complete();
+
+  string net = "static_cast<" + _name + "::Network*>( net )";
+
+  ostringstream out;
+
+  out << "// Generated by larasynth from a trained network. Do not edit.\n\n"
+      << "#include <cstddef>\n\n"
+      << "#include \"" << header_filename << "\"\n\n"
+      << "extern \"C\" {\n\n"
+      << "int lara_compiled_abi_version() { return "
+      << COMPILED_NETWORK_ABI_VERSION << "; }\n\n"
+      << "unsigned long long lara_compiled_fingerprint() {\n"
+      << "  return " << _name << "::FINGERPRINT;\n"
+      << "}\n\n"
+      << "std::size_t lara_compiled_input_count() {\n"
+      << "  return " << _name << "::INPUT_COUNT;\n"
+      << "}\n\n"
+      << "std::size_t lara_compiled_output_count() {\n"
+      << "  return " << _name << "::OUTPUT_COUNT;\n"
+      << "}\n\n"
+      << "void* lara_compiled_create() {\n"
+      << "  return new " << _name << "::Network();\n"
+      << "}\n\n"
+      << "void lara_compiled_destroy( void* net ) {\n"
+      << "  delete " << net << ";\n"
+      << "}\n\n"
+      << "void lara_compiled_reset( void* net ) {\n"
+      << "  " << net << "->reset();\n"
+      << "}\n\n"
+      << "void lara_compiled_feed_forward( void* net, const double* input,\n"
+      << "                                 double* output ) {\n"
+      << "  " << net << "->feed_forward( input, output );\n"
+      << "}\n\n"
+      << "}\n";
+
+  return out.str();
+}
@@ -0,0 +1,118 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include <stdexcept>
+
+#include "lstm_activation_function.hpp"
+#include "network_exporter.hpp"
+
+namespace littlelstm {
+
+// Changes whenever the functions a compiled network library exports change
+// (see get_library_source()).
+static const int COMPILED_NETWORK_ABI_VERSION = 1;
+
+// Runs of at least this many connections from evenly spaced units with the
+// same gater are summed by a loop over the weight table. Shorter runs are
+// written out with their weights as literals.
+static const size_t CODE_EXPORTER_MIN_LOOP_LENGTH = 8;
+
+class CodeExporterException : public std::runtime_error {
+public:
+  explicit CodeExporterException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * Exports a trained network as C++ source code that performs the network's
+ * feed forward step with its topology and weights built in.
+ *
+ * get_header() is a standalone header with no dependencies beyond the C++11
+ * standard library, defining the class <name>::Network. It can be used on
+ * its own, for example in firmware. get_library_source() wraps the header in
+ * the C functions that CompiledNetwork loads from a shared library.
+ *
+ * The generated code calculates the units in the same order as an LstmNetwork
+ * with the same levels (see LstmNetwork::get_levels()), and with the same
+ * activation function implementation. Only the order in which the
+ * connections into a unit are summed differs, so the outputs match the
+ * network's to within rounding.
+ */
+class CodeExporter : public NetworkExporter {
+public:
+  CodeExporter( const std::string& name, lstm_act_impl_t act_impl,
+                const std::vector< std::vector<Id_t> >& levels );
+
+  std::string get_header() const;
+  std::string get_library_source( const std::string& header_filename ) const;
+  uint64_t get_fingerprint() const;
+
+  void set_input_count( size_t input_count );
+  void set_output_count( size_t output_count );
+  void set_unit_count( size_t unit_count );
+  void set_connections( const std::vector< std::pair<Id_t, Id_t> >&
+                        connections );
+  void set_units_properties( const std::vector<LstmUnitProperties>&
+                             units_properties );
+  void set_connection_weights( const ConnectionWeights_t& weights );
+
+private:
+  // connections with consecutive connection numbers and the same gater, from
+  // units that are evenly spaced (stride apart)
+  struct ConnectionRun {
+    Index_t first_conn;
+    Id_t first_in_id;
+    size_t length;
+    size_t stride;
+    Id_t gater_id;
+  };
+
+  void check_complete() const;
+  std::vector< std::vector<ConnectionRun> > get_connection_runs() const;
+  void write_activation_functions( std::ostream& out ) const;
+  void write_unit( std::ostream& out, Id_t id,
+                   const std::vector<ConnectionRun>& runs,
+                   const std::string& destination ) const;
+
+  std::string _name;
+  lstm_act_impl_t _act_impl;
+  std::vector< std::vector<Id_t> > _levels;
+
+  size_t _input_count;
+  size_t _output_count;
+  size_t _unit_count;
+
+  std::vector< std::pair<Id_t, Id_t> > _connections;
+  ConnectionWeights_t _weights;
+
+  // indexed by unit ID
+  std::vector<lstm_act_func_t> _act_func_types;
+  std::vector<Id_t> _self_conn_gaters;
+
+  std::vector<LstmGatedConn> _gated_conns;
+  bool _units_properties_set;
+};
+
+}
@@ -0,0 +1,108 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <dlfcn.h>
+
+#include "compiled_network.hpp"
+
+using namespace std;
+using namespace littlelstm;
+
+CompiledNetwork::CompiledNetwork( const string& library_filename )
+  : _library_filename( library_filename )
+  , _library( nullptr )
+  , _net( nullptr )
+{
+  _library = dlopen( library_filename.c_str(), RTLD_NOW | RTLD_LOCAL );
+
+  if( _library == nullptr ) {
+    const char* error = dlerror();
+    throw CompiledNetworkException( error ? error : "cannot open " +
+                                    library_filename );
+  }
+
+  try {
+    int (*abi_version)() =
+      reinterpret_cast<int (*)()>( get_symbol( "lara_compiled_abi_version" ) );
+
+    if( abi_version() != COMPILED_NETWORK_ABI_VERSION )
+      throw CompiledNetworkException( library_filename + " was compiled by a "
+                                      "different version of larasynth" );
+
+    unsigned long long (*fingerprint)() =
+      reinterpret_cast<unsigned long long (*)()>
+      ( get_symbol( "lara_compiled_fingerprint" ) );
+    size_t (*input_count)() =
+      reinterpret_cast<size_t (*)()>
+      ( get_symbol( "lara_compiled_input_count" ) );
+    size_t (*output_count)() =
+      reinterpret_cast<size_t (*)()>
+      ( get_symbol( "lara_compiled_output_count" ) );
+    void* (*create)() =
+      reinterpret_cast<void* (*)()>( get_symbol( "lara_compiled_create" ) );
+
+    _destroy = reinterpret_cast<void (*)( void* )>
+      ( get_symbol( "lara_compiled_destroy" ) );
+    _reset = reinterpret_cast<void (*)( void* )>
+      ( get_symbol( "lara_compiled_reset" ) );
+    _feed_forward = reinterpret_cast<void (*)( void*, const double*, double* )>
+      ( get_symbol( "lara_compiled_feed_forward" ) );
+
+    _fingerprint = fingerprint();
+    _input_size = input_count();
+    _output.assign( output_count(), 0.0 );
+
+    _net = create();
+  }
+  catch( ... ) {
+    dlclose( _library );
+    throw;
+  }
+}
+
+CompiledNetwork::~CompiledNetwork() {
+  if( _net != nullptr )
+    _destroy( _net );
+
+  dlclose( _library );
+}
+
+void* CompiledNetwork::get_symbol( const string& name ) {
+  void* symbol = dlsym( _library, name.c_str() );
+
+  if( symbol == nullptr )
+    throw CompiledNetworkException( _library_filename + " has no " + name );
+
+  return symbol;
+}
+
+void CompiledNetwork::feed_forward( const vector<double>& input ) {
+  assert( input.size() == _input_size );
+
+  _feed_forward( _net, input.data(), _output.data() );
+}
+
+/**
+ * Return the network to the state it was loaded in, like
+ * LstmNetwork::zero_network().
+ */
+void CompiledNetwork::zero_network() {
+  _reset( _net );
+}
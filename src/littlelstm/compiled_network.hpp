@@ -0,0 +1,77 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include "code_exporter.hpp"
+#include "feed_forward_network.hpp"
+
+namespace littlelstm {
+
+class CompiledNetworkException : public std::runtime_error {
+public:
+  explicit CompiledNetworkException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * A network compiled from the source written by CodeExporter, loaded from a
+ * shared library. It only performs: there is no training, and the weights
+ * are those the library was generated from. get_fingerprint() tells which
+ * network and settings that was (see CodeExporter::get_fingerprint()).
+ */
+class CompiledNetwork : public FeedForwardNetwork {
+public:
+  explicit CompiledNetwork( const std::string& library_filename );
+  ~CompiledNetwork();
+
+  CompiledNetwork( const CompiledNetwork& ) = delete;
+  CompiledNetwork& operator=( const CompiledNetwork& ) = delete;
+
+  void feed_forward( const std::vector<double>& input );
+  const std::vector<double>& get_output() const { return _output; }
+  std::size_t get_output_size() const { return _output.size(); }
+  std::size_t get_input_size() const { return _input_size; }
+
+  uint64_t get_fingerprint() const { return _fingerprint; }
+
+  void zero_network();
+
+private:
+  void* get_symbol( const std::string& name );
+
+  std::string _library_filename;
+  void* _library;
+  void* _net;
+
+  void (*_destroy)( void* );
+  void (*_reset)( void* );
+  void (*_feed_forward)( void*, const double*, double* );
+
+  uint64_t _fingerprint;
+  std::size_t _input_size;
+  std::vector<double> _output;
+};
+
+}
@@ -0,0 +1,44 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace littlelstm {
+
+/**
+ * The part of a network that is needed to perform with it. LstmNetwork
+ * implements it, as do the forms of a trained network that can only
+ * perform: CompiledNetwork and QuantizedNetwork.
+ */
+class FeedForwardNetwork {
+public:
+  virtual ~FeedForwardNetwork() {}
+
+  virtual void feed_forward( const std::vector<double>& input ) =0;
+  virtual const std::vector<double>& get_output() const =0;
+  virtual std::size_t get_output_size() const =0;
+  virtual std::size_t get_input_size() const =0;
+
+  virtual void zero_network() =0;
+};
+
+}
@@ -69,16 +69,18 @@ void JsonExporter::set_units_properties( const std::vector<LstmUnitProperties>&
   }
 }
 
-void JsonExporter::set_weights( const WeightsMap_t& weights ) {
+void JsonExporter::set_connection_weights( const ConnectionWeights_t&
+                                           weights ) {
   if( _json.find( "connections" ) == _json.end() ) {
     string error = "connections must be exported before weights";
     throw JsonExporterException( error );
   }
 
-  for( size_t i = 0; i < _json["connections"].size(); i += 2 ) {
-    Id_t in_id = _json["connections"][i];
-    Id_t out_id = _json["connections"][i + 1];
-
-    _json["weights"].push_back( weights.at( out_id ).at ( in_id ) );
+  if( weights.size() * 2 != _json["connections"].size() ) {
+    string error = "weight count does not match connection count";
+    throw JsonExporterException( error );
   }
+
+  for( auto& weight : weights )
+    _json["weights"].push_back( weight );
 }
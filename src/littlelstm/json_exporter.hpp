@@ -42,7 +42,7 @@ public:
                         connections );
   void set_units_properties( const std::vector<LstmUnitProperties>&
                              units_properties );
-  void set_weights( const WeightsMap_t& weights );
+  void set_connection_weights( const ConnectionWeights_t& weights );
 
 private:
   nlohmann::json _json;
@@ -142,3 +142,19 @@ WeightsMap_t JsonImporter::get_weights() {
 
   return weights_map;
 }
+
+ConnectionWeights_t JsonImporter::get_connection_weights() {
+  ConnectionWeights_t weights;
+
+  try {
+    weights.reserve( _json["weights"].size() );
+
+    for( auto& weight : _json["weights"] )
+      weights.push_back( weight );
+  }
+  catch( const domain_error& e ) {
+    throw JsonImporterException( e.what() );
+  }
+
+  return weights;
+}
@@ -44,6 +44,7 @@ public:
   std::vector< std::pair<Id_t, Id_t> > get_connections();
   const std::vector<LstmUnitProperties> get_units_properties();
   WeightsMap_t get_weights();
+  ConnectionWeights_t get_connection_weights();
 
 private:
   nlohmann::json _json;
@@ -20,11 +20,44 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <cmath>
+#include <string>
 
 #include "lstm_types.hpp"
 
 namespace littlelstm {
 
+/**
+ * How a network computes its logistic activation functions. EXACT_ACT_FUNCS
+ * calls exp() for every unit on every step. FAST_ACT_FUNCS interpolates a
+ * table instead (see logistic_fast()), which is several times faster and
+ * differs from the exact function by less than MAX_FAST_LOGISTIC_ERROR.
+ */
+enum lstm_act_impl_t {
+  EXACT_ACT_FUNCS,
+  FAST_ACT_FUNCS,
+  NO_ACT_FUNCS
+};
+
+inline std::string act_impl_to_string( lstm_act_impl_t impl ) {
+  switch( impl ) {
+  case EXACT_ACT_FUNCS:
+    return "exact";
+  case FAST_ACT_FUNCS:
+    return "fast";
+  default:
+    return "";
+  }
+}
+
+inline lstm_act_impl_t string_to_act_impl( const std::string& str ) {
+  if( str == "exact" )
+    return EXACT_ACT_FUNCS;
+  else if( str == "fast" )
+    return FAST_ACT_FUNCS;
+  else
+    return NO_ACT_FUNCS;
+}
+
 inline Real_t identity( Real_t x ) {
   return x;
 }
@@ -58,4 +91,156 @@ inline Real_t tanh_derivative( Real_t x ) {
   return 1.0 - x * x;
 }
 
+// The fast logistic function interpolates the logistic function sampled
+// every 1/8 from -16 to 16. Outside of that range it is clamped to the ends.
+static const int LOGISTIC_TABLE_INTERVALS = 256;
+static constexpr Real_t LOGISTIC_TABLE_MIN = -16.0;
+static constexpr Real_t LOGISTIC_TABLE_STEP = 1.0 / 8.0;
+
+// Measured against logistic() over the whole range of doubles (see
+// activation_function_test). Most of it comes from the clamping, since
+// 1 - logistic( 16 ) is about 1.1e-7.
+static constexpr Real_t MAX_FAST_LOGISTIC_ERROR = 2e-7;
+
+// exp() is not constexpr, so the table is computed with a Taylor series,
+// after halving the argument until the series converges quickly.
+constexpr Real_t constexpr_exp_series( Real_t x, Real_t term, Real_t sum,
+                                       int n ) {
+  return n > 24 ? sum
+    : constexpr_exp_series( x, term * x / n, sum + term * x / n, n + 1 );
+}
+
+constexpr Real_t constexpr_square( Real_t x ) {
+  return x * x;
+}
+
+constexpr Real_t constexpr_exp( Real_t x ) {
+  return ( x > 0.5 || x < -0.5 ) ? constexpr_square( constexpr_exp( x / 2 ) )
+    : constexpr_exp_series( x, 1.0, 1.0, 1 );
+}
+
+constexpr Real_t constexpr_logistic( Real_t x ) {
+  return 1.0 / ( 1.0 + constexpr_exp( -x ) );
+}
+
+/**
+ * The value of the logistic function at the start of an interval of the
+ * table, and its slope there in units of the interval.
+ */
+constexpr Real_t logistic_table_value( int interval ) {
+  return constexpr_logistic( LOGISTIC_TABLE_MIN +
+                             interval * LOGISTIC_TABLE_STEP );
+}
+
+constexpr Real_t logistic_table_slope( int interval ) {
+  return logistic_table_value( interval ) *
+    ( 1.0 - logistic_table_value( interval ) ) * LOGISTIC_TABLE_STEP;
+}
+
+/**
+ * Coefficient power of the cubic Hermite polynomial that matches the
+ * logistic function and its slope at both ends of an interval.
+ */
+constexpr Real_t logistic_table_coefficient( int interval, int power ) {
+  return power == 0 ? logistic_table_value( interval )
+    : power == 1 ? logistic_table_slope( interval )
+    : power == 2 ? 3.0 * ( logistic_table_value( interval + 1 ) -
+                           logistic_table_value( interval ) )
+                   - 2.0 * logistic_table_slope( interval )
+                   - logistic_table_slope( interval + 1 )
+    : 2.0 * ( logistic_table_value( interval ) -
+              logistic_table_value( interval + 1 ) )
+      + logistic_table_slope( interval ) + logistic_table_slope( interval + 1 );
+}
+
+template <int... I>
+struct IndexList {};
+
+template <typename First, typename Second>
+struct ConcatIndexLists;
+
+template <int... I, int... J>
+struct ConcatIndexLists< IndexList<I...>, IndexList<J...> > {
+  typedef IndexList<I..., ( sizeof...( I ) + J )...> type;
+};
+
+// IndexList<0, 1, ..., N - 1>, built by halves to keep the template
+// recursion shallow
+template <int N>
+struct MakeIndexList {
+  typedef typename ConcatIndexLists<
+    typename MakeIndexList<N / 2>::type,
+    typename MakeIndexList<N - N / 2>::type >::type type;
+};
+
+template <>
+struct MakeIndexList<0> {
+  typedef IndexList<> type;
+};
+
+template <>
+struct MakeIndexList<1> {
+  typedef IndexList<0> type;
+};
+
+template <typename Indexes>
+struct LogisticTable;
+
+/**
+ * Four polynomial coefficients per interval, computed at compile time.
+ */
+template <int... I>
+struct LogisticTable< IndexList<I...> > {
+  static constexpr Real_t coefficients[sizeof...( I )] = {
+    logistic_table_coefficient( I / 4, I % 4 )...
+  };
+};
+
+template <int... I>
+constexpr Real_t LogisticTable< IndexList<I...> >::coefficients[sizeof...( I )];
+
+typedef LogisticTable< MakeIndexList<LOGISTIC_TABLE_INTERVALS * 4>::type >
+  logistic_table_t;
+
+/**
+ * The logistic function, by piecewise cubic interpolation. There are no
+ * branches or calls, so loops over this function can be vectorized.
+ */
+inline Real_t logistic_fast( Real_t x ) {
+  Real_t u = ( x - LOGISTIC_TABLE_MIN ) * ( 1.0 / LOGISTIC_TABLE_STEP );
+
+  // written so that NaN ends up at the start of the table
+  u = u > 0.0 ? u : 0.0;
+  u = u < LOGISTIC_TABLE_INTERVALS ? u : LOGISTIC_TABLE_INTERVALS;
+
+  int i = (int)u;
+  i = i < LOGISTIC_TABLE_INTERVALS - 1 ? i : LOGISTIC_TABLE_INTERVALS - 1;
+
+  Real_t t = u - i;
+  const Real_t* c = logistic_table_t::coefficients + i * 4;
+
+  return c[0] + t * ( c[1] + t * ( c[2] + t * c[3] ) );
+}
+
+inline Real_t logistic_centered_fast( Real_t x ) {
+  return logistic_fast( x ) * 2.0 - 1.0;
+}
+
+/**
+ * Get the activation function for a unit. The derivatives are the same for
+ * both implementations, since they are computed from the activation.
+ */
+inline act_func_ptr_t get_act_func( lstm_act_func_t type,
+                                    lstm_act_impl_t impl ) {
+  switch( type ) {
+  case LOGISTIC:
+    return impl == FAST_ACT_FUNCS ? logistic_fast : logistic;
+  case LOGISTIC_CENTERED:
+    return impl == FAST_ACT_FUNCS ? logistic_centered_fast
+                                  : logistic_centered;
+  default:
+    return identity;
+  }
+}
+
 }
@@ -23,17 +23,24 @@ using namespace std;
 using namespace littlelstm;
 
 LstmArchitecture::LstmArchitecture( size_t input_count, size_t output_count,
-                                    vector<size_t> block_counts )
+                                    vector<size_t> block_counts,
+                                    vector<lstm_block_t> block_types )
   : _input_count( input_count ),
     _output_count( output_count ),
+    _block_types( block_types ),
     _next_id( 0 )
 {
   size_t hidden_layer_count = block_counts.size();
+
+  if( _block_types.empty() )
+    _block_types.assign( hidden_layer_count, LSTM_BLOCK );
+
+  assert( _block_types.size() == hidden_layer_count );
   
   _unit_count = _input_count + _output_count + 1;
   for( size_t h = 0; h < hidden_layer_count; ++h ) {
     for( size_t b = 0; b < block_counts[h]; ++b ) {
-      _unit_count += UNITS_PER_BLOCK;
+      _unit_count += get_units_per_block( _block_types[h] );
     }
   }
 
@@ -50,7 +57,7 @@ LstmArchitecture::LstmArchitecture( size_t input_count, size_t output_count,
   for( size_t i = 0; i < _input_count; ++i )
     _input_ids.push_back( add_unit( INPUT_UNIT ) );
   
-  Id_t bias_id = add_unit( BIAS_UNIT );
+  _bias_id = add_unit( BIAS_UNIT );
 
   for( size_t h = 0; h < hidden_layer_count; ++h ) {
     _input_gate_ids.push_back( vector<Id_t>() );
@@ -60,13 +67,18 @@ LstmArchitecture::LstmArchitecture( size_t input_count, size_t output_count,
     _cell_ids.push_back( vector<Id_t>() );
 
     for( size_t b = 0; b < block_counts[h]; ++b ) {
-      _input_gate_ids[h].push_back( add_unit( INPUT_GATE, LOGISTIC ) );
-      _forget_gate_ids[h].push_back( add_unit( FORGET_GATE, LOGISTIC ) );
-      _output_gate_ids[h].push_back( add_unit( OUTPUT_GATE, LOGISTIC ) );
+      if( _block_types[h] == LSTM_BLOCK ) {
+        _input_gate_ids[h].push_back( add_unit( INPUT_GATE, LOGISTIC ) );
+        _all_gate_ids[h].push_back( _input_gate_ids[h].back() );
+      }
 
-      _all_gate_ids[h].push_back( _input_gate_ids[h].back() );
+      _forget_gate_ids[h].push_back( add_unit( FORGET_GATE, LOGISTIC ) );
       _all_gate_ids[h].push_back( _forget_gate_ids[h].back() );
-      _all_gate_ids[h].push_back( _output_gate_ids[h].back() );
+
+      if( _block_types[h] == LSTM_BLOCK ) {
+        _output_gate_ids[h].push_back( add_unit( OUTPUT_GATE, LOGISTIC ) );
+        _all_gate_ids[h].push_back( _output_gate_ids[h].back() );
+      }
 
       Id_t cell_id = add_unit( CELL, LOGISTIC );
       _cell_ids[h].push_back( cell_id );
@@ -117,22 +129,22 @@ LstmArchitecture::LstmArchitecture( size_t input_count, size_t output_count,
     if( connection_needed( BIAS_LAYER_ID, h_id, BIAS_UNIT,
                                   INPUT_GATE ) ) {
       for( auto& out_id : _input_gate_ids[h] )
-        add_connection( bias_id, out_id );
+        add_connection( _bias_id, out_id );
     }
     if( connection_needed( BIAS_LAYER_ID, h_id, BIAS_UNIT,
                                   FORGET_GATE ) ) {
       for( auto& out_id : _forget_gate_ids[h] )
-        add_connection( bias_id, out_id );
+        add_connection( _bias_id, out_id );
     }
     if( connection_needed( BIAS_LAYER_ID, h_id, BIAS_UNIT,
                                   OUTPUT_GATE ) ) {
       for( auto& out_id : _output_gate_ids[h] )
-        add_connection( bias_id, out_id );
+        add_connection( _bias_id, out_id );
     }
     if( connection_needed( BIAS_LAYER_ID, h_id, BIAS_UNIT, CELL ) ) {
       for( auto& out_id : _cell_ids[h] ) {
-        add_connection( bias_id, out_id );
-        _gated_cell_inputs[out_id].push_back( bias_id );
+        add_connection( _bias_id, out_id );
+        _gated_cell_inputs[out_id].push_back( _bias_id );
       }
     }
   }
@@ -247,14 +259,18 @@ LstmArchitecture::LstmArchitecture( size_t input_count, size_t output_count,
   // add gates
   for( Index_t h = 0; h < hidden_layer_count; ++h ) {
     for( Index_t b = 0; b < block_counts[h]; ++b ) {
-      Id_t input_gate_id = _input_gate_ids[h][b];
       Id_t forget_gate_id = _forget_gate_ids[h][b];
-      Id_t output_gate_id = _output_gate_ids[h][b];
-
       Id_t cell_id = _cell_ids[h][b];
 
       add_self_gate( cell_id, forget_gate_id );
 
+      // a forget gate block's inputs and output are not gated
+      if( _block_types[h] != LSTM_BLOCK )
+        continue;
+
+      Id_t input_gate_id = _input_gate_ids[h][b];
+      Id_t output_gate_id = _output_gate_ids[h][b];
+
       for( auto& in_id : _gated_cell_inputs[cell_id] ) {
         // cout << "gate " << input_gate_id << " gating " << in_id << " -> "
         //      << cell_id << endl;
@@ -269,10 +285,23 @@ LstmArchitecture::LstmArchitecture( size_t input_count, size_t output_count,
   if( connection_needed( BIAS_LAYER_ID, output_layer_id, BIAS_UNIT,
                          OUTPUT_UNIT ) ) {
     for( auto& out_id : _output_ids )
-      add_connection( bias_id, out_id );
+      add_connection( _bias_id, out_id );
   }
 }
 
+/**
+ * Get the IDs of block b in hidden layer h: its input, forget and output
+ * gates followed by its cell, or only its forget gate and cell for a forget
+ * gate block.
+ */
+vector<Id_t> LstmArchitecture::get_block_ids( Index_t h, Index_t b ) const {
+  if( _block_types[h] == FORGET_GATE_BLOCK )
+    return { _forget_gate_ids[h][b], _cell_ids[h][b] };
+
+  return { _input_gate_ids[h][b], _forget_gate_ids[h][b],
+           _output_gate_ids[h][b], _cell_ids[h][b] };
+}
+
 void LstmArchitecture::add_connection( Id_t in_id, Id_t out_id ) {
   _connections.push_back( Conn_t( in_id, out_id ) );
 }
@@ -32,14 +32,23 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 namespace littlelstm {
 
 static const size_t UNITS_PER_BLOCK = 4;
+static const size_t UNITS_PER_FORGET_GATE_BLOCK = 2;
 
 /**
- * This class builds an architecture for an LSTM network.
+ * This class builds an architecture for an LSTM network. Each hidden layer is
+ * built from one type of block, LSTM blocks unless block_types says
+ * otherwise.
  */
 class LstmArchitecture {
 public:
   LstmArchitecture( size_t input_count, size_t output_count,
-                    std::vector<size_t> block_counts );
+                    std::vector<size_t> block_counts,
+                    std::vector<lstm_block_t> block_types = {} );
+
+  static size_t get_units_per_block( lstm_block_t block_type ) {
+    return block_type == FORGET_GATE_BLOCK ? UNITS_PER_FORGET_GATE_BLOCK
+                                           : UNITS_PER_BLOCK;
+  }
 
   size_t get_unit_count() const { return _unit_count; }
   size_t get_input_count() const { return _input_count; }
@@ -52,6 +61,14 @@ public:
   const LstmUnitProperties& get_unit_properties( Id_t id ) const
   { return _units_properties[id]; }
 
+  const std::vector<Id_t>& get_input_ids() const { return _input_ids; }
+  const std::vector<Id_t>& get_output_ids() const { return _output_ids; }
+  Id_t get_bias_id() const { return _bias_id; }
+  size_t get_hidden_layer_count() const { return _cell_ids.size(); }
+  size_t get_block_count( Index_t h ) const { return _cell_ids[h].size(); }
+  lstm_block_t get_block_type( Index_t h ) const { return _block_types[h]; }
+  std::vector<Id_t> get_block_ids( Index_t h, Index_t b ) const;
+
 private:
   Id_t add_unit( lstm_unit_t type, lstm_act_func_t act_func = IDENTITY );
   void add_gate( Id_t in_id, Id_t out_id, Id_t gate_id );
@@ -69,6 +86,8 @@ private:
   size_t _input_count;
   size_t _output_count;
 
+  std::vector<lstm_block_t> _block_types;
+
   std::vector<LstmLayerConfig> _layer_configs;
   LstmWeightConfig _weight_config;
 
@@ -77,6 +96,7 @@ private:
 
   // groups of IDs for connection building
   std::vector<Id_t> _input_ids;
+  Id_t _bias_id;
   std::vector< std::vector<Id_t> > _input_gate_ids;
   std::vector< std::vector<Id_t> > _forget_gate_ids;
   std::vector< std::vector<Id_t> > _output_gate_ids;
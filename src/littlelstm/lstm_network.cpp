@@ -43,7 +43,21 @@ LstmNetwork::LstmNetwork( NetworkImporter& importer, bool training )
                  importer.get_units_properties(),
                  training )
 {
-  set_weights( importer.get_weights() );
+  ConnectionWeights_t weights = importer.get_connection_weights();
+  vector< pair<Id_t, Id_t> > connections = importer.get_connections();
+
+  if( connections == get_connections() ) {
+    set_connection_weights( weights );
+    return;
+  }
+
+  // the importer lists its connections in a different order than ours
+  if( weights.size() != connections.size() )
+    throw out_of_range( "Weight count does not match connection count" );
+
+  for( Index_t i = 0; i < connections.size(); ++i )
+    _weights[_conn_indexes[connections[i].second][connections[i].first]] =
+      weights[i];
 }
 
 LstmNetwork::LstmNetwork( size_t input_count,
@@ -66,6 +80,8 @@ LstmNetwork::LstmNetwork( size_t input_count,
   , _act_funcs( _unit_count, nullptr )
   , _act_func_derivatives( _unit_count, nullptr )
   , _incoming_conns( _unit_count )
+  , _conn_offsets( _unit_count + 1, 0 )
+  , _conn_indexes( _unit_count, vector<Index_t>( _unit_count, NO_CONNECTION ) )
   , _conn_gains( _unit_count, vector<double>( _unit_count, 0.0 ) )
   , _self_conn( _unit_count, false )
   , _self_conn_gaters( _unit_count, NO_UNIT )
@@ -82,8 +98,10 @@ LstmNetwork::LstmNetwork( size_t input_count,
   , _error_resp_ps( _unit_count, 0.0 )
   , _error_resp_gs( _unit_count, 0.0 )
   , _error_resps( _unit_count, 0.0 )
-  , _weights( _unit_count, vector<double>( _unit_count, 0.0 ) )
-  , _old_weight_changes( _unit_count, vector<double>( _unit_count, 0.0 ) )
+  , _weights( connections.size(), 0.0 )
+  , _gradients( connections.size(), 0.0 )
+  , _old_weight_changes( connections.size(), 0.0 )
+  , _optimizer_step_count( 0 )
   , _units_properties( units_properties )
 {
   for( auto& conn : connections ) {
@@ -94,19 +112,37 @@ LstmNetwork::LstmNetwork( size_t input_count,
 
     if( in_id < out_id )
       _projection_sets[in_id].insert( out_id );
+  }
+
+  for( Id_t out_id = 0; out_id < _unit_count; ++out_id ) {
+    _conn_offsets[out_id + 1] =
+      _conn_offsets[out_id] + _incoming_conns[out_id].size();
+
+    for( Index_t in_i = 0; in_i < _incoming_conns[out_id].size(); ++in_i ) {
+      Id_t in_id = _incoming_conns[out_id][in_i];
+      _conn_indexes[out_id][in_id] = _conn_offsets[out_id] + in_i;
+    }
+  }
+
+  // initialize in the order the connections were given so that the random
+  // weights do not depend on how they are stored
+  for( auto& conn : connections ) {
+    Index_t in_id = conn.first;
+    Index_t out_id = conn.second;
+    double& weight = _weights[_conn_indexes[out_id][in_id]];
 
     if( units_properties[in_id].get_type() == BIAS_UNIT ) {
       if( units_properties[out_id].get_type() == FORGET_GATE )
-        _weights[out_id][in_id] = uniform_random_weight( 0.0, 2.0 );
+        weight = uniform_random_weight( 0.0, 2.0 );
       else if( units_properties[out_id].get_type() == INPUT_GATE )
-        _weights[out_id][in_id] = uniform_random_weight( -2.0, 0.0 );
+        weight = uniform_random_weight( -2.0, 0.0 );
       else if( units_properties[out_id].get_type() == OUTPUT_GATE )
-        _weights[out_id][in_id] = uniform_random_weight( -2.0, 0.0 );
+        weight = uniform_random_weight( -2.0, 0.0 );
       else
-        _weights[out_id][in_id] = normal_random_weight( 0.0, 0.1 );
+        weight = normal_random_weight( 0.0, 0.1 );
     }
     else
-      _weights[out_id][in_id] = normal_random_weight( 0.0, 0.1 );
+      weight = normal_random_weight( 0.0, 0.1 );
   }
 
   for( auto& unit_properties : units_properties ) {
@@ -139,6 +175,14 @@ LstmNetwork::LstmNetwork( size_t input_count,
     }
   }
 
+  for( Id_t id = _bias_id; id < _unit_count; ++id ) {
+    if( _gated_sets[id].empty() )
+      continue;
+
+    _gater_ids.push_back( id );
+    _ext_trace_work += _gated_sets[id].size() * _incoming_conns[id].size();
+  }
+
   _activations[_bias_id] = 1.0;
 }
 
@@ -148,41 +192,56 @@ void LstmNetwork::export_network( NetworkExporter& exporter ) const {
   exporter.set_unit_count( _unit_count );
   exporter.set_connections( get_connections() );
   exporter.set_units_properties( _units_properties );
-  exporter.set_weights( get_weights_map() );
+  exporter.set_connection_weights( _weights );
 }
 
 void LstmNetwork::feed_forward( const vector<double>& input ) {
   assert( input.size() == _input_count );
 
-  //clock_t begin = clock();
-
   _input = input;
 
+  PhaseTimer timer( _profiling ? &_profile.activations : nullptr );
   calculate_activations();
-
-  //clock_t end = clock();
-
-  //double elapsed = end - begin;
-
-  //cout << "fed forward in " << elapsed << endl;
 }
 
 void LstmNetwork::backpropagate( const vector<double>& target,
                                   const double learning_rate,
                                   const double momentum ) {
-  //clock_t begin = clock();
-
   _target = target;
 
-  calculate_extended_eligibility_traces();
-  calculate_error_responsibilities();
-  update_weights( learning_rate, momentum );
+  if( !_profiling ) {
+    calculate_extended_eligibility_traces();
+    calculate_error_responsibilities();
+    update_weights( learning_rate, momentum );
+    return;
+  }
 
-  //clock_t end = clock();
+  {
+    PhaseTimer timer( &_profile.eligibility_traces );
+    calculate_extended_eligibility_traces();
+  }
+  {
+    PhaseTimer timer( &_profile.error_responsibilities );
+    calculate_error_responsibilities();
+  }
+  {
+    PhaseTimer timer( &_profile.weight_updates );
+    update_weights( learning_rate, momentum );
+  }
 
-  //double elapsed = end - begin;
+  _profile.connection_update_count += _weights.size();
+}
 
-  //  cout << "backpropagated in " << elapsed << endl;
+/**
+ * Turn on or off timing of the phases of feed_forward() and
+ * backpropagate(). Profiling is off by default.
+ */
+void LstmNetwork::set_profiling( bool profiling ) {
+  _profiling = profiling;
+}
+
+void LstmNetwork::reset_profile() {
+  _profile = LstmProfile();
 }
 
 double LstmNetwork::uniform_random_weight( double min, double max ) {
@@ -196,10 +255,10 @@ double LstmNetwork::normal_random_weight( double mean, double stddev ) {
 void LstmNetwork::zero_network() {
   fill( _states.begin(), _states.end(), 0.0 );
   fill( _activations.begin(), _activations.end(), 0.0 );
-  for( Index_t i = 0; i < _old_weight_changes.size(); ++i ) {
-    fill( _old_weight_changes[i].begin(), _old_weight_changes[i].end(),
-          0.0 );
-  }
+
+  // the adaptive optimizers keep their averages across sequences
+  if( _optimizer.type == MOMENTUM_OPTIMIZER )
+    fill( _old_weight_changes.begin(), _old_weight_changes.end(), 0.0 );
 
   // return bias activation to 1.0
   _activations[_bias_id] = 1.0;
@@ -219,6 +278,14 @@ map<Id_t, double> LstmNetwork::get_cell_states() {
 }
 
 
+/**
+ * Feed the input forward. In unit order every unit sees the new activations
+ * of the units before it and the previous step's activations of the rest. In
+ * level order (see set_step_order()) every unit sees the new
+ * activations of the levels before its own and the previous step's
+ * activations of its own level and the rest, so the units of a level can be
+ * calculated at the same time.
+ */
 void LstmNetwork::calculate_activations() {
   copy( _input.begin(), _input.end(), _activations.begin() );
 
@@ -227,89 +294,121 @@ void LstmNetwork::calculate_activations() {
   for( size_t i = 0; i < _right_term_sums.size(); ++i )
     fill( _right_term_sums[i].begin(), _right_term_sums[i].end(), 0.0 );
 
-  Id_t first_id = _bias_id + 1;
-
-  for( Id_t id = first_id; id < _unit_count; ++id ) {
-    double sum = 0.0;
+  if( _levels.empty() ) {
+    for( Id_t id = _bias_id + 1; id < _unit_count; ++id )
+      _activations[id] = calculate_activation( id );
+  }
+  else {
+    for( size_t l = 0; l < _levels.size(); ++l ) {
+      const vector<Id_t>& level = _levels[l];
+
+      run_step_loop( level.size(), _level_work[l],
+                     [this, &level]( size_t begin, size_t end ) {
+                       for( size_t i = begin; i < end; ++i )
+                         _level_activations[level[i]] =
+                           calculate_activation( level[i] );
+                     } );
+
+      for( Id_t id : level )
+        _activations[id] = _level_activations[id];
+    }
+  }
 
-    if( _self_conn[id] ) {
-      Id_t gater_id = _self_conn_gaters[id];
+  copy( _activations.begin() + _first_output_id, _activations.end(),
+        _output.begin() );
+}
 
-      double gain;
+/**
+ * Calculate the state of a unit and return its activation, which the caller
+ * stores. Only writes to the unit's own state, traces and gains, so different
+ * units can be calculated at the same time.
+ */
+double LstmNetwork::calculate_activation( Id_t id ) {
+  double sum = 0.0;
 
-      if( gater_id == NO_UNIT )
-        gain = 1.0;
-      else
-        gain = _activations[gater_id];
+  if( _self_conn[id] ) {
+    Id_t gater_id = _self_conn_gaters[id];
 
-      sum += gain * _old_states[id];
+    double gain;
 
-      if( _training )
-        _self_conn_gains[id] = gain;
-    }
-    
-    for( Index_t in_i = 0; in_i < _incoming_conns[id].size(); ++in_i ) {
-      Id_t in_id = _incoming_conns[id][in_i];
-      Id_t gater_id = _gaters[id][in_id];
+    if( gater_id == NO_UNIT )
+      gain = 1.0;
+    else
+      gain = _activations[gater_id];
 
-      double gain;
+    sum += gain * _old_states[id];
 
-      if( gater_id == NO_UNIT )
-        gain = 1.0;
-      else {
-        gain = _activations[gater_id];
-        if( _training ) {
-          _right_term_sums[gater_id][id] += _weights[id][in_id] *
-            _activations[in_id];
-          _conn_gains[id][in_id] = gain;
-        }
+    if( _training )
+      _self_conn_gains[id] = gain;
+  }
+    
+  const double* weights = _weights.data() + _conn_offsets[id];
+
+  for( Index_t in_i = 0; in_i < _incoming_conns[id].size(); ++in_i ) {
+    Id_t in_id = _incoming_conns[id][in_i];
+    Id_t gater_id = _gaters[id][in_id];
+
+    double gain;
+
+    if( gater_id == NO_UNIT )
+      gain = 1.0;
+    else {
+      gain = _activations[gater_id];
+      if( _training ) {
+        _right_term_sums[gater_id][id] += weights[in_i] *
+          _activations[in_id];
+        _conn_gains[id][in_id] = gain;
       }
+    }
 
-      sum += gain * _weights[id][in_id] * _activations[in_id];
-
-      if( !_training )
-        continue;
-
-      if( _self_conn[id] )
-        _traces[id][in_id] = _self_conn_gains[id] * _traces[id][in_id];
-      else
-        _traces[id][in_id] = 0.0;
+    sum += gain * weights[in_i] * _activations[in_id];
 
-      _traces[id][in_id] += gain * _activations[in_id];
-    }
+    if( !_training )
+      continue;
 
-    _states[id] = sum;
+    if( _self_conn[id] )
+      _traces[id][in_id] = _self_conn_gains[id] * _traces[id][in_id];
+    else
+      _traces[id][in_id] = 0.0;
 
-    _activations[id] = _act_funcs[id]( _states[id] );
+    _traces[id][in_id] += gain * _activations[in_id];
   }
 
-  copy( _activations.begin() + _first_output_id, _activations.end(),
-        _output.begin() );
+  _states[id] = sum;
+
+  return _act_funcs[id]( _states[id] );
 }
 
+/**
+ * The extended traces of each gater are independent of the others, so they
+ * are split between the step workers.
+ */
 void LstmNetwork::calculate_extended_eligibility_traces() {
-  for( Id_t j = _bias_id; j < _gated_sets.size(); ++j ) {
-    if( _gated_sets[j].size() == 0 )
-      continue;
+  run_step_loop( _gater_ids.size(), _ext_trace_work,
+                 [this]( size_t begin, size_t end ) {
+                   for( size_t g = begin; g < end; ++g )
+                     calculate_extended_eligibility_traces( _gater_ids[g] );
+                 } );
+}
 
-    for( auto& k : _gated_sets[j] ) {
-      for( auto& i : _incoming_conns[j] ) {
-        double right_term = 0.0;
-        double trace = 0.0;
+void LstmNetwork::calculate_extended_eligibility_traces( Id_t j ) {
+  for( auto& k : _gated_sets[j] ) {
+    for( auto& i : _incoming_conns[j] ) {
+      double right_term = 0.0;
+      double trace = 0.0;
 
-        if( _self_conn[k] ) {
-          if( _self_conn_gaters[k] == j )
-            right_term += _old_states[k];
-          trace += _self_conn_gains[k] * _ext_traces[k][j][i];
-        }
+      if( _self_conn[k] ) {
+        if( _self_conn_gaters[k] == j )
+          right_term += _old_states[k];
+        trace += _self_conn_gains[k] * _ext_traces[k][j][i];
+      }
 
-        right_term += _right_term_sums[j][k];
+      right_term += _right_term_sums[j][k];
 
-        trace += _act_func_derivatives[j]( _activations[j] ) * _traces[j][i]
-          * right_term;
+      trace += _act_func_derivatives[j]( _activations[j] ) * _traces[j][i]
+        * right_term;
 
-        _ext_traces[k][j][i] = trace;
-      }
+      _ext_traces[k][j][i] = trace;
     }
   }
 }
@@ -333,7 +432,8 @@ void LstmNetwork::calculate_error_responsibilities() {
       else
         gain = _conn_gains[proj_id][id];
 
-      sum += _error_resps[proj_id] * gain * _weights[proj_id][id];
+      sum += _error_resps[proj_id] * gain *
+        _weights[_conn_indexes[proj_id][id]];
     }
 
     _error_resp_ps[id] = derivative * sum;
@@ -353,51 +453,452 @@ void LstmNetwork::calculate_error_responsibilities() {
   }
 }
 
-void LstmNetwork::update_weights( const double learning_rate,
-                                   const double momentum ) {
+/**
+ * Calculate the gradient of each connection from the error responsibilities
+ * and eligibility traces. The gradients point in the direction the weights
+ * should move.
+ */
+void LstmNetwork::calculate_gradients() {
   Id_t first_id = _bias_id + 1;
-  for( Id_t id = first_id; id < _unit_count; ++id ) {
-    for( Index_t in_i = 0; in_i < _incoming_conns[id].size(); ++in_i ) {
-      Id_t in_id = _incoming_conns[id][in_i];
 
+  run_step_loop( _unit_count - first_id, _weights.size(),
+                 [this, first_id]( size_t begin, size_t end ) {
+                   for( Id_t id = first_id + begin; id < first_id + end; ++id )
+                     calculate_gradients( id );
+                 } );
+}
+
+void LstmNetwork::calculate_gradients( Id_t id ) {
+  for( Index_t in_i = 0; in_i < _incoming_conns[id].size(); ++in_i ) {
+    Id_t in_id = _incoming_conns[id][in_i];
+    Index_t conn_i = _conn_offsets[id] + in_i;
+
+    double gradient;
+
+    if( id >= _first_output_id ) {
+      gradient = _act_func_derivatives[id]( _activations[id] ) *
+        _error_resps[id] * _activations[in_id];
+      if( _gaters[id][in_id] != NO_UNIT )
+        gradient *= _conn_gains[id][in_id];
+    }
+    else {
       double sum = 0.0;
-      double weight_change;
 
-      if( id >= _first_output_id ) {
-        weight_change = _act_func_derivatives[id]( _activations[id] ) *
-          _error_resps[id] * _activations[in_id];
-        if( _gaters[id][in_id] != NO_UNIT )
-          weight_change *= _conn_gains[id][in_id];
+      for( auto& k : _gated_sets[id] ) {
+        sum += _error_resps[k] * _ext_traces[k][id][in_id];
       }
-      else {
-        for( auto& k : _gated_sets[id] ) {
-          sum += _error_resps[k] * _ext_traces[k][id][in_id];
-        }
 
-        weight_change = learning_rate * ( _error_resp_ps[id] *
-                                          _traces[id][in_id] + sum );
+      gradient = _error_resp_ps[id] * _traces[id][in_id] + sum;
+    }
+
+    _gradients[conn_i] = gradient;
+  }
+}
 
-        weight_change += momentum * _old_weight_changes[id][in_id];
-      }
-      
-      _weights[id][in_id] += weight_change;
-      _old_weight_changes[id][in_id] = weight_change;
+/**
+ * Change the weights of all connections according to the optimizer. With the
+ * default momentum optimizer the weights of connections into the output units
+ * change by their raw gradient, without the learning rate or momentum, unless
+ * the optimizer scales the output updates. The adaptive optimizers treat all
+ * connections in the same way.
+ */
+void LstmNetwork::update_weights( const double learning_rate,
+                                  const double momentum ) {
+  calculate_gradients();
+
+  size_t conn_count = _weights.size();
+
+  switch( _optimizer.type ) {
+  case RMSPROP_OPTIMIZER: {
+    double decay = _optimizer.second_moment_decay;
+
+    for( Index_t i = 0; i < conn_count; ++i ) {
+      double gradient = _gradients[i];
+
+      _second_moments[i] = decay * _second_moments[i] +
+        ( 1.0 - decay ) * gradient * gradient;
+
+      double weight_change = learning_rate * gradient /
+        ( sqrt( _second_moments[i] ) + OPTIMIZER_EPSILON );
+
+      _weights[i] += weight_change;
+      _old_weight_changes[i] = weight_change;
+    }
+    break;
+  }
+  case ADAM_OPTIMIZER: {
+    double decay = _optimizer.second_moment_decay;
+
+    ++_optimizer_step_count;
+
+    // bias correction for the moments starting at zero
+    double step = (double)_optimizer_step_count;
+    double corrected_rate = learning_rate *
+      sqrt( 1.0 - pow( decay, step ) ) / ( 1.0 - pow( momentum, step ) );
+
+    for( Index_t i = 0; i < conn_count; ++i ) {
+      double gradient = _gradients[i];
+
+      _old_weight_changes[i] = momentum * _old_weight_changes[i] +
+        ( 1.0 - momentum ) * gradient;
+      _second_moments[i] = decay * _second_moments[i] +
+        ( 1.0 - decay ) * gradient * gradient;
+
+      _weights[i] += corrected_rate * _old_weight_changes[i] /
+        ( sqrt( _second_moments[i] ) + OPTIMIZER_EPSILON );
+    }
+    break;
+  }
+  default: {
+    Index_t first_output_conn = _optimizer.scale_output_updates ?
+      conn_count : _conn_offsets[_first_output_id];
+
+    for( Index_t i = 0; i < conn_count; ++i ) {
+      double weight_change;
+
+      if( i >= first_output_conn )
+        weight_change = _gradients[i];
+      else
+        weight_change = learning_rate * _gradients[i] +
+          momentum * _old_weight_changes[i];
+
+      _weights[i] += weight_change;
+      _old_weight_changes[i] = weight_change;
+    }
+    break;
+  }
+  }
+}
+
+/**
+ * Compute the logistic activation functions exactly or with the fast
+ * approximations (see lstm_act_impl_t). The derivatives are the same either
+ * way, so this can be changed at any time, even in the middle of training.
+ */
+void LstmNetwork::set_act_impl( lstm_act_impl_t impl ) {
+  _act_impl = impl;
+
+  for( auto& unit_properties : _units_properties ) {
+    lstm_unit_t unit_type = unit_properties.get_type();
+
+    if( unit_type == INPUT_UNIT || unit_type == BIAS_UNIT )
+      continue;
+
+    _act_funcs[unit_properties.get_id()] =
+      get_act_func( unit_properties.get_act_func_type(), impl );
+  }
+}
+
+/**
+ * Calculate the units in the order of their IDs, as they always have been,
+ * or in level order: the units are grouped into levels whose units do not
+ * see each other's new activations, so the units of a level can be
+ * calculated in parallel (see set_step_thread_count()). For the networks
+ * built by LstmArchitecture the gates of a hidden layer form one level and
+ * its cells the next, so recurrent connections within a layer carry the
+ * previous step's activations. This changes the outputs slightly, so a
+ * network should be performed in the order it was trained in.
+ */
+void LstmNetwork::set_step_order( lstm_step_order_t order ) {
+  _step_order = order;
+
+  if( order == UNIT_STEP_ORDER ) {
+    _levels.clear();
+    _level_work.clear();
+  }
+  else if( _levels.empty() ) {
+    calculate_levels();
+  }
+}
+
+/**
+ * Calculate the units in level order with the given levels instead of ones
+ * worked out from the connections (see calculate_levels()). Every unit after
+ * the bias must be in exactly one level.
+ */
+void LstmNetwork::set_levels( const vector< vector<Id_t> >& levels ) {
+  vector<bool> found( _unit_count, false );
+  size_t found_count = 0;
+
+  for( auto& level : levels ) {
+    for( Id_t id : level ) {
+      if( id <= _bias_id || id >= _unit_count || found[id] )
+        throw out_of_range( "Levels do not match the network's units" );
+
+      found[id] = true;
+      ++found_count;
     }
   }
-}      
 
+  if( found_count != _unit_count - _bias_id - 1 )
+    throw out_of_range( "Levels do not match the network's units" );
+
+  _step_order = LEVEL_STEP_ORDER;
+  _levels = levels;
+  _level_work.assign( _levels.size(), 0 );
+
+  for( size_t l = 0; l < _levels.size(); ++l ) {
+    for( Id_t id : _levels[l] )
+      _level_work[l] += _incoming_conns[id].size();
+  }
+
+  _level_activations.assign( _unit_count, 0.0 );
+}
+
+/**
+ * Share the work of each step between thread_count threads, counting the
+ * calling thread. 0 uses one thread per hardware thread. The number of
+ * threads never changes the outputs. In unit order the activations are
+ * calculated on the calling thread and only the rest of the step is shared.
+ *
+ * Loops with less work than PARALLEL_STEP_MIN_WORK stay on the calling
+ * thread, so small networks do not gain anything from the threads.
+ */
+void LstmNetwork::set_step_thread_count( size_t thread_count ) {
+  if( thread_count == 0 )
+    thread_count = max( 1u, thread::hardware_concurrency() );
+
+  _step_thread_count = thread_count;
+  _step_pool = StepWorkerPool( thread_count - 1 );
+}
+
+/**
+ * A unit depends on the units before it whose new activations it must see:
+ * its inputs, the gaters of its connections, and the gater of its self
+ * connection. Dependencies on later units are always on their previous
+ * activations. A connection between two units that also connect the other
+ * way is recurrent, unless it is a gate's connection to a cell, which always
+ * sees the gate's new activation. Each unit's level is one more than the
+ * highest level it depends on.
+ *
+ * Since a connection only counts as recurrent while the connection back
+ * exists, removing connections can change the levels. A pruned network keeps
+ * the levels of the network it was pruned from (see set_levels()).
+ */
+void LstmNetwork::calculate_levels() {
+  vector<size_t> unit_levels( _unit_count, 0 );
+
+  _levels.clear();
+  _level_work.clear();
+
+  for( Id_t id = _bias_id + 1; id < _unit_count; ++id ) {
+    size_t level = 0;
+
+    auto depend_on = [&]( Id_t dep_id ) {
+      if( dep_id == NO_UNIT || dep_id <= _bias_id || dep_id >= id )
+        return;
+
+      lstm_unit_t dep_type = _units_properties[dep_id].get_type();
+      bool gate_to_cell = _units_properties[id].get_type() == CELL &&
+        ( dep_type == INPUT_GATE || dep_type == FORGET_GATE ||
+          dep_type == OUTPUT_GATE );
+
+      if( _conn_indexes[dep_id][id] != NO_CONNECTION && !gate_to_cell )
+        return;
+
+      level = max( level, unit_levels[dep_id] + 1 );
+    };
+
+    for( auto& in_id : _incoming_conns[id] ) {
+      depend_on( in_id );
+      depend_on( _gaters[id][in_id] );
+    }
+
+    if( _self_conn[id] )
+      depend_on( _self_conn_gaters[id] );
+
+    unit_levels[id] = level;
+
+    if( level >= _levels.size() ) {
+      _levels.resize( level + 1 );
+      _level_work.resize( level + 1, 0 );
+    }
+
+    _levels[level].push_back( id );
+    _level_work[level] += _incoming_conns[id].size();
+  }
+
+  _level_activations.assign( _unit_count, 0.0 );
+}
+
+void LstmNetwork::run_step_loop( size_t count, size_t work,
+                                 const StepWorkerPool::RangeFunction&
+                                 function ) {
+  if( work >= PARALLEL_STEP_MIN_WORK )
+    _step_pool.run( count, function );
+  else
+    function( 0, count );
+}
+
+/**
+ * Use a different optimizer for the following weight updates. The
+ * optimizer's per connection state starts from zero.
+ */
+void LstmNetwork::set_optimizer( const LstmOptimizerConfig& config ) {
+  _optimizer = config;
+
+  fill( _old_weight_changes.begin(), _old_weight_changes.end(), 0.0 );
+
+  if( _optimizer.type == RMSPROP_OPTIMIZER ||
+      _optimizer.type == ADAM_OPTIMIZER )
+    _second_moments.assign( _weights.size(), 0.0 );
+  else
+    _second_moments.clear();
+
+  _optimizer_step_count = 0;
+}
+
+/**
+ * Set the weights from a vector in the same order as get_connections(), such
+ * as one returned by get_connection_weights(). Since this is also how the
+ * weights are stored, this is a straight copy and does not allocate.
+ */
+void LstmNetwork::set_connection_weights( const ConnectionWeights_t& weights ) {
+  if( weights.size() < _weights.size() )
+    throw out_of_range( "Too few weights for the network's connections" );
+  if( weights.size() > _weights.size() )
+    throw out_of_range( "Too many weights for the network's connections" );
+
+  copy( weights.begin(), weights.end(), _weights.begin() );
+}
+
+/**
+ * Get each gater and each unit it gates, in the order LstmNetworkState stores
+ * their gains and extended traces.
+ */
+vector< pair<Id_t, Id_t> > LstmNetwork::get_gated_pairs() const {
+  vector< pair<Id_t, Id_t> > pairs;
+
+  for( Id_t j = 0; j < _unit_count; ++j ) {
+    vector<Id_t> gated( _gated_sets[j].begin(), _gated_sets[j].end() );
+    sort( gated.begin(), gated.end() );
+
+    for( Id_t k : gated )
+      pairs.emplace_back( j, k );
+  }
+
+  return pairs;
+}
+
+/**
+ * Copy everything needed to continue training into state. Reusing the same
+ * state object avoids reallocating its vectors.
+ */
+void LstmNetwork::get_state( LstmNetworkState& state ) const {
+  state.weights = _weights;
+  state.weight_changes = _old_weight_changes;
+  state.second_moments = _second_moments;
+  state.optimizer_step_count = _optimizer_step_count;
+  state.states = _states;
+  state.old_states = _old_states;
+  state.activations = _activations;
+  state.self_conn_gains = _self_conn_gains;
+
+  state.traces.clear();
+  state.conn_gains.clear();
+
+  for( Id_t id = 0; id < _unit_count; ++id ) {
+    for( Id_t in_id : _incoming_conns[id] ) {
+      state.traces.push_back( _traces[id][in_id] );
+      state.conn_gains.push_back( _conn_gains[id][in_id] );
+    }
+  }
+
+  state.right_term_sums.clear();
+  state.extended_traces.clear();
+
+  for( auto& gated_pair : get_gated_pairs() ) {
+    Id_t j = gated_pair.first;
+    Id_t k = gated_pair.second;
+
+    state.right_term_sums.push_back( _right_term_sums[j][k] );
+
+    for( Id_t i : _incoming_conns[j] )
+      state.extended_traces.push_back( _ext_traces[k][j][i] );
+  }
+}
+
+/**
+ * Restore a state from get_state(). The state must come from a network with
+ * the same architecture.
+ */
+void LstmNetwork::set_state( const LstmNetworkState& state ) {
+  vector< pair<Id_t, Id_t> > gated_pairs = get_gated_pairs();
+  size_t extended_trace_count = 0;
+
+  for( auto& gated_pair : gated_pairs )
+    extended_trace_count += _incoming_conns[gated_pair.first].size();
+
+  if( state.weights.size() != _weights.size() ||
+      state.weight_changes.size() != _old_weight_changes.size() ||
+      state.second_moments.size() != _second_moments.size() ||
+      state.states.size() != _unit_count ||
+      state.old_states.size() != _unit_count ||
+      state.activations.size() != _unit_count ||
+      state.traces.size() != _weights.size() ||
+      state.conn_gains.size() != _weights.size() ||
+      state.self_conn_gains.size() != _unit_count ||
+      state.right_term_sums.size() != gated_pairs.size() ||
+      state.extended_traces.size() != extended_trace_count )
+    throw out_of_range( "Network state does not match the network's "
+                        "architecture" );
+
+  _weights = state.weights;
+  _old_weight_changes = state.weight_changes;
+  _second_moments = state.second_moments;
+  _optimizer_step_count = state.optimizer_step_count;
+  _states = state.states;
+  _old_states = state.old_states;
+  _activations = state.activations;
+  _self_conn_gains = state.self_conn_gains;
+
+  size_t conn_i = 0;
+
+  for( Id_t id = 0; id < _unit_count; ++id ) {
+    for( Id_t in_id : _incoming_conns[id] ) {
+      _traces[id][in_id] = state.traces[conn_i];
+      _conn_gains[id][in_id] = state.conn_gains[conn_i];
+      ++conn_i;
+    }
+  }
+
+  size_t ext_trace_i = 0;
+
+  for( size_t p = 0; p < gated_pairs.size(); ++p ) {
+    Id_t j = gated_pairs[p].first;
+    Id_t k = gated_pairs[p].second;
+
+    _right_term_sums[j][k] = state.right_term_sums[p];
+
+    for( Id_t i : _incoming_conns[j] )
+      _ext_traces[k][j][i] = state.extended_traces[ext_trace_i++];
+  }
+}
+
+/**
+ * Set the weights of the connections in weights_map. Prefer
+ * set_connection_weights(), this is kept for compatibility.
+ */
 void LstmNetwork::set_weights( const WeightsMap_t& weights_map ) {
   for( auto& kv_out : weights_map ) {
     Id_t out_id = kv_out.first;
-    for( auto& kv_in : weights_map.at( out_id ) ) {
+    for( auto& kv_in : kv_out.second ) {
       Id_t in_id = kv_in.first;
-      double weight = kv_in.second;
 
-      _weights[out_id][in_id] = weight;
+      if( out_id >= _unit_count || in_id >= _unit_count ||
+          _conn_indexes[out_id][in_id] == NO_CONNECTION )
+        throw out_of_range( "Weight for a connection the network does not "
+                            "have" );
+
+      _weights[_conn_indexes[out_id][in_id]] = kv_in.second;
     }
   }
 }
 
+/**
+ * Get the weights keyed by output and input unit. Prefer
+ * get_connection_weights(), this is kept for compatibility.
+ */
 WeightsMap_t LstmNetwork::get_weights_map() const {
   WeightsMap_t weights_map;
 
@@ -405,7 +906,7 @@ WeightsMap_t LstmNetwork::get_weights_map() const {
     for( Index_t i = 0; i < _incoming_conns[out_id].size(); ++i ) {
       Id_t in_id = _incoming_conns[out_id][i];
       
-      weights_map[out_id][in_id] = _weights[out_id][in_id];
+      weights_map[out_id][in_id] = _weights[_conn_offsets[out_id] + i];
     }
   }
 
@@ -431,7 +932,7 @@ void LstmNetwork::print_weights() {
       Id_t in_id = _incoming_conns[out_id][i];
 
       cout << " " << in_id << " -> " << out_id << ": "
-           << _weights[out_id][in_id] << endl;
+           << _weights[_conn_offsets[out_id] + i] << endl;
     }
   }
 }
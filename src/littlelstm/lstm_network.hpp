@@ -26,23 +26,63 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
 #include <unordered_set>
 #include <map>
+#include <stdexcept>
 
 #include "lstm_types.hpp"
 #include "lstm_gated_connection.hpp"
 #include "lstm_architecture.hpp"
 #include "lstm_unit_properties.hpp"
+#include "lstm_activation_function.hpp"
 #include "network_exporter.hpp"
 #include "network_importer.hpp"
 #include "rand_gen.hpp"
+#include "lstm_optimizer.hpp"
+#include "lstm_profile.hpp"
+#include "step_worker_pool.hpp"
+#include "feed_forward_network.hpp"
 
 namespace littlelstm {
 
 class LstmArchitecture;
 
-class LstmNetwork {
+// Loops of a step over fewer connections than this stay on the calling
+// thread, since handing them to the step workers would cost more than the
+// work itself.
+static const size_t PARALLEL_STEP_MIN_WORK = 2048;
+
+/**
+ * The parts of a network's state that change during training and are needed
+ * to continue training exactly where it left off: the weights, the optimizer
+ * state, the unit states and activations, and the eligibility traces and
+ * gains that the next step builds on. The error responsibilities and
+ * gradients are not included since every step recalculates them.
+ *
+ * The per-connection vectors are in connection order. The gated vectors have
+ * an entry for each gater and each unit it gates, in order of the gater's ID
+ * and then the gated unit's ID, and extended_traces has one for each of the
+ * gater's incoming connections within that.
+ */
+struct LstmNetworkState {
+  ConnectionWeights_t weights;
+  std::vector<double> weight_changes;
+  std::vector<double> second_moments;
+  size_t optimizer_step_count = 0;
+  std::vector<double> states;
+  std::vector<double> old_states;
+  std::vector<double> activations;
+  std::vector<double> traces;
+  std::vector<double> conn_gains;
+  std::vector<double> self_conn_gains;
+  std::vector<double> right_term_sums;
+  std::vector<double> extended_traces;
+};
+
+class LstmNetwork : public FeedForwardNetwork {
 public:
   explicit LstmNetwork( LstmArchitecture& arch, bool training = true );
   explicit LstmNetwork( NetworkImporter& importer, bool training = false );
@@ -58,14 +98,40 @@ public:
                       const double learning_rate,
                       const double momentum );
 
-  std::vector<double> get_output() { return _output; }
-  std::size_t get_output_size() { return _output.size(); }
-  std::size_t get_input_size() { return _input.size(); }
+  const std::vector<double>& get_output() const { return _output; }
+  std::size_t get_output_size() const { return _output.size(); }
+  std::size_t get_input_size() const { return _input.size(); }
 
   std::map<Id_t, double> get_cell_states();
 
-  WeightsMap_t get_weights_map() const;
   std::vector< std::pair<Id_t, Id_t> > get_connections() const;
+  const ConnectionWeights_t& get_connection_weights() const
+  { return _weights; }
+  void set_connection_weights( const ConnectionWeights_t& weights );
+
+  void set_optimizer( const LstmOptimizerConfig& config );
+  const LstmOptimizerConfig& get_optimizer() const { return _optimizer; }
+
+  void set_act_impl( lstm_act_impl_t impl );
+  lstm_act_impl_t get_act_impl() const { return _act_impl; }
+
+  void set_step_order( lstm_step_order_t order );
+  lstm_step_order_t get_step_order() const { return _step_order; }
+
+  void set_step_thread_count( size_t thread_count );
+  size_t get_step_thread_count() const { return _step_thread_count; }
+  const std::vector< std::vector<Id_t> >& get_levels() const
+  { return _levels; }
+  void set_levels( const std::vector< std::vector<Id_t> >& levels );
+
+  void set_profiling( bool profiling );
+  const LstmProfile& get_profile() const { return _profile; }
+  void reset_profile();
+
+  void get_state( LstmNetworkState& state ) const;
+  void set_state( const LstmNetworkState& state );
+
+  WeightsMap_t get_weights_map() const;
   void set_weights( const WeightsMap_t& weights_map );
 
   void zero_network();
@@ -74,8 +140,16 @@ public:
 
 private:
   void calculate_activations();
+  double calculate_activation( Id_t id );
   void calculate_extended_eligibility_traces();
+  void calculate_extended_eligibility_traces( Id_t j );
   void calculate_error_responsibilities();
+  void calculate_gradients();
+  void calculate_gradients( Id_t id );
+  void calculate_levels();
+  std::vector< std::pair<Id_t, Id_t> > get_gated_pairs() const;
+  void run_step_loop( size_t count, size_t work,
+                      const StepWorkerPool::RangeFunction& function );
   void update_weights( const double learning_rate, const double momentum );
   double uniform_random_weight( double min = -1.0, double max = 1.0 );
   double normal_random_weight( double mean = 0.0, double stddev = 0.1 );  
@@ -103,6 +177,13 @@ private:
   std::vector<double (*)(double)> _act_func_derivatives;
 
   std::vector< std::vector<Id_t> > _incoming_conns;
+
+  // Connections are numbered in the order of get_connections(). The incoming
+  // connections of unit id are numbered from _conn_offsets[id], and
+  // _conn_indexes[out_id][in_id] is the number of the connection from in_id
+  // to out_id, or NO_CONNECTION.
+  std::vector<Index_t> _conn_offsets;
+  std::vector< std::vector<Index_t> > _conn_indexes;
   std::vector< std::vector<double> > _conn_gains;
 
   std::vector<bool> _self_conn;
@@ -126,8 +207,36 @@ private:
 
   std::vector<double> _error_resps;
 
-  std::vector< std::vector<double> > _weights;
-  std::vector< std::vector<double> > _old_weight_changes;
+  // indexed by connection number
+  ConnectionWeights_t _weights;
+  std::vector<double> _gradients;
+  std::vector<double> _old_weight_changes;
+
+  // Also indexed by connection number, but only used by the optimizers that
+  // need them. _old_weight_changes doubles as Adam's first moments.
+  LstmOptimizerConfig _optimizer;
+  std::vector<double> _second_moments;
+  size_t _optimizer_step_count;
+
+  lstm_act_impl_t _act_impl = EXACT_ACT_FUNCS;
+
+  // The gaters in order of ID, and the number of extended traces they
+  // update, for splitting the extended traces between the step workers
+  std::vector<Id_t> _gater_ids;
+  size_t _ext_trace_work = 0;
+
+  // Empty when the units are calculated in order of ID. Otherwise the units
+  // of each level and the number of connections into them (see
+  // set_step_order()).
+  lstm_step_order_t _step_order = UNIT_STEP_ORDER;
+  size_t _step_thread_count = 1;
+  std::vector< std::vector<Id_t> > _levels;
+  std::vector<size_t> _level_work;
+  std::vector<double> _level_activations;
+  StepWorkerPool _step_pool;
+
+  bool _profiling = false;
+  LstmProfile _profile;
 
   std::vector<LstmUnitProperties> _units_properties;
 
@@ -0,0 +1,84 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+
+namespace littlelstm {
+
+enum lstm_optimizer_t {
+  MOMENTUM_OPTIMIZER,
+  RMSPROP_OPTIMIZER,
+  ADAM_OPTIMIZER,
+  NO_OPTIMIZER
+};
+
+static const double OPTIMIZER_EPSILON = 1e-8;
+
+/**
+ * How an LstmNetwork turns the gradient it calculates while backpropagating
+ * into weight changes.
+ *
+ * MOMENTUM_OPTIMIZER adds the previous weight change scaled by the momentum
+ * to the gradient scaled by the learning rate, except for the connections
+ * into the output units, which change by their raw gradient unless
+ * scale_output_updates is set. RMSPROP_OPTIMIZER divides the gradient of each
+ * connection by the root of a decaying average of its squares, and
+ * ADAM_OPTIMIZER does the same with a decaying average of the gradient
+ * itself, using the momentum as its decay rate. second_moment_decay is the
+ * decay rate of the average of the squares.
+ */
+struct LstmOptimizerConfig {
+  LstmOptimizerConfig( lstm_optimizer_t type = MOMENTUM_OPTIMIZER,
+                       double second_moment_decay = 0.999,
+                       bool scale_output_updates = false )
+    : type( type ), second_moment_decay( second_moment_decay ),
+      scale_output_updates( scale_output_updates ) {}
+
+  lstm_optimizer_t type;
+  double second_moment_decay;
+  bool scale_output_updates;
+};
+
+inline std::string optimizer_type_to_string( lstm_optimizer_t type ) {
+  switch( type ) {
+  case MOMENTUM_OPTIMIZER:
+    return "momentum";
+  case RMSPROP_OPTIMIZER:
+    return "rmsprop";
+  case ADAM_OPTIMIZER:
+    return "adam";
+  default:
+    return "";
+  }
+}
+
+inline lstm_optimizer_t string_to_optimizer_type( const std::string& str ) {
+  if( str == "momentum" )
+    return MOMENTUM_OPTIMIZER;
+  else if( str == "rmsprop" )
+    return RMSPROP_OPTIMIZER;
+  else if( str == "adam" )
+    return ADAM_OPTIMIZER;
+  else
+    return NO_OPTIMIZER;
+}
+
+}
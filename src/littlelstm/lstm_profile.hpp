@@ -0,0 +1,99 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace littlelstm {
+
+/**
+ * Nanoseconds from the steady clock, for timing phases of a computation.
+ */
+inline uint64_t profile_nanoseconds() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>( now ).count();
+}
+
+/**
+ * Cumulative time spent in one phase of a computation and how many times the
+ * phase ran.
+ */
+struct PhaseCounter {
+  uint64_t call_count = 0;
+  uint64_t nanoseconds = 0;
+
+  void record( uint64_t elapsed_nanoseconds ) {
+    ++call_count;
+    nanoseconds += elapsed_nanoseconds;
+  }
+
+  void add( const PhaseCounter& other ) {
+    call_count += other.call_count;
+    nanoseconds += other.nanoseconds;
+  }
+
+  double get_seconds() const { return nanoseconds / 1e9; }
+};
+
+/**
+ * Records the time until the end of its scope in a counter. A null counter
+ * records nothing and does not read the clock, so profiling that is turned
+ * off costs one branch.
+ */
+class PhaseTimer {
+public:
+  explicit PhaseTimer( PhaseCounter* counter )
+    : _counter( counter ), _begin( counter ? profile_nanoseconds() : 0 ) {}
+
+  ~PhaseTimer() {
+    if( _counter )
+      _counter->record( profile_nanoseconds() - _begin );
+  }
+
+  PhaseTimer( const PhaseTimer& ) = delete;
+  PhaseTimer& operator=( const PhaseTimer& ) = delete;
+
+private:
+  PhaseCounter* _counter;
+  uint64_t _begin;
+};
+
+/**
+ * Where an LstmNetwork spends its time, kept while profiling is turned on
+ * with LstmNetwork::set_profiling(). connection_update_count counts every
+ * weight updated by backpropagation.
+ */
+struct LstmProfile {
+  PhaseCounter activations;
+  PhaseCounter eligibility_traces;
+  PhaseCounter error_responsibilities;
+  PhaseCounter weight_updates;
+  uint64_t connection_update_count = 0;
+
+  void add( const LstmProfile& other ) {
+    activations.add( other.activations );
+    eligibility_traces.add( other.eligibility_traces );
+    error_responsibilities.add( other.error_responsibilities );
+    weight_updates.add( other.weight_updates );
+    connection_update_count += other.connection_update_count;
+  }
+};
+
+}
@@ -23,6 +23,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #include <utility>
 #include <string>
 #include <map>
+#include <vector>
 
 typedef double Real_t;
 typedef size_t Index_t;
@@ -135,11 +136,81 @@ enum lstm_layer_t {
   OUTPUT,
   NONE
 };
+
+/**
+ * The kind of memory block a hidden layer is built from. An LSTM block has
+ * input, forget and output gates and a cell. A forget gate block only has the
+ * forget gate, which gates the cell's self connection, and its cell's inputs
+ * and output are not gated.
+ */
+enum lstm_block_t {
+  LSTM_BLOCK,
+  FORGET_GATE_BLOCK,
+  NO_BLOCK_TYPE
+};
+
+inline std::string block_type_to_string( lstm_block_t type ) {
+  switch( type ) {
+  case LSTM_BLOCK:
+    return "lstm";
+  case FORGET_GATE_BLOCK:
+    return "forget_gate";
+  default:
+    return "";
+  }
+}
+
+inline lstm_block_t string_to_block_type( const std::string& str ) {
+  if( str == "lstm" )
+    return LSTM_BLOCK;
+  else if( str == "forget_gate" )
+    return FORGET_GATE_BLOCK;
+  else
+    return NO_BLOCK_TYPE;
+}
+
+/**
+ * The order a network calculates its units in on each step (see
+ * LstmNetwork::set_step_order()).
+ */
+enum lstm_step_order_t {
+  UNIT_STEP_ORDER,
+  LEVEL_STEP_ORDER,
+  NO_STEP_ORDER
+};
+
+inline std::string step_order_to_string( lstm_step_order_t order ) {
+  switch( order ) {
+  case UNIT_STEP_ORDER:
+    return "unit";
+  case LEVEL_STEP_ORDER:
+    return "level";
+  default:
+    return "";
+  }
+}
+
+inline lstm_step_order_t string_to_step_order( const std::string& str ) {
+  if( str == "unit" )
+    return UNIT_STEP_ORDER;
+  else if( str == "level" )
+    return LEVEL_STEP_ORDER;
+  else
+    return NO_STEP_ORDER;
+}
   
 #define NO_UNIT std::numeric_limits<size_t>::max()
+#define NO_CONNECTION std::numeric_limits<size_t>::max()
 
 typedef Real_t (*act_func_ptr_t)(Real_t);
 typedef std::pair<Id_t, Id_t> Conn_t;
+
+// One weight per connection, in the order of LstmNetwork::get_connections().
+// This is how networks store their weights, so copying one is a memcpy.
+typedef std::vector<Real_t> ConnectionWeights_t;
+
+// Weights keyed by output unit and then input unit. Only used to convert
+// to and from older code; prefer ConnectionWeights_t.
 typedef std::map< Id_t, std::map<Id_t, Real_t> > WeightsMap_t;
 
 #define INPUT_LAYER_ID 0
@@ -0,0 +1,56 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "lstm_types.hpp"
+#include "lstm_unit_properties.hpp"
+#include "network_exporter.hpp"
+
+namespace littlelstm {
+
+/**
+ * Keeps everything a network exports, for building other forms of the
+ * network from it.
+ */
+class NetworkCapture : public NetworkExporter {
+public:
+  void set_input_count( size_t count ) { input_count = count; }
+  void set_output_count( size_t count ) { output_count = count; }
+  void set_unit_count( size_t count ) { unit_count = count; }
+  void set_connections( const std::vector< std::pair<Id_t, Id_t> >& conns )
+  { connections = conns; }
+  void set_units_properties( const std::vector<LstmUnitProperties>&
+                             properties )
+  { units_properties = properties; }
+  void set_connection_weights( const ConnectionWeights_t& conn_weights )
+  { weights = conn_weights; }
+
+  size_t input_count = 0;
+  size_t output_count = 0;
+  size_t unit_count = 0;
+  std::vector< std::pair<Id_t, Id_t> > connections;
+  std::vector<LstmUnitProperties> units_properties;
+  ConnectionWeights_t weights;
+};
+
+}
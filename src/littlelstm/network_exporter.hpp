@@ -40,7 +40,12 @@ public:
                                 connections ) =0;
   virtual void set_units_properties( const std::vector<LstmUnitProperties>&
                                      units_properties ) =0;
-  virtual void set_weights( const WeightsMap_t& weights ) =0;
+
+  /**
+   * Set the weights in the same order as the connections passed to
+   * set_connections(), which must be called first.
+   */
+  virtual void set_connection_weights( const ConnectionWeights_t& weights ) =0;
 };
 
 }
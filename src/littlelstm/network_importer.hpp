@@ -36,6 +36,25 @@ public:
   virtual std::vector< std::pair<Id_t, Id_t> > get_connections() =0;
   virtual const std::vector<LstmUnitProperties> get_units_properties() =0;
   virtual WeightsMap_t get_weights() =0;
+
+  /**
+   * Get the weights in the same order as get_connections(). This is what
+   * LstmNetwork uses, so importers that store weights this way should
+   * override this to avoid building a WeightsMap_t.
+   */
+  virtual ConnectionWeights_t get_connection_weights() {
+    std::vector< std::pair<Id_t, Id_t> > connections = get_connections();
+    WeightsMap_t weights_map = get_weights();
+
+    ConnectionWeights_t weights;
+    weights.reserve( connections.size() );
+
+    for( auto& connection : connections )
+      weights.push_back( weights_map.at( connection.second )
+                                    .at( connection.first ) );
+
+    return weights;
+  }
 };
 
 }
@@ -0,0 +1,135 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <map>
+#include <set>
+#include <algorithm>
+
+#include "network_pruner.hpp"
+#include "network_capture.hpp"
+
+using namespace std;
+using namespace littlelstm;
+
+LstmNetwork NetworkPruner::prune( const LstmNetwork& net, double sparsity,
+                                  const vector<Index_t>& unit_layers,
+                                  bool training ) {
+  if( sparsity < 0.0 || sparsity >= 1.0 )
+    throw NetworkPrunerException( "sparsity must be at least 0 and less "
+                                  "than 1" );
+
+  NetworkCapture capture;
+  net.export_network( capture );
+
+  if( !unit_layers.empty() && unit_layers.size() != capture.unit_count )
+    throw NetworkPrunerException( "the layers are for a network with a "
+                                  "different number of units" );
+
+  map< Index_t, vector<Index_t> > layer_conns;
+
+  for( Index_t i = 0; i < capture.connections.size(); ++i ) {
+    Id_t out_id = capture.connections[i].second;
+    layer_conns[unit_layers.empty() ? 0 : unit_layers[out_id]].push_back( i );
+  }
+
+  vector<bool> pruned( capture.connections.size(), false );
+
+  for( auto& kv : layer_conns ) {
+    vector<Index_t>& conns = kv.second;
+
+    stable_sort( conns.begin(), conns.end(), [&]( Index_t a, Index_t b ) {
+        return fabs( capture.weights[a] ) < fabs( capture.weights[b] );
+      } );
+
+    size_t prune_count = (size_t)( sparsity * conns.size() );
+
+    for( size_t i = 0; i < prune_count; ++i )
+      pruned[conns[i]] = true;
+  }
+
+  vector< pair<Id_t, Id_t> > connections;
+  ConnectionWeights_t weights;
+  set< pair<Id_t, Id_t> > pruned_conns;
+
+  // the remaining connections keep their order, so each unit's incoming
+  // connections are still together
+  for( Index_t i = 0; i < capture.connections.size(); ++i ) {
+    if( pruned[i] ) {
+      pruned_conns.insert( capture.connections[i] );
+    }
+    else {
+      connections.push_back( capture.connections[i] );
+      weights.push_back( capture.weights[i] );
+    }
+  }
+
+  vector<LstmUnitProperties> units_properties;
+
+  for( auto& properties : capture.units_properties ) {
+    vector<LstmGatedConn> gated_conns;
+
+    for( auto& conn : properties.get_gated_conns() ) {
+      if( pruned_conns.count( make_pair( conn.in_id, conn.out_id ) ) == 0 )
+        gated_conns.push_back( conn );
+    }
+
+    units_properties.emplace_back( properties.get_id(), properties.get_type(),
+                                   properties.get_act_func_type(),
+                                   properties.get_self_conn_gater(),
+                                   gated_conns );
+  }
+
+  LstmNetwork pruned_net( capture.input_count, capture.output_count,
+                          capture.unit_count, connections, units_properties,
+                          training );
+  pruned_net.set_connection_weights( weights );
+
+  pruned_net.set_act_impl( net.get_act_impl() );
+
+  // the pruned network is calculated in the same levels as the network it was
+  // pruned from, even where removed connections would change them
+  if( net.get_step_order() == LEVEL_STEP_ORDER )
+    pruned_net.set_levels( net.get_levels() );
+
+  pruned_net.set_step_thread_count( net.get_step_thread_count() );
+
+  return pruned_net;
+}
+
+/**
+ * The layer of each unit in a network built from arch: the index of its
+ * hidden layer, or the hidden layer count for the output layer and for the
+ * inputs and bias.
+ */
+vector<Index_t> NetworkPruner::get_unit_layers( const LstmArchitecture&
+                                                arch ) {
+  size_t layer_count = arch.get_hidden_layer_count();
+
+  vector<Index_t> unit_layers( arch.get_unit_count(), layer_count );
+
+  for( Index_t h = 0; h < layer_count; ++h ) {
+    for( Index_t b = 0; b < arch.get_block_count( h ); ++b ) {
+      for( Id_t id : arch.get_block_ids( h, b ) )
+        unit_layers[id] = h;
+    }
+  }
+
+  return unit_layers;
+}
@@ -0,0 +1,63 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+
+#include "lstm_types.hpp"
+#include "lstm_network.hpp"
+#include "lstm_architecture.hpp"
+
+namespace littlelstm {
+
+class NetworkPrunerException : public std::runtime_error {
+public:
+  explicit NetworkPrunerException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * Removes the connections with the smallest weight magnitudes from a trained
+ * network. The pruned network only has the remaining connections, so each
+ * step of it, and of a network compiled or quantized from it, does less work
+ * instead of multiplying by zeros.
+ *
+ * The sparsity is the fraction of the connections to remove. They are
+ * ranked across the whole network, or within each layer if unit_layers is
+ * given, in which case a connection belongs to the layer of the unit it
+ * connects to (see get_unit_layers()). Pruning each layer separately keeps a
+ * layer with small weights from losing most of its connections.
+ *
+ * Self-connections have no weight and are never pruned. The pruned network
+ * keeps the activation functions, step order and levels of the original.
+ */
+class NetworkPruner {
+public:
+  static LstmNetwork prune( const LstmNetwork& net, double sparsity,
+                            const std::vector<Index_t>& unit_layers =
+                            std::vector<Index_t>(),
+                            bool training = false );
+
+  static std::vector<Index_t> get_unit_layers( const LstmArchitecture&
+                                               arch );
+};
+
+}
@@ -0,0 +1,364 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <cassert>
+#include <limits>
+#include <algorithm>
+
+#include "quantized_network.hpp"
+#include "network_capture.hpp"
+
+using namespace std;
+using namespace littlelstm;
+
+static const uint32_t NO_GATER = numeric_limits<uint32_t>::max();
+
+static int32_t saturate( int64_t value ) {
+  if( value > numeric_limits<int32_t>::max() )
+    return numeric_limits<int32_t>::max();
+  if( value < numeric_limits<int32_t>::min() )
+    return numeric_limits<int32_t>::min();
+
+  return (int32_t)value;
+}
+
+static int64_t rounding_shift( int64_t value, int shift ) {
+  if( shift == 0 )
+    return value;
+
+  return ( value + ( int64_t( 1 ) << ( shift - 1 ) ) ) >> shift;
+}
+
+void QuantizationCalibration::record( const vector<double>& input,
+                                      const map<Id_t, double>& cell_states ) {
+  if( max_abs_inputs.size() < input.size() )
+    max_abs_inputs.resize( input.size(), 0.0 );
+
+  for( size_t i = 0; i < input.size(); ++i )
+    max_abs_inputs[i] = max( max_abs_inputs[i], fabs( input[i] ) );
+
+  for( auto& kv : cell_states )
+    max_abs_states[kv.first] = max( max_abs_states[kv.first],
+                                    fabs( kv.second ) );
+
+  ++update_count;
+}
+
+QuantizedNetwork::QuantizedNetwork( const LstmNetwork& net,
+                                    const QuantizationCalibration&
+                                    calibration,
+                                    size_t weight_bits )
+  : _weight_bits( weight_bits )
+  , _levels( net.get_levels() )
+{
+  if( weight_bits != 8 && weight_bits != 16 )
+    throw QuantizedNetworkException( "weights can only be quantized to 8 or "
+                                     "16 bits" );
+
+  NetworkCapture capture;
+  net.export_network( capture );
+
+  _unit_count = capture.unit_count;
+  _input_count = capture.input_count;
+  _bias_id = _input_count;
+
+  if( _unit_count >= NO_GATER || capture.weights.size() >= NO_GATER )
+    throw QuantizedNetworkException( "the network is too large" );
+
+  if( calibration.max_abs_inputs.size() != _input_count )
+    throw QuantizedNetworkException( "the calibration is for a network with a "
+                                     "different number of inputs" );
+
+  // every input is scaled so that its calibrated range is 1.0, and the
+  // weights from it are scaled up to match
+  vector<double> in_ranges( _unit_count, 1.0 );
+
+  for( Id_t id = 0; id < _input_count; ++id ) {
+    if( calibration.max_abs_inputs[id] > 0.0 )
+      in_ranges[id] = calibration.max_abs_inputs[id];
+
+    _input_scales.push_back( ( 1 << QUANTIZED_ACTIVATION_BITS ) /
+                             in_ranges[id] );
+  }
+
+  _act_func_types.assign( _unit_count, IDENTITY );
+  _self_conn_gaters.assign( _unit_count, NO_GATER );
+
+  map< pair<Id_t, Id_t>, Id_t > gaters;
+
+  for( auto& unit_properties : capture.units_properties ) {
+    Id_t id = unit_properties.get_id();
+
+    _act_func_types[id] = unit_properties.get_act_func_type();
+
+    if( unit_properties.get_self_conn() )
+      _self_conn_gaters[id] = unit_properties.get_self_conn_gater();
+
+    for( auto& conn : unit_properties.get_gated_conns() )
+      gaters[make_pair( conn.out_id, conn.in_id )] = conn.gater_id;
+  }
+
+  vector< vector<Index_t> > incoming_conns( _unit_count );
+
+  for( Index_t i = 0; i < capture.connections.size(); ++i )
+    incoming_conns[capture.connections[i].second].push_back( i );
+
+  const double max_quantized_weight = ( 1 << ( weight_bits - 1 ) ) - 1;
+
+  _run_offsets.assign( _unit_count + 1, 0 );
+  _multipliers.assign( _unit_count, 0 );
+  _shifts.assign( _unit_count, 0 );
+  _state_bits.assign( _unit_count, QUANTIZED_STATE_BITS );
+
+  uint32_t weight_count = 0;
+
+  for( Id_t id = 0; id < _unit_count; ++id ) {
+    _run_offsets[id] = _runs.size();
+
+    double max_abs_weight = 0.0;
+
+    for( Index_t i : incoming_conns[id] ) {
+      Id_t in_id = capture.connections[i].first;
+      max_abs_weight = max( max_abs_weight,
+                            fabs( capture.weights[i] * in_ranges[in_id] ) );
+    }
+
+    for( Index_t i : incoming_conns[id] ) {
+      Id_t in_id = capture.connections[i].first;
+
+      long weight = 0;
+
+      if( max_abs_weight > 0.0 )
+        weight = lround( capture.weights[i] * in_ranges[in_id] /
+                         max_abs_weight * max_quantized_weight );
+
+      if( weight_bits == 8 )
+        _weights_8.push_back( (int8_t)weight );
+      else
+        _weights_16.push_back( (int16_t)weight );
+
+      auto gater = gaters.find( make_pair( id, in_id ) );
+      uint32_t gater_id = gater == gaters.end() ? NO_GATER
+                                                : (uint32_t)gater->second;
+
+      bool extended = false;
+
+      if( _runs.size() > _run_offsets[id] ) {
+        QuantizedRun& run = _runs.back();
+
+        if( run.gater_id == gater_id ) {
+          if( run.length == 1 && in_id > run.first_in_id ) {
+            run.stride = in_id - run.first_in_id;
+            ++run.length;
+            extended = true;
+          }
+          else if( run.length > 1 &&
+                   run.first_in_id + run.length * run.stride == in_id ) {
+            ++run.length;
+            extended = true;
+          }
+        }
+      }
+
+      if( !extended )
+        _runs.push_back( { weight_count, 1, (uint32_t)in_id, 1, gater_id } );
+
+      ++weight_count;
+    }
+
+    // self-connected states get as much precision as their range allows,
+    // leaving room for twice the calibrated range
+    if( _self_conn_gaters[id] != NO_GATER ) {
+      _state_bits[id] = QUANTIZED_MAX_STATE_BITS;
+
+      auto max_state = calibration.max_abs_states.find( id );
+
+      if( max_state != calibration.max_abs_states.end() &&
+          max_state->second > 0.0 ) {
+        int bits = (int)floor( log2( ( 1 << 30 ) / max_state->second ) );
+        _state_bits[id] = min( max( bits, QUANTIZED_MIN_STATE_BITS ),
+                               QUANTIZED_MAX_STATE_BITS );
+      }
+    }
+
+    // a sum of quantized weights times activations is converted to a state
+    // by multiplying by _multipliers[id] / 2^_shifts[id]
+    double ratio = max_abs_weight / max_quantized_weight *
+      pow( 2.0, _state_bits[id] - QUANTIZED_ACTIVATION_BITS );
+
+    if( ratio > 0.0 ) {
+      int exponent;
+      double mantissa = frexp( ratio, &exponent );
+
+      _multipliers[id] = llround( mantissa * ( 1 << 15 ) );
+      _shifts[id] = 15 - exponent;
+
+      if( _shifts[id] < 0 ) {
+        _multipliers[id] <<= -_shifts[id];
+        _shifts[id] = 0;
+      }
+      else if( _shifts[id] > 62 ) {
+        _multipliers[id] = 0;
+        _shifts[id] = 0;
+      }
+    }
+  }
+
+  _run_offsets[_unit_count] = _runs.size();
+
+  size_t table_size = 2 * QUANTIZED_LOGISTIC_RANGE * QUANTIZED_LOGISTIC_STEPS;
+
+  for( size_t i = 0; i <= table_size; ++i ) {
+    double x = -QUANTIZED_LOGISTIC_RANGE +
+      (double)i / QUANTIZED_LOGISTIC_STEPS;
+    _logistic_table.push_back( (int32_t)lround( logistic( x ) *
+                                                ( 1 << QUANTIZED_ACTIVATION_BITS
+                                                  ) ) );
+  }
+
+  _states.assign( _unit_count, 0 );
+  _activations.assign( _unit_count, 0 );
+  _level_activations.assign( _unit_count, 0 );
+  _output.assign( capture.output_count, 0.0 );
+
+  zero_network();
+}
+
+/**
+ * The memory read by every step: the weights and the runs describing them.
+ */
+size_t QuantizedNetwork::get_weight_bytes() const {
+  return _weights_8.size() + _weights_16.size() * sizeof( int16_t ) +
+    _runs.size() * sizeof( QuantizedRun );
+}
+
+void QuantizedNetwork::zero_network() {
+  fill( _states.begin(), _states.end(), 0 );
+  fill( _activations.begin(), _activations.end(), 0 );
+
+  _activations[_bias_id] = 1 << QUANTIZED_ACTIVATION_BITS;
+}
+
+void QuantizedNetwork::feed_forward( const vector<double>& input ) {
+  assert( input.size() == _input_count );
+
+  // inputs far outside of their calibrated range are clamped so that the
+  // sums cannot overflow
+  const double max_input = 1 << ( QUANTIZED_ACTIVATION_BITS + 2 );
+
+  for( Id_t id = 0; id < _input_count; ++id ) {
+    double scaled = input[id] * _input_scales[id];
+    scaled = min( max( scaled, -max_input ), max_input );
+    _activations[id] = (int32_t)lround( scaled );
+  }
+
+  if( _weight_bits == 8 )
+    calculate_activations( _weights_8.data() );
+  else
+    calculate_activations( _weights_16.data() );
+
+  Id_t first_output_id = _unit_count - _output.size();
+
+  for( size_t i = 0; i < _output.size(); ++i )
+    _output[i] = _activations[first_output_id + i] /
+      (double)( 1 << QUANTIZED_ACTIVATION_BITS );
+}
+
+template <typename Weight_t>
+void QuantizedNetwork::calculate_activations( const Weight_t* weights ) {
+  if( _levels.empty() ) {
+    for( Id_t id = _bias_id + 1; id < _unit_count; ++id )
+      _activations[id] = calculate_activation( id, weights );
+
+    return;
+  }
+
+  for( auto& level : _levels ) {
+    for( Id_t id : level )
+      _level_activations[id] = calculate_activation( id, weights );
+
+    for( Id_t id : level )
+      _activations[id] = _level_activations[id];
+  }
+}
+
+template <typename Weight_t>
+int32_t QuantizedNetwork::calculate_activation( Id_t id,
+                                                const Weight_t* weights ) {
+  int64_t sum = 0;
+
+  for( uint32_t r = _run_offsets[id]; r < _run_offsets[id + 1]; ++r ) {
+    const QuantizedRun& run = _runs[r];
+    const Weight_t* run_weights = weights + run.first_weight;
+    const int32_t* activations = _activations.data() + run.first_in_id;
+
+    int64_t run_sum = 0;
+
+    for( uint32_t i = 0; i < run.length; ++i )
+      run_sum += (int64_t)run_weights[i] * activations[i * run.stride];
+
+    if( run.gater_id != NO_GATER )
+      run_sum = ( run_sum * _activations[run.gater_id] ) >>
+        QUANTIZED_ACTIVATION_BITS;
+
+    sum += run_sum;
+  }
+
+  int64_t state = rounding_shift( sum * _multipliers[id], _shifts[id] );
+
+  if( _self_conn_gaters[id] != NO_GATER )
+    state += ( (int64_t)_states[id] * _activations[_self_conn_gaters[id]] ) >>
+      QUANTIZED_ACTIVATION_BITS;
+
+  _states[id] = saturate( state );
+
+  return activate( id, _states[id] );
+}
+
+/**
+ * Apply a unit's activation function to its fixed point state.
+ */
+int32_t QuantizedNetwork::activate( Id_t id, int32_t state ) const {
+  int bits = _state_bits[id];
+
+  if( _act_func_types[id] != LOGISTIC &&
+      _act_func_types[id] != LOGISTIC_CENTERED )
+    return saturate( rounding_shift( state, bits -
+                                     QUANTIZED_ACTIVATION_BITS ) );
+
+  // position in the table, with bits fractional bits
+  int64_t position = (int64_t)state * QUANTIZED_LOGISTIC_STEPS +
+    ( (int64_t)QUANTIZED_LOGISTIC_RANGE * QUANTIZED_LOGISTIC_STEPS << bits );
+  int64_t end = (int64_t)( _logistic_table.size() - 1 ) << bits;
+
+  position = min( max( position, (int64_t)0 ), end - 1 );
+
+  size_t i = position >> bits;
+  int64_t fraction = position & ( ( (int64_t)1 << bits ) - 1 );
+
+  int32_t activation = _logistic_table[i] +
+    (int32_t)( ( ( _logistic_table[i + 1] - _logistic_table[i] ) *
+                 fraction ) >> bits );
+
+  if( _act_func_types[id] == LOGISTIC_CENTERED )
+    return activation * 2 - ( 1 << QUANTIZED_ACTIVATION_BITS );
+
+  return activation;
+}
@@ -0,0 +1,146 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <stdexcept>
+
+#include "lstm_types.hpp"
+#include "lstm_network.hpp"
+#include "feed_forward_network.hpp"
+
+namespace littlelstm {
+
+// Activations are fixed point numbers with this many fractional bits, so
+// 1 << 15 is an activation of 1.0.
+static const int QUANTIZED_ACTIVATION_BITS = 15;
+
+// The logistic function is interpolated from a table sampled this many times
+// per unit between -QUANTIZED_LOGISTIC_RANGE and QUANTIZED_LOGISTIC_RANGE.
+static const int QUANTIZED_LOGISTIC_STEPS = 32;
+static const int QUANTIZED_LOGISTIC_RANGE = 16;
+
+// The fractional bits of the states of units without a self-connection. Their
+// states only feed their activation function, which is flat long before the
+// 2048 where they saturate. Self-connected states get as many fractional bits
+// as their calibrated range allows, between the min and max.
+static const int QUANTIZED_STATE_BITS = 20;
+static const int QUANTIZED_MIN_STATE_BITS = 15;
+static const int QUANTIZED_MAX_STATE_BITS = 24;
+
+class QuantizedNetworkException : public std::runtime_error {
+public:
+  explicit QuantizedNetworkException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * The ranges of a network's inputs and of the states of its self-connected
+ * units, recorded while the network runs on representative input.
+ */
+struct QuantizationCalibration {
+  std::vector<double> max_abs_inputs;
+  std::map<Id_t, double> max_abs_states;
+  size_t update_count = 0;
+
+  void record( const std::vector<double>& input,
+               const std::map<Id_t, double>& cell_states );
+};
+
+/**
+ * A trained network that performs with integer arithmetic only. The weights
+ * are stored in 8 or 16 bits, scaled separately for the connections into each
+ * unit, activations are 32 bit fixed point numbers with
+ * QUANTIZED_ACTIVATION_BITS fractional bits, and the logistic function is
+ * interpolated from a table. Inputs are scaled by their calibrated ranges as
+ * they are converted from doubles, and outputs are converted back.
+ *
+ * The connections into a unit are stored as runs from evenly spaced units,
+ * like the cells of a layer, so no unit IDs are stored per connection.
+ *
+ * The units are calculated in the same order as the network it was made
+ * from (see LstmNetwork::get_levels()).
+ */
+class QuantizedNetwork : public FeedForwardNetwork {
+public:
+  QuantizedNetwork( const LstmNetwork& net,
+                    const QuantizationCalibration& calibration,
+                    size_t weight_bits );
+
+  void feed_forward( const std::vector<double>& input );
+  const std::vector<double>& get_output() const { return _output; }
+  std::size_t get_output_size() const { return _output.size(); }
+  std::size_t get_input_size() const { return _input_scales.size(); }
+
+  void zero_network();
+
+  size_t get_weight_bits() const { return _weight_bits; }
+  size_t get_weight_bytes() const;
+
+private:
+  // connections with consecutive weights and the same gater, from units
+  // that are stride apart
+  struct QuantizedRun {
+    uint32_t first_weight;
+    uint32_t length;
+    uint32_t first_in_id;
+    uint32_t stride;
+    uint32_t gater_id;
+  };
+
+  template <typename Weight_t>
+  void calculate_activations( const Weight_t* weights );
+  template <typename Weight_t>
+  int32_t calculate_activation( Id_t id, const Weight_t* weights );
+  int32_t activate( Id_t id, int32_t state ) const;
+
+  size_t _weight_bits;
+
+  std::size_t _unit_count;
+  std::size_t _input_count;
+  Id_t _bias_id;
+
+  std::vector<double> _input_scales;
+  std::vector<double> _output;
+
+  std::vector<int8_t> _weights_8;
+  std::vector<int16_t> _weights_16;
+  std::vector<QuantizedRun> _runs;
+
+  // indexed by unit ID
+  std::vector<uint32_t> _run_offsets;
+  std::vector<int64_t> _multipliers;
+  std::vector<int> _shifts;
+  std::vector<int> _state_bits;
+  std::vector<uint32_t> _self_conn_gaters;
+  std::vector<lstm_act_func_t> _act_func_types;
+
+  std::vector<int32_t> _states;
+  std::vector<int32_t> _activations;
+
+  std::vector< std::vector<Id_t> > _levels;
+  std::vector<int32_t> _level_activations;
+
+  std::vector<int32_t> _logistic_table;
+};
+
+}
@@ -16,63 +16,284 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 */
-
 #pragma once
 
 #include <random>
-#include <functional>
-#include <algorithm>
-#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <stdexcept>
 
 namespace littlelstm {
 
 enum random_type { UNIFORM, NORMAL };
 
-class RandGen {
+/**
+ * Advance a splitmix64 state and return the next value. Used to expand seeds,
+ * since nearby seeds give unrelated outputs.
+ */
+inline uint64_t splitmix64( uint64_t& state ) {
+  uint64_t z = ( state += 0x9e3779b97f4a7c15ULL );
+  z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+  z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+  return z ^ ( z >> 31 );
+}
+
+/**
+ * The xoshiro256** generator: 32 bytes of state, a few instructions per
+ * number, and good enough statistically for training. It can be used with the
+ * standard library distributions and algorithms such as std::shuffle.
+ */
+class Xoshiro256 {
 public:
-  RandGen() {
-    // we'll use a seed sequence whose length is the same as the size of the
-    // RNG engine
-    const auto seed_seq_length = std::mt19937::state_size;
+  typedef uint64_t result_type;
+
+  explicit Xoshiro256( uint64_t seed_value = 0 ) { seed( seed_value ); }
+
+  void seed( uint64_t seed_value ) {
+    for( auto& s : _s )
+      s = splitmix64( seed_value );
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return UINT64_MAX; }
+
+  result_type operator()() {
+    const uint64_t result = rotl( _s[1] * 5, 7 ) * 9;
+    const uint64_t t = _s[1] << 17;
+
+    _s[2] ^= _s[0];
+    _s[3] ^= _s[1];
+    _s[1] ^= _s[2];
+    _s[0] ^= _s[3];
+
+    _s[2] ^= t;
+    _s[3] = rotl( _s[3], 45 );
+
+    return result;
+  }
+
+  friend std::ostream& operator<<( std::ostream& out, const Xoshiro256& x ) {
+    return out << x._s[0] << " " << x._s[1] << " " << x._s[2] << " "
+               << x._s[3];
+  }
 
-    std::mt19937::result_type seed_data[seed_seq_length];
+  friend std::istream& operator>>( std::istream& in, Xoshiro256& x ) {
+    return in >> x._s[0] >> x._s[1] >> x._s[2] >> x._s[3];
+  }
+
+private:
+  static uint64_t rotl( const uint64_t x, int k ) {
+    return ( x << k ) | ( x >> ( 64 - k ) );
+  }
 
-    std::random_device source;
+  uint64_t _s[4];
+};
+
+/**
+ * Random numbers for the network, the trainer, the training stream and the
+ * configuration parser.
+ *
+ * Each RandGen is seeded from std::random_device, unless set_global_seed()
+ * has been called, in which case every RandGen created afterwards gets its
+ * own stream derived from the global seed and the order of creation. A
+ * program that creates its generators in the same order therefore gets the
+ * same random numbers on every run.
+ *
+ * Generators created on several threads at once are created in no
+ * particular order, so each thread's share of the work should be given its
+ * own stream with a StreamScope. The generators created on a thread while a
+ * StreamScope exists are derived from the global seed, the scope's stream and
+ * their order of creation within the scope only.
+ */
+class RandGen {
+  // the stream of the current thread's StreamScope, if it has one
+  struct ThreadSeed {
+    bool active;
+    uint64_t seed;
+    uint64_t created_count;
+  };
 
-    // fill the array with seed_seq_length integers from the random device
-    std::generate( std::begin( seed_data ), std::end( seed_data ),
-                   std::ref( source ) );
+public:
+  RandGen() : _rand_engine( next_seed() ), _has_spare_normal( false ) {}
+  explicit RandGen( uint64_t seed )
+    : _rand_engine( seed ), _has_spare_normal( false ) {}
 
-    std::seed_seq seeds( std::begin( seed_data ), std::end( seed_data ) );
+  /**
+   * Derive the seeds of all generators created from now on from seed and
+   * stream. Separate processes working on the same problem should use
+   * different streams. A seed of 0 goes back to seeding from
+   * std::random_device.
+   */
+  static void set_global_seed( uint64_t seed, uint64_t stream = 0 ) {
+    GlobalSeed& global = get_global_seed();
 
-    _rand_engine = std::mt19937( seeds );
+    uint64_t stream_state = stream;
+    global.seed = seed ^ splitmix64( stream_state );
+    global.created_count = 0;
+    global.seeded = ( seed != 0 );
   }
 
+  class StreamScope {
+  public:
+    explicit StreamScope( uint64_t stream ) {
+      ThreadSeed& thread_seed = get_thread_seed();
+      _previous = thread_seed;
+
+      uint64_t stream_state = stream;
+      thread_seed.seed = get_global_seed().seed ^ splitmix64( stream_state );
+      thread_seed.created_count = 0;
+      thread_seed.active = true;
+    }
+
+    ~StreamScope() { get_thread_seed() = _previous; }
+
+    StreamScope( const StreamScope& ) = delete;
+    StreamScope& operator=( const StreamScope& ) = delete;
+
+  private:
+    ThreadSeed _previous;
+  };
+
   template <typename T>
   T normal( T mean, T std ) {
-    std::normal_distribution<T> dist( mean, std );
-    return dist( _rand_engine );
+    return mean + std * standard_normal();
   }
 
+  /**
+   * A uniform real in [min, max).
+   */
   template <typename T>
   T uniform_real( T min, T max ) {
-    std::uniform_real_distribution<T> dist( min, max );
-    return dist( _rand_engine );
+    return min + ( max - min ) * unit();
   }
 
+  /**
+   * A uniform integer in [min, max].
+   */
   template <typename T>
   T uniform_int( T min, T max ) {
-    std::uniform_int_distribution<T> dist( min, max );
-    return dist( _rand_engine );
+    uint64_t range = (uint64_t)max - (uint64_t)min + 1;
+
+    if( range == 0 )
+      return (T)_rand_engine();
+
+    // reject the top of the range that would make smaller values more likely
+    uint64_t limit = UINT64_MAX - UINT64_MAX % range;
+    uint64_t value;
+
+    do {
+      value = _rand_engine();
+    } while( value >= limit );
+
+    return (T)( (uint64_t)min + value % range );
   }
 
-  std::mt19937* get_engine_ptr() {
+  Xoshiro256* get_engine_ptr() {
     return &_rand_engine;
   }
 
+  /**
+   * Get the generator state in a form that set_state() can restore, so that
+   * a resumed training run continues the same random sequence.
+   */
+  std::string get_state() const {
+    uint64_t spare_bits;
+    std::memcpy( &spare_bits, &_spare_normal, sizeof( spare_bits ) );
+
+    std::ostringstream oss;
+    oss << _rand_engine << " " << _has_spare_normal << " " << spare_bits;
+    return oss.str();
+  }
+
+  void set_state( const std::string& state ) {
+    std::istringstream iss( state );
+    uint64_t spare_bits;
+
+    iss >> _rand_engine >> _has_spare_normal >> spare_bits;
+
+    if( !iss )
+      throw std::runtime_error( "Invalid random number generator state" );
+
+    std::memcpy( &_spare_normal, &spare_bits, sizeof( spare_bits ) );
+  }
+
 private:
-  //std::random_device _rd;
-  std::mt19937 _rand_engine;
+  struct GlobalSeed {
+    std::atomic<bool> seeded;
+    std::atomic<uint64_t> seed;
+    std::atomic<uint64_t> created_count;
+  };
+
+  static GlobalSeed& get_global_seed() {
+    static GlobalSeed global = { { false }, { 0 }, { 0 } };
+    return global;
+  }
+
+  static ThreadSeed& get_thread_seed() {
+    static thread_local ThreadSeed thread_seed = { false, 0, 0 };
+    return thread_seed;
+  }
+
+  static uint64_t next_seed() {
+    GlobalSeed& global = get_global_seed();
+
+    if( !global.seeded ) {
+      std::random_device source;
+      return ( (uint64_t)source() << 32 ) ^ source();
+    }
+
+    ThreadSeed& thread_seed = get_thread_seed();
+    uint64_t state;
+
+    if( thread_seed.active )
+      state = thread_seed.seed + thread_seed.created_count++;
+    else
+      state = global.seed + global.created_count++;
+
+    return splitmix64( state );
+  }
+
+  /**
+   * A uniform double in [0, 1) from the top 53 bits of a random number.
+   */
+  double unit() {
+    return ( _rand_engine() >> 11 ) * ( 1.0 / 9007199254740992.0 );
+  }
+
+  /**
+   * A standard normal from the Marsaglia polar method, which makes two at a
+   * time, so every other call is almost free.
+   */
+  double standard_normal() {
+    if( _has_spare_normal ) {
+      _has_spare_normal = false;
+      return _spare_normal;
+    }
+
+    double u, v, s;
+
+    do {
+      u = 2.0 * unit() - 1.0;
+      v = 2.0 * unit() - 1.0;
+      s = u * u + v * v;
+    } while( s >= 1.0 || s == 0.0 );
+
+    double factor = std::sqrt( -2.0 * std::log( s ) / s );
+
+    _spare_normal = v * factor;
+    _has_spare_normal = true;
+
+    return u * factor;
+  }
+
+  Xoshiro256 _rand_engine;
+  bool _has_spare_normal;
+  double _spare_normal = 0.0;
 };
 
 }
@@ -0,0 +1,176 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+namespace littlelstm {
+
+/**
+ * A pool of threads that share the work of a single network step. A step is
+ * split into several short loops, each of which is only a few microseconds of
+ * work, so starting threads or waking sleeping ones for each loop would cost
+ * more than it saves. Instead the workers spin while they wait for the next
+ * loop, and only go to sleep after they have been idle for a while, such as
+ * between epochs.
+ *
+ * Copying a pool starts a new pool with the same number of workers, so that
+ * copies of a network never share threads.
+ */
+class StepWorkerPool {
+public:
+  typedef std::function<void( size_t begin, size_t end )> RangeFunction;
+
+  explicit StepWorkerPool( size_t worker_count = 0 ) { start( worker_count ); }
+  StepWorkerPool( const StepWorkerPool& other ) {
+    start( other.get_worker_count() );
+  }
+  ~StepWorkerPool() { stop(); }
+
+  StepWorkerPool& operator=( const StepWorkerPool& other ) {
+    if( this != &other ) {
+      stop();
+      start( other.get_worker_count() );
+    }
+    return *this;
+  }
+
+  size_t get_worker_count() const { return _threads.size(); }
+
+  /**
+   * Split [0, count) into one contiguous range per thread and call function
+   * for each range, with the calling thread taking the first range. Returns
+   * once every range is done. function must be safe to call concurrently for
+   * different ranges.
+   */
+  void run( size_t count, const RangeFunction& function ) {
+    if( _part_count == 1 || count < 2 ) {
+      function( 0, count );
+      return;
+    }
+
+    _function = &function;
+    _count = count;
+    _pending = _threads.size();
+
+    ++_generation;
+
+    if( _sleeping_count > 0 ) {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _wake.notify_all();
+    }
+
+    function( 0, count / _part_count );
+
+    for( size_t spins = 0; _pending > 0; ++spins )
+      pause( spins );
+  }
+
+private:
+  // busy iterations before yielding, and yields before sleeping
+  static const size_t BUSY_SPINS = 1 << 10;
+  static const size_t YIELD_SPINS = 1 << 14;
+
+  void start( size_t worker_count ) {
+    _generation = 0;
+    _pending = 0;
+    _sleeping_count = 0;
+    _stopping = false;
+    _part_count = worker_count + 1;
+
+    for( size_t i = 0; i < worker_count; ++i )
+      _threads.emplace_back( &StepWorkerPool::work, this, i + 1 );
+  }
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock( _mutex );
+      _stopping = true;
+      _wake.notify_all();
+    }
+
+    for( auto& thread : _threads )
+      thread.join();
+
+    _threads.clear();
+  }
+
+  static void pause( size_t spins ) {
+    if( spins >= BUSY_SPINS )
+      std::this_thread::yield();
+  }
+
+  void work( size_t part_i ) {
+    uint64_t seen_generation = 0;
+
+    while( true ) {
+      size_t spins = 0;
+
+      while( _generation == seen_generation && !_stopping ) {
+        if( spins < BUSY_SPINS + YIELD_SPINS ) {
+          pause( spins++ );
+          continue;
+        }
+
+        // idle for a while, so stop using the CPU until the next run
+        std::unique_lock<std::mutex> lock( _mutex );
+        ++_sleeping_count;
+        _wake.wait( lock, [&]() {
+            return _generation != seen_generation || _stopping;
+          } );
+        --_sleeping_count;
+      }
+
+      if( _stopping )
+        return;
+
+      seen_generation = _generation;
+
+      size_t begin = _count * part_i / _part_count;
+      size_t end = _count * ( part_i + 1 ) / _part_count;
+
+      ( *_function )( begin, end );
+
+      --_pending;
+    }
+  }
+
+  std::vector<std::thread> _threads;
+  size_t _part_count = 1;
+
+  std::atomic<uint64_t> _generation;
+  std::atomic<size_t> _pending;
+  std::atomic<size_t> _sleeping_count;
+  std::atomic<bool> _stopping;
+
+  std::mutex _mutex;
+  std::condition_variable _wake;
+
+  // set before each run's generation is published
+  const RangeFunction* _function = nullptr;
+  size_t _count = 0;
+};
+
+}
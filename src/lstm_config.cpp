@@ -41,6 +41,123 @@ LstmConfig::LstmConfig( ConfigParameters& params ) {
     }
   }
 
+  string optimizer;
+  string output_updates;
+  string schedule;
+  string activation_functions;
+  string step_order;
+
+  unordered_map<string,pair<string*,string> > optional_strings = {
+    { "optimizer", { &optimizer, DEFAULT_OPTIMIZER } },
+    { "output_updates", { &output_updates, DEFAULT_OUTPUT_UPDATES } },
+    { "learning_rate_schedule", { &schedule, DEFAULT_LEARNING_RATE_SCHEDULE } },
+    { "activation_functions", { &activation_functions,
+                                DEFAULT_ACTIVATION_FUNCTIONS } },
+    { "step_order", { &step_order, DEFAULT_STEP_ORDER } }
+  };
+
+  for( auto& kv : optional_strings ) {
+    try {
+      params.set_var( kv.first, *kv.second.first );
+    }
+    catch( ConfigParameterException& e ) {
+      throw LstmConfigException( e.what() );
+    }
+    catch( UndefinedParameterException& e ) {
+      *kv.second.first = kv.second.second;
+    }
+  }
+
+  _optimizer_config.type = string_to_optimizer_type( optimizer );
+
+  if( _optimizer_config.type == NO_OPTIMIZER )
+    throw LstmConfigException( "Unknown optimizer " + optimizer + ". Use "
+                               "momentum, rmsprop or adam." );
+
+  if( output_updates == "scaled" )
+    _optimizer_config.scale_output_updates = true;
+  else if( output_updates != "gradient" )
+    throw LstmConfigException( "Unknown output_updates " + output_updates +
+                               ". Use gradient or scaled." );
+
+  _schedule_type = string_to_schedule_type( schedule );
+
+  if( _schedule_type == NO_SCHEDULE )
+    throw LstmConfigException( "Unknown learning_rate_schedule " + schedule +
+                               ". Use constant, step, cosine or plateau." );
+
+  _act_impl = string_to_act_impl( activation_functions );
+
+  if( _act_impl == NO_ACT_FUNCS )
+    throw LstmConfigException( "Unknown activation_functions " +
+                               activation_functions + ". Use exact or "
+                               "fast." );
+
+  _step_order = string_to_step_order( step_order );
+
+  if( _step_order == NO_STEP_ORDER )
+    throw LstmConfigException( "Unknown step_order " + step_order + ". Use "
+                               "unit or level." );
+
+  double second_moment_decay_default =
+    _optimizer_config.type == RMSPROP_OPTIMIZER ?
+    DEFAULT_RMSPROP_SECOND_MOMENT_DECAY : DEFAULT_ADAM_SECOND_MOMENT_DECAY;
+
+  vector<ConfigVariableToSet<double> > optional_ranged_doubles;
+
+  optional_ranged_doubles.emplace_back( "second_moment_decay",
+                                        &_optimizer_config.second_moment_decay,
+                                        second_moment_decay_default,
+                                        0.0, 1.0 );
+  optional_ranged_doubles.emplace_back( "learning_rate_decay",
+                                        &_learning_rate_decay,
+                                        DEFAULT_LEARNING_RATE_DECAY, 0.0, 1.0 );
+  optional_ranged_doubles.emplace_back( "min_learning_rate",
+                                        &_min_learning_rate,
+                                        DEFAULT_MIN_LEARNING_RATE, 0.0,
+                                        numeric_limits<double>::max() );
+
+  for( auto& var_to_set : optional_ranged_doubles ) {
+    try {
+      params.set_var( var_to_set.name, *var_to_set.var_ptr, var_to_set.min,
+                      var_to_set.max );
+    }
+    catch( ConfigParameterException& e ) {
+      throw LstmConfigException( e.what() );
+    }
+    catch( UndefinedParameterException& e ) {
+      *var_to_set.var_ptr = var_to_set.default_value;
+    }
+  }
+
+  if( _optimizer_config.second_moment_decay >= 1.0 )
+    throw LstmConfigException( "second_moment_decay must be less than 1.0" );
+
+  vector<ConfigVariableToSet<size_t> > optional_size_ts;
+
+  optional_size_ts.emplace_back( "schedule_epochs", &_schedule_epochs,
+                                 DEFAULT_SCHEDULE_EPOCHS, (size_t)1,
+                                 numeric_limits<size_t>::max() );
+  optional_size_ts.emplace_back( "plateau_patience", &_plateau_patience,
+                                 DEFAULT_PLATEAU_PATIENCE, (size_t)1,
+                                 numeric_limits<size_t>::max() );
+  optional_size_ts.emplace_back( "step_thread_count", &_step_thread_count,
+                                 DEFAULT_STEP_THREAD_COUNT, (size_t)0,
+                                 numeric_limits<size_t>::max() );
+
+  for( auto& var_to_set : optional_size_ts ) {
+    try {
+      params.set_var( var_to_set.name, *var_to_set.var_ptr, var_to_set.min,
+                      var_to_set.max );
+    }
+    catch( ConfigParameterException& e ) {
+      throw LstmConfigException( e.what() );
+    }
+    catch( UndefinedParameterException& e ) {
+      *var_to_set.var_ptr = var_to_set.default_value;
+    }
+  }
+
   try {
     params.set_var( "block_counts", _block_counts );
   }
@@ -51,6 +168,32 @@ LstmConfig::LstmConfig( ConfigParameters& params ) {
     throw LstmConfigException( e.what() );
   }
 
+  vector<string> block_type_strings;
+
+  try {
+    params.set_var( "block_types", block_type_strings );
+  }
+  catch( UndefinedParameterException& e ) {
+    block_type_strings.assign( _block_counts.size(), DEFAULT_BLOCK_TYPE );
+  }
+  catch( ConfigParameterException& e ) {
+    throw LstmConfigException( e.what() );
+  }
+
+  if( block_type_strings.size() != _block_counts.size() )
+    throw LstmConfigException( "block_types must have one type for each "
+                               "hidden layer in block_counts" );
+
+  for( auto& block_type_string : block_type_strings ) {
+    lstm_block_t block_type = string_to_block_type( block_type_string );
+
+    if( block_type == NO_BLOCK_TYPE )
+      throw LstmConfigException( "Unknown block type " + block_type_string +
+                                 ". Use lstm or forget_gate." );
+
+    _block_types.push_back( block_type );
+  }
+
   // any unset parameters are invalid
   set<string> unset_params = params.get_unset_params();
   if( unset_params.size() != 0 ) {
@@ -74,13 +217,53 @@ LstmConfig::LstmConfig( ConfigParameters& params ) {
   setup_output_layer_default_weight_configs();
 }
 
+/**
+ * Replace the hidden layers, which are LSTM blocks unless block_types is
+ * given.
+ */
+void LstmConfig::set_block_counts( const vector<size_t>& block_counts,
+                                   const vector<lstm_block_t>& block_types ) {
+  _block_counts = block_counts;
+  _block_types = block_types;
+
+  if( _block_types.empty() )
+    _block_types.assign( _block_counts.size(), LSTM_BLOCK );
+}
+
 void LstmConfig::print_network_configuration() {
   cout << "Block counts:";
   for( auto& block_count : _block_counts )
     cout << " " << block_count;
   cout << endl;
+  if( find( _block_types.begin(), _block_types.end(), FORGET_GATE_BLOCK ) !=
+      _block_types.end() ) {
+    cout << "Block types:";
+    for( auto& block_type : _block_types )
+      cout << " " << block_type_to_string( block_type );
+    cout << endl;
+  }
   cout << "Learning rate: " << _learning_rate << endl;
   cout << "Momentum:      " << _momentum << endl;
+  cout << "Optimizer:     "
+       << optimizer_type_to_string( _optimizer_config.type ) << endl;
+  if( _optimizer_config.type == MOMENTUM_OPTIMIZER &&
+      _optimizer_config.scale_output_updates )
+    cout << "Output updates: scaled" << endl;
+  if( _optimizer_config.type != MOMENTUM_OPTIMIZER )
+    cout << "Second moment decay: " << _optimizer_config.second_moment_decay
+         << endl;
+  cout << "Learning rate schedule: "
+       << schedule_type_to_string( _schedule_type ) << endl;
+  cout << "Activation functions: " << act_impl_to_string( _act_impl ) << endl;
+  cout << "Step order: " << step_order_to_string( _step_order ) << endl;
+  if( _step_thread_count != 1 )
+    cout << "Threads per step: " << _step_thread_count << endl;
+}
+
+LearningRateSchedule LstmConfig::get_learning_rate_schedule() const {
+  return LearningRateSchedule( _schedule_type, _learning_rate,
+                               _min_learning_rate, _learning_rate_decay,
+                               _schedule_epochs, _plateau_patience );
 }
 
 lstm_unit_t LstmConfig::string_to_unit_t( const string& s ) {
@@ -26,6 +26,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #include <vector>
 #include <unordered_map>
 #include <stdexcept>
+#include <limits>
 
 #include "config_parser.hpp"
 #include "littlelstm/lstm_layer_config.hpp"
@@ -34,7 +35,11 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #include "debug.hpp"
 #include "config_parameter.hpp"
 #include "config_parameters.hpp"
+#include "config_variable_to_set.hpp"
 #include "lstm_defaults.hpp"
+#include "learning_rate_schedule.hpp"
+#include "littlelstm/lstm_optimizer.hpp"
+#include "littlelstm/lstm_activation_function.hpp"
 
 namespace larasynth {
 
@@ -50,13 +55,18 @@ public:
 
   void set_input_count( size_t input_count ) { _input_count = input_count; }
   void set_output_count( size_t output_count ) { _output_count = output_count; }
+  void set_block_counts( const std::vector<size_t>& block_counts,
+                         const std::vector<littlelstm::lstm_block_t>&
+                         block_types = {} );
 
   void print_network_configuration();
 
-  size_t get_input_count() { return _input_count; }
-  size_t get_output_count() { return _output_count; }
+  size_t get_input_count() const { return _input_count; }
+  size_t get_output_count() const { return _output_count; }
   size_t get_hidden_layer_count() { return _block_counts.size(); }
   const std::vector<size_t>& get_block_counts() const { return _block_counts; }
+  const std::vector<littlelstm::lstm_block_t>& get_block_types() const
+  { return _block_types; }
   const std::vector<size_t>& get_cells_per_block() const { return _cells_per_block; }
   bool connection_needed( Id_t source_layer_id, Id_t dest_layer_id,
                           littlelstm::lstm_unit_t source_type,
@@ -67,6 +77,17 @@ public:
                      littlelstm::lstm_unit_t dest_type );
   double get_learning_rate() const { return _learning_rate; }
   double get_momentum() const { return _momentum; }
+  littlelstm::LstmOptimizerConfig get_optimizer_config() const
+  { return _optimizer_config; }
+  LearningRateSchedule get_learning_rate_schedule() const;
+  lr_schedule_t get_schedule_type() const { return _schedule_type; }
+  littlelstm::lstm_act_impl_t get_act_impl() const { return _act_impl; }
+  void set_act_impl( littlelstm::lstm_act_impl_t act_impl )
+  { _act_impl = act_impl; }
+  littlelstm::lstm_step_order_t get_step_order() const { return _step_order; }
+  void set_step_order( littlelstm::lstm_step_order_t step_order )
+  { _step_order = step_order; }
+  size_t get_step_thread_count() const { return _step_thread_count; }
 
 private:
   void setup_output_layer_default_weight_configs();
@@ -82,6 +103,7 @@ private:
   littlelstm::LstmWeightConfig _weight_config;
 
   std::vector<size_t> _block_counts;
+  std::vector<littlelstm::lstm_block_t> _block_types;
   std::vector<size_t> _cells_per_block;
 
   littlelstm::lstm_unit_t _source_type;
@@ -91,6 +113,17 @@ private:
 
   double _learning_rate;
   double _momentum;
+
+  littlelstm::LstmOptimizerConfig _optimizer_config;
+
+  lr_schedule_t _schedule_type;
+  double _learning_rate_decay;
+  double _min_learning_rate;
+  size_t _schedule_epochs;
+  size_t _plateau_patience;
+  littlelstm::lstm_act_impl_t _act_impl;
+  littlelstm::lstm_step_order_t _step_order;
+  size_t _step_thread_count;
 };
 
 }
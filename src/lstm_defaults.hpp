@@ -19,11 +19,25 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <cstddef>
 #include <vector>
+#include <string>
 
 namespace larasynth {
 
   static const std::vector<size_t> DEFAULT_BLOCK_COUNTS = { 17 };
+  static const std::string DEFAULT_BLOCK_TYPE = "lstm";
   static const double DEFAULT_LEARNING_RATE = 0.05;
   static const double DEFAULT_MOMENTUM = 0.8;
+  static const std::string DEFAULT_OPTIMIZER = "momentum";
+  static const std::string DEFAULT_OUTPUT_UPDATES = "gradient";
+  static const double DEFAULT_RMSPROP_SECOND_MOMENT_DECAY = 0.9;
+  static const double DEFAULT_ADAM_SECOND_MOMENT_DECAY = 0.999;
+  static const std::string DEFAULT_LEARNING_RATE_SCHEDULE = "constant";
+  static const double DEFAULT_LEARNING_RATE_DECAY = 0.5;
+  static const double DEFAULT_MIN_LEARNING_RATE = 0.0;
+  static const size_t DEFAULT_SCHEDULE_EPOCHS = 1000;
+  static const size_t DEFAULT_PLATEAU_PATIENCE = 5;
+  static const std::string DEFAULT_ACTIVATION_FUNCTIONS = "exact";
+  static const std::string DEFAULT_STEP_ORDER = "unit";
+  static const size_t DEFAULT_STEP_THREAD_COUNT = 1;
 
 }
@@ -21,14 +21,23 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <vector>
 #include <map>
+#include <utility>
 
 #include "midi_types.hpp"
 
 namespace larasynth {
 
+/**
+ * The MSE of one validation, and the targets, outputs and cell states of
+ * its samples. With a sample limit, only evenly spaced samples are kept:
+ * whenever there are more than the limit, every other kept sample is
+ * dropped and the stride between kept samples doubles.
+ */
 class LstmResult {
 public:
-  explicit LstmResult( size_t epoch = 0 ) : _epoch( epoch ), _mse( 0.0 ) {}
+  explicit LstmResult( size_t epoch = 0, size_t sample_limit = 0 )
+    : _epoch( epoch ), _mse( 0.0 ), _sample_limit( sample_limit )
+    , _sample_count( 0 ), _sample_stride( 1 ) {}
 
   size_t get_epoch() const { return _epoch; }
   double get_mse() const { return _mse; }
@@ -39,20 +48,54 @@ public:
   const std::vector< std::map<size_t, double> >& get_cell_states() const
   { return _cell_states; }
 
+  // the number of samples added, including the ones that were not kept
+  size_t get_sample_count() const { return _sample_count; }
+  // the number of added samples between two kept samples
+  size_t get_sample_stride() const { return _sample_stride; }
+
   void set_mse( const double mse ) { _mse = mse; }
-  void add_target( const ctrl_values_t& target )
-  { _targets.push_back( target ); }
-  void add_output( const ctrl_values_t& output )
-  { _outputs.push_back( output ); }
-  void add_cell_states( const std::map<size_t, double>& cell_states )
-  { _cell_states.push_back( cell_states ); }
+  void set_sample_count( size_t sample_count, size_t sample_stride ) {
+    _sample_count = sample_count;
+    _sample_stride = sample_stride;
+  }
+
+  void add_sample( ctrl_values_t target, ctrl_values_t output,
+                   std::map<size_t, double> cell_states ) {
+    if( _sample_count++ % _sample_stride != 0 )
+      return;
+
+    _targets.push_back( std::move( target ) );
+    _outputs.push_back( std::move( output ) );
+    _cell_states.push_back( std::move( cell_states ) );
+
+    if( _sample_limit > 0 && _targets.size() > _sample_limit )
+      drop_every_other_sample();
+  }
 
 private:
+  void drop_every_other_sample() {
+    size_t kept_count = 1;
+
+    for( size_t i = 2; i < _targets.size(); i += 2 ) {
+      _targets[kept_count] = std::move( _targets[i] );
+      _outputs[kept_count] = std::move( _outputs[i] );
+      _cell_states[kept_count] = std::move( _cell_states[i] );
+      ++kept_count;
+    }
+
+    _targets.resize( kept_count );
+    _outputs.resize( kept_count );
+    _cell_states.resize( kept_count );
+    _sample_stride *= 2;
+  }
+
   size_t _epoch;
   double _mse;
+  size_t _sample_limit;
+  size_t _sample_count;
+  size_t _sample_stride;
   std::vector<ctrl_values_t> _targets;
   std::vector<ctrl_values_t> _outputs;
   std::vector< std::map<size_t, double> > _cell_states;
 };
-
 }
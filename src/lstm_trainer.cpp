@@ -18,6 +18,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "lstm_trainer.hpp"
+#include "trace.hpp"
 
 using namespace std;
 using namespace larasynth;
@@ -34,17 +35,83 @@ LstmTrainer::LstmTrainer( littlelstm::LstmNetwork& untrained_network,
   , _network_config( network_config )
   , _midi_translator( midi_translator )
   , _update_period( update_period )
+  , _schedule( network_config.get_learning_rate_schedule() )
 {
+  _network.set_optimizer( network_config.get_optimizer_config() );
+  _network.set_act_impl( network_config.get_act_impl() );
+  _network.set_step_order( network_config.get_step_order() );
+  _network.set_step_thread_count( network_config.get_step_thread_count() );
+  _network.set_profiling( true );
   _network.zero_network();
 }
 
+/**
+ * Get the profile of this session of training, including the workers'.
+ */
+TrainingProfile LstmTrainer::get_profile() const {
+  TrainingProfile profile = _profile;
+
+  profile.network.add( _network.get_profile() );
+  profile.step_count = _step_count;
+
+  return profile;
+}
+
+/**
+ * Continue from a checkpoint. The network must be restored separately.
+ */
+void LstmTrainer::restore( size_t epoch, size_t max_streak,
+                           const string& rand_state,
+                           const LearningRateScheduleState& schedule_state ) {
+  _epoch = epoch;
+  _previous_epoch = epoch;
+  _max_streak = max_streak;
+  _new_best_streak = false;
+  if( !rand_state.empty() )
+    _rand_gen.set_state( rand_state );
+  _schedule.set_state( schedule_state );
+}
+
+/**
+ * Train toward a teacher's outputs (soft targets) as well as the examples'
+ * targets. During training steps the teacher is fed the same inputs as the
+ * network, and the target used in backpropagation is
+ * soft_target_weight * teacher output + (1 - soft_target_weight) * target.
+ * Every training step is backpropagated, since an output that rounds to the
+ * target can still be far from the teacher's. The teacher is zeroed whenever
+ * the network is, and every epoch starts both from zero. Pass nullptr to
+ * stop. Only supported without workers.
+ */
+void LstmTrainer::set_teacher( littlelstm::FeedForwardNetwork* teacher,
+                               double soft_target_weight ) {
+  if( teacher && ( !_workers.empty() || _round_runner ) )
+    throw logic_error( "A teacher cannot be set on a trainer with workers" );
+
+  if( teacher && ( teacher->get_input_size() != _network.get_input_size() ||
+                   teacher->get_output_size() != _network.get_output_size() ) )
+    throw out_of_range( "Teacher network does not match the network" );
+
+  _teacher = teacher;
+  _soft_target_weight = soft_target_weight;
+
+  if( _teacher )
+    _teacher->zero_network();
+}
+
 void LstmTrainer::feed_forward_next( ctrl_values_t& target_ctrl_values,
                                       ctrl_values_t& output_ctrl_values,
                                       feedback_source source,
                                       bool print ) {
+  uint64_t begin = littlelstm::profile_nanoseconds();
   vector<double> input = _midi_translator.get_input( source );
+  uint64_t translator_nanoseconds = littlelstm::profile_nanoseconds() - begin;
+
   _network.feed_forward( input );
 
+  if( _teacher && source == TARGET_SOURCE )
+    _teacher->feed_forward( input );
+
+  begin = littlelstm::profile_nanoseconds();
   vector<double> output = _network.get_output();
   _midi_translator.report_output( output );
 
@@ -74,7 +141,10 @@ void LstmTrainer::feed_forward_next( ctrl_values_t& target_ctrl_values,
   }
 
   target_ctrl_values = _midi_translator.get_target_ctrl_values();
-  output_ctrl_values = _midi_translator.get_output_ctrl_values();  
+  output_ctrl_values = _midi_translator.get_output_ctrl_values();
+
+  translator_nanoseconds += littlelstm::profile_nanoseconds() - begin;
+  _profile.translator.record( translator_nanoseconds );
 }
 
 double LstmTrainer::calculate_error( const ctrl_values_t& target_ctrl_values,
@@ -96,6 +166,8 @@ double LstmTrainer::calculate_error( const ctrl_values_t& target_ctrl_values,
 }
 
 void LstmTrainer::advance_stream_until_update_time() {
+  littlelstm::PhaseTimer timer( &_profile.stream );
+
   bool time_to_update = false;
 
   while( !time_to_update ) {
@@ -112,6 +184,7 @@ void LstmTrainer::advance_stream_until_update_time() {
     // next event is a note event and should be presented immediately
     else if( next_type == NOTE_ON || next_type == NOTE_OFF ) {
       Event event = _training_stream.get_next();
+      ++_profile.event_count;
 
       _midi_translator.report_note_event( &event );
 
@@ -124,6 +197,7 @@ void LstmTrainer::advance_stream_until_update_time() {
     // time. only present if this is the last event
     else {
       Event event = _training_stream.get_next();
+      ++_profile.event_count;
 
       assert( event.type() == CTRL_CHANGE );
 
@@ -135,11 +209,163 @@ void LstmTrainer::advance_stream_until_update_time() {
   }
 }
 
+/**
+ * Train data parallel with another trainer. The worker's network must have
+ * the same architecture as this trainer's network.
+ */
+void LstmTrainer::add_worker( LstmTrainer& worker ) {
+  if( worker._network.get_connection_weights().size() !=
+      _network.get_connection_weights().size() )
+    throw out_of_range( "Worker network does not match the network" );
+
+  _workers.push_back( &worker );
+}
+
+/**
+ * Run each round of periodic averaging with round_runner instead of with
+ * workers in this process.
+ */
+void LstmTrainer::set_round_runner( RoundRunner_t round_runner ) {
+  _round_runner = round_runner;
+}
+
+/**
+ * Get the fraction of the time spent in parallel rounds that the workers
+ * were busy training. Time lost to waiting for the slowest worker, starting
+ * threads or processes, and averaging weights lowers the utilization. This
+ * shows how evenly the work is shared, not how much faster the workers train
+ * than one thread would.
+ */
+double LstmTrainer::get_worker_utilization() const {
+  if( _worker_count == 0 || _round_seconds == 0.0 )
+    return 1.0;
+
+  return _worker_seconds / ( _worker_count * _round_seconds );
+}
+
+/**
+ * Train as a worker for one round. The round's weights, epoch, best streak
+ * and schedule state replace this trainer's, so a resumed or warm started
+ * network and plateau reductions carry over to every worker.
+ */
+TrainingRoundResult LstmTrainer::run_round( const TrainingRound& round ) {
+  TRACE_SCOPE( "training round" );
+
+  Timer round_timer;
+
+  if( round.weights.size() != _network.get_connection_weights().size() )
+    throw out_of_range( "Round weights do not match the network" );
+
+  _network.set_connection_weights( round.weights );
+  _epoch = round.epoch;
+  _max_streak = round.max_streak;
+  _schedule.set_state( round.schedule_state );
+
+  size_t first_step_count = _step_count;
+  _profile = TrainingProfile();
+  _network.reset_profile();
+
+  while( _epoch < round.epoch + round.epoch_count )
+    run_training_epoch();
+
+  TrainingRoundResult result;
+
+  result.weight_deltas = _network.get_connection_weights();
+
+  for( size_t i = 0; i < result.weight_deltas.size(); ++i )
+    result.weight_deltas[i] -= round.weights[i];
+
+  result.max_streak = _max_streak;
+  result.step_count = _step_count - first_step_count;
+  result.learning_rate = _learning_rate;
+  result.seconds = round_timer.get_elapsed_seconds();
+  result.profile = get_profile();
+  result.profile.step_count = result.step_count;
+
+  return result;
+}
+
+/**
+ * Run one round of periodic averaging on the workers and add the average of
+ * their weight changes to this trainer's weights.
+ */
+void LstmTrainer::run_worker_epochs() {
+  Timer round_timer;
+
+  TrainingRound round;
+  round.epoch = _epoch;
+  round.epoch_count = _training_config.get_averaging_period();
+  round.max_streak = _max_streak;
+  round.schedule_state = _schedule.get_state();
+  round.weights = _network.get_connection_weights();
+
+  vector<TrainingRoundResult> results;
+
+  if( _round_runner ) {
+    results = _round_runner( round );
+  }
+  else {
+    results.resize( _workers.size() );
+
+    run_in_parallel( _workers.size(), [&]( size_t i ) {
+        results[i] = _workers[i]->run_round( round );
+      }, _workers.size() );
+  }
+
+  if( results.empty() )
+    throw runtime_error( "No workers reported training results" );
+
+  _epoch += round.epoch_count;
+  _worker_count = results.size();
+  _learning_rate = results[0].learning_rate;
+
+  littlelstm::ConnectionWeights_t weights = round.weights;
+
+  for( const TrainingRoundResult& result : results ) {
+    if( result.weight_deltas.size() != weights.size() )
+      throw out_of_range( "Worker weights do not match the network" );
+
+    for( size_t i = 0; i < weights.size(); ++i )
+      weights[i] += result.weight_deltas[i] / results.size();
+
+    if( result.max_streak > _max_streak ) {
+      _max_streak = result.max_streak;
+      _new_best_streak = true;
+    }
+
+    _worker_seconds += result.seconds;
+    _step_count += result.step_count;
+    _profile.add( result.profile );
+  }
+
+  _network.set_connection_weights( weights );
+
+  _round_seconds += round_timer.get_elapsed_seconds();
+}
+
 void LstmTrainer::run_training_epoch() {
+  TRACE_SCOPE( "epoch" );
+
+  _previous_epoch = _epoch;
+
+  if( !_workers.empty() || _round_runner ) {
+    _new_best_streak = false;
+    run_worker_epochs();
+    return;
+  }
+
   ++_epoch;
 
-  if( _training_config.get_zero_network_before_each_epoch() )
+  _learning_rate = _schedule.get_learning_rate( _epoch );
+
+  // with a teacher both networks always start from zero, since either may
+  // have been run on other inputs since the last epoch (such as by
+  // ExamplePlayer::compare())
+  if( _training_config.get_zero_network_before_each_epoch() || _teacher ) {
     _network.zero_network();
+    if( _teacher )
+      _teacher->zero_network();
+  }
 
   _current_time = 0;
   _next_update_time = 0;
@@ -150,7 +376,10 @@ void LstmTrainer::run_training_epoch() {
 
   bool reset = false;
 
-  _training_stream.reset( _training_config.get_example_repetitions() );
+  {
+    littlelstm::PhaseTimer reset_timer( &_profile.stream_reset );
+    _training_stream.reset( _training_config.get_example_repetitions() );
+  }
   _midi_translator.reset();
 
   while( _training_stream.has_next() && !reset ) {
@@ -161,6 +390,7 @@ void LstmTrainer::run_training_epoch() {
 
     feed_forward_next( target_ctrl_values, output_ctrl_values,
                        TARGET_SOURCE );
+    ++_step_count;
 
     double sse = calculate_error( target_ctrl_values, output_ctrl_values );
 
@@ -184,15 +414,29 @@ void LstmTrainer::run_training_epoch() {
         consecutive_failure_count = 0;
     }
 
-    if( should_backpropogate( correct ) ) {
+    if( _teacher ) {
+      vector<double> target = _midi_translator.get_target();
+      const vector<double>& soft_target = _teacher->get_output();
+
+      for( size_t i = 0; i < target.size(); ++i )
+        target[i] = _soft_target_weight * soft_target[i] +
+          ( 1.0 - _soft_target_weight ) * target[i];
+
+      _network.backpropagate( target, _learning_rate,
+                              _network_config.get_momentum() );
+    }
+    else if( should_backpropogate( correct ) ) {
       _network.backpropagate( _midi_translator.get_target(),
-                              _network_config.get_learning_rate(),
+                              _learning_rate,
                               _network_config.get_momentum() );
     }
     if( should_reset( correct, consecutive_failure_count ) ) {
       reset = true;
-      if( prob_bool( _training_config.get_zero_network_on_reset() ) )
+      if( prob_bool( _training_config.get_zero_network_on_reset() ) ) {
         _network.zero_network();
+        if( _teacher )
+          _teacher->zero_network();
+      }
     }
   }
 }
@@ -224,17 +468,26 @@ bool LstmTrainer::should_backpropogate( bool correct ) {
 }
 
 
+/**
+ * Validate when the last call to run_training_epoch() passed a multiple of
+ * epoch_count_before_validating, or found a new best streak. A parallel
+ * round can run several epochs at once.
+ */
 bool LstmTrainer::should_validate() {
-  return ( _epoch % _training_config.get_epoch_count_before_validating() == 0 ||
-           _new_best_streak );
+  size_t period = _training_config.get_epoch_count_before_validating();
+
+  return ( _epoch / period != _previous_epoch / period || _new_best_streak );
 }
 
 LstmResult LstmTrainer::validate() {
+  TRACE_SCOPE( "validate" );
+
   if( prob_bool( _training_config.get_zero_network_before_validation() ) ||
       _training_config.get_zero_network_before_each_epoch() )
     _network.zero_network();
 
-  LstmResult result( _epoch );
+  LstmResult result( _epoch,
+                     _training_config.get_validation_trace_sample_limit() );
 
   size_t feed_forward_count = 0;
   double sse = 0.0;
@@ -244,9 +497,15 @@ LstmResult LstmTrainer::validate() {
   _current_time = 0;
   _next_update_time = 0;
 
-  _training_stream.reset( _training_config.get_validation_example_repetitions() );
+  {
+    littlelstm::PhaseTimer reset_timer( &_profile.stream_reset );
+    _training_stream.reset(
+      _training_config.get_validation_example_repetitions() );
+  }
   _midi_translator.reset();
-    
+
+  littlelstm::PhaseTimer timer( &_profile.validation );
+
   while( _training_stream.has_next() ) {
     advance_stream_until_update_time();
 
@@ -266,15 +525,16 @@ LstmResult LstmTrainer::validate() {
 
     sse += squared_error;
 
-    result.add_target( target_ctrl_values );
-    result.add_output( output_ctrl_values );
-    result.add_cell_states( _network.get_cell_states() );
+    result.add_sample( target_ctrl_values, output_ctrl_values,
+                       _network.get_cell_states() );
   }
 
   double mse = sse / (double)feed_forward_count;
 
   result.set_mse( mse );
 
+  _schedule.report_validation_mse( mse );
+
   return result;
 }
 
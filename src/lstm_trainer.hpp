@@ -23,6 +23,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "littlelstm/lstm_activation_function.hpp"
 #include "littlelstm/lstm_network.hpp"
+#include "littlelstm/feed_forward_network.hpp"
 #include "training_config.hpp"
 #include "littlelstm/lstm_types.hpp"
 #include "lstm_result.hpp"
@@ -30,9 +31,59 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #include "midi_types.hpp"
 #include "midi_translator.hpp"
 #include "lstm_config.hpp"
+#include "learning_rate_schedule.hpp"
+#include "training_profile.hpp"
+#include "worker_pool.hpp"
+#include "time_utilities.hpp"
+
+#include <functional>
 
 namespace larasynth {
 
+/**
+ * What a worker needs to train for one round of periodic averaging: the
+ * weights and trainer state to start from and the number of epochs to run.
+ */
+struct TrainingRound {
+  size_t epoch = 0;
+  size_t epoch_count = 0;
+  size_t max_streak = 0;
+  LearningRateScheduleState schedule_state;
+  littlelstm::ConnectionWeights_t weights;
+};
+
+/**
+ * What a worker reports after a round: how far training moved each weight
+ * from the round's weights, and what it took to get there.
+ */
+struct TrainingRoundResult {
+  littlelstm::ConnectionWeights_t weight_deltas;
+  size_t max_streak = 0;
+  size_t step_count = 0;
+  double learning_rate = 0.0;
+  double seconds = 0.0;
+  TrainingProfile profile;
+};
+
+typedef std::function<std::vector<TrainingRoundResult>( const TrainingRound& )>
+RoundRunner_t;
+
+/**
+ * Trains a network on the events from a training stream.
+ *
+ * A trainer can also train data parallel with worker trainers added with
+ * add_worker(). Each worker has its own network, training stream and
+ * translator, so the activations, traces and optimizer state are private to
+ * its thread. Each call to run_training_epoch() then runs a round on every
+ * worker in parallel: the worker starts from this trainer's weights, runs
+ * averaging_period epochs with run_round(), and the average of the workers'
+ * weight changes is added to this trainer's weights. Validation is always
+ * done by this trainer on its own network and stream.
+ *
+ * The workers do not have to be in this process. A round runner set with
+ * set_round_runner() is given each round instead, and returns the results of
+ * running it on every worker (see TrainingCoordinator).
+ */
 class LstmTrainer {
 public:
   LstmTrainer( littlelstm::LstmNetwork& untrained_network,
@@ -49,6 +100,26 @@ public:
   void run_training_epoch();
   LstmResult validate();
 
+  void add_worker( LstmTrainer& worker );
+  void set_round_runner( RoundRunner_t round_runner );
+  TrainingRoundResult run_round( const TrainingRound& round );
+  size_t get_worker_count() const { return _worker_count; }
+  size_t get_step_count() const { return _step_count; }
+  TrainingProfile get_profile() const;
+  double get_worker_utilization() const;
+
+  double get_learning_rate() const { return _learning_rate; }
+
+  std::string get_rand_state() const { return _rand_gen.get_state(); }
+  LearningRateScheduleState get_schedule_state() const
+  { return _schedule.get_state(); }
+  void restore( size_t epoch, size_t max_streak,
+                const std::string& rand_state,
+                const LearningRateScheduleState& schedule_state );
+
+  void set_teacher( littlelstm::FeedForwardNetwork* teacher,
+                    double soft_target_weight );
+
 private:
   void advance_stream_until_update_time();
   void feed_forward_next( ctrl_values_t& target_ctrl_values,
@@ -59,6 +130,7 @@ private:
                           const ctrl_values_t& output_ctrl_values );
   bool should_backpropogate( bool correct );
   bool should_reset( bool correct, size_t consecutive_failure_count );
+  void run_worker_epochs();
   void prepare_network_and_training_data();
   void shuffle();
   bool result_is_quality( LstmResult& result );
@@ -71,17 +143,37 @@ private:
   LstmConfig& _network_config;
   MidiTranslator& _midi_translator;
 
+  // a trained network whose outputs are blended into the training targets
+  littlelstm::FeedForwardNetwork* _teacher = nullptr;
+  double _soft_target_weight = 0.0;
+
   size_t _epoch = 0;
+  size_t _previous_epoch = 0;
 
   size_t _max_streak = 0;
   bool _new_best_streak = false;
 
   size_t _update_period;
+
+  LearningRateSchedule _schedule;
+  double _learning_rate = 0.0;
   
   size_t _current_time = 0;
   size_t _next_update_time = 0;
 
   RandGen _rand_gen;
+
+  // training steps (feed forwards during training epochs) in this session
+  size_t _step_count = 0;
+
+  // the phases timed by this trainer, plus the workers' profiles
+  TrainingProfile _profile;
+
+  std::vector<LstmTrainer*> _workers;
+  RoundRunner_t _round_runner;
+  size_t _worker_count = 0;
+  double _worker_seconds = 0.0;
+  double _round_seconds = 0.0;
 };
 
 }
@@ -21,6 +21,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <vector>
 #include <cmath>
+#include <memory>
 
 #include "lstm_types.hpp"
 #include "rand_gen.hpp"
@@ -53,7 +54,8 @@ public:
   LstmWeightGenRange( double min, double max, RandGen* rand_gen )
     : _min( min ), _max( max ), _rand_gen( rand_gen ) {}
   LstmWeightGenRange( double min, double max )
-    : _min( min ), _max( max ), _rand_gen( new RandGen ) {}
+    : _min( min ), _max( max ), _owned_rand_gen( new RandGen ),
+      _rand_gen( _owned_rand_gen.get() ) {}
   ~LstmWeightGenRange() {}
 
   double next_weight() { return _rand_gen->uniform_real( _min, _max ); }
@@ -62,6 +64,7 @@ public:
 private:
   double _min;
   double _max;
+  std::unique_ptr<RandGen> _owned_rand_gen;
   RandGen* _rand_gen;
 };
 
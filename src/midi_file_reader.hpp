@@ -61,6 +61,7 @@ public:
   size_t get_note_on_count() const { return _note_on_count; }
   size_t get_ctrl_change_count() const { return _ctrl_change_count; }
   std::vector<Event> get_events() const { return _events; }
+  const std::vector<Event>& get_events_ref() const { return _events; }
 
 private:
   std::string _midi_filename;
@@ -68,6 +68,21 @@ void MidiMinMax::consider_sequence( const TrainingSequence& seq ) {
   }
 }
 
+/**
+ * Widen this min/max to also cover everything considered by other. Merging
+ * the min/maxes of several sequences gives the same result as considering
+ * the sequences one after another.
+ */
+void MidiMinMax::merge( const MidiMinMax& other ) {
+  _note_min = min( _note_min, other._note_min );
+  _note_max = max( _note_max, other._note_max );
+
+  for( size_t ctrl = 0; ctrl < _ctrl_mins.size(); ++ctrl ) {
+    _ctrl_mins[ctrl] = min( _ctrl_mins[ctrl], other._ctrl_mins[ctrl] );
+    _ctrl_maxs[ctrl] = max( _ctrl_maxs[ctrl], other._ctrl_maxs[ctrl] );
+  }
+}
+
 namespace larasynth {
   ostream& operator<<( ostream& os, const MidiMinMax& min_max ) {
     os << "Note min: " << (unsigned int)min_max._note_min << endl;
@@ -21,6 +21,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <vector>
 #include <iostream>
+#include <algorithm>
 
 #include "training_sequence.hpp"
 #include "midi_types.hpp"
@@ -38,6 +39,7 @@ public:
   }
 
   void consider_sequence( const TrainingSequence& seq );
+  void merge( const MidiMinMax& other );
 
   event_data_t get_note_min() const { return _note_min; }
   event_data_t get_note_max() const { return _note_max; }
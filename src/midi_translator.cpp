@@ -53,6 +53,15 @@ MidiTranslator::MidiTranslator( const unordered_map<event_data_t,size_t>&
     setup_ctrl_maps( ctrl );
   }
 
+  // controllers without outputs are ignored, so that the translator for a
+  // network of a controller group only follows the group's controllers
+  for( auto it = _ctrl_defaults.begin(); it != _ctrl_defaults.end(); ) {
+    if( _ctrl_output_counts.count( it->first ) == 0 )
+      it = _ctrl_defaults.erase( it );
+    else
+      ++it;
+  }
+
   adjust_ctrl_values( _ctrl_defaults );
   _output_ctrl_values = _ctrl_defaults;
   _target_ctrl_values = _ctrl_defaults;  
@@ -130,12 +139,19 @@ void MidiTranslator::report_note_event( const Event* note_event ) {
 }
 
 void MidiTranslator::update_ctrl_values( const ctrl_values_t& new_values ) {
-  _target_ctrl_values = new_values;
+  for( auto& kv : new_values ) {
+    if( _ctrl_output_counts.count( kv.first ) != 0 )
+      _target_ctrl_values[kv.first] = kv.second;
+  }
+
   adjust_ctrl_values( _target_ctrl_values );
 }
 
 void MidiTranslator::update_ctrl_value( event_data_t ctrl,
                                         event_data_t value ) {
+  if( _ctrl_output_counts.count( ctrl ) == 0 )
+    return;
+
   if( _target_ctrl_values[ctrl] != value ) {
     _target_ctrl_values[ctrl] = value;
     adjust_ctrl_values( _target_ctrl_values );
@@ -190,6 +206,31 @@ void MidiTranslator::reset() {
   _note_velocities = vector<event_data_t>( 128, 0 );
 }
 
+/**
+ * Get the state that continues from one pass to the next, for checkpoints.
+ */
+MidiTranslatorState MidiTranslator::get_state() const {
+  MidiTranslatorState state;
+
+  state.previous_target = _previous_target;
+  state.last_event_type = _last_event_type;
+  state.last_pitch = _last_pitch;
+  state.last_velocity = _last_velocity;
+  state.last_interval = _last_interval;
+
+  return state;
+}
+
+void MidiTranslator::set_state( const MidiTranslatorState& state ) {
+  if( state.previous_target.size() != _previous_target.size() )
+    throw out_of_range( "Translator state does not match the translator" );
+
+  _previous_target = state.previous_target;
+  _last_event_type = state.last_event_type;
+  _last_pitch = state.last_pitch;
+  _last_velocity = state.last_velocity;
+  _last_interval = state.last_interval;
+}
 
 size_t MidiTranslator::index_of_closest_value( vector<double> spaced_values,
                                                event_data_t ctrl_value ) {
@@ -37,6 +37,18 @@ namespace larasynth {
 
 enum feedback_source { OUTPUT_SOURCE, TARGET_SOURCE, NO_FEEDBACK_SOURCE };
 
+/**
+ * The parts of a translator's state that reset() leaves alone, so that they
+ * carry over from one pass through the training stream to the next.
+ */
+struct MidiTranslatorState {
+  std::vector<double> previous_target;
+  event_data_t last_event_type = NO_EVENT;
+  event_data_t last_pitch = NOTE_MAX + 1;
+  event_data_t last_velocity = 0;
+  int last_interval = 0;
+};
+
 class MidiTranslator {
 public:
   MidiTranslator( const std::unordered_map<event_data_t,size_t>&
@@ -66,6 +78,9 @@ public:
 
   void reset();
 
+  MidiTranslatorState get_state() const;
+  void set_state( const MidiTranslatorState& state );
+
   void ctrl_vals_and_hot_output( const std::vector<double>& output,
                                  std::unordered_map<event_data_t,
                                  event_data_t>& ctrl_values,
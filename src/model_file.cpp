@@ -0,0 +1,240 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <algorithm>
+
+#include "model_file.hpp"
+#include "byte_buffer.hpp"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+// version of the user data layout, independent of the network format version
+static const uint64_t MODEL_USER_DATA_VERSION = 3;
+
+ModelFile::ModelFile( const string& filename )
+  : _filename( filename )
+  , _update_rate( 0 )
+  , _act_impl( EXACT_ACT_FUNCS )
+  , _step_order( UNIT_STEP_ORDER )
+{
+  try {
+    _file.reset( new MappedFile( _filename ) );
+    _importer.reset( new BinaryImporter( _file->data(), _file->size() ) );
+  }
+  catch( const FilesystemException& e ) {
+    throw ModelFileException( e.what() );
+  }
+  catch( const BinaryImporterException& e ) {
+    throw ModelFileException( _filename + ": " + e.what() );
+  }
+
+  read_user_data();
+}
+
+/**
+ * Get the name of the model file that accompanies a training results file.
+ */
+string ModelFile::get_model_filename( const string& results_filename ) {
+  return replace_extension( results_filename, ".model" );
+}
+
+/**
+ * Get the name of the model file for one group of results trained for
+ * controller groups. Grouped results have no model file of their own.
+ */
+string ModelFile::get_group_model_filename( const string& results_filename,
+                                            size_t group_i ) {
+  return replace_extension( results_filename,
+                            "-group-" + to_string( group_i + 1 ) + ".model" );
+}
+
+/**
+ * Count the group model files that accompany a training results file, which
+ * is 0 for results that were not trained for controller groups or were
+ * written before group model files existed.
+ */
+size_t ModelFile::get_group_model_count( const string& results_filename ) {
+  size_t count = 0;
+
+  while( is_regular_file( get_group_model_filename( results_filename,
+                                                    count ) ) )
+    ++count;
+
+  return count;
+}
+
+/**
+ * Get the trained network, set up to calculate its activation functions and
+ * its units the way it was trained.
+ */
+LstmNetwork ModelFile::get_trained_network() {
+  try {
+    LstmNetwork net( *_importer, false );
+
+    net.set_act_impl( _act_impl );
+    net.set_step_order( _step_order );
+
+    if( !_levels.empty() )
+      net.set_levels( _levels );
+
+    return net;
+  }
+  catch( const BinaryImporterException& e ) {
+    throw ModelFileException( _filename + ": " + e.what() );
+  }
+  catch( const out_of_range& e ) {
+    throw ModelFileException( _filename + ": " + e.what() );
+  }
+}
+
+RepresentationConfig ModelFile::get_repr_config() const {
+  return RepresentationConfig( _ctrl_output_counts_list, _update_rate,
+                               _feature_config );
+}
+
+void ModelFile::read_user_data() {
+  string bytes = _importer->get_user_data();
+  ByteReader<ModelFileException> reader( bytes.data(), bytes.size(),
+                                         "Model user data is truncated" );
+
+  uint64_t version = reader.read_u64();
+
+  if( version < 1 || version > MODEL_USER_DATA_VERSION )
+    throw ModelFileException( _filename + ": unsupported model version" );
+
+  _min_max.set_note_min( reader.read_u64() );
+  _min_max.set_note_max( reader.read_u64() );
+
+  for( size_t ctrl = 0; ctrl < 128; ++ctrl ) {
+    _min_max.set_ctrl_min( ctrl, reader.read_u64() );
+    _min_max.set_ctrl_max( ctrl, reader.read_u64() );
+  }
+
+  _update_rate = reader.read_u64();
+  _feature_config = feature_config_t( reader.read_u64() );
+
+  uint64_t ctrl_count = reader.read_u64();
+
+  if( ctrl_count > 128 )
+    throw ModelFileException( _filename + ": invalid controller count" );
+
+  for( size_t i = 0; i < ctrl_count * 2; ++i )
+    _ctrl_output_counts_list.push_back( reader.read_u64() );
+
+  // version 1 models were always trained with exact activation functions in
+  // unit order
+  if( version >= 2 ) {
+    _act_impl = lstm_act_impl_t( reader.read_u64() );
+    _step_order = lstm_step_order_t( reader.read_u64() );
+
+    if( _act_impl >= NO_ACT_FUNCS || _step_order >= NO_STEP_ORDER )
+      throw ModelFileException( _filename + ": invalid network settings" );
+  }
+
+  // the levels are stored since a pruned network's levels can not be worked
+  // out from its connections
+  if( version >= 3 ) {
+    uint64_t level_count = reader.read_u64();
+
+    for( size_t l = 0; l < level_count; ++l ) {
+      uint64_t unit_count = reader.read_u64();
+
+      if( unit_count > reader.get_remaining_size() / sizeof( uint64_t ) )
+        throw ModelFileException( _filename + ": invalid level size" );
+
+      _levels.emplace_back();
+
+      for( size_t i = 0; i < unit_count; ++i )
+        _levels.back().push_back( reader.read_u64() );
+    }
+  }
+}
+
+/**
+ * Write a model file. The file is written under a temporary name and renamed
+ * into place, so a partially written model is never picked up.
+ */
+void ModelFile::write( const string& filename, const LstmNetwork& net,
+                       const MidiMinMax& min_max,
+                       const RepresentationConfig& repr_config ) {
+  string user_data;
+
+  append_u64( user_data, MODEL_USER_DATA_VERSION );
+
+  append_u64( user_data, min_max.get_note_min() );
+  append_u64( user_data, min_max.get_note_max() );
+
+  for( size_t ctrl = 0; ctrl < 128; ++ctrl ) {
+    append_u64( user_data, min_max.get_ctrl_min( ctrl ) );
+    append_u64( user_data, min_max.get_ctrl_max( ctrl ) );
+  }
+
+  append_u64( user_data, repr_config.get_update_rate() );
+  append_u64( user_data, repr_config.get_input_feature_config().to_ullong() );
+
+  vector< pair<event_data_t, size_t> > ctrl_output_counts;
+
+  for( const auto& kv : repr_config.get_ctrl_output_counts() )
+    ctrl_output_counts.push_back( kv );
+
+  sort( ctrl_output_counts.begin(), ctrl_output_counts.end() );
+
+  append_u64( user_data, ctrl_output_counts.size() );
+
+  for( auto& kv : ctrl_output_counts ) {
+    append_u64( user_data, kv.first );
+    append_u64( user_data, kv.second );
+  }
+
+  append_u64( user_data, net.get_act_impl() );
+  append_u64( user_data, net.get_step_order() );
+
+  const vector< vector<Id_t> >& levels = net.get_levels();
+
+  append_u64( user_data, levels.size() );
+
+  for( auto& level : levels ) {
+    append_u64( user_data, level.size() );
+
+    for( Id_t id : level )
+      append_u64( user_data, id );
+  }
+
+  BinaryExporter exporter;
+  net.export_network( exporter );
+  exporter.set_user_data( user_data );
+
+  string bytes = exporter.get_bytes();
+  string temp_filename = filename + ".tmp";
+
+  {
+    ofstream outfile( temp_filename, ios::binary | ios::trunc );
+    outfile.write( bytes.data(), bytes.size() );
+
+    if( !outfile )
+      throw ModelFileException( "Error writing " + temp_filename );
+  }
+
+  if( rename( temp_filename.c_str(), filename.c_str() ) != 0 )
+    throw ModelFileException( "Error renaming " + temp_filename + " to " +
+                              filename );
+}
@@ -0,0 +1,91 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+#include "littlelstm/lstm_network.hpp"
+#include "littlelstm/binary_exporter.hpp"
+#include "littlelstm/binary_importer.hpp"
+#include "midi_min_max.hpp"
+#include "representation_config.hpp"
+#include "filesystem_operations.hpp"
+
+namespace larasynth {
+
+class ModelFileException : public std::runtime_error {
+public:
+  explicit ModelFileException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * A trained model in binary form: the network in the littlelstm binary
+ * network format, with the MIDI min/max values, the representation
+ * configuration, and the activation functions, step order and levels the
+ * network was trained with stored in its user data. This is everything
+ * needed to perform with the model.
+ *
+ * Model files are written next to the JSON training results (see
+ * get_model_filename()), one for each group of results trained for controller
+ * groups (see get_group_model_filename()). Reading one memory maps the file,
+ * so loading the network does not involve any parsing.
+ */
+class ModelFile {
+public:
+  explicit ModelFile( const std::string& filename );
+
+  littlelstm::LstmNetwork get_trained_network();
+  MidiMinMax get_min_max() const { return _min_max; }
+  RepresentationConfig get_repr_config() const;
+
+  static void write( const std::string& filename,
+                     const littlelstm::LstmNetwork& net,
+                     const MidiMinMax& min_max,
+                     const RepresentationConfig& repr_config );
+
+  static std::string get_model_filename( const std::string&
+                                         results_filename );
+  static std::string get_group_model_filename( const std::string&
+                                               results_filename,
+                                               size_t group_i );
+  static size_t get_group_model_count( const std::string& results_filename );
+
+private:
+  void read_user_data();
+
+  std::string _filename;
+
+  std::unique_ptr<MappedFile> _file;
+  std::unique_ptr<littlelstm::BinaryImporter> _importer;
+
+  MidiMinMax _min_max;
+  std::vector<size_t> _ctrl_output_counts_list;
+  size_t _update_rate;
+  feature_config_t _feature_config;
+  littlelstm::lstm_act_impl_t _act_impl;
+  littlelstm::lstm_step_order_t _step_order;
+  std::vector< std::vector<Id_t> > _levels;
+};
+
+}
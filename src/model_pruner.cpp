@@ -0,0 +1,204 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+#include <cmath>
+
+#include "model_pruner.hpp"
+#include "config_parser.hpp"
+#include "midi_config.hpp"
+#include "midi_translator.hpp"
+#include "representation_config.hpp"
+#include "training_config.hpp"
+#include "training_event_stream.hpp"
+#include "training_results.hpp"
+#include "model_file.hpp"
+#include "results_index.hpp"
+#include "lstm_config.hpp"
+#include "lstm_trainer.hpp"
+#include "filesystem_operations.hpp"
+#include "time_utilities.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "littlelstm/network_pruner.hpp"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+/**
+ * The pruned results are named after the original results and the sparsity
+ * in percent, e.g. results-....-pruned-50.json.
+ */
+string ModelPruner::get_pruned_results_filename( const string&
+                                                 results_filename,
+                                                 double sparsity ) {
+  return replace_extension( results_filename,
+                            "-pruned-" +
+                            to_string( (int)round( sparsity * 100.0 ) ) +
+                            ".json" );
+}
+
+ModelPruner::ModelPruner( const string& config_directory_path,
+                          const string& results_filename,
+                          const PruningConfig& config,
+                          volatile sig_atomic_t* shutdown_flag )
+  : _pruned_results_filename( get_pruned_results_filename( results_filename,
+                                                           config.sparsity )
+                              )
+{
+  if( config.sparsity < 0.0 || config.sparsity >= 1.0 )
+    throw ModelPrunerException( "The sparsity must be at least 0 and less "
+                                "than 1" );
+
+  ConfigDirectory dir( config_directory_path );
+  dir.process_directory();
+
+  if( !dir.training_examples_exist() )
+    throw ModelPrunerException( "There are no training examples in the "
+                                "directory " + config_directory_path );
+
+  ConfigParser cp( dir.get_config_file_path() );
+
+  ConfigParameters lstm_params = cp.get_section_params( "lstm" );
+  ConfigParameters midi_params = cp.get_section_params( "midi" );
+  ConfigParameters training_params = cp.get_section_params( "training" );
+
+  LstmConfig lstm_config( lstm_params );
+  MidiConfig midi_config( midi_params );
+  TrainingConfig training_config( training_params );
+
+  TrainingResults results( results_filename, READ_RESULTS );
+
+  // the network is read from the binary model file if there is one, since
+  // that is faster
+  string model_filename = ModelFile::get_model_filename( results_filename );
+
+  unique_ptr<ModelFile> model;
+
+  if( is_regular_file( model_filename ) )
+    model.reset( new ModelFile( model_filename ) );
+
+  MidiMinMax min_max = model ? model->get_min_max() : results.get_min_max();
+  RepresentationConfig repr_config = model ? model->get_repr_config()
+                                           : results.get_repr_config();
+  LstmNetwork net = model ? model->get_trained_network()
+                          : results.get_trained_network();
+
+  net.set_step_thread_count( lstm_config.get_step_thread_count() );
+
+  // the pruned network is fine-tuned and written with the activation
+  // functions and step order the network was trained with
+  lstm_config.set_act_impl( net.get_act_impl() );
+  lstm_config.set_step_order( net.get_step_order() );
+
+  vector<size_t> block_counts = results.get_block_counts();
+  vector<lstm_block_t> block_types = results.get_block_types();
+
+  vector<Index_t> unit_layers;
+
+  if( config.per_layer ) {
+    LstmArchitecture arch( net.get_input_size(), net.get_output_size(),
+                           block_counts, block_types );
+    unit_layers = NetworkPruner::get_unit_layers( arch );
+  }
+
+  ExamplePlayer player( dir.get_training_example_filenames(), midi_config,
+                        repr_config, min_max );
+
+  _report.connection_count = net.get_connection_weights().size();
+  _report.mse = player.calculate_mse( net );
+
+  LstmNetwork pruned_net =
+    NetworkPruner::prune( net, config.sparsity, unit_layers,
+                          config.fine_tune_epoch_count > 0 );
+
+  _report.remaining_connection_count =
+    pruned_net.get_connection_weights().size();
+  _report.pruned_mse = player.calculate_mse( pruned_net );
+  _report.fine_tuned_mse = _report.pruned_mse;
+
+  size_t epoch = results.get_json()["epoch"];
+
+  if( config.fine_tune_epoch_count > 0 ) {
+    size_t update_period =
+      MICROSECONDS_PER_SECOND / repr_config.get_update_rate();
+
+    TrainingEventStream stream( update_period,
+                                training_config.get_tempo_adjustment_factor(),
+                                training_config.get_tempo_jitter_factor(),
+                                training_config.get_mean_padding(),
+                                training_config.get_padding_stddev(),
+                                midi_config.get_ctrl_defaults() );
+    stream.add_examples( dir.get_training_example_filenames() );
+
+    MidiTranslator translator( repr_config.get_ctrl_output_counts(),
+                               repr_config.get_input_feature_config(),
+                               midi_config.get_ctrl_defaults(), min_max,
+                               TRAIN );
+
+    LstmTrainer trainer( pruned_net, stream, training_config, lstm_config,
+                         translator, update_period );
+
+    // learning rate schedules carry on from where training stopped
+    trainer.restore( epoch, 0, "", LearningRateScheduleState() );
+
+    ConnectionWeights_t best_weights = pruned_net.get_connection_weights();
+
+    while( _report.fine_tune_epoch_count < config.fine_tune_epoch_count &&
+           !*shutdown_flag ) {
+      trainer.run_training_epoch();
+      ++_report.fine_tune_epoch_count;
+
+      double mse = player.calculate_mse( pruned_net );
+
+      if( mse < _report.fine_tuned_mse ) {
+        _report.fine_tuned_mse = mse;
+        best_weights = pruned_net.get_connection_weights();
+      }
+    }
+
+    pruned_net.set_connection_weights( best_weights );
+    epoch = trainer.get_epoch();
+  }
+
+  LstmResult result( epoch,
+                     training_config.get_validation_trace_sample_limit() );
+  player.calculate_mse( pruned_net, &result );
+
+  TrainingResults pruned_results( _pruned_results_filename, WRITE_RESULTS );
+
+  lstm_config.set_block_counts( block_counts, block_types );
+
+  pruned_results.add_network( pruned_net );
+  pruned_results.add_lstm_config( lstm_config );
+  pruned_results.add_repr_config( repr_config );
+  pruned_results.add_training_config( training_config );
+  pruned_results.add_min_max( min_max );
+  pruned_results.add_result( std::move( result ),
+                             training_config
+                             .get_validation_trace_sample_limit() );
+
+  pruned_results.write();
+
+  ModelFile::write( ModelFile::get_model_filename( _pruned_results_filename ),
+                    pruned_net, min_max, repr_config );
+
+  ResultsIndex::add_entry( dir.get_training_results_directory_name(),
+                           pruned_results.get_index_entry() );
+}
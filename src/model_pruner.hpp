@@ -0,0 +1,98 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <csignal>
+#include <stdexcept>
+
+#include "config_directory.hpp"
+#include "example_player.hpp"
+#include "littlelstm/lstm_network.hpp"
+
+namespace larasynth {
+
+class ModelPrunerException : public std::runtime_error {
+public:
+  explicit ModelPrunerException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+struct PruningConfig {
+  // fraction of the connections to remove
+  double sparsity = 0.5;
+  // rank the connections within each layer instead of across the network
+  bool per_layer = false;
+  // epochs of training after pruning, 0 for none
+  size_t fine_tune_epoch_count = 0;
+};
+
+struct PruningReport {
+  size_t connection_count = 0;
+  size_t remaining_connection_count = 0;
+
+  // the MSE over the training examples before pruning, right after pruning,
+  // and after fine-tuning, which is the same as pruned_mse without it
+  double mse = 0.0;
+  double pruned_mse = 0.0;
+  double fine_tuned_mse = 0.0;
+  size_t fine_tune_epoch_count = 0;
+
+  double get_sparsity() const {
+    return connection_count == 0 ? 0.0 :
+      1.0 - (double)remaining_connection_count / connection_count;
+  }
+};
+
+/**
+ * Prunes the network in training results with NetworkPruner, optionally
+ * fine-tunes the pruned network with LstmTrainer using the project's [lstm]
+ * and [training] sections, and writes the result as new training results,
+ * next to the original, that perform, compile and quantize can use like any
+ * other.
+ *
+ * The MSEs are measured by playing the training examples once without any of
+ * the training variations (see ExamplePlayer), so they are the same every
+ * time and can be compared with each other, but not with the MSE of
+ * validation during training. Fine-tuning keeps the weights with the lowest
+ * MSE, which are the pruned weights if no epoch improves on them.
+ */
+class ModelPruner {
+public:
+  ModelPruner( const std::string& config_directory_path,
+               const std::string& results_filename,
+               const PruningConfig& config,
+               volatile sig_atomic_t* shutdown_flag );
+
+  const PruningReport& get_report() const { return _report; }
+  const std::string& get_pruned_results_filename() const
+  { return _pruned_results_filename; }
+
+  static std::string get_pruned_results_filename( const std::string&
+                                                  results_filename,
+                                                  double sparsity );
+
+private:
+  PruningReport _report;
+  std::string _pruned_results_filename;
+};
+
+}
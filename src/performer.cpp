@@ -18,33 +18,40 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "performer.hpp"
+#include "trace.hpp"
 
 using namespace std;
 using namespace larasynth;
 using namespace littlelstm;
 
-Performer::Performer( MidiClient* midi_client, LstmNetwork& network,
+Performer::Performer( MidiClient* midi_client,
+                      const vector<PerformingNetwork>& networks,
                       MidiConfig& midi_config,
-                      RepresentationConfig& repr_config,
-                      MidiMinMax& min_max,
                       volatile sig_atomic_t* shutdown_flag, bool verbose )
   : _midi_client( midi_client )
-  , _network( network )
   , _ctrls( midi_config.get_ctrls() )
   , _shutdown_flag( shutdown_flag )
   , _verbose( verbose )
 {
-  MidiTranslator translator( repr_config.get_ctrl_output_counts(),
-                             repr_config.get_input_feature_config(),
-                             midi_config.get_ctrl_defaults(),
-                             min_max, PERFORM );
+  for( auto& performing_net : networks ) {
+    const RepresentationConfig& repr_config = performing_net.repr_config;
+
+    _networks.push_back( performing_net.network );
+    _translators.emplace_back( repr_config.get_ctrl_output_counts(),
+                               repr_config.get_input_feature_config(),
+                               midi_config.get_ctrl_defaults(),
+                               performing_net.min_max, PERFORM );
+    _net_inputs.emplace_back( performing_net.network->get_input_size(), 0.0 );
+  }
 
   Event* event;
 
   ctrl_values_t current_ctrl_vals;  
   ctrl_values_t new_ctrl_vals;
 
-  size_t period = MICROSECONDS_PER_SECOND / repr_config.get_update_rate();
+  // the networks of controller groups are trained with the same update rate
+  size_t period = MICROSECONDS_PER_SECOND /
+    networks.at( 0 ).repr_config.get_update_rate();
 
   cout << "Performing with an update interval of " << period << " microseconds"
        << endl;
@@ -54,13 +61,12 @@ Performer::Performer( MidiClient* midi_client, LstmNetwork& network,
   deque<Event*> notes_to_play;
   deque<Event*> events_to_forward;
 
-  _net_input = vector<double>( _network.get_input_size(), 0.0 );
-  vector<Real_t> net_output( _network.get_output_size(), 0.0 );
-
-  translator.fill_target( net_output );
+  TRACE_THREAD_NAME( "performer" );
 
   while( !*_shutdown_flag ) {
     while( _midi_client->has_input_event() ) {
+      TRACE_SCOPE( "handle input event" );
+
       event = _midi_client->get_input_event();
 
       if( event->type() == NOTE_ON || event->type() == NOTE_OFF ) {
@@ -69,8 +75,9 @@ Performer::Performer( MidiClient* midi_client, LstmNetwork& network,
         }
 
         notes_to_play.push_back( event );
-        translator.report_note_event( event );
-        new_ctrl_vals = get_ctrl_values_from_network( translator );
+        for( auto& translator : _translators )
+          translator.report_note_event( event );
+        new_ctrl_vals = get_ctrl_values_from_networks();
       }
       // an event that is not a note event, and not one of the controllers
       // larasynth is controlling, should be forwarded on
@@ -85,6 +92,8 @@ Performer::Performer( MidiClient* midi_client, LstmNetwork& network,
     }
 
     if( !notes_to_play.empty() ) {
+      TRACE_SCOPE( "play notes" );
+
       next_update_time = current_microseconds() + period;
 
       set_ctrls( current_ctrl_vals, new_ctrl_vals );
@@ -99,8 +108,10 @@ Performer::Performer( MidiClient* midi_client, LstmNetwork& network,
       usleep(1);
     }
     else {
+      TRACE_SCOPE( "periodic update" );
+
       next_update_time = current_microseconds() + period;
-      new_ctrl_vals = get_ctrl_values_from_network( translator );
+      new_ctrl_vals = get_ctrl_values_from_networks();
       set_ctrls( current_ctrl_vals, new_ctrl_vals );
     }
   }
@@ -108,17 +119,24 @@ Performer::Performer( MidiClient* midi_client, LstmNetwork& network,
   cout << endl << "Shutting down." << endl;
 }
 
-ctrl_values_t
-Performer::get_ctrl_values_from_network( MidiTranslator& translator ) {
-  translator.fill_input( _net_input, OUTPUT_SOURCE );
+/**
+ * Run every network once and collect the controller values of all of them.
+ */
+ctrl_values_t Performer::get_ctrl_values_from_networks() {
+  TRACE_SCOPE( "get_ctrl_values_from_networks" );
 
-  _network.feed_forward( _net_input );
+  ctrl_values_t ctrl_values;
 
-  vector<double> net_output = _network.get_output();
+  for( size_t i = 0; i < _networks.size(); ++i ) {
+    _translators[i].fill_input( _net_inputs[i], OUTPUT_SOURCE );
+    _networks[i]->feed_forward( _net_inputs[i] );
+    _translators[i].report_output( _networks[i]->get_output() );
 
-  translator.report_output( net_output );
+    for( auto& kv : _translators[i].get_output_ctrl_values() )
+      ctrl_values[kv.first] = kv.second;
+  }
 
-  return translator.get_output_ctrl_values();
+  return ctrl_values;
 }
 
 
@@ -165,6 +183,8 @@ void Performer::forward_events( deque<Event*>& events_to_forward ) {
 void
 Performer::set_ctrls( unordered_map<event_data_t,event_data_t>& old_vals,
                       unordered_map<event_data_t,event_data_t>& new_vals ) {
+  TRACE_SCOPE( "set_ctrls" );
+
   Event ctrl_event;
 
   for( auto ctrl : _ctrls ) {
@@ -31,20 +31,37 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #include "midi_config.hpp"
 #include "midi_translator.hpp"
 #include "representation_config.hpp"
-#include "littlelstm/lstm_network.hpp"
+#include "littlelstm/feed_forward_network.hpp"
 #include "time_utilities.hpp"
 
 namespace larasynth {
 
+/**
+ * A network to perform with, and the representation and min/max it was
+ * trained with.
+ */
+struct PerformingNetwork {
+  littlelstm::FeedForwardNetwork* network;
+  RepresentationConfig repr_config;
+  MidiMinMax min_max;
+};
+
+/**
+ * Controls a synthesizer's controllers with trained networks while notes are
+ * played. Usually there is one network for all of the controllers, but
+ * results trained for controller groups have a network for each group. Each
+ * network has its own translator, and on every update the networks are run
+ * one after the other and each sets its own group's controllers.
+ */
 class Performer {
 public:
-  Performer( MidiClient* midi_client, littlelstm::LstmNetwork& network,
-             MidiConfig& midi_config, RepresentationConfig& repr_config,
-             MidiMinMax& min_max, volatile sig_atomic_t* shutdown_flag,
+  Performer( MidiClient* midi_client,
+             const std::vector<PerformingNetwork>& networks,
+             MidiConfig& midi_config, volatile sig_atomic_t* shutdown_flag,
              bool verbose );
 
 private:
-  ctrl_values_t get_ctrl_values_from_network( MidiTranslator& translator );
+  ctrl_values_t get_ctrl_values_from_networks();
   void set_ctrls( ctrl_values_t& old_vals, ctrl_values_t& new_vals );
   void play_notes( std::deque<Event*>& notes_to_play );
   void forward_events( std::deque<Event*>& events_to_forward );
@@ -52,13 +69,15 @@ private:
   void return_events( std::deque<Event*>& events );
 
   MidiClient* _midi_client;
-  littlelstm::LstmNetwork& _network;
+
+  std::vector<littlelstm::FeedForwardNetwork*> _networks;
+  std::vector<MidiTranslator> _translators;
 
   EventPool _event_pool;
   
   std::vector<event_data_t> _ctrls;
 
-  std::vector<double> _net_input;
+  std::vector< std::vector<double> > _net_inputs;
 
   volatile sig_atomic_t* _shutdown_flag;
 
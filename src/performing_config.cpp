@@ -24,6 +24,7 @@ using namespace larasynth;
 
 PerformingConfig::PerformingConfig( ConfigParameters& config_params )
   : _training_results_filename( "" )
+  , _weight_bits( DEFAULT_WEIGHT_BITS )
 {
   try {
     config_params.set_var( "training_results", _training_results_filename );
@@ -34,6 +35,19 @@ PerformingConfig::PerformingConfig( ConfigParameters& config_params )
     throw PerformingConfigException( e.what() );
   }
 
+  try {
+    config_params.set_var( "weight_bits", _weight_bits, (size_t)0,
+                           (size_t)16 );
+  }
+  catch( UndefinedParameterException& e ) {
+  }
+  catch( ConfigParameterException& e ) {
+    throw PerformingConfigException( e.what() );
+  }
+
+  if( _weight_bits != 0 && _weight_bits != 8 && _weight_bits != 16 )
+    throw PerformingConfigException( "weight_bits must be 0, 8 or 16" );
+
   for( const string& name : config_params.get_unset_params() )
     throw PerformingConfigException( "Unknown parameter " + name );
 }
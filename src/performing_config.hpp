@@ -26,6 +26,8 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 
 namespace larasynth {
 
+static const size_t DEFAULT_WEIGHT_BITS = 0;
+
 class PerformingConfigException : public std::runtime_error {
 public:
   PerformingConfigException( const std::string& message )
@@ -39,9 +41,11 @@ public:
 
   std::string get_training_results_filename()
   { return _training_results_filename; }
+  size_t get_weight_bits() { return _weight_bits; }
 
 private:
   std::string _training_results_filename;
+  size_t _weight_bits;
 };
 
 }
@@ -0,0 +1,134 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+
+#include "quantized_model.hpp"
+#include "filesystem_operations.hpp"
+#include "json/json.hpp"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+string QuantizedModel::get_calibration_filename( const string&
+                                                 results_filename ) {
+  return replace_extension( results_filename, ".calibration" );
+}
+
+/**
+ * Find the range of the network's inputs and cell states while it plays the
+ * training examples.
+ */
+QuantizationCalibration QuantizedModel::calibrate( ExamplePlayer& player,
+                                                   LstmNetwork& net ) {
+  QuantizationCalibration calibration;
+
+  player.play( { &net }, [&]( const vector<ExampleStep>& steps ) {
+      calibration.record( steps[0].input, net.get_cell_states() );
+    } );
+
+  return calibration;
+}
+
+QuantizationReport QuantizedModel::compare( ExamplePlayer& player,
+                                            LstmNetwork& net,
+                                            QuantizedNetwork& quantized_net ) {
+  QuantizationReport report;
+  report.weight_bits = quantized_net.get_weight_bits();
+  report.weight_bytes = quantized_net.get_weight_bytes();
+
+  report.comparison = player.compare( net, quantized_net );
+
+  return report;
+}
+
+void QuantizedModel::write_calibration( const string& results_filename,
+                                        const QuantizationCalibration&
+                                        calibration ) {
+  nlohmann::json json;
+
+  json["update_count"] = calibration.update_count;
+  json["max_abs_inputs"] = calibration.max_abs_inputs;
+  json["max_abs_states"] = nlohmann::json::object();
+
+  for( auto& kv : calibration.max_abs_states )
+    json["max_abs_states"][to_string( kv.first )] = kv.second;
+
+  string filename = get_calibration_filename( results_filename );
+
+  ofstream out( filename );
+  out << json.dump( 2 ) << endl;
+  out.close();
+
+  if( !out )
+    throw QuantizedModelException( "Error writing " + filename );
+}
+
+QuantizationCalibration
+QuantizedModel::read_calibration( const string& results_filename ) {
+  string filename = get_calibration_filename( results_filename );
+
+  ifstream in( filename );
+
+  if( !in )
+    throw QuantizedModelException( filename + " does not exist. Run quantize "
+                                   "first." );
+
+  QuantizationCalibration calibration;
+
+  try {
+    nlohmann::json json;
+    in >> json;
+
+    calibration.update_count = json.at( "update_count" ).get<size_t>();
+    calibration.max_abs_inputs =
+      json.at( "max_abs_inputs" ).get< vector<double> >();
+
+    for( auto it = json.at( "max_abs_states" ).begin();
+         it != json.at( "max_abs_states" ).end(); ++it )
+      calibration.max_abs_states[stoul( it.key() )] = it.value().get<double>();
+  }
+  catch( const exception& e ) {
+    throw QuantizedModelException( "Error reading " + filename + ": " +
+                                   e.what() );
+  }
+
+  return calibration;
+}
+
+/**
+ * Quantize a trained network with its calibration from lara quantize.
+ */
+unique_ptr<QuantizedNetwork>
+QuantizedModel::load( const string& results_filename, const LstmNetwork& net,
+                      size_t weight_bits ) {
+  QuantizationCalibration calibration = read_calibration( results_filename );
+
+  try {
+    return unique_ptr<QuantizedNetwork>( new QuantizedNetwork( net,
+                                                               calibration,
+                                                               weight_bits ) );
+  }
+  catch( const QuantizedNetworkException& e ) {
+    throw QuantizedModelException( e.what() );
+  }
+}
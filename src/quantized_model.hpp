@@ -0,0 +1,82 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include <stdexcept>
+
+#include "example_player.hpp"
+#include "littlelstm/lstm_network.hpp"
+#include "littlelstm/quantized_network.hpp"
+
+namespace larasynth {
+
+class QuantizedModelException : public std::runtime_error {
+public:
+  explicit QuantizedModelException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * How closely a quantized network follows the network it was quantized
+ * from over the training examples, and the size of its weights.
+ */
+struct QuantizationReport {
+  size_t weight_bits = 0;
+  size_t weight_bytes = 0;
+  NetworkComparison comparison;
+};
+
+/**
+ * A trained network quantized by lara quantize. The calibration, which is
+ * the range of every input and every cell state over the training examples,
+ * is written next to the JSON training results:
+ *
+ *   results-....calibration
+ *
+ * The quantized network itself is built from the calibration and the trained
+ * network each time it is loaded, since that is fast.
+ */
+class QuantizedModel {
+public:
+  static littlelstm::QuantizationCalibration
+  calibrate( ExamplePlayer& player, littlelstm::LstmNetwork& net );
+
+  static QuantizationReport compare( ExamplePlayer& player,
+                                     littlelstm::LstmNetwork& net,
+                                     littlelstm::QuantizedNetwork&
+                                     quantized_net );
+
+  static void write_calibration( const std::string& results_filename,
+                                 const littlelstm::QuantizationCalibration&
+                                 calibration );
+  static littlelstm::QuantizationCalibration
+  read_calibration( const std::string& results_filename );
+
+  static std::unique_ptr<littlelstm::QuantizedNetwork>
+  load( const std::string& results_filename,
+        const littlelstm::LstmNetwork& net, size_t weight_bits );
+
+  static std::string get_calibration_filename( const std::string&
+                                               results_filename );
+};
+
+}
@@ -38,8 +38,19 @@ RepresentationConfig::RepresentationConfig( vector<size_t>
 
 RepresentationConfig::RepresentationConfig( ConfigParameters& config_params ) {
   vector<size_t> output_counts;
+  vector<size_t> ctrl_groups;
   vector<string> input_features;
 
+  try {
+    config_params.set_var( "controller_groups", ctrl_groups );
+  }
+  catch( UndefinedParameterException& e ) {
+    // every controller is in one network
+  }
+  catch( runtime_error& e ) {
+    throw RepresentationConfigException( e.what() );
+  }
+
   try {
     config_params.set_var( "controller_output_counts", output_counts );
     config_params.set_var( "update_rate", _update_rate, (size_t)1,
@@ -86,6 +97,8 @@ RepresentationConfig::RepresentationConfig( ConfigParameters& config_params ) {
     _ctrl_output_counts[ctrl] = count;
   }
 
+  set_ctrl_groups( ctrl_groups );
+
   for( string& feature : input_features ) {
     if( feature_string_to_type.count( feature ) )
       _input_feature_config.set( feature_string_to_type.at( feature ), 1 );
@@ -103,6 +116,81 @@ RepresentationConfig::RepresentationConfig( ConfigParameters& config_params ) {
     throw RepresentationConfigException( "Unknown parameter " + name );
 }
 
+/**
+ * Set the controller groups from a list of controller and group number
+ * pairs. Every controller with outputs must be in exactly one group, and the
+ * groups are ordered by their numbers. Putting every controller in the same
+ * group is the same as not grouping them.
+ */
+void
+RepresentationConfig::set_ctrl_groups( const vector<size_t>& ctrl_groups_list )
+{
+  if( ctrl_groups_list.size() % 2 != 0 )
+    throw RepresentationConfigException(
+      "Controller groups are set like so:\ncontroller_groups: <ctrl 1>, "
+      "<ctrl 1 group>, <ctrl 2>, <ctrl 2 group> ..." );
+
+  map< size_t, vector<event_data_t> > groups;
+  set<size_t> grouped_ctrls;
+
+  for( size_t i = 0; i < ctrl_groups_list.size(); i += 2 ) {
+    size_t ctrl = ctrl_groups_list[i];
+    size_t group = ctrl_groups_list[i+1];
+
+    if( _ctrl_output_counts.count( ctrl ) == 0 ) {
+      ostringstream error;
+      error << "Controller " << ctrl << " is in controller_groups but not in "
+            << "controller_output_counts.";
+      throw RepresentationConfigException( error.str() );
+    }
+
+    if( !grouped_ctrls.insert( ctrl ).second ) {
+      ostringstream error;
+      error << "Controller " << ctrl << " is in more than one controller "
+            << "group.";
+      throw RepresentationConfigException( error.str() );
+    }
+
+    groups[group].push_back( ctrl );
+  }
+
+  if( groups.size() < 2 )
+    return;
+
+  for( auto& kv : _ctrl_output_counts ) {
+    if( grouped_ctrls.count( kv.first ) == 0 ) {
+      ostringstream error;
+      error << "Controller " << (unsigned int)kv.first << " is not in any of "
+            << "the controller_groups.";
+      throw RepresentationConfigException( error.str() );
+    }
+  }
+
+  for( auto& kv : groups ) {
+    sort( kv.second.begin(), kv.second.end() );
+    _ctrl_groups.push_back( kv.second );
+  }
+}
+
+/**
+ * Get the representation for the network of a group of controllers, which
+ * has the same update rate and input features but only the group's
+ * controller outputs.
+ */
+RepresentationConfig
+RepresentationConfig::get_group_config( const vector<event_data_t>& ctrls )
+  const {
+  vector<size_t> ctrl_output_counts_list;
+
+  for( event_data_t ctrl : ctrls ) {
+    ctrl_output_counts_list.push_back( ctrl );
+    ctrl_output_counts_list.push_back( _ctrl_output_counts.at( ctrl ) );
+  }
+
+  return RepresentationConfig( ctrl_output_counts_list, _update_rate,
+                               _input_feature_config );
+}
+
 size_t RepresentationConfig::get_total_output_count() const {
   size_t sum = 0;
 
@@ -118,6 +206,17 @@ void RepresentationConfig::print_representation_configuration() {
   for( auto& kv : _ctrl_output_counts )
     cout << "  " << (unsigned int)kv.first << ": " << kv.second << endl;
 
+  if( !_ctrl_groups.empty() ) {
+    cout << "Controller groups:" << endl;
+
+    for( size_t i = 0; i < _ctrl_groups.size(); ++i ) {
+      cout << "  " << i + 1 << ":";
+      for( event_data_t ctrl : _ctrl_groups[i] )
+        cout << " " << (unsigned int)ctrl;
+      cout << endl;
+    }
+  }
+
   cout << "Update rate: " << _update_rate << endl;
 
   cout << "Input features:" << endl;
@@ -23,6 +23,9 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <map>
+#include <set>
+#include <algorithm>
 #include <stdexcept>
 
 #include "midi_types.hpp"
@@ -40,6 +43,14 @@ public:
                      message ) {};
 };
 
+/**
+ * How notes and controller values are represented for the network.
+ *
+ * If controller_groups puts the controllers in more than one group, each
+ * group is trained as its own network (see GroupTrainer). Every group's
+ * network sees the same note input features, but only feeds back and
+ * predicts the controllers in its group, which get_group_config() describes.
+ */
 class RepresentationConfig {
 public:
   RepresentationConfig( std::vector<size_t> ctrl_output_counts_list,
@@ -55,6 +66,11 @@ public:
   { return _ctrl_output_counts.at( ctrl ); }
   size_t get_total_output_count() const;
 
+  const std::vector< std::vector<event_data_t> >& get_ctrl_groups() const
+  { return _ctrl_groups; }
+  RepresentationConfig
+  get_group_config( const std::vector<event_data_t>& ctrls ) const;
+
   size_t get_update_rate() const { return _update_rate; }
   feature_config_t get_input_feature_config() const
   { return _input_feature_config; }
@@ -70,8 +86,13 @@ public:
   { return _input_feature_config[INTERVAL]; }
 
 private:
+  void set_ctrl_groups( const std::vector<size_t>& ctrl_groups_list );
+
   std::unordered_map<event_data_t, size_t> _ctrl_output_counts;
 
+  // empty unless the controllers are split into more than one group
+  std::vector< std::vector<event_data_t> > _ctrl_groups;
+
   size_t _update_rate;
 
   feature_config_t _input_feature_config;
@@ -0,0 +1,167 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+#include "results_index.hpp"
+
+using namespace std;
+using namespace larasynth;
+
+static const string RESULTS_INDEX_HEADER = "larasynth results index 1";
+
+ResultsIndex::ResultsIndex( const string& results_dir_name )
+  : _entries( read_entries( get_index_filename( results_dir_name ) ) )
+{}
+
+string ResultsIndex::get_index_filename( string results_dir_name ) {
+  append_slash_if_necessary( results_dir_name );
+
+  return results_dir_name + "index";
+}
+
+bool ResultsIndex::has_entry( const string& filename ) const {
+  return _entries.count( get_basename( filename ) ) > 0;
+}
+
+const ResultsIndexEntry& ResultsIndex::get_entry( const string& filename )
+  const {
+  auto it = _entries.find( get_basename( filename ) );
+
+  if( it == _entries.end() )
+    throw ResultsIndexException( "No index entry for " + filename );
+
+  return it->second;
+}
+
+vector<ResultsIndexEntry> ResultsIndex::get_entries() const {
+  vector<ResultsIndexEntry> entries;
+
+  for( auto& kv : _entries )
+    entries.push_back( kv.second );
+
+  return entries;
+}
+
+/**
+ * Read the entries in an index file. A missing index has no entries, and
+ * malformed lines are skipped, since the index can always be rebuilt from
+ * the results files themselves.
+ */
+map<string, ResultsIndexEntry>
+ResultsIndex::read_entries( const string& index_filename ) {
+  map<string, ResultsIndexEntry> entries;
+
+  ifstream infile( index_filename );
+
+  if( !infile )
+    return entries;
+
+  string line;
+
+  if( !getline( infile, line ) || line != RESULTS_INDEX_HEADER )
+    return entries;
+
+  while( getline( infile, line ) ) {
+    vector<string> fields;
+    istringstream line_stream( line );
+    string field;
+
+    while( getline( line_stream, field, '\t' ) )
+      fields.push_back( field );
+
+    if( fields.size() != 5 )
+      continue;
+
+    ResultsIndexEntry entry;
+    entry.filename = fields[0];
+    entry.arch = fields[3];
+    entry.timestamp = fields[4];
+
+    try {
+      entry.mse = stod( fields[1] );
+      entry.epoch = stoul( fields[2] );
+    }
+    catch( const logic_error& e ) {
+      continue;
+    }
+
+    entries[entry.filename] = entry;
+  }
+
+  return entries;
+}
+
+/**
+ * Add an entry to the index in a results directory, replacing any existing
+ * entry for the same file.
+ */
+void ResultsIndex::add_entry( const string& results_dir_name,
+                              const ResultsIndexEntry& entry ) {
+  string index_filename = get_index_filename( results_dir_name );
+  string lock_filename = index_filename + ".lock";
+  string temp_filename = index_filename + ".tmp";
+
+  int lock_fd = open( lock_filename.c_str(), O_RDWR | O_CREAT, 0644 );
+
+  if( lock_fd == -1 || flock( lock_fd, LOCK_EX ) == -1 ) {
+    if( lock_fd != -1 )
+      close( lock_fd );
+    throw ResultsIndexException( "Error locking " + lock_filename );
+  }
+
+  map<string, ResultsIndexEntry> entries = read_entries( index_filename );
+
+  ResultsIndexEntry new_entry = entry;
+  new_entry.filename = get_basename( entry.filename );
+  entries[new_entry.filename] = new_entry;
+
+  bool written;
+
+  {
+    ofstream outfile( temp_filename, ios::trunc );
+
+    outfile << RESULTS_INDEX_HEADER << endl;
+    outfile << setprecision( numeric_limits<double>::max_digits10 );
+
+    for( auto& kv : entries ) {
+      const ResultsIndexEntry& e = kv.second;
+      outfile << e.filename << '\t' << e.mse << '\t' << e.epoch << '\t'
+              << e.arch << '\t' << e.timestamp << endl;
+    }
+
+    written = outfile.good();
+  }
+
+  bool renamed = written &&
+    rename( temp_filename.c_str(), index_filename.c_str() ) == 0;
+
+  flock( lock_fd, LOCK_UN );
+  close( lock_fd );
+
+  if( !renamed )
+    throw ResultsIndexException( "Error writing " + index_filename );
+}
@@ -0,0 +1,82 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stdexcept>
+
+#include "filesystem_operations.hpp"
+
+namespace larasynth {
+
+class ResultsIndexException : public std::runtime_error {
+public:
+  explicit ResultsIndexException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * Summary of one training results file.
+ */
+struct ResultsIndexEntry {
+  std::string filename;  // without the directory
+  double mse;
+  size_t epoch;
+  std::string arch;      // e.g. "inputs:12 blocks:4,3 outputs:8"
+  std::string timestamp;
+};
+
+/**
+ * A small index of the training results in a results directory, so the
+ * results can be listed without parsing every results file.
+ *
+ * The index is a text file named "index" in the results directory. Its first
+ * line identifies the format, and each following line is one tab-separated
+ * entry:
+ *
+ *   filename  MSE  epoch  architecture  timestamp
+ *
+ * Entries are added with add_entry(), which holds a lock while it re-reads
+ * the index and replaces it through a rename, so concurrent writers never
+ * lose each other's entries and readers never see a partial file.
+ */
+class ResultsIndex {
+public:
+  explicit ResultsIndex( const std::string& results_dir_name );
+
+  bool has_entry( const std::string& filename ) const;
+  const ResultsIndexEntry& get_entry( const std::string& filename ) const;
+  std::vector<ResultsIndexEntry> get_entries() const;
+
+  static void add_entry( const std::string& results_dir_name,
+                         const ResultsIndexEntry& entry );
+
+  static std::string get_index_filename( std::string results_dir_name );
+
+private:
+  static std::map<std::string, ResultsIndexEntry>
+  read_entries( const std::string& index_filename );
+
+  std::map<std::string, ResultsIndexEntry> _entries;
+};
+
+}
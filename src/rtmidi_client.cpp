@@ -18,6 +18,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "rtmidi_client.hpp"
+#include "trace.hpp"
 
 using namespace std;
 using namespace larasynth;
@@ -163,6 +164,9 @@ void RtMidiClient::throw_exception( string error_msg ) {
 namespace larasynth {
   void input_callback( double delta_time, vector<unsigned char>* message,
                        void* in_q) {
+    TRACE_THREAD_NAME( "midi input" );
+    TRACE_SCOPE( "input_callback" );
+
     static_cast<EventQueue*>( in_q )->push( message );
   }
 }
@@ -0,0 +1,86 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "search_config.hpp"
+
+using namespace std;
+using namespace larasynth;
+
+SearchConfig::SearchConfig( ConfigParameters& params ) {
+  size_t size_t_max = numeric_limits<size_t>::max();
+
+  vector<ConfigVariableToSet<size_t> > optional_size_ts;
+
+  optional_size_ts.emplace_back( "trial_count", &_trial_count,
+                                 DEFAULT_SEARCH_TRIAL_COUNT, (size_t)1,
+                                 size_t_max );
+  optional_size_ts.emplace_back( "initial_epoch_budget",
+                                 &_initial_epoch_budget,
+                                 DEFAULT_SEARCH_INITIAL_EPOCH_BUDGET,
+                                 (size_t)1, size_t_max );
+  optional_size_ts.emplace_back( "reduction_factor", &_reduction_factor,
+                                 DEFAULT_SEARCH_REDUCTION_FACTOR, (size_t)2,
+                                 size_t_max );
+  optional_size_ts.emplace_back( "thread_count", &_thread_count,
+                                 DEFAULT_SEARCH_THREAD_COUNT, (size_t)0,
+                                 size_t_max );
+
+  for( auto& var_to_set : optional_size_ts ) {
+    try {
+      params.set_var( var_to_set.name, *var_to_set.var_ptr, var_to_set.min,
+                      var_to_set.max );
+    }
+    catch( ConfigParameterException& e ) {
+      throw SearchConfigException( e.what() );
+    }
+    catch( UndefinedParameterException& e ) {
+      *var_to_set.var_ptr = var_to_set.default_value;
+    }
+  }
+
+  try {
+    params.set_var( "trial_minutes", _trial_minutes, 0.0,
+                    numeric_limits<double>::max() );
+  }
+  catch( ConfigParameterException& e ) {
+    throw SearchConfigException( e.what() );
+  }
+  catch( UndefinedParameterException& e ) {
+    _trial_minutes = DEFAULT_SEARCH_TRIAL_MINUTES;
+  }
+
+  // any unset parameters are invalid
+  set<string> unset_params = params.get_unset_params();
+  if( unset_params.size() != 0 ) {
+    ostringstream error;
+    error << "Invalid parameter(s): " << endl;
+    for( auto& param : unset_params )
+      error << "  " << param << endl;
+
+    throw SearchConfigException( error.str() );
+  }
+}
+
+void SearchConfig::print_search_configuration() {
+  cout << "Trials:               " << _trial_count << endl;
+  cout << "Initial epoch budget: " << _initial_epoch_budget << endl;
+  cout << "Reduction factor:     " << _reduction_factor << endl;
+  if( _trial_minutes > 0.0 )
+    cout << "Minutes per trial:    " << _trial_minutes << endl;
+}
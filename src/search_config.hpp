@@ -0,0 +1,70 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <vector>
+#include <stdexcept>
+
+#include "config_parameters.hpp"
+#include "config_variable_to_set.hpp"
+#include "search_defaults.hpp"
+
+namespace larasynth {
+
+/**
+ * Thrown if any errors are encountered when constructing the search
+ * configuration from the configuration parameters.
+ */
+class SearchConfigException : public std::runtime_error {
+public:
+  SearchConfigException( const std::string& message )
+    : std::runtime_error( "Error in configuration section [search]:\n" +
+                          message ) {};
+};
+
+/**
+ * Represents the configuration used by `lara search`. Uses the parameters from
+ * the [search] section of a configuration file.
+ *
+ * See search_defaults.hpp for default parameter values.
+ */
+class SearchConfig {
+public:
+  explicit SearchConfig( ConfigParameters& params );
+
+  void print_search_configuration();
+
+  size_t get_trial_count() const { return _trial_count; }
+  size_t get_initial_epoch_budget() const { return _initial_epoch_budget; }
+  size_t get_reduction_factor() const { return _reduction_factor; }
+  double get_trial_minutes() const { return _trial_minutes; }
+  size_t get_thread_count() const { return _thread_count; }
+
+private:
+  size_t _trial_count;
+  size_t _initial_epoch_budget;
+  size_t _reduction_factor;
+  double _trial_minutes;
+  size_t _thread_count;
+};
+
+}
@@ -0,0 +1,32 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace larasynth {
+
+  static const size_t DEFAULT_SEARCH_TRIAL_COUNT = 8;
+  static const size_t DEFAULT_SEARCH_INITIAL_EPOCH_BUDGET = 100;
+  static const size_t DEFAULT_SEARCH_REDUCTION_FACTOR = 2;
+  static const double DEFAULT_SEARCH_TRIAL_MINUTES = 0.0;
+  static const size_t DEFAULT_SEARCH_THREAD_COUNT = 0;
+
+}
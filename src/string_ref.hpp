@@ -0,0 +1,74 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <ostream>
+
+namespace larasynth {
+
+/**
+ * A non-owning reference to a range of characters, used so that tokens can
+ * refer directly into a lexer's buffer instead of each holding a copy.
+ *
+ * The referenced characters must outlive the StringRef.
+ */
+class StringRef {
+public:
+  StringRef() : _data( nullptr ), _size( 0 ) {}
+  StringRef( const char* data, size_t size ) : _data( data ), _size( size ) {}
+  StringRef( const std::string& str )
+    : _data( str.data() ), _size( str.size() ) {}
+
+  const char* data() const { return _data; }
+  size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+
+  const char* begin() const { return _data; }
+  const char* end() const { return _data + _size; }
+
+  char operator[]( size_t i ) const { return _data[i]; }
+
+  std::string str() const { return std::string( _data, _size ); }
+
+  bool starts_with( const std::string& prefix ) const {
+    return( prefix.size() <= _size &&
+            std::memcmp( _data, prefix.data(), prefix.size() ) == 0 );
+  }
+
+  bool operator==( const StringRef& other ) const {
+    return( _size == other._size &&
+            ( _size == 0 || std::memcmp( _data, other._data, _size ) == 0 ) );
+  }
+  bool operator!=( const StringRef& other ) const {
+    return !( *this == other );
+  }
+
+private:
+  const char* _data;
+  size_t _size;
+};
+
+inline std::ostream& operator<<( std::ostream& os, const StringRef& ref ) {
+  return os.write( ref.data(), ref.size() );
+}
+
+}
@@ -20,6 +20,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <chrono>
+#include <ctime>
 #include <string>
 #include <sstream>
 #include <sys/time.h>
@@ -56,15 +57,17 @@ inline std::string pad_with_zeros( const std::string& string_to_pad,
 }
 
 /**
- * Get a timestamp in localtime with microsecond precision.
+ * Get a timestamp in localtime with microsecond precision. Safe to call from
+ * several threads at once.
  */
 inline std::string get_timestamp_string() {
   struct timeval tv;
 	struct timezone tz;
-	struct tm *tm;
+  struct tm local_tm;
+	struct tm *tm = &local_tm;
 
   gettimeofday( &tv, &tz );
-  tm = localtime( &tv.tv_sec );
+  localtime_r( &tv.tv_sec, tm );
 
   std::string year = std::to_string( tm->tm_year + 1900 );
   std::string month = pad_with_zeros( std::to_string( tm->tm_mon + 1 ) );
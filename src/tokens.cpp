@@ -61,6 +61,15 @@ string Token::get_type_str() {
   }
 }
 
+string Token::get_location() const {
+  if( _source == nullptr )
+    return _location;
+
+  ostringstream oss;
+  oss << *_source << ":" << _line_number;
+  return oss.str();
+}
+
 Tokens::Tokens()
   : _i( 0 )
 {}
@@ -93,7 +102,7 @@ string Tokens::eat() {
 void Tokens::print() {
   for( auto& token : _tokens ) {
     cout << token.get_type_str() << ": "
-         << token.get_value() << " at "
+         << token.get_value_ref() << " at "
          << token.get_location() << endl;
   }
 }
@@ -106,7 +115,7 @@ string Tokens::cur_tok_to_str() {
 
   ostringstream oss;
   oss << token.get_type_str() << ": "
-      << token.get_value() << " at "
+      << token.get_value_ref() << " at "
       << token.get_location();
 
   return oss.str();
@@ -142,7 +151,8 @@ bool Tokens::match( const vector<token_t>& types ) {
 }
 
 bool Tokens::match( const string& value ) {
-  return ( n_tokens_remaining() > 0 && _tokens[_i].get_value() == value );
+  return ( n_tokens_remaining() > 0 &&
+           _tokens[_i].get_value_ref() == StringRef( value ) );
 }
 
 bool Tokens::match( const vector<string>& values ) {
@@ -150,7 +160,7 @@ bool Tokens::match( const vector<string>& values ) {
     return false;
 
   for( size_t i = 0; i < values.size(); ++i ) {
-    if( values[i] != _tokens[_i + i].get_value() )
+    if( StringRef( values[i] ) != _tokens[_i + i].get_value_ref() )
       return false;
   }
 
@@ -21,10 +21,14 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
 
+#include "string_ref.hpp"
+#include "filesystem_operations.hpp"
+
 namespace larasynth {
 
 enum token_t {
@@ -52,22 +56,56 @@ public:
   TokenException( const std::string& message ) : runtime_error( message ) {};
 };
 
+/**
+ * A single token. Tokens produced by the Lexer refer directly into the
+ * lexer's file buffer and only store the line number of their location, so
+ * neither the value nor the location string is built unless it is asked for.
+ * Tokens constructed from strings own their value and location.
+ */
 class Token {
 public:
   Token( token_t type, std::string value, std::string location )
     : _type( type ),
       _value( value ),
+      _owns_value( true ),
+      _source( nullptr ),
+      _line_number( 0 ),
       _location( location )
   {}
 
-  token_t get_type() { return _type; }
+  Token( token_t type, StringRef value, const std::string* source,
+         size_t line_number )
+    : _type( type ),
+      _value_ref( value ),
+      _owns_value( false ),
+      _source( source ),
+      _line_number( line_number )
+  {}
+
+  Token( token_t type, std::string value, const std::string* source,
+         size_t line_number )
+    : _type( type ),
+      _value( value ),
+      _owns_value( true ),
+      _source( source ),
+      _line_number( line_number )
+  {}
+
+  token_t get_type() const { return _type; }
   std::string get_type_str();
-  std::string get_value() { return _value; }
-  std::string get_location() { return _location; }
+  std::string get_value() const
+  { return _owns_value ? _value : _value_ref.str(); }
+  StringRef get_value_ref() const
+  { return _owns_value ? StringRef( _value ) : _value_ref; }
+  std::string get_location() const;
 
 private:
   token_t _type;
+  StringRef _value_ref;
   std::string _value;
+  bool _owns_value;
+  const std::string* _source;
+  size_t _line_number;
   std::string _location;
 };
 
@@ -83,6 +121,14 @@ public:
   std::string get_prev_location();  
   std::string cur_tok_to_str();
 
+  /**
+   * Keep the source name and buffer that lexed tokens refer to alive for as
+   * long as any copy of this object exists.
+   */
+  void set_source( std::shared_ptr<const std::string> source_name,
+                   std::shared_ptr<const MappedFile> buffer )
+  { _source_name = source_name; _buffer = buffer; }
+
   bool match( token_t type );
   bool match( token_t type_1, token_t type_2 );
   bool match( token_t type_1, token_t type_2, token_t type_3 );  
@@ -97,6 +143,9 @@ public:
 private:
   std::vector<Token> _tokens;
   size_t _i;
+
+  std::shared_ptr<const std::string> _source_name;
+  std::shared_ptr<const MappedFile> _buffer;
 };
 
 }
@@ -0,0 +1,250 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <chrono>
+#include <iomanip>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "trace.hpp"
+
+using namespace std;
+using namespace larasynth;
+
+static const chrono::milliseconds FLUSH_INTERVAL( 100 );
+
+namespace {
+
+/**
+ * Gives a thread's buffer back to the tracer when the thread exits.
+ */
+struct ThreadBufferHandle {
+  TraceBuffer* buffer = nullptr;
+
+  ~ThreadBufferHandle() {
+    if( buffer != nullptr )
+      Tracer::get().release_buffer( buffer );
+  }
+};
+
+thread_local ThreadBufferHandle thread_buffer;
+
+}
+
+TraceBuffer::TraceBuffer( size_t thread_id )
+  : thread_name( nullptr )
+  , _events( CAPACITY )
+  , _head( 0 )
+  , _tail( 0 )
+  , _dropped_count( 0 )
+  , _thread_id( thread_id )
+{}
+
+void TraceBuffer::push( const TraceEvent& event ) {
+  size_t head = _head.load( memory_order_relaxed );
+
+  if( head - _tail.load( memory_order_acquire ) >= CAPACITY ) {
+    _dropped_count.fetch_add( 1, memory_order_relaxed );
+    return;
+  }
+
+  _events[head % CAPACITY] = event;
+  _head.store( head + 1, memory_order_release );
+}
+
+/**
+ * Move the buffered events to the end of events. Returns the number of events
+ * moved.
+ */
+size_t TraceBuffer::drain( vector<TraceEvent>& events ) {
+  size_t tail = _tail.load( memory_order_relaxed );
+  size_t head = _head.load( memory_order_acquire );
+
+  for( size_t i = tail; i != head; ++i )
+    events.push_back( _events[i % CAPACITY] );
+
+  _tail.store( head, memory_order_release );
+
+  return head - tail;
+}
+
+Tracer& Tracer::get() {
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::Tracer()
+  : _running( false )
+  , _start_nanoseconds( 0 )
+  , _first_event( true )
+  , _dropped_count( 0 )
+  , _stopping( false )
+{}
+
+Tracer::~Tracer() {
+  stop();
+}
+
+uint64_t Tracer::now() {
+  auto now = chrono::steady_clock::now().time_since_epoch();
+  return chrono::duration_cast<chrono::nanoseconds>( now ).count();
+}
+
+/**
+ * Start recording events into a new trace file. Does nothing if the tracer is
+ * already running.
+ */
+void Tracer::start( const string& filename ) {
+  if( _running )
+    return;
+
+  _file.open( filename );
+  if( !_file.good() )
+    throw runtime_error( "Could not open the trace file " + filename );
+
+  // timestamps are written in microseconds with nanosecond resolution
+  _file << fixed << setprecision( 3 ) << "{\"traceEvents\":[";
+  _first_event = true;
+  _dropped_count = 0;
+  _start_nanoseconds = now();
+  _stopping = false;
+
+  _running = true;
+  _thread = thread( &Tracer::run, this );
+}
+
+/**
+ * Stop recording, write the remaining events and close the trace file.
+ */
+void Tracer::stop() {
+  if( !_running )
+    return;
+
+  _running = false;
+
+  {
+    lock_guard<mutex> lock( _flush_mutex );
+    _stopping = true;
+  }
+  _flush_cond.notify_one();
+  _thread.join();
+
+  write_events();
+
+  // name the rows of the threads that named themselves
+  lock_guard<mutex> lock( _buffers_mutex );
+
+  for( auto& buffer : _buffers ) {
+    const char* name = buffer->thread_name;
+    if( name == nullptr )
+      continue;
+
+    _file << ( _first_event ? "\n" : ",\n" )
+          << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << getpid()
+          << ",\"tid\":" << buffer->get_thread_id()
+          << ",\"args\":{\"name\":\"" << name << "\"}}";
+    _first_event = false;
+  }
+
+  _file << "\n],\"otherData\":{\"dropped_event_count\":" << _dropped_count
+        << "}}\n";
+  _file.close();
+}
+
+void Tracer::record( const char* name, uint64_t begin_nanoseconds,
+                     uint64_t duration_nanoseconds ) {
+  if( !_running )
+    return;
+
+  get_thread_buffer()->push( { name, begin_nanoseconds,
+                               duration_nanoseconds } );
+}
+
+/**
+ * Name the calling thread's row in the trace.
+ */
+void Tracer::set_thread_name( const char* name ) {
+  get_thread_buffer()->thread_name = name;
+}
+
+TraceBuffer* Tracer::get_thread_buffer() {
+  if( thread_buffer.buffer != nullptr )
+    return thread_buffer.buffer;
+
+  lock_guard<mutex> lock( _buffers_mutex );
+
+  if( !_free_buffers.empty() ) {
+    thread_buffer.buffer = _free_buffers.back();
+    _free_buffers.pop_back();
+  }
+  else {
+    _buffers.emplace_back( new TraceBuffer( _buffers.size() + 1 ) );
+    thread_buffer.buffer = _buffers.back().get();
+  }
+
+  return thread_buffer.buffer;
+}
+
+void Tracer::release_buffer( TraceBuffer* buffer ) {
+  lock_guard<mutex> lock( _buffers_mutex );
+  _free_buffers.push_back( buffer );
+}
+
+void Tracer::run() {
+  unique_lock<mutex> lock( _flush_mutex );
+
+  while( !_stopping ) {
+    _flush_cond.wait_for( lock, FLUSH_INTERVAL );
+
+    lock.unlock();
+    write_events();
+    lock.lock();
+  }
+}
+
+/**
+ * Drain every thread's buffer into the trace file. Only called from the
+ * flushing thread, or after it has stopped.
+ */
+void Tracer::write_events() {
+  lock_guard<mutex> lock( _buffers_mutex );
+
+  pid_t pid = getpid();
+
+  for( auto& buffer : _buffers ) {
+    _drained_events.clear();
+    buffer->drain( _drained_events );
+
+    for( const TraceEvent& event : _drained_events ) {
+      uint64_t begin = event.begin_nanoseconds > _start_nanoseconds ?
+        event.begin_nanoseconds - _start_nanoseconds : 0;
+
+      _file << ( _first_event ? "\n" : ",\n" )
+            << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"ts\":"
+            << begin / 1000.0 << ",\"dur\":"
+            << event.duration_nanoseconds / 1000.0 << ",\"pid\":" << pid
+            << ",\"tid\":" << buffer->get_thread_id() << "}";
+      _first_event = false;
+    }
+  }
+
+  size_t dropped_count = 0;
+  for( auto& buffer : _buffers )
+    dropped_count += buffer->get_dropped_count();
+  _dropped_count = dropped_count;
+}
@@ -0,0 +1,171 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <fstream>
+#include <cstdint>
+
+namespace larasynth {
+
+/**
+ * A completed span of time on one thread. name must be a string literal, or
+ * otherwise outlive the tracer.
+ */
+struct TraceEvent {
+  const char* name;
+  uint64_t begin_nanoseconds;
+  uint64_t duration_nanoseconds;
+};
+
+/**
+ * A fixed size ring buffer of trace events with a single producer, the thread
+ * that owns it, and a single consumer, the tracer's flushing thread. Events
+ * that do not fit are dropped and counted rather than blocking the producer.
+ */
+class TraceBuffer {
+public:
+  explicit TraceBuffer( size_t thread_id );
+
+  void push( const TraceEvent& event );
+  size_t drain( std::vector<TraceEvent>& events );
+
+  size_t get_thread_id() const { return _thread_id; }
+  size_t get_dropped_count() const { return _dropped_count; }
+
+  // set by the owning thread and read when the trace is finished
+  std::atomic<const char*> thread_name;
+
+private:
+  static const size_t CAPACITY = 1 << 14;
+
+  std::vector<TraceEvent> _events;
+  std::atomic<size_t> _head;
+  std::atomic<size_t> _tail;
+  std::atomic<size_t> _dropped_count;
+  size_t _thread_id;
+};
+
+/**
+ * Records trace events from every thread and writes them to a file in the
+ * Chrome trace event format, which can be viewed with chrome://tracing or
+ * Perfetto.
+ *
+ * Each thread records into its own TraceBuffer, so recording never takes a
+ * lock once a thread has its buffer. A background thread drains the buffers
+ * into the file. A thread's buffer is reused by a later thread once the
+ * thread exits, so short lived worker threads share a few trace rows.
+ *
+ * Nothing is recorded unless start() has been called. The trace macros below
+ * only record anything in builds configured with --enable-tracing.
+ */
+class Tracer {
+public:
+  static Tracer& get();
+
+  ~Tracer();
+
+  void start( const std::string& filename );
+  void stop();
+  bool is_running() const { return _running; }
+
+  void record( const char* name, uint64_t begin_nanoseconds,
+               uint64_t duration_nanoseconds );
+  void set_thread_name( const char* name );
+
+  void release_buffer( TraceBuffer* buffer );
+
+  static uint64_t now();
+
+private:
+  Tracer();
+
+  TraceBuffer* get_thread_buffer();
+  void run();
+  void write_events();
+
+  std::atomic<bool> _running;
+  uint64_t _start_nanoseconds;
+  std::ofstream _file;
+  bool _first_event;
+  size_t _dropped_count;
+
+  std::mutex _buffers_mutex;
+  std::vector< std::unique_ptr<TraceBuffer> > _buffers;
+  std::vector<TraceBuffer*> _free_buffers;
+
+  std::mutex _flush_mutex;
+  std::condition_variable _flush_cond;
+  bool _stopping;
+  std::thread _thread;
+
+  std::vector<TraceEvent> _drained_events;
+};
+
+/**
+ * Records the time from its construction to the end of its scope as a trace
+ * event, if the tracer is running.
+ */
+class TraceScope {
+public:
+  explicit TraceScope( const char* name )
+    : _name( name )
+    , _begin( Tracer::get().is_running() ? Tracer::now() : 0 ) {}
+
+  ~TraceScope() {
+    if( _begin != 0 )
+      Tracer::get().record( _name, _begin, Tracer::now() - _begin );
+  }
+
+  TraceScope( const TraceScope& ) = delete;
+  TraceScope& operator=( const TraceScope& ) = delete;
+
+private:
+  const char* _name;
+  uint64_t _begin;
+};
+
+}
+
+#ifdef LARASYNTH_TRACING
+
+#define LARASYNTH_TRACE_CONCAT_INNER( a, b ) a##b
+#define LARASYNTH_TRACE_CONCAT( a, b ) LARASYNTH_TRACE_CONCAT_INNER( a, b )
+
+#define TRACE_SCOPE( name ) \
+  larasynth::TraceScope LARASYNTH_TRACE_CONCAT( trace_scope_, __LINE__ )( name )
+#define TRACE_THREAD_NAME( name ) \
+  larasynth::Tracer::get().set_thread_name( name )
+#define TRACE_START( filename ) larasynth::Tracer::get().start( filename )
+#define TRACE_STOP() larasynth::Tracer::get().stop()
+
+#else
+
+#define TRACE_SCOPE( name ) static_cast<void>( 0 )
+#define TRACE_THREAD_NAME( name ) static_cast<void>( 0 )
+#define TRACE_START( filename ) static_cast<void>( 0 )
+#define TRACE_STOP() static_cast<void>( 0 )
+
+#endif
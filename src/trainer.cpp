@@ -18,152 +18,755 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "trainer.hpp"
+#include "trace.hpp"
 
 using namespace std;
 using namespace larasynth;
 using namespace littlelstm;
 
-bool Trainer::_keep_running = true;
+/**
+ * Get the filenames in shard shard_index of shard_count shards. If there are
+ * fewer filenames than shards, every shard gets all of them.
+ */
+static vector<string> get_shard( const vector<string>& filenames,
+                                 size_t shard_index, size_t shard_count ) {
+  if( filenames.size() < shard_count )
+    return filenames;
+
+  vector<string> shard;
+
+  for( size_t i = shard_index; i < filenames.size(); i += shard_count )
+    shard.push_back( filenames[i] );
+
+  return shard;
+}
 
 Trainer::Trainer( const string& config_directory_path,
-                  volatile sig_atomic_t* shutdown_flag )
+                  volatile sig_atomic_t* shutdown_flag, bool resume,
+                  size_t worker_process_count )
+  : _shutdown_flag( shutdown_flag )
+  , _verbose( true )
+  , _worker_process_count( worker_process_count )
+  , _shard_index( 0 )
+  , _shard_count( 1 )
+  , _group_count( 1 )
+{
+  ConfigDirectory dir( config_directory_path );
+  dir.process_directory();
+
+  _results_filename = dir.get_new_training_results_filename();
+
+  seed_random_numbers( dir.get_config_file_path() );
+
+  ConfigParser cp( dir.get_config_file_path() );
+
+  setup( dir, cp );
+
+  _checkpoint_filename =
+    TrainingCheckpoint::get_checkpoint_filename( _results_filename );
+
+  if( _training_config->get_checkpoint_minutes() > 0.0 )
+    _checkpoint_writer.reset( new CheckpointWriter() );
+
+  if( _worker_process_count > 0 ) {
+    cout << "Waiting for " << _worker_process_count << " worker(s) on "
+         << TrainingCoordinator::get_socket_filename( _results_dir_name )
+         << endl << endl;
+
+    _coordinator.reset( new TrainingCoordinator(
+                          _results_dir_name, _worker_process_count,
+                          _net->get_connection_weights().size(),
+                          _shutdown_flag,
+                          _training_config->get_round_timeout_minutes() *
+                          60.0 ) );
+
+    _trainer->set_round_runner( [this]( const TrainingRound& round ) {
+        return _coordinator->run_round( round );
+      } );
+  }
+
+  if( resume )
+    resume_from_checkpoint();
+
+  // a worker that stops ends training like a shutdown, and is reported once
+  // the checkpoint and the best results so far are written
+  string stopped_worker_error;
+
+  try {
+    train();
+  }
+  catch( const TrainingCoordinatorException& e ) {
+    stopped_worker_error = e.what();
+  }
+
+  // keep a checkpoint to resume from if training was interrupted
+  if( _checkpoint_writer && !_finished ) {
+    write_checkpoint( _training_minutes );
+    _checkpoint_writer->flush();
+  }
+
+  // closing the connections tells the workers that training is over
+  _coordinator.reset();
+
+  write_results();
+
+  if( _checkpoint_writer && _finished ) {
+    _checkpoint_writer->flush();
+    remove( _checkpoint_filename.c_str() );
+  }
+
+  if( !stopped_worker_error.empty() )
+    throw TrainerException( stopped_worker_error + "\nTraining stopped early" );
+}
+
+Trainer::Trainer( ConfigDirectory& dir, ConfigParser& cp,
+                  const string& results_filename,
+                  volatile sig_atomic_t* shutdown_flag, bool verbose,
+                  size_t shard_index, size_t shard_count,
+                  const vector<event_data_t>& ctrl_group )
   : _shutdown_flag( shutdown_flag )
+  , _verbose( verbose )
+  , _results_filename( results_filename )
+  , _worker_process_count( 0 )
+  , _shard_index( shard_index )
+  , _shard_count( shard_count )
+  , _ctrl_group( ctrl_group )
+  , _group_count( 1 )
 {
+  setup( dir, cp );
+}
+
+/**
+ * Train as one of the worker processes of a coordinator for the project
+ * (`lara train --worker`). The worker trains on its shard of the examples for
+ * every round the coordinator sends, and returns once the coordinator closes
+ * the connection. Workers ignore the shutdown flag and stop when their
+ * coordinator does.
+ */
+void Trainer::train_as_worker( const string& config_directory_path ) {
   ConfigDirectory dir( config_directory_path );
   dir.process_directory();
 
+  TrainingWorkerConnection connection(
+    dir.get_training_results_directory_name() );
+
+  cout << "Training shard " << connection.get_shard_index() + 1 << " of "
+       << connection.get_shard_count() << " for the coordinator" << endl;
+
+  // each worker gets its own streams so the shards are not shuffled alike
+  seed_random_numbers( dir.get_config_file_path(),
+                       connection.get_shard_index() + 1 );
+
+  ConfigParser cp( dir.get_config_file_path() );
+  volatile sig_atomic_t never_shut_down = false;
+
+  Trainer trainer( dir, cp, "", &never_shut_down, false,
+                   connection.get_shard_index(),
+                   connection.get_shard_count() );
+
+  if( connection.get_weight_count() !=
+      trainer._net->get_connection_weights().size() )
+    throw TrainerException( "The network configured in larasynth.conf does "
+                            "not match the coordinator's network." );
+
+  TrainingRound round;
+
+  try {
+    while( connection.receive_round( round ) )
+      connection.send_result( trainer._trainer->run_round( round ) );
+  }
+  catch( const out_of_range& e ) {
+    throw TrainerException( "The network configured in larasynth.conf does "
+                            "not match the coordinator's network." );
+  }
+
+  cout << "The coordinator finished training" << endl;
+}
+
+/**
+ * If seed is set in the training section of the configuration file, derive
+ * the seeds of all random number generators created from now on from it (see
+ * RandGen::set_global_seed()), so that training runs that create the same
+ * generators in the same order are reproducible. This must be called before
+ * the configuration is parsed for training, since the parser samples random
+ * parameter values.
+ */
+void Trainer::seed_random_numbers( const string& config_file_path,
+                                   uint64_t stream ) {
+  ConfigParser cp( config_file_path );
+  ConfigParameters training_params = cp.get_section_params( "training" );
+  TrainingConfig training_config( training_params );
+
+  if( training_config.get_seed() != 0 )
+    RandGen::set_global_seed( training_config.get_seed(), stream );
+}
+
+void Trainer::setup( ConfigDirectory& dir, ConfigParser& cp ) {
   if( !dir.training_examples_exist() ) {
     string error = "There are no training examples in the directory " +
-      config_directory_path + ".\nCould not train.";
+      dir.get_directory_name() + ".\nCould not train.";
     throw TrainerException( error );
   }
 
-  TrainingResults results( dir.get_new_training_results_filename(),
-                           WRITE_RESULTS );
+  _results_dir_name = dir.get_training_results_directory_name();
 
-  ConfigParser cp( dir.get_config_file_path() );
   ConfigParameters lstm_params = cp.get_section_params( "lstm" );
   ConfigParameters seq_params = cp.get_section_params( "representation" );
   ConfigParameters midi_params = cp.get_section_params( "midi" );
   ConfigParameters training_params = cp.get_section_params( "training" );
 
-  TrainingConfig training_config( training_params );
+  _training_config.reset( new TrainingConfig( training_params ) );
 
-  MidiConfig midi_config( midi_params );   
+  _midi_config.reset( new MidiConfig( midi_params ) );
 
-  RepresentationConfig repr_config( seq_params );
+  _repr_config.reset( new RepresentationConfig( seq_params ) );
+
+  // the network of a controller group only feeds back and predicts the
+  // group's controllers
+  if( !_ctrl_group.empty() ) {
+    _group_count = _repr_config->get_ctrl_groups().size();
+    _repr_config.reset(
+      new RepresentationConfig( _repr_config->get_group_config( _ctrl_group ) )
+      );
+  }
 
   vector<string> example_filenames = dir.get_training_example_filenames();
 
   size_t update_period =
-    MICROSECONDS_PER_SECOND / repr_config.get_update_rate();
+    MICROSECONDS_PER_SECOND / _repr_config->get_update_rate();
+
+  _training_stream.reset(
+    new TrainingEventStream( update_period,
+                             _training_config->get_tempo_adjustment_factor(),
+                             _training_config->get_tempo_jitter_factor(),
+                             _training_config->get_mean_padding(),
+                             _training_config->get_padding_stddev(),
+                             _midi_config->get_ctrl_defaults() ) );
+
+  // a worker process trains on its shard, but with the min/max of all of the
+  // examples like the coordinator
+  if( _shard_count > 1 ) {
+    TrainingEventStream all_examples( update_period, 0.0, 0.0, 0.0, 0.0,
+                                      _midi_config->get_ctrl_defaults() );
+    all_examples.add_examples( example_filenames );
+    _min_max = all_examples.get_min_max();
+
+    if( example_filenames.size() < _shard_count )
+      cout << "There are fewer training examples than workers, so every "
+           << "worker trains on all of them" << endl << endl;
+
+    example_filenames = get_shard( example_filenames, _shard_index,
+                                   _shard_count );
+    _training_stream->add_examples( example_filenames );
+  }
+  else {
+    _training_stream->add_examples( example_filenames );
+    _min_max = _training_stream->get_min_max();
+  }
+
+  _translator.reset(
+    new MidiTranslator( _repr_config->get_ctrl_output_counts(),
+                        _repr_config->get_input_feature_config(),
+                        _midi_config->get_ctrl_defaults(),
+                        _min_max, TRAIN ) );
 
-  TrainingEventStream training_stream( update_period,
-                                training_config.get_tempo_adjustment_factor(),
-                                training_config.get_tempo_jitter_factor(),
-                                training_config.get_mean_padding(),
-                                training_config.get_padding_stddev(),
-                                midi_config.get_ctrl_defaults() );
+  _lstm_config.reset( new LstmConfig( lstm_params ) );
 
-  training_stream.add_examples( example_filenames );
+  _lstm_config->set_input_count( _translator->get_input_count() );
+  _lstm_config->set_output_count( _translator->get_output_count() );
 
-  MidiTranslator translator( repr_config.get_ctrl_output_counts(),
-                             repr_config.get_input_feature_config(),
-                             midi_config.get_ctrl_defaults(),
-                             training_stream.get_min_max(),
-                             TRAIN );
+  littlelstm::LstmArchitecture arch( _lstm_config->get_input_count(),
+                                     _lstm_config->get_output_count(),
+                                     _lstm_config->get_block_counts(),
+                                     _lstm_config->get_block_types() );
 
-  LstmConfig lstm_config( lstm_params );
+  _net.reset( new littlelstm::LstmNetwork( arch ) );
+  
+  _trainer.reset( new LstmTrainer( *_net, *_training_stream,
+                                   *_training_config, *_lstm_config,
+                                   *_translator, update_period ) );
 
-  lstm_config.set_input_count( translator.get_input_count() );
-  lstm_config.set_output_count( translator.get_output_count() );
+  add_workers( arch, example_filenames, update_period );
 
-  littlelstm::LstmArchitecture arch( lstm_config.get_input_count(),
-                                     lstm_config.get_output_count(),
-                                     lstm_config.get_block_counts() );
+  if( _training_config->get_max_epoch_count() > 0 )
+    _max_epoch_count = _training_config->get_max_epoch_count();
+  else
+    _max_epoch_count = numeric_limits<size_t>::max();
 
-  littlelstm::LstmNetwork net( arch );
-  
-  LstmTrainer trainer( net, training_stream, training_config, lstm_config,
-                        translator, update_period );
+  _finished = false;
+  _best_mse = INFINITY;
+  _training_minutes = 0.0;
 
-  double best_mse = INFINITY;
-  LstmResult best_result;
-  WeightsMap_t best_weights;
+  if( _verbose )
+    print_configuration();
+
+  if( _training_config->get_warm_start_results() != "" )
+    warm_start( dir );
+}
 
+void Trainer::print_configuration() {
   cout << "Training LSTM network." << endl << endl;
   cout << "Network configuration:" << endl << endl;
-  lstm_config.print_network_configuration();
+  _lstm_config->print_network_configuration();
   cout << endl;
 
   cout << "Training configuration:" << endl << endl;
-  training_config.print_training_configuration();
+  _training_config->print_training_configuration();
   cout << endl;
 
   cout << "Representation configuration:" << endl << endl;
-  repr_config.print_representation_configuration();
+  _repr_config->print_representation_configuration();
   cout << endl;
+}
 
-  size_t max_epoch_count;
+/**
+ * Create the worker trainers for parallel training. The examples are split
+ * between the workers' training streams, so there are never more workers
+ * than examples. The workers' translators use the min/max of all the
+ * examples so that every worker sees the same representation.
+ */
+void Trainer::add_workers( LstmArchitecture& arch,
+                           const vector<string>& example_filenames,
+                           size_t update_period ) {
+  size_t thread_count = _training_config->get_thread_count();
+
+  // the networks of controller groups train at the same time, so they share
+  // the processors
+  if( thread_count == 0 )
+    thread_count = max( (size_t)1, worker_thread_count(
+                          numeric_limits<size_t>::max() ) / _group_count );
+
+  if( _worker_process_count > 0 )
+    return;
+
+  if( thread_count > example_filenames.size() ) {
+    thread_count = max( (size_t)1, example_filenames.size() );
+
+    if( _verbose )
+      cout << "Training on " << thread_count << " thread(s), one for each "
+           << "training example" << endl << endl;
+  }
 
-  if( training_config.get_max_epoch_count() > 0 )
-    max_epoch_count = training_config.get_max_epoch_count();
-  else
-    max_epoch_count = numeric_limits<size_t>::max();
+  if( thread_count == 1 )
+    return;
+
+  _workers.resize( thread_count );
+
+  for( size_t i = 0; i < thread_count; ++i ) {
+    TrainingWorker& worker = _workers[i];
+
+    vector<string> filenames = get_shard( example_filenames, i,
+                                          thread_count );
+
+    worker.training_stream.reset(
+      new TrainingEventStream( update_period,
+                               _training_config->get_tempo_adjustment_factor(),
+                               _training_config->get_tempo_jitter_factor(),
+                               _training_config->get_mean_padding(),
+                               _training_config->get_padding_stddev(),
+                               _midi_config->get_ctrl_defaults() ) );
+
+    worker.training_stream->add_examples( filenames );
+
+    worker.translator.reset(
+      new MidiTranslator( _repr_config->get_ctrl_output_counts(),
+                          _repr_config->get_input_feature_config(),
+                          _midi_config->get_ctrl_defaults(),
+                          _min_max, TRAIN ) );
+
+    worker.net.reset( new LstmNetwork( arch ) );
+
+    worker.trainer.reset( new LstmTrainer( *worker.net,
+                                           *worker.training_stream,
+                                           *_training_config, *_lstm_config,
+                                           *worker.translator,
+                                           update_period ) );
+
+    // the workers already keep the processors busy, so each of them steps
+    // its network on its own thread
+    worker.net->set_step_thread_count( 1 );
+
+    _trainer->add_worker( *worker.trainer );
+  }
+}
+
+/**
+ * Replace the network's random weights with the weights from the results file
+ * named by warm_start_results. The name is looked up in the project's
+ * training results directory.
+ */
+void Trainer::warm_start( ConfigDirectory& dir ) {
+  string warm_start_name = _training_config->get_warm_start_results();
+  string warm_start_filename;
+
+  for( const string& filename : dir.get_training_results_filenames() ) {
+    if( get_basename( filename ) == warm_start_name )
+      warm_start_filename = filename;
+  }
+
+  if( warm_start_filename.empty() ) {
+    string error = "Configuration error: warm start results " +
+      warm_start_name + " do not exist.";
+    throw TrainerException( error );
+  }
+
+  try {
+    TrainingResults results( warm_start_filename, READ_RESULTS );
+
+    WarmStart start( results, *_repr_config, _min_max,
+                     _lstm_config->get_block_counts(),
+                     _lstm_config->get_block_types() );
+
+    start.apply( *_net );
+
+    if( _verbose )
+      cout << "Starting from " << start.get_weight_count() << " of "
+           << _net->get_connection_weights().size() << " weights in "
+           << warm_start_name << endl << endl;
+  }
+  catch( const TrainingResultsException& e ) {
+    throw TrainerException( "Error reading " + warm_start_filename + ":\n" +
+                            e.what() );
+  }
+  catch( const WarmStartException& e ) {
+    throw TrainerException( string( e.what() ) + "\nCould not warm start." );
+  }
+}
+
+/**
+ * Restore the state saved in the newest checkpoint in the project. The
+ * network built from the current configuration file must have the same
+ * architecture as the one that was checkpointed.
+ *
+ * The resumed run writes new results, so its checkpoint is saved under the
+ * new name right away and the old checkpoint is removed.
+ */
+void Trainer::resume_from_checkpoint() {
+  string old_checkpoint_filename =
+    TrainingCheckpoint::find_latest_checkpoint( _results_dir_name );
+
+  if( old_checkpoint_filename.empty() ) {
+    string error = "There is no checkpoint to resume from in " +
+      _results_dir_name + ".\nCould not resume.";
+    throw TrainerException( error );
+  }
+
+  TrainingCheckpoint checkpoint( old_checkpoint_filename );
+
+  try {
+    restore_checkpoint( checkpoint );
+  }
+  catch( const runtime_error& e ) {
+    throw TrainerException( "Invalid checkpoint: " + string( e.what() ) );
+  }
+  catch( const out_of_range& e ) {
+    string error = old_checkpoint_filename + " does not match the network "
+      "configured in larasynth.conf.\nCould not resume.";
+    throw TrainerException( error );
+  }
+
+  if( _verbose )
+    cout << "Resuming training from " << old_checkpoint_filename
+         << " after epoch " << checkpoint.epoch << endl << endl;
+
+  if( _checkpoint_writer ) {
+    write_checkpoint( _training_minutes );
+    _checkpoint_writer->flush();
+    remove( old_checkpoint_filename.c_str() );
+  }
+}
+
+/**
+ * Continue training from checkpoint. The checkpoint must come from a network
+ * with the same architecture.
+ */
+void Trainer::restore_checkpoint( const TrainingCheckpoint& checkpoint ) {
+  _net->set_state( checkpoint.network_state );
+  _translator->set_state( checkpoint.translator_state );
+
+  // with a different thread_count the workers start fresh
+  if( checkpoint.workers.size() == _workers.size() ) {
+    for( size_t i = 0; i < _workers.size(); ++i ) {
+      const WorkerCheckpoint& saved = checkpoint.workers[i];
+      TrainingWorker& worker = _workers[i];
+
+      worker.net->set_state( saved.network_state );
+      worker.translator->set_state( saved.translator_state );
+      worker.trainer->restore( 0, 0, saved.trainer_rand_state,
+                               checkpoint.schedule_state );
+      worker.training_stream->set_rand_state( saved.stream_rand_state );
+    }
+  }
+
+  if( !checkpoint.best_weights.empty() &&
+      checkpoint.best_weights.size() != checkpoint.network_state.weights.size() )
+    throw out_of_range( "Best weights do not match the network" );
+
+  _trainer->restore( checkpoint.epoch, checkpoint.max_streak,
+                     checkpoint.trainer_rand_state,
+                     checkpoint.schedule_state );
+  if( !checkpoint.stream_rand_state.empty() )
+    _training_stream->set_rand_state( checkpoint.stream_rand_state );
+
+  _best_mse = checkpoint.best_mse;
+  _best_result = checkpoint.best_result;
+  _best_weights = checkpoint.best_weights;
+  _training_minutes = checkpoint.training_minutes;
+}
+
+/**
+ * Copy the current training state into checkpoint. Reusing the same
+ * checkpoint object avoids reallocating its vectors.
+ */
+void Trainer::save_checkpoint( TrainingCheckpoint& checkpoint ) const {
+  checkpoint.epoch = _trainer->get_epoch();
+  checkpoint.max_streak = _trainer->get_best_streak();
+  checkpoint.training_minutes = _training_minutes;
+
+  checkpoint.trainer_rand_state = _trainer->get_rand_state();
+  checkpoint.schedule_state = _trainer->get_schedule_state();
+  checkpoint.stream_rand_state = _training_stream->get_rand_state();
+
+  _net->get_state( checkpoint.network_state );
+  checkpoint.translator_state = _translator->get_state();
+
+  checkpoint.workers.resize( _workers.size() );
+
+  for( size_t i = 0; i < _workers.size(); ++i ) {
+    WorkerCheckpoint& saved = checkpoint.workers[i];
+    const TrainingWorker& worker = _workers[i];
+
+    saved.trainer_rand_state = worker.trainer->get_rand_state();
+    saved.stream_rand_state = worker.training_stream->get_rand_state();
+    worker.net->get_state( saved.network_state );
+    saved.translator_state = worker.translator->get_state();
+  }
+
+  checkpoint.best_mse = _best_mse;
+  checkpoint.best_result = _best_result;
+  checkpoint.best_weights = _best_weights;
+}
+
+/**
+ * Queue a checkpoint of the current training state. It is written in the
+ * background.
+ */
+void Trainer::write_checkpoint( double training_minutes ) {
+  TRACE_SCOPE( "Trainer::write_checkpoint" );
+
+  save_checkpoint( _checkpoint );
+  _checkpoint.training_minutes = training_minutes;
+
+  _checkpoint_writer->write( _checkpoint_filename, _checkpoint.get_bytes() );
+}
+
+/**
+ * Trains until the maximum epoch count or the MSE threshold from the training
+ * configuration is reached, at which point the session is finished and
+ * further calls do nothing. Training also stops if the shutdown flag is set.
+ *
+ * A nonzero epoch_limit stops training early once that many epochs in total
+ * have been run, and a nonzero minute_limit stops training early once this
+ * call has run for that long. Training can then be continued with another
+ * call.
+ */
+void Trainer::train( size_t epoch_limit, double minute_limit ) {
+  TRACE_SCOPE( "Trainer::train" );
+
+  if( _finished )
+    return;
 
   Timer training_timer;
   Timer since_last_report_timer;
+  Timer since_last_checkpoint_timer;
+  exception_ptr stopped_worker;
+
+  while( !_finished ) {
+    if( _trainer->get_epoch() > _max_epoch_count ) {
+      _finished = true;
+      break;
+    }
+
+    if( *_shutdown_flag )
+      break;
 
-  while( trainer.get_epoch() <= max_epoch_count && !*_shutdown_flag ) {
-    trainer.run_training_epoch();
+    if( epoch_limit > 0 && _trainer->get_epoch() >= epoch_limit )
+      break;
 
-    if( since_last_report_timer.get_elapsed_minutes() >= 1.0 ) {
+    if( minute_limit > 0.0 &&
+        training_timer.get_elapsed_minutes() >= minute_limit )
+      break;
+
+    try {
+      _trainer->run_training_epoch();
+    }
+    catch( const TrainingCoordinatorException& ) {
+      // a worker stopped, so count the time trained so far before reporting
+      // it, unless the round was interrupted by a shutdown
+      if( !*_shutdown_flag )
+        stopped_worker = current_exception();
+      break;
+    }
+
+    if( _verbose && since_last_report_timer.get_elapsed_minutes() >= 1.0 ) {
       since_last_report_timer.start();
-      double elapsed_minutes = training_timer.get_elapsed_minutes();
+      double elapsed_minutes =
+        _training_minutes + training_timer.get_elapsed_minutes();
       
       cout << endl;
       cout << (int)elapsed_minutes << " minute(s) elapsed" << endl;
-      cout << trainer.get_epoch() / elapsed_minutes << " epochs per minute"
+      cout << _trainer->get_epoch() / elapsed_minutes << " epochs per minute"
            << endl;
-      if( best_mse != INFINITY )
-        cout << "Best MSE: " << best_mse << " after epoch " <<
-             best_result.get_epoch() << endl;
+      if( _lstm_config->get_schedule_type() != CONSTANT_SCHEDULE )
+        cout << "Learning rate: " << _trainer->get_learning_rate() << endl;
+      print_profile( _profile_seconds + training_timer.get_elapsed_seconds() );
+      write_stats( _profile_seconds + training_timer.get_elapsed_seconds() );
+      if( _best_mse != INFINITY )
+        cout << "Best MSE: " << _best_mse << " after epoch " <<
+             _best_result.get_epoch() << endl;
       cout << endl;
     }
 
-    if( trainer.should_validate() ) {
-      cout << "Validating after epoch " << trainer.get_epoch() << endl;
+    if( _trainer->should_validate() ) {
+      if( _verbose )
+        cout << "Validating after epoch " << _trainer->get_epoch() << endl;
 
-      LstmResult result = trainer.validate();
+      LstmResult result = _trainer->validate();
+      double mse = result.get_mse();
 
-      cout << "MSE: " << result.get_mse() << endl;
+      if( _verbose )
+        cout << "MSE: " << mse << endl;
 
-      if( result.get_mse() < best_mse ) {
-        best_mse = result.get_mse();
-        best_weights = net.get_weights_map();
-        best_result = result;
-        cout << "New best MSE" << endl;
+      if( mse < _best_mse ) {
+        _best_mse = mse;
+        _best_weights = _net->get_connection_weights();
+        _best_result = std::move( result );
+        if( _verbose )
+          cout << "New best MSE" << endl;
       }
 
-      if( result.get_mse() <= training_config.get_mse_threshold() ) {
-        cout << "MSE threshold hit after " << trainer.get_epoch() << " epochs"
-             << endl;
-        break;
+      if( mse <= _training_config->get_mse_threshold() ) {
+        if( _verbose )
+          cout << "MSE threshold hit after " << _trainer->get_epoch()
+               << " epochs" << endl;
+        _finished = true;
       }
     }
+
+    if( _checkpoint_writer && !_finished &&
+        since_last_checkpoint_timer.get_elapsed_minutes() >=
+        _training_config->get_checkpoint_minutes() ) {
+      since_last_checkpoint_timer.start();
+      write_checkpoint( _training_minutes +
+                        training_timer.get_elapsed_minutes() );
+    }
   }
 
-  net.set_weights( best_weights );
+  _profile_seconds += training_timer.get_elapsed_seconds();
 
-  results.add_network( net );
-  results.add_lstm_config( lstm_config );
-  results.add_repr_config( repr_config );
-  results.add_training_config( training_config );
-  results.add_min_max( training_stream.get_min_max() );
+  if( _verbose ) {
+    cout << endl;
+    print_profile( _profile_seconds );
+  }
 
-  results.add_result( best_result );
+  _training_minutes += training_timer.get_elapsed_minutes();
 
-  cout << endl << "Writing results to " << results.get_filename() << endl;
+  if( stopped_worker )
+    rethrow_exception( stopped_worker );
+}
+
+/**
+ * Print the training profile for this session, which has trained for
+ * seconds, and when training in parallel, the steps per second per worker
+ * and the worker utilization (see LstmTrainer::get_worker_utilization()).
+ */
+void Trainer::print_profile( double seconds ) {
+  if( seconds <= 0.0 )
+    return;
+
+  TrainingProfile profile = _trainer->get_profile();
+  size_t worker_count = _trainer->get_worker_count();
+
+  if( worker_count > 0 )
+    cout << worker_count << " workers: " << profile.step_count / seconds /
+      worker_count << " training steps per second per worker, "
+         << 100.0 * _trainer->get_worker_utilization()
+         << "% worker utilization" << endl;
+
+  profile.print( cout, seconds );
+}
+
+/**
+ * Write the training profile for this session to the stats file next to the
+ * results.
+ */
+void Trainer::write_stats( double seconds ) {
+  if( _results_filename.empty() )
+    return;
+
+  TrainingProfile profile = _trainer->get_profile();
+  nlohmann::json stats = profile.get_json( seconds );
+
+  stats["worker_count"] = _trainer->get_worker_count();
+  stats["worker_utilization"] = _trainer->get_worker_utilization();
+
+  string filename = TrainingProfile::get_stats_filename( _results_filename );
+
+  try {
+    ofstream outfile( filename );
+    outfile << stats.dump( 1 );
+  }
+  catch( const ios_base::failure& e ) {
+    throw TrainerException( e.what() );
+  }
+}
+
+/**
+ * Writes the results file, the binary model file, and the results index
+ * entry for the network with the best validation MSE seen so far.
+ */
+void Trainer::write_results() {
+  TRACE_SCOPE( "Trainer::write_results" );
+
+  TrainingResults results( _results_filename, WRITE_RESULTS );
+
+  add_results( results );
+
+  if( _verbose )
+    cout << endl << "Writing results to " << results.get_filename() << endl;
 
   results.write();
+
+  write_model( ModelFile::get_model_filename( results.get_filename() ) );
+
+  write_stats( _profile_seconds );
+
+  ResultsIndex::add_entry( _results_dir_name, results.get_index_entry() );
+}
+
+/**
+ * Write the binary model file for the network that add_results() added to
+ * the results.
+ */
+void Trainer::write_model( const string& model_filename ) const {
+  ModelFile::write( model_filename, *_net, _min_max, *_repr_config );
+}
+
+/**
+ * Add the network with the best validation MSE seen so far and its
+ * configuration to results that have not been written yet.
+ */
+void Trainer::add_results( TrainingResults& results ) {
+  if( !_best_weights.empty() )
+    _net->set_connection_weights( _best_weights );
+
+  results.add_network( *_net );
+  results.add_lstm_config( *_lstm_config );
+  results.add_repr_config( *_repr_config );
+  results.add_training_config( *_training_config );
+  results.add_min_max( _min_max );
+
+  // only called once training has stopped, so the samples can be moved
+  results.add_result( std::move( _best_result ),
+                      _training_config->get_validation_trace_sample_limit() );
 }
@@ -20,26 +20,36 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #pragma once
 
 #include <iostream>
+#include <fstream>
 #include <algorithm>
 #include <vector>
 #include <ctime>
 #include <string>
+#include <memory>
+#include <exception>
 
 #include <thread>
 #include <chrono>
 #include <csignal>
 
 #include "config_directory.hpp"
+#include "config_parser.hpp"
 #include "littlelstm/lstm_network.hpp"
 #include "littlelstm/lstm_architecture.hpp"
 #include "training_sequence.hpp"
 #include "training_event_stream.hpp"
 #include "training_results.hpp"
+#include "model_file.hpp"
 #include "lstm_trainer.hpp"
 #include "lstm_validation_results.hpp"
 #include "midi_config.hpp"
 #include "midi_translator.hpp"
+#include "representation_config.hpp"
 #include "training_config.hpp"
+#include "training_checkpoint.hpp"
+#include "warm_start.hpp"
+#include "training_coordinator.hpp"
+#include "time_utilities.hpp"
 
 namespace larasynth {
 
@@ -49,15 +59,129 @@ public:
     : runtime_error( message ) {};
 };
 
+/**
+ * Trains an LSTM network using the configuration file and training examples
+ * from a configuration directory. The network starts from random weights, or
+ * from the weights in earlier results if warm_start_results is set in the
+ * training configuration (see WarmStart).
+ *
+ * The first constructor runs a complete training session and writes the
+ * results, which is what `lara train` does. It also writes periodic
+ * checkpoints so that an interrupted session can be resumed. The second
+ * constructor only sets up the session from an already parsed configuration
+ * so that the caller can train in budgeted steps with train() and decide
+ * whether to call write_results(), which is what `lara search` does for each
+ * trial. save_checkpoint() and restore_checkpoint() copy the whole training
+ * state, which the first constructor writes to and resumes from checkpoint
+ * files.
+ *
+ * If thread_count in the training configuration is not 1, the epochs are run
+ * by worker trainers on separate threads and their weights are averaged (see
+ * LstmTrainer). With a nonzero worker_process_count, the first constructor
+ * instead coordinates that many worker processes, each of which runs
+ * train_as_worker() on its shard of the training examples (see
+ * TrainingCoordinator).
+ *
+ * With a ctrl_group, the second constructor sets up a network for only that
+ * group of controllers from the representation's controller_groups, which
+ * GroupTrainer trains side by side with the other groups.
+ */
 class Trainer {
 public:
   Trainer( const std::string& config_directory_path,
-           volatile sig_atomic_t* shutdown_flag );
+           volatile sig_atomic_t* shutdown_flag, bool resume = false,
+           size_t worker_process_count = 0 );
+
+  Trainer( ConfigDirectory& dir, ConfigParser& cp,
+           const std::string& results_filename,
+           volatile sig_atomic_t* shutdown_flag, bool verbose,
+           size_t shard_index = 0, size_t shard_count = 1,
+           const std::vector<event_data_t>& ctrl_group = {} );
+
+  static void train_as_worker( const std::string& config_directory_path );
+
+  static void seed_random_numbers( const std::string& config_file_path,
+                                   uint64_t stream = 0 );
+
+  void train( size_t epoch_limit = 0, double minute_limit = 0.0 );
+  void write_results();
+  void add_results( TrainingResults& results );
+  void write_model( const std::string& model_filename ) const;
+
+  void save_checkpoint( TrainingCheckpoint& checkpoint ) const;
+  void restore_checkpoint( const TrainingCheckpoint& checkpoint );
+
+  bool is_finished() const { return _finished; }
+  size_t get_epoch() const { return _trainer->get_epoch(); }
+  double get_best_mse() const { return _best_mse; }
+  double get_training_minutes() const { return _training_minutes; }
+  TrainingProfile get_profile() const { return _trainer->get_profile(); }
+
+  const LstmConfig& get_lstm_config() const { return *_lstm_config; }
+  const RepresentationConfig& get_repr_config() const { return *_repr_config; }
+  const std::string& get_results_filename() const
+  { return _results_filename; }
 
 private:
-  static bool _keep_running;
+  void setup( ConfigDirectory& dir, ConfigParser& cp );
+  void print_configuration();
+  void print_profile( double seconds );
+  void write_stats( double seconds );
+  void add_workers( littlelstm::LstmArchitecture& arch,
+                    const std::vector<std::string>& example_filenames,
+                    size_t update_period );
+  void warm_start( ConfigDirectory& dir );
+  void resume_from_checkpoint();
+  void write_checkpoint( double training_minutes );
 
   volatile sig_atomic_t* _shutdown_flag;
+  bool _verbose;
+  bool _finished;
+
+  std::string _results_filename;
+  std::string _results_dir_name;
+
+  size_t _worker_process_count;
+  size_t _shard_index;
+  size_t _shard_count;
+
+  // the controllers this network is for, if it is one of several groups
+  std::vector<event_data_t> _ctrl_group;
+  size_t _group_count;
+
+  size_t _max_epoch_count;
+  double _best_mse;
+  double _training_minutes;
+  double _profile_seconds = 0.0;
+  LstmResult _best_result;
+  littlelstm::ConnectionWeights_t _best_weights;
+
+  std::unique_ptr<TrainingConfig> _training_config;
+  std::unique_ptr<MidiConfig> _midi_config;
+  std::unique_ptr<RepresentationConfig> _repr_config;
+  std::unique_ptr<TrainingEventStream> _training_stream;
+  MidiMinMax _min_max;
+  std::unique_ptr<MidiTranslator> _translator;
+  std::unique_ptr<LstmConfig> _lstm_config;
+  std::unique_ptr<littlelstm::LstmNetwork> _net;
+  std::unique_ptr<LstmTrainer> _trainer;
+
+  // everything a worker trainer needs for itself to train on its own thread
+  struct TrainingWorker {
+    std::unique_ptr<TrainingEventStream> training_stream;
+    std::unique_ptr<MidiTranslator> translator;
+    std::unique_ptr<littlelstm::LstmNetwork> net;
+    std::unique_ptr<LstmTrainer> trainer;
+  };
+
+  std::vector<TrainingWorker> _workers;
+
+  std::unique_ptr<TrainingCoordinator> _coordinator;
+
+  // checkpointing is only enabled when _checkpoint_writer is set
+  std::string _checkpoint_filename;
+  std::unique_ptr<CheckpointWriter> _checkpoint_writer;
+  TrainingCheckpoint _checkpoint;
 };
 
 }
@@ -0,0 +1,283 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "training_benchmark.hpp"
+#include "memory_usage.hpp"
+
+using namespace std;
+using namespace larasynth;
+
+static const int LOWEST_PITCH = 48;
+static const int HIGHEST_PITCH = 72;
+static const double MIN_NOTE_SECONDS = 0.05;
+static const double MAX_NOTE_SECONDS = 0.5;
+
+TrainingBenchmark::TrainingBenchmark( const string& directory_name,
+                                      const TrainingBenchmarkConfig& config,
+                                      volatile sig_atomic_t* shutdown_flag )
+  : _config( config )
+  , _shutdown_flag( shutdown_flag )
+  , _corpus_event_count( 0 )
+{
+  if( _config.example_count == 0 || _config.controller_count == 0 ||
+      _config.epoch_count == 0 || _config.notes_per_second <= 0.0 ||
+      _config.example_seconds <= 0.0 || _config.block_counts.empty() )
+    throw TrainingBenchmarkException( "Invalid benchmark parameters" );
+
+  ConfigDirectory dir( directory_name );
+
+  // never overwrite a real project
+  if( dir.config_file_exists() ) {
+    throw TrainingBenchmarkException( dir.get_config_file_path() +
+                                      " already exists. Please choose a new "
+                                      "directory for the benchmark." );
+  }
+
+  if( !dir.exists() )
+    dir.create();
+
+  write_project( dir );
+
+  ConfigDirectory project_dir( directory_name );
+  project_dir.process_directory();
+
+  _report_filename = project_dir.get_directory_name() +
+    "training_benchmark.json";
+
+  run( project_dir );
+  print_report();
+
+  ofstream report_file( _report_filename );
+  report_file << _report.dump( 2 ) << endl;
+
+  cout << endl << "Wrote " << _report_filename << endl;
+}
+
+/**
+ * Get the configuration file of a benchmark project. Controllers are
+ * numbered from 1.
+ */
+string TrainingBenchmark::get_config_string( const TrainingBenchmarkConfig&
+                                             config ) {
+  ostringstream controllers;
+  ostringstream defaults;
+  ostringstream output_counts;
+
+  for( size_t c = 1; c <= config.controller_count; ++c ) {
+    string separator = c > 1 ? ", " : "";
+    controllers << separator << c;
+    defaults << separator << c << ", 64";
+    output_counts << separator << c << ", 8";
+  }
+
+  ostringstream block_counts;
+  for( size_t i = 0; i < config.block_counts.size(); ++i )
+    block_counts << ( i > 0 ? ", " : "" ) << config.block_counts[i];
+
+  ostringstream block_types;
+  for( size_t i = 0; i < config.block_types.size(); ++i )
+    block_types << ( i > 0 ? ", " : "" ) << "\""
+                << littlelstm::block_type_to_string( config.block_types[i] )
+                << "\"";
+
+  ostringstream oss;
+
+  oss << "# A synthetic project written by lara bench train" << endl
+      << endl
+      << "[midi]" << endl
+      << "controllers = " << controllers.str() << endl
+      << "controller_defaults = " << defaults.str() << endl
+      << endl
+      << "[representation]" << endl
+      << "controller_output_counts = " << output_counts.str() << endl
+      << "update_rate = 50" << endl
+      << "input_features = \"some note on\", \"note struck\", "
+      << "\"note released\", \"velocity\", \"interval\"" << endl
+      << endl
+      << "[lstm]" << endl
+      << "block_counts = " << block_counts.str() << endl;
+
+  if( !config.block_types.empty() )
+    oss << "block_types = " << block_types.str() << endl;
+
+  oss << endl
+      << "[training]" << endl
+      << "epoch_count_before_validating = "
+      << config.epoch_count_before_validating << endl
+      << "thread_count = 1" << endl
+      << "seed = " << config.seed << endl;
+
+  return oss.str();
+}
+
+/**
+ * Generate one synthetic training example. Notes arrive at random with an
+ * average of notes_per_second, one at a time, and every controller changes
+ * with each note to a value that depends on the note's pitch and velocity,
+ * so there is something for the network to learn.
+ */
+vector<Event>
+TrainingBenchmark::generate_example( const TrainingBenchmarkConfig& config,
+                                     size_t example_i ) {
+  mt19937 rand_engine( config.seed + example_i );
+
+  exponential_distribution<double> gap_dist( config.notes_per_second );
+  uniform_int_distribution<int> pitch_dist( LOWEST_PITCH, HIGHEST_PITCH );
+  uniform_int_distribution<int> velocity_dist( 40, 120 );
+  uniform_real_distribution<double> length_dist( MIN_NOTE_SECONDS,
+                                                 MAX_NOTE_SECONDS );
+
+  vector<Event> events;
+
+  double seconds = gap_dist( rand_engine );
+
+  while( seconds < config.example_seconds ) {
+    double next_seconds = seconds + gap_dist( rand_engine );
+    double off_seconds = min( seconds + length_dist( rand_engine ),
+                              next_seconds );
+
+    size_t on_time = seconds * MICROSECONDS_PER_SECOND;
+    size_t off_time = max( on_time + 1,
+                           (size_t)( off_seconds * MICROSECONDS_PER_SECOND ) );
+
+    int pitch = pitch_dist( rand_engine );
+    int velocity = velocity_dist( rand_engine );
+
+    for( size_t c = 1; c <= config.controller_count; ++c ) {
+      Event ctrl;
+      ctrl.set_ctrl( 0, c, ( pitch * c + velocity ) % 128, on_time );
+      events.push_back( ctrl );
+    }
+
+    Event note_on;
+    note_on.set_note_on( 0, pitch, velocity, on_time );
+    events.push_back( note_on );
+
+    Event note_off;
+    note_off.set_note_off( 0, pitch, 0, off_time );
+    events.push_back( note_off );
+
+    seconds = next_seconds;
+  }
+
+  return events;
+}
+
+void TrainingBenchmark::write_project( ConfigDirectory& dir ) {
+  ofstream config_file( dir.get_config_file_path() );
+  config_file << get_config_string( _config );
+  config_file.close();
+
+  string examples_dir_name = dir.get_directory_name() + "training_examples/";
+
+  if( !is_directory( examples_dir_name ) )
+    make_directory( examples_dir_name );
+
+  for( size_t i = 0; i < _config.example_count; ++i ) {
+    vector<Event> events = generate_example( _config, i );
+    _corpus_event_count += events.size();
+
+    ostringstream filename;
+    filename << examples_dir_name << "synthetic-" << i << ".seq";
+
+    write_events( events, filename.str() );
+  }
+
+  cout << "Wrote " << _config.example_count << " synthetic examples with "
+       << _corpus_event_count << " events to " << examples_dir_name << endl;
+}
+
+void TrainingBenchmark::run( ConfigDirectory& dir ) {
+  Trainer::seed_random_numbers( dir.get_config_file_path() );
+
+  ConfigParser cp( dir.get_config_file_path() );
+
+  Trainer trainer( dir, cp, dir.get_new_training_results_filename(),
+                   _shutdown_flag, false );
+
+  cout << "Training for " << _config.epoch_count << " epochs" << endl;
+
+  Timer timer;
+  trainer.train( _config.epoch_count );
+  double seconds = timer.get_elapsed_seconds();
+
+  TrainingProfile profile = trainer.get_profile();
+
+  double stream_rebuild_seconds = profile.stream_reset.get_seconds();
+  double validation_seconds = profile.validation.get_seconds();
+  double training_seconds =
+    max( 0.0, seconds - stream_rebuild_seconds - validation_seconds );
+
+  // every feed forward, in training and in validation, is a network step
+  uint64_t network_step_count = profile.network.activations.call_count;
+
+  _report = nlohmann::json();
+
+  _report["corpus"]["example_count"] = _config.example_count;
+  _report["corpus"]["example_seconds"] = _config.example_seconds;
+  _report["corpus"]["notes_per_second"] = _config.notes_per_second;
+  _report["corpus"]["controller_count"] = _config.controller_count;
+  _report["corpus"]["event_count"] = _corpus_event_count;
+  _report["corpus"]["seed"] = _config.seed;
+
+  _report["block_counts"] = _config.block_counts;
+  _report["block_types"] = nlohmann::json::array();
+  for( auto block_type : _config.block_types )
+    _report["block_types"].push_back(
+      littlelstm::block_type_to_string( block_type ) );
+  _report["epoch_count"] = trainer.get_epoch();
+  _report["validation_count"] = profile.validation.call_count;
+  _report["seconds"] = seconds;
+  _report["mse"] = trainer.get_best_mse();
+
+  _report["events_per_second"] =
+    seconds > 0.0 ? profile.event_count / seconds : 0.0;
+  _report["network_steps_per_second"] =
+    seconds > 0.0 ? network_step_count / seconds : 0.0;
+
+  // averaged over the epochs, although not every epoch is validated
+  double epoch_count = max<size_t>( trainer.get_epoch(), 1 );
+
+  _report["epoch_seconds"]["stream_rebuild"] =
+    stream_rebuild_seconds / epoch_count;
+  _report["epoch_seconds"]["training"] = training_seconds / epoch_count;
+  _report["epoch_seconds"]["validation"] = validation_seconds / epoch_count;
+
+  _report["peak_rss_bytes"] = get_peak_rss_bytes();
+  _report["profile"] = profile.get_json( seconds );
+}
+
+void TrainingBenchmark::print_report() {
+  cout << endl
+       << "Trained " << _report["epoch_count"] << " epochs with "
+       << _report["validation_count"] << " validations in "
+       << _report["seconds"] << " seconds" << endl
+       << "Best validation MSE: " << _report["mse"] << endl
+       << _report["events_per_second"] << " events per second" << endl
+       << _report["network_steps_per_second"] << " network steps per second"
+       << endl
+       << "Time per epoch:" << endl
+       << "  stream rebuild: " << _report["epoch_seconds"]["stream_rebuild"]
+       << " s" << endl
+       << "  training: " << _report["epoch_seconds"]["training"] << " s"
+       << endl
+       << "  validation: " << _report["epoch_seconds"]["validation"] << " s"
+       << endl
+       << "Peak memory: " << _report["peak_rss_bytes"].get<size_t>() / 1024
+       << " KiB" << endl;
+}
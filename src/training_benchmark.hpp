@@ -0,0 +1,109 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <csignal>
+#include <stdexcept>
+
+#include "config_directory.hpp"
+#include "config_parser.hpp"
+#include "event.hpp"
+#include "trainer.hpp"
+#include "training_profile.hpp"
+#include "write_training_example.hpp"
+#include "time_utilities.hpp"
+#include "json/json.hpp"
+
+namespace larasynth {
+
+class TrainingBenchmarkException : public std::runtime_error {
+public:
+  explicit TrainingBenchmarkException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * The synthetic project a TrainingBenchmark generates and how long to train
+ * it for.
+ */
+struct TrainingBenchmarkConfig {
+  size_t example_count = 4;
+  double example_seconds = 30.0;
+  double notes_per_second = 4.0;
+  size_t controller_count = 2;
+  std::vector<size_t> block_counts = { 16 };
+  // LSTM blocks in every hidden layer if empty
+  std::vector<littlelstm::lstm_block_t> block_types;
+  size_t epoch_count = 20;
+  size_t epoch_count_before_validating = 5;
+  unsigned int seed = 1;
+};
+
+/**
+ * Measures end to end training throughput, which is what `lara bench train`
+ * does.
+ *
+ * A synthetic project is written to a new directory: a configuration file and
+ * example_count training examples of random notes, with every controller
+ * changing on each note. The project is then trained for epoch_count epochs
+ * by a Trainer, exactly as `lara train` would train it, and a report of
+ * events and network steps per second, the average time per epoch spent
+ * rebuilding the training stream, training and validating, and the peak
+ * memory use is
+ * printed and written to training_benchmark.json in the project directory.
+ *
+ * The examples are generated from seed, so a benchmark can be repeated with
+ * the same corpus.
+ */
+class TrainingBenchmark {
+public:
+  TrainingBenchmark( const std::string& directory_name,
+                     const TrainingBenchmarkConfig& config,
+                     volatile sig_atomic_t* shutdown_flag );
+
+  const nlohmann::json& get_report() const { return _report; }
+  const std::string& get_report_filename() const
+  { return _report_filename; }
+
+  static std::string get_config_string( const TrainingBenchmarkConfig&
+                                        config );
+  static std::vector<Event> generate_example( const TrainingBenchmarkConfig&
+                                              config, size_t example_i );
+
+private:
+  void write_project( ConfigDirectory& dir );
+  void run( ConfigDirectory& dir );
+  void print_report();
+
+  TrainingBenchmarkConfig _config;
+  volatile sig_atomic_t* _shutdown_flag;
+
+  size_t _corpus_event_count;
+  nlohmann::json _report;
+  std::string _report_filename;
+};
+
+}
@@ -0,0 +1,472 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <iostream>
+#include <memory>
+#include <cmath>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "training_checkpoint.hpp"
+#include "byte_buffer.hpp"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+static const char CHECKPOINT_MAGIC[8] = { 'L', 'A', 'R', 'A',
+                                          'C', 'K', 'P', 'T' };
+static const uint64_t CHECKPOINT_VERSION = 1;
+static const uint64_t CHECKPOINT_BYTE_ORDER = 0x0102030405060708ULL;
+
+static void append_ctrl_values( string& bytes, const ctrl_values_t& values ) {
+  append_u64( bytes, values.size() );
+  for( auto& kv : values ) {
+    bytes.push_back( kv.first );
+    bytes.push_back( kv.second );
+  }
+}
+
+static void append_network_state( string& bytes,
+                                  const LstmNetworkState& state ) {
+  append_doubles( bytes, state.weights );
+  append_doubles( bytes, state.weight_changes );
+  append_doubles( bytes, state.second_moments );
+  append_u64( bytes, state.optimizer_step_count );
+  append_doubles( bytes, state.states );
+  append_doubles( bytes, state.old_states );
+  append_doubles( bytes, state.activations );
+  append_doubles( bytes, state.traces );
+  append_doubles( bytes, state.conn_gains );
+  append_doubles( bytes, state.self_conn_gains );
+  append_doubles( bytes, state.right_term_sums );
+  append_doubles( bytes, state.extended_traces );
+}
+
+static void append_translator_state( string& bytes,
+                                     const MidiTranslatorState& state ) {
+  append_doubles( bytes, state.previous_target );
+  append_u64( bytes, state.last_event_type );
+  append_u64( bytes, state.last_pitch );
+  append_u64( bytes, state.last_velocity );
+  append_u64( bytes, (int64_t)state.last_interval );
+}
+
+/**
+ * Reads the checkpoint's own values written by the append functions above.
+ */
+class CheckpointReader : public ByteReader<TrainingCheckpointException> {
+public:
+  CheckpointReader( const char* data, size_t size )
+    : ByteReader( data, size, "Checkpoint is truncated" ) {}
+
+  ctrl_values_t read_ctrl_values() {
+    uint64_t count = read_u64();
+    ctrl_values_t values;
+
+    for( uint64_t i = 0; i < count; ++i ) {
+      event_data_t pair[2];
+      read( pair, sizeof( pair ) );
+      values[pair[0]] = pair[1];
+    }
+
+    return values;
+  }
+
+  LstmNetworkState read_network_state() {
+    LstmNetworkState state;
+
+    state.weights = read_doubles();
+    state.weight_changes = read_doubles();
+    state.second_moments = read_doubles();
+    state.optimizer_step_count = read_u64();
+    state.states = read_doubles();
+    state.old_states = read_doubles();
+    state.activations = read_doubles();
+    state.traces = read_doubles();
+    state.conn_gains = read_doubles();
+    state.self_conn_gains = read_doubles();
+    state.right_term_sums = read_doubles();
+    state.extended_traces = read_doubles();
+
+    return state;
+  }
+
+  MidiTranslatorState read_translator_state() {
+    MidiTranslatorState state;
+
+    state.previous_target = read_doubles();
+    state.last_event_type = read_u64();
+    state.last_pitch = read_u64();
+    state.last_velocity = read_u64();
+    state.last_interval = (int64_t)read_u64();
+
+    return state;
+  }
+};
+
+TrainingCheckpoint::TrainingCheckpoint()
+  : epoch( 0 )
+  , max_streak( 0 )
+  , training_minutes( 0.0 )
+  , best_mse( INFINITY )
+{}
+
+TrainingCheckpoint::TrainingCheckpoint( const string& filename )
+  : TrainingCheckpoint()
+{
+  unique_ptr<MappedFile> file;
+
+  try {
+    file.reset( new MappedFile( filename ) );
+  }
+  catch( const FilesystemException& e ) {
+    throw TrainingCheckpointException( e.what() );
+  }
+
+  CheckpointReader reader( file->data(), file->size() );
+
+  char magic[sizeof( CHECKPOINT_MAGIC )];
+  reader.read( magic, sizeof( magic ) );
+
+  if( memcmp( magic, CHECKPOINT_MAGIC, sizeof( magic ) ) != 0 )
+    throw TrainingCheckpointException( filename + " is not a checkpoint" );
+
+  if( reader.read_u64() != CHECKPOINT_VERSION )
+    throw TrainingCheckpointException( filename + " has an unsupported "
+                                       "checkpoint version" );
+
+  if( reader.read_u64() != CHECKPOINT_BYTE_ORDER )
+    throw TrainingCheckpointException( filename + " was written on a machine "
+                                       "with a different byte order" );
+
+  epoch = reader.read_u64();
+  max_streak = reader.read_u64();
+  training_minutes = reader.read_double();
+
+  trainer_rand_state = reader.read_string();
+  stream_rand_state = reader.read_string();
+
+  schedule_state.plateau_scale = reader.read_double();
+  schedule_state.best_mse = reader.read_double();
+  schedule_state.stale_validation_count = reader.read_u64();
+
+  network_state = reader.read_network_state();
+  translator_state = reader.read_translator_state();
+
+  uint64_t worker_count = reader.read_u64();
+
+  // every worker takes more than a byte, so this rejects corrupt counts
+  if( worker_count > reader.get_remaining_size() )
+    throw TrainingCheckpointException( "Checkpoint is truncated" );
+
+  workers.resize( worker_count );
+
+  for( auto& worker : workers ) {
+    worker.trainer_rand_state = reader.read_string();
+    worker.stream_rand_state = reader.read_string();
+    worker.network_state = reader.read_network_state();
+    worker.translator_state = reader.read_translator_state();
+  }
+
+  best_mse = reader.read_double();
+
+  best_result = LstmResult( reader.read_u64() );
+  best_result.set_mse( reader.read_double() );
+
+  uint64_t kept_sample_count = reader.read_u64();
+
+  for( uint64_t i = 0; i < kept_sample_count; ++i ) {
+    ctrl_values_t target = reader.read_ctrl_values();
+    ctrl_values_t output = reader.read_ctrl_values();
+
+    map<size_t, double> cell_states;
+    uint64_t cell_count = reader.read_u64();
+
+    for( uint64_t j = 0; j < cell_count; ++j ) {
+      size_t id = reader.read_u64();
+      cell_states[id] = reader.read_double();
+    }
+
+    best_result.add_sample( move( target ), move( output ),
+                            move( cell_states ) );
+  }
+
+  uint64_t sample_count = reader.read_u64();
+  best_result.set_sample_count( sample_count, reader.read_u64() );
+
+  best_weights = reader.read_doubles();
+
+  if( !reader.at_end() )
+    throw TrainingCheckpointException( filename + " has trailing data" );
+}
+
+/**
+ * Get the name of the checkpoint file for the training run that will write
+ * results_filename.
+ */
+string TrainingCheckpoint::get_checkpoint_filename( const string&
+                                                    results_filename ) {
+  return replace_extension( results_filename, ".checkpoint" );
+}
+
+/**
+ * Get the path of the newest checkpoint in a training results directory, or
+ * an empty string if there are none. Results filenames start with a
+ * timestamp, so the newest checkpoint sorts last.
+ */
+string TrainingCheckpoint::find_latest_checkpoint( const string&
+                                                   results_dir ) {
+  vector<string> filenames;
+  vector<string> subdirs;
+
+  get_directory_filenames_and_subdirs( results_dir, filenames, subdirs );
+
+  string suffix = ".checkpoint";
+  string latest;
+
+  for( auto& filename : filenames ) {
+    if( filename.size() > suffix.size() &&
+        filename.compare( filename.size() - suffix.size(), suffix.size(),
+                          suffix ) == 0 )
+      latest = max( latest, filename );
+  }
+
+  if( latest.empty() )
+    return latest;
+
+  return results_dir + latest;
+}
+
+string TrainingCheckpoint::get_bytes() const {
+  string bytes;
+
+  bytes.append( CHECKPOINT_MAGIC, sizeof( CHECKPOINT_MAGIC ) );
+  append_u64( bytes, CHECKPOINT_VERSION );
+  append_u64( bytes, CHECKPOINT_BYTE_ORDER );
+
+  append_u64( bytes, epoch );
+  append_u64( bytes, max_streak );
+  append_double( bytes, training_minutes );
+
+  append_string( bytes, trainer_rand_state );
+  append_string( bytes, stream_rand_state );
+
+  append_double( bytes, schedule_state.plateau_scale );
+  append_double( bytes, schedule_state.best_mse );
+  append_u64( bytes, schedule_state.stale_validation_count );
+
+  append_network_state( bytes, network_state );
+  append_translator_state( bytes, translator_state );
+
+  append_u64( bytes, workers.size() );
+
+  for( auto& worker : workers ) {
+    append_string( bytes, worker.trainer_rand_state );
+    append_string( bytes, worker.stream_rand_state );
+    append_network_state( bytes, worker.network_state );
+    append_translator_state( bytes, worker.translator_state );
+  }
+
+  append_double( bytes, best_mse );
+
+  append_u64( bytes, best_result.get_epoch() );
+  append_double( bytes, best_result.get_mse() );
+
+  const vector<ctrl_values_t>& targets = best_result.get_targets();
+  const vector<ctrl_values_t>& outputs = best_result.get_outputs();
+  const vector< map<size_t, double> >& cell_states =
+    best_result.get_cell_states();
+
+  if( outputs.size() != targets.size() ||
+      cell_states.size() != targets.size() )
+    throw TrainingCheckpointException( "Best result has mismatched sample "
+                                       "counts" );
+
+  append_u64( bytes, targets.size() );
+
+  for( size_t i = 0; i < targets.size(); ++i ) {
+    append_ctrl_values( bytes, targets[i] );
+    append_ctrl_values( bytes, outputs[i] );
+
+    append_u64( bytes, cell_states[i].size() );
+    for( auto& kv : cell_states[i] ) {
+      append_u64( bytes, kv.first );
+      append_double( bytes, kv.second );
+    }
+  }
+
+  append_u64( bytes, best_result.get_sample_count() );
+  append_u64( bytes, best_result.get_sample_stride() );
+
+  append_doubles( bytes, best_weights );
+
+  return bytes;
+}
+
+CheckpointWriter::CheckpointWriter()
+  : _pending( false )
+  , _writing( false )
+  , _stopping( false )
+  , _thread( &CheckpointWriter::run, this )
+{}
+
+CheckpointWriter::~CheckpointWriter() {
+  {
+    lock_guard<mutex> lock( _mutex );
+    _stopping = true;
+  }
+
+  _cond.notify_all();
+  _thread.join();
+}
+
+/**
+ * Queue bytes to be written to filename. Returns without waiting for the
+ * write.
+ */
+void CheckpointWriter::write( const string& filename, string&& bytes ) {
+  {
+    lock_guard<mutex> lock( _mutex );
+    _filename = filename;
+    _bytes = move( bytes );
+    _pending = true;
+  }
+
+  _cond.notify_all();
+}
+
+/**
+ * Wait until every queued checkpoint has been written. Throws if any write
+ * has failed since the last flush.
+ */
+void CheckpointWriter::flush() {
+  unique_lock<mutex> lock( _mutex );
+  _cond.wait( lock, [this]() { return !_pending && !_writing; } );
+
+  if( !_error.empty() ) {
+    string error = _error;
+    _error.clear();
+    throw TrainingCheckpointException( error );
+  }
+}
+
+/**
+ * Write bytes to filename and wait for them to reach the disk. Returns false
+ * on any error.
+ */
+static bool write_and_sync( const string& filename, const string& bytes ) {
+  int fd = open( filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+
+  if( fd == -1 )
+    return false;
+
+  const char* data = bytes.data();
+  size_t remaining = bytes.size();
+
+  while( remaining > 0 ) {
+    ssize_t written = ::write( fd, data, remaining );
+
+    if( written == -1 ) {
+      if( errno == EINTR )
+        continue;
+
+      close( fd );
+      return false;
+    }
+
+    data += written;
+    remaining -= written;
+  }
+
+  bool synced = ( fsync( fd ) == 0 );
+
+  return close( fd ) == 0 && synced;
+}
+
+/**
+ * Wait for the directory entries of the directory holding filename to reach
+ * the disk. Returns false on any error.
+ */
+static bool sync_parent_directory( const string& filename ) {
+  size_t slash = filename.rfind( '/' );
+  string dirname = ".";
+
+  if( slash == 0 )
+    dirname = "/";
+  else if( slash != string::npos )
+    dirname = filename.substr( 0, slash );
+
+  int fd = open( dirname.c_str(), O_RDONLY | O_DIRECTORY );
+
+  if( fd == -1 )
+    return false;
+
+  bool synced = ( fsync( fd ) == 0 );
+
+  return close( fd ) == 0 && synced;
+}
+
+void CheckpointWriter::run() {
+  unique_lock<mutex> lock( _mutex );
+
+  while( true ) {
+    _cond.wait( lock, [this]() { return _pending || _stopping; } );
+
+    // finish any queued write before stopping
+    if( !_pending )
+      return;
+
+    string filename = _filename;
+    string bytes = move( _bytes );
+    _pending = false;
+    _writing = true;
+
+    lock.unlock();
+
+    string temp_filename = filename + ".tmp";
+    string error;
+
+    // the data must be on disk before the rename replaces the only good
+    // checkpoint, and the rename must be on disk before it is relied upon
+    if( !write_and_sync( temp_filename, bytes ) )
+      error = "Error writing " + temp_filename;
+
+    if( error.empty() && rename( temp_filename.c_str(),
+                                 filename.c_str() ) != 0 )
+      error = "Error renaming " + temp_filename + " to " + filename;
+
+    if( error.empty() && !sync_parent_directory( filename ) )
+      error = "Error syncing the directory of " + filename;
+
+    if( !error.empty() )
+      cerr << error << endl;
+
+    lock.lock();
+
+    _writing = false;
+    if( !error.empty() )
+      _error = error;
+
+    _cond.notify_all();
+  }
+}
@@ -0,0 +1,131 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+
+#include "littlelstm/lstm_network.hpp"
+#include "lstm_result.hpp"
+#include "midi_translator.hpp"
+#include "learning_rate_schedule.hpp"
+#include "filesystem_operations.hpp"
+
+namespace larasynth {
+
+class TrainingCheckpointException : public std::runtime_error {
+public:
+  explicit TrainingCheckpointException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * The training state of one of the worker trainers that train on their own
+ * threads (see LstmTrainer::add_worker()).
+ */
+struct WorkerCheckpoint {
+  std::string trainer_rand_state;
+  std::string stream_rand_state;
+  littlelstm::LstmNetworkState network_state;
+  MidiTranslatorState translator_state;
+};
+
+/**
+ * Everything needed to continue an interrupted training run exactly where
+ * it left off: the training state of the network and translator, the
+ * trainer's position and random number generator states, the same for each
+ * worker thread, and the best result so far. The state of worker processes
+ * (see TrainingCoordinator) is not included.
+ *
+ * Checkpoints are binary files in native byte order. The file starts with
+ * the magic string "LARACKPT", a version number and a byte order mark, each
+ * 8 bytes, followed by the fields in the order they are declared here.
+ */
+class TrainingCheckpoint {
+public:
+  TrainingCheckpoint();
+  explicit TrainingCheckpoint( const std::string& filename );
+
+  std::string get_bytes() const;
+
+  static std::string get_checkpoint_filename( const std::string&
+                                              results_filename );
+  static std::string find_latest_checkpoint( const std::string&
+                                             results_dir );
+
+  size_t epoch;
+  size_t max_streak;
+  double training_minutes;
+
+  std::string trainer_rand_state;
+  std::string stream_rand_state;
+
+  LearningRateScheduleState schedule_state;
+
+  littlelstm::LstmNetworkState network_state;
+  MidiTranslatorState translator_state;
+
+  std::vector<WorkerCheckpoint> workers;
+
+  double best_mse;
+  LstmResult best_result;
+  littlelstm::ConnectionWeights_t best_weights;
+};
+
+/**
+ * Writes checkpoints on a background thread so that training does not wait
+ * for the disk. Each checkpoint is written under a temporary name, synced to
+ * disk and renamed into place, and the directory is synced after the rename,
+ * so neither an interrupted write nor a crash or power loss ever replaces a
+ * good checkpoint.
+ *
+ * If a new checkpoint is queued while the previous one is still being
+ * written, only the newest one is kept.
+ */
+class CheckpointWriter {
+public:
+  CheckpointWriter();
+  ~CheckpointWriter();
+
+  void write( const std::string& filename, std::string&& bytes );
+  void flush();
+
+private:
+  void run();
+
+  std::mutex _mutex;
+  std::condition_variable _cond;
+
+  std::string _filename;
+  std::string _bytes;
+  bool _pending;
+  bool _writing;
+  bool _stopping;
+  std::string _error;
+
+  std::thread _thread;
+};
+
+}
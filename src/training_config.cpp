@@ -64,6 +64,18 @@ TrainingConfig::TrainingConfig( ConfigParameters& params ) {
                                  &_squared_error_failure_tolerance,
                                  DEFAULT_SQUARED_ERROR_FAILURE_TOLERANCE,
                                  (size_t)0, size_t_max );
+  optional_size_ts.emplace_back( "validation_trace_sample_limit",
+                                 &_validation_trace_sample_limit,
+                                 DEFAULT_VALIDATION_TRACE_SAMPLE_LIMIT,
+                                 (size_t)0, size_t_max );
+  optional_size_ts.emplace_back( "thread_count", &_thread_count,
+                                 DEFAULT_TRAINING_THREAD_COUNT, (size_t)0,
+                                 size_t_max );
+  optional_size_ts.emplace_back( "averaging_period", &_averaging_period,
+                                 DEFAULT_AVERAGING_PERIOD, (size_t)1,
+                                 size_t_max );
+  optional_size_ts.emplace_back( "seed", &_seed, DEFAULT_TRAINING_SEED,
+                                 (size_t)0, size_t_max );
 
   for( auto& var_to_set : optional_size_ts ) {
     try {
@@ -120,6 +132,13 @@ TrainingConfig::TrainingConfig( ConfigParameters& params ) {
                                  DEFAULT_ZERO_NETWORK_ON_RESET, 0.0, 1.0 );
   optional_doubles.emplace_back( "mse_threshold", &_mse_threshold,
                                  DEFAULT_MSE_THRESHOLD, 0.0, double_max );
+  optional_doubles.emplace_back( "checkpoint_minutes", &_checkpoint_minutes,
+                                 DEFAULT_CHECKPOINT_MINUTES, 0.0,
+                                 double_max );
+  optional_doubles.emplace_back( "round_timeout_minutes",
+                                 &_round_timeout_minutes,
+                                 DEFAULT_ROUND_TIMEOUT_MINUTES, 0.0,
+                                 double_max );
 
   for( auto& var_to_set : optional_doubles ) {
     try {
@@ -134,6 +153,16 @@ TrainingConfig::TrainingConfig( ConfigParameters& params ) {
     }
   }
 
+  try {
+    params.set_var( "warm_start_results", _warm_start_results );
+  }
+  catch( ConfigParameterException& e ) {
+    throw TrainingConfigException( e.what() );
+  }
+  catch( UndefinedParameterException& e ) {
+    _warm_start_results = "";
+  }
+
   // any unset parameters are invalid
   set<string> unset_params = params.get_unset_params();
   if( unset_params.size() != 0 ) {
@@ -159,4 +188,12 @@ void TrainingConfig::print_training_configuration() {
        << _consecutive_failures_for_reset << endl;
   cout << "Squared error failure tolerance: "
        << _squared_error_failure_tolerance << endl;
+  if( _thread_count != 1 ) {
+    cout << "Threads: " << _thread_count << endl;
+    cout << "Averaging period: " << _averaging_period << " epoch(s)" << endl;
+  }
+  if( _seed != 0 )
+    cout << "Random seed: " << _seed << endl;
+  if( _warm_start_results != "" )
+    cout << "Warm start from: " << _warm_start_results << endl;
 }
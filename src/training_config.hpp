@@ -86,6 +86,14 @@ public:
   double get_zero_network_on_reset() const { return _zero_network_on_reset; }
   double get_mse_threshold() const { return _mse_threshold; }
   int get_max_epoch_count() const { return _max_epoch_count; }
+  size_t get_validation_trace_sample_limit() const
+  { return _validation_trace_sample_limit; }
+  double get_checkpoint_minutes() const { return _checkpoint_minutes; }
+  double get_round_timeout_minutes() const { return _round_timeout_minutes; }
+  std::string get_warm_start_results() const { return _warm_start_results; }
+  size_t get_thread_count() const { return _thread_count; }
+  size_t get_averaging_period() const { return _averaging_period; }
+  size_t get_seed() const { return _seed; }
 
 private:
   // booleans
@@ -110,9 +118,17 @@ private:
   size_t _round_count;
   size_t _consecutive_failures_for_reset;
   size_t _squared_error_failure_tolerance;
+  size_t _validation_trace_sample_limit;
+  size_t _thread_count;
+  size_t _averaging_period;
+  size_t _seed;
 
   int _max_epoch_count;
   double _mse_threshold;
+  double _checkpoint_minutes;
+  double _round_timeout_minutes;
+
+  std::string _warm_start_results;
 };
 
 }
@@ -0,0 +1,528 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <chrono>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "training_coordinator.hpp"
+#include "byte_buffer.hpp"
+#include "time_utilities.hpp"
+#include "filesystem_operations.hpp"
+
+using namespace std;
+using namespace larasynth;
+
+static const string SOCKET_BASENAME = "coordinator.socket";
+static const int ACCEPT_POLL_MILLISECONDS = 250;
+static const int REQUEST_WAIT_MILLISECONDS = 5000;
+
+static string error_string( const string& what ) {
+  return what + ": " + strerror( errno );
+}
+
+static vector<littlelstm::PhaseCounter*> get_counters( TrainingProfile&
+                                                       profile ) {
+  return { &profile.network.activations, &profile.network.eligibility_traces,
+           &profile.network.error_responsibilities,
+           &profile.network.weight_updates, &profile.stream_reset,
+           &profile.stream, &profile.translator, &profile.validation };
+}
+
+static void append_profile( string& bytes, TrainingProfile profile ) {
+  for( littlelstm::PhaseCounter* counter : get_counters( profile ) ) {
+    append_u64( bytes, counter->call_count );
+    append_u64( bytes, counter->nanoseconds );
+  }
+
+  append_u64( bytes, profile.network.connection_update_count );
+  append_u64( bytes, profile.step_count );
+  append_u64( bytes, profile.event_count );
+}
+
+static void append_round( string& bytes, const TrainingRound& round ) {
+  append_u64( bytes, round.epoch );
+  append_u64( bytes, round.epoch_count );
+  append_u64( bytes, round.max_streak );
+  append_double( bytes, round.schedule_state.plateau_scale );
+  append_double( bytes, round.schedule_state.best_mse );
+  append_u64( bytes, round.schedule_state.stale_validation_count );
+  append_doubles( bytes, round.weights );
+}
+
+static void append_result( string& bytes, const TrainingRoundResult& result ) {
+  append_doubles( bytes, result.weight_deltas );
+  append_u64( bytes, result.max_streak );
+  append_u64( bytes, result.step_count );
+  append_double( bytes, result.learning_rate );
+  append_double( bytes, result.seconds );
+  append_profile( bytes, result.profile );
+}
+
+/**
+ * The size of a round message for a network with weight_count weights.
+ */
+static size_t get_round_size( size_t weight_count ) {
+  string bytes;
+  append_round( bytes, TrainingRound() );
+
+  return bytes.size() + weight_count * sizeof( double );
+}
+
+/**
+ * The size of a result message for a network with weight_count weights.
+ */
+static size_t get_result_size( size_t weight_count ) {
+  string bytes;
+  append_result( bytes, TrainingRoundResult() );
+
+  return bytes.size() + weight_count * sizeof( double );
+}
+
+static const size_t HELLO_SIZE = 3 * sizeof( uint64_t );
+
+/**
+ * Reads the messages written with the append functions.
+ */
+class MessageReader : public ByteReader<TrainingCoordinatorException> {
+public:
+  explicit MessageReader( const string& bytes )
+    : ByteReader( bytes.data(), bytes.size(),
+                  "Training message is truncated" ) {}
+
+  TrainingProfile read_profile() {
+    TrainingProfile profile;
+
+    for( littlelstm::PhaseCounter* counter : get_counters( profile ) ) {
+      counter->call_count = read_u64();
+      counter->nanoseconds = read_u64();
+    }
+
+    profile.network.connection_update_count = read_u64();
+    profile.step_count = read_u64();
+    profile.event_count = read_u64();
+
+    return profile;
+  }
+};
+
+/**
+ * Send a size-prefixed message. MSG_NOSIGNAL turns a closed peer into an
+ * error instead of a SIGPIPE.
+ */
+static void send_message( int fd, const string& payload ) {
+  string bytes;
+  append_u64( bytes, payload.size() );
+  bytes.append( payload );
+
+  size_t sent = 0;
+
+  while( sent < bytes.size() ) {
+    ssize_t count = send( fd, bytes.data() + sent, bytes.size() - sent,
+                          MSG_NOSIGNAL );
+    if( count < 0 ) {
+      if( errno == EINTR )
+        continue;
+      throw TrainingCoordinatorException(
+        error_string( "Could not send training message" ) );
+    }
+
+    sent += count;
+  }
+}
+
+/**
+ * Read exactly size bytes. Returns false if the peer closed the connection
+ * before the first byte.
+ */
+static bool receive_bytes( int fd, char* dest, size_t size ) {
+  size_t received = 0;
+
+  while( received < size ) {
+    ssize_t count = recv( fd, dest + received, size - received, 0 );
+    if( count < 0 ) {
+      if( errno == EINTR )
+        continue;
+      throw TrainingCoordinatorException(
+        error_string( "Could not receive training message" ) );
+    }
+    if( count == 0 ) {
+      if( received == 0 )
+        return false;
+      throw TrainingCoordinatorException( "Training message is truncated" );
+    }
+
+    received += count;
+  }
+
+  return true;
+}
+
+/**
+ * Receive a size-prefixed message of at most max_size bytes. Returns false if
+ * the peer closed the connection. A larger size can only come from a stray or
+ * corrupt message, so it is refused before anything is allocated for it.
+ */
+static bool receive_message( int fd, string& payload, size_t max_size ) {
+  uint64_t size;
+
+  if( !receive_bytes( fd, reinterpret_cast<char*>( &size ), sizeof( size ) ) )
+    return false;
+
+  if( size > max_size )
+    throw TrainingCoordinatorException( "Training message of " +
+                                        to_string( size ) + " bytes is " +
+                                        "larger than the largest message "
+                                        "of " + to_string( max_size ) +
+                                        " bytes" );
+
+  payload.resize( size );
+
+  if( size > 0 && !receive_bytes( fd, &payload[0], size ) )
+    throw TrainingCoordinatorException( "Training message is truncated" );
+
+  return true;
+}
+
+/**
+ * Wait for the shard request that a worker sends as soon as it connects.
+ * Returns false if nothing arrives within REQUEST_WAIT_MILLISECONDS, so a
+ * connection that never sends cannot stall the coordinator. Waiting stops
+ * with an exception if the shutdown flag is set.
+ */
+static bool wait_for_request( int fd, volatile sig_atomic_t* shutdown_flag ) {
+  for( int waited = 0; waited < REQUEST_WAIT_MILLISECONDS;
+       waited += ACCEPT_POLL_MILLISECONDS ) {
+    if( *shutdown_flag )
+      throw TrainingCoordinatorException( "Stopped waiting for workers" );
+
+    pollfd request_poll = { fd, POLLIN, 0 };
+
+    if( poll( &request_poll, 1, ACCEPT_POLL_MILLISECONDS ) > 0 )
+      return true;
+  }
+
+  return false;
+}
+
+/**
+ * Wait for worker i's result. A worker that sends nothing for
+ * timeout_seconds is taken to have hung, so the wait stops with an exception,
+ * as it does if the shutdown flag is set. A timeout of 0.0 waits for as long
+ * as the worker takes.
+ */
+static void wait_for_result( int fd, size_t i, double timeout_seconds,
+                             volatile sig_atomic_t* shutdown_flag ) {
+  Timer timer;
+  timer.start();
+
+  while( true ) {
+    if( *shutdown_flag )
+      throw TrainingCoordinatorException( "Stopped waiting for worker " +
+                                          to_string( i ) );
+
+    pollfd result_poll = { fd, POLLIN, 0 };
+
+    if( poll( &result_poll, 1, ACCEPT_POLL_MILLISECONDS ) > 0 )
+      return;
+
+    if( timeout_seconds > 0.0 &&
+        timer.get_elapsed_seconds() >= timeout_seconds )
+      throw TrainingCoordinatorException( "Worker " + to_string( i ) +
+                                          " sent nothing for " +
+                                          to_string( timeout_seconds ) +
+                                          " seconds" );
+  }
+}
+
+static sockaddr_un get_socket_address( const string& filename ) {
+  sockaddr_un address;
+  memset( &address, 0, sizeof( address ) );
+  address.sun_family = AF_UNIX;
+
+  if( filename.size() >= sizeof( address.sun_path ) )
+    throw TrainingCoordinatorException( "The socket path " + filename +
+                                        " is too long" );
+
+  strncpy( address.sun_path, filename.c_str(),
+           sizeof( address.sun_path ) - 1 );
+
+  return address;
+}
+
+/**
+ * Whether a coordinator is listening at address. Connecting is the only way
+ * to tell a live socket from one left behind by a coordinator that did not
+ * exit cleanly.
+ */
+static bool is_listening( const sockaddr_un& address ) {
+  int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+  if( fd < 0 )
+    throw TrainingCoordinatorException(
+      error_string( "Could not create a socket" ) );
+
+  bool listening = connect( fd, (const sockaddr*)&address,
+                            sizeof( address ) ) == 0;
+  close( fd );
+
+  return listening;
+}
+
+string TrainingCoordinator::get_socket_filename( const string&
+                                                 results_dir ) {
+  string filename = results_dir;
+  append_slash_if_necessary( filename );
+
+  return filename + SOCKET_BASENAME;
+}
+
+/**
+ * Listen for the workers and wait until worker_count of them have connected.
+ * The workers get the shards in the order they connect, and are told that the
+ * network has weight_count weights. Waiting, here and in run_round(), stops
+ * with an exception if the shutdown flag is set, and run_round() gives up on
+ * a worker that sends nothing for round_timeout_seconds.
+ */
+TrainingCoordinator::TrainingCoordinator( const string& results_dir,
+                                          size_t worker_count,
+                                          size_t weight_count,
+                                          volatile sig_atomic_t*
+                                          shutdown_flag,
+                                          double round_timeout_seconds )
+  : _socket_filename( get_socket_filename( results_dir ) )
+  , _weight_count( weight_count )
+  , _listen_fd( -1 )
+  , _shutdown_flag( shutdown_flag )
+  , _round_timeout_seconds( round_timeout_seconds )
+{
+  sockaddr_un address = get_socket_address( _socket_filename );
+
+  if( is_listening( address ) )
+    throw TrainingCoordinatorException( "A coordinator is already listening "
+                                        "on " + _socket_filename );
+
+  _listen_fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+  if( _listen_fd < 0 )
+    throw TrainingCoordinatorException(
+      error_string( "Could not create the coordinator socket" ) );
+
+  // nothing is listening, so this was left behind by a coordinator that did
+  // not exit cleanly
+  unlink( _socket_filename.c_str() );
+
+  if( bind( _listen_fd, (sockaddr*)&address, sizeof( address ) ) < 0 ||
+      listen( _listen_fd, worker_count ) < 0 ) {
+    string error = error_string( "Could not listen on " + _socket_filename );
+    close( _listen_fd );
+    throw TrainingCoordinatorException( error );
+  }
+
+  try {
+    while( _worker_fds.size() < worker_count ) {
+      if( *shutdown_flag )
+        throw TrainingCoordinatorException( "Stopped waiting for workers" );
+
+      pollfd listen_poll = { _listen_fd, POLLIN, 0 };
+
+      if( poll( &listen_poll, 1, ACCEPT_POLL_MILLISECONDS ) <= 0 )
+        continue;
+
+      int fd = accept( _listen_fd, nullptr, nullptr );
+      if( fd < 0 ) {
+        if( errno == EINTR )
+          continue;
+        throw TrainingCoordinatorException(
+          error_string( "Could not accept a worker" ) );
+      }
+
+      // connections that close or stay silent without asking for a shard,
+      // such as another coordinator checking whether this one is running,
+      // are not workers
+      string request;
+      bool requested;
+
+      try {
+        requested = wait_for_request( fd, shutdown_flag ) &&
+                    receive_message( fd, request, 0 );
+      }
+      catch( ... ) {
+        close( fd );
+        throw;
+      }
+
+      if( !requested ) {
+        close( fd );
+        continue;
+      }
+
+      _worker_fds.push_back( fd );
+
+      string hello;
+      append_u64( hello, _worker_fds.size() - 1 );
+      append_u64( hello, worker_count );
+      append_u64( hello, _weight_count );
+      send_message( fd, hello );
+    }
+  }
+  catch( ... ) {
+    for( int fd : _worker_fds )
+      close( fd );
+    close( _listen_fd );
+    unlink( _socket_filename.c_str() );
+    throw;
+  }
+}
+
+TrainingCoordinator::~TrainingCoordinator() {
+  for( int fd : _worker_fds )
+    close( fd );
+
+  close( _listen_fd );
+  unlink( _socket_filename.c_str() );
+}
+
+/**
+ * Send the round to every worker and wait for all of their results, which
+ * are returned in shard order. Each worker has the round timeout to send its
+ * result after the previous worker's has arrived.
+ */
+vector<TrainingRoundResult>
+TrainingCoordinator::run_round( const TrainingRound& round ) {
+  if( round.weights.size() != _weight_count )
+    throw TrainingCoordinatorException( "The round's network does not match "
+                                        "the workers' network" );
+
+  string bytes;
+  append_round( bytes, round );
+
+  for( int fd : _worker_fds )
+    send_message( fd, bytes );
+
+  vector<TrainingRoundResult> results( _worker_fds.size() );
+
+  for( size_t i = 0; i < _worker_fds.size(); ++i ) {
+    string payload;
+
+    wait_for_result( _worker_fds[i], i, _round_timeout_seconds,
+                     _shutdown_flag );
+
+    if( !receive_message( _worker_fds[i], payload,
+                          get_result_size( _weight_count ) ) )
+      throw TrainingCoordinatorException( "Worker " + to_string( i ) +
+                                          " stopped training" );
+
+    MessageReader reader( payload );
+    results[i].weight_deltas = reader.read_doubles();
+    results[i].max_streak = reader.read_u64();
+    results[i].step_count = reader.read_u64();
+    results[i].learning_rate = reader.read_double();
+    results[i].seconds = reader.read_double();
+    results[i].profile = reader.read_profile();
+  }
+
+  return results;
+}
+
+/**
+ * Connect to the coordinator for the project whose results are in
+ * results_dir. The coordinator may be started after the worker, so
+ * connecting is retried until timeout_seconds have passed.
+ */
+TrainingWorkerConnection::TrainingWorkerConnection( const string& results_dir,
+                                                    double timeout_seconds )
+  : _fd( -1 )
+{
+  string filename = TrainingCoordinator::get_socket_filename( results_dir );
+  sockaddr_un address = get_socket_address( filename );
+
+  Timer timer;
+
+  while( true ) {
+    _fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if( _fd < 0 )
+      throw TrainingCoordinatorException(
+        error_string( "Could not create a worker socket" ) );
+
+    if( connect( _fd, (sockaddr*)&address, sizeof( address ) ) == 0 )
+      break;
+
+    string error = error_string( "Could not connect to " + filename );
+    close( _fd );
+
+    if( timer.get_elapsed_seconds() >= timeout_seconds )
+      throw TrainingCoordinatorException( error );
+
+    this_thread::sleep_for( chrono::milliseconds( 100 ) );
+  }
+
+  try {
+    send_message( _fd, string() );
+
+    string hello;
+    if( !receive_message( _fd, hello, HELLO_SIZE ) )
+      throw TrainingCoordinatorException( "The coordinator closed the "
+                                          "connection" );
+
+    MessageReader reader( hello );
+    _shard_index = reader.read_u64();
+    _shard_count = reader.read_u64();
+    _weight_count = reader.read_u64();
+  }
+  catch( ... ) {
+    close( _fd );
+    throw;
+  }
+}
+
+TrainingWorkerConnection::~TrainingWorkerConnection() {
+  close( _fd );
+}
+
+/**
+ * Wait for the next round. Returns false once the coordinator has finished.
+ */
+bool TrainingWorkerConnection::receive_round( TrainingRound& round ) {
+  string payload;
+
+  if( !receive_message( _fd, payload, get_round_size( _weight_count ) ) )
+    return false;
+
+  MessageReader reader( payload );
+  round.epoch = reader.read_u64();
+  round.epoch_count = reader.read_u64();
+  round.max_streak = reader.read_u64();
+  round.schedule_state.plateau_scale = reader.read_double();
+  round.schedule_state.best_mse = reader.read_double();
+  round.schedule_state.stale_validation_count = reader.read_u64();
+  round.weights = reader.read_doubles();
+
+  return true;
+}
+
+void TrainingWorkerConnection::send_result( const TrainingRoundResult&
+                                            result ) {
+  string bytes;
+  append_result( bytes, result );
+
+  send_message( _fd, bytes );
+}
@@ -0,0 +1,107 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <csignal>
+
+#include "lstm_trainer.hpp"
+
+namespace larasynth {
+
+class TrainingCoordinatorException : public std::runtime_error {
+public:
+  explicit TrainingCoordinatorException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * Coordinates training of one network by worker processes on the same
+ * machine (`lara train --coordinate` and `lara train --worker`).
+ *
+ * The coordinator listens on a Unix socket in the project's training results
+ * directory and waits for the workers to connect, refusing to start if
+ * another coordinator is already listening there. Each worker asks for a
+ * shard with an empty message and is told which shard of the training
+ * examples to train on and how many weights the network has. For each round
+ * of periodic averaging, run_round() sends the round to every worker, and
+ * every worker trains on its shard and sends back its weight changes (see
+ * LstmTrainer). A worker that sends nothing for the round timeout, or a
+ * shutdown while waiting, ends the round with an exception. Closing the
+ * coordinator tells the workers that training is over.
+ *
+ * Messages are a 64-bit size followed by that many bytes, with the fields in
+ * native byte order, so the coordinator and workers must be built the same
+ * way. A message larger than the largest one the protocol can carry for the
+ * network is refused.
+ */
+class TrainingCoordinator {
+public:
+  TrainingCoordinator( const std::string& results_dir, size_t worker_count,
+                       size_t weight_count,
+                       volatile sig_atomic_t* shutdown_flag,
+                       double round_timeout_seconds = 0.0 );
+  ~TrainingCoordinator();
+
+  TrainingCoordinator( const TrainingCoordinator& ) = delete;
+  TrainingCoordinator& operator=( const TrainingCoordinator& ) = delete;
+
+  std::vector<TrainingRoundResult> run_round( const TrainingRound& round );
+
+  static std::string get_socket_filename( const std::string& results_dir );
+
+private:
+  std::string _socket_filename;
+  size_t _weight_count;
+  int _listen_fd;
+  std::vector<int> _worker_fds;
+  volatile sig_atomic_t* _shutdown_flag;
+  double _round_timeout_seconds;
+};
+
+/**
+ * A worker's connection to a TrainingCoordinator.
+ */
+class TrainingWorkerConnection {
+public:
+  TrainingWorkerConnection( const std::string& results_dir,
+                            double timeout_seconds = 10.0 );
+  ~TrainingWorkerConnection();
+
+  TrainingWorkerConnection( const TrainingWorkerConnection& ) = delete;
+  TrainingWorkerConnection&
+  operator=( const TrainingWorkerConnection& ) = delete;
+
+  size_t get_shard_index() const { return _shard_index; }
+  size_t get_shard_count() const { return _shard_count; }
+  size_t get_weight_count() const { return _weight_count; }
+
+  bool receive_round( TrainingRound& round );
+  void send_result( const TrainingRoundResult& result );
+
+private:
+  int _fd;
+  size_t _shard_index;
+  size_t _shard_count;
+  size_t _weight_count;
+};
+
+}
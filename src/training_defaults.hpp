@@ -39,4 +39,10 @@ namespace larasynth {
   static const size_t DEFAULT_MAX_EPOCH_COUNT = 10000;
   static const double DEFAULT_MSE_THRESHOLD = 0.0;
   static const size_t DEFAULT_BEST_RESULT_COUNT = 5;
+  static const size_t DEFAULT_VALIDATION_TRACE_SAMPLE_LIMIT = 0;
+  static const double DEFAULT_CHECKPOINT_MINUTES = 10.0;
+  static const double DEFAULT_ROUND_TIMEOUT_MINUTES = 10.0;
+  static const size_t DEFAULT_TRAINING_THREAD_COUNT = 1;
+  static const size_t DEFAULT_AVERAGING_PERIOD = 1;
+  static const size_t DEFAULT_TRAINING_SEED = 0;
 }
@@ -18,6 +18,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include "training_event_stream.hpp"
+#include "trace.hpp"
 
 using namespace std;
 using namespace larasynth;
@@ -42,11 +43,33 @@ void TrainingEventStream::add_sequence( const TrainingSequence& seq ) {
   _min_max.consider_sequence( seq );
 }
 
-void TrainingEventStream::add_examples( const vector<string>& filenames ) {
-  for( const string& filename : filenames ) {
-    TrainingSequenceParser tsp( filename );
-    TrainingSequence seq( tsp.get_sequence() );
-    add_sequence( seq );
+void TrainingEventStream::add_sequence( TrainingSequence&& seq ) {
+  _min_max.consider_sequence( seq );
+  _orig_seqs.push_back( std::move( seq ) );
+}
+
+/**
+ * Parse the example files on a pool of worker threads. Each file gets its
+ * own parser and min/max, and the results are moved into place in filename
+ * order so the stream does not depend on which thread finished first. If
+ * any files fail to parse, the error for the first such file is thrown.
+ */
+void TrainingEventStream::add_examples( const vector<string>& filenames,
+                                        size_t thread_count ) {
+  vector<TrainingSequence> seqs( filenames.size() );
+  vector<MidiMinMax> min_maxes( filenames.size() );
+
+  run_in_parallel( filenames.size(), [&]( size_t i ) {
+      TrainingSequenceParser tsp( filenames[i] );
+      seqs[i] = tsp.take_sequence();
+      min_maxes[i].consider_sequence( seqs[i] );
+    }, thread_count );
+
+  _orig_seqs.reserve( _orig_seqs.size() + seqs.size() );
+
+  for( size_t i = 0; i < seqs.size(); ++i ) {
+    _orig_seqs.push_back( std::move( seqs[i] ) );
+    _min_max.merge( min_maxes[i] );
   }
 }
 
@@ -96,6 +119,8 @@ vector<Event> TrainingEventStream::adjust_events( const vector<Event>&
 }
 
 void TrainingEventStream::reset( size_t count ) {
+  TRACE_SCOPE( "TrainingEventStream::reset" );
+
   vector<TrainingSequence> seqs;
 
   for( auto& seq : _orig_seqs ) {
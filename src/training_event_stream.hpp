@@ -28,6 +28,7 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #include "event.hpp"
 #include "rand_gen.hpp"
 #include "midi_min_max.hpp"
+#include "worker_pool.hpp"
 
 namespace larasynth {
 
@@ -50,7 +51,9 @@ public:
                                 ctrl_values_t default_ctrl_values );
 
   void add_sequence( const TrainingSequence& seq );
-  void add_examples( const std::vector<std::string>& filenames );
+  void add_sequence( TrainingSequence&& seq );
+  void add_examples( const std::vector<std::string>& filenames,
+                     size_t thread_count = 0 );
 
   bool has_next() const { return _stream_i < _event_stream.size(); }
   Event get_next() { return _event_stream[_stream_i++]; }
@@ -62,6 +65,10 @@ public:
 
   void reset( size_t count );
 
+  std::string get_rand_state() const { return _rand_gen.get_state(); }
+  void set_rand_state( const std::string& state )
+  { _rand_gen.set_state( state ); }
+
 private:
   double random_multiplier( double adjustment_factor );
   std::vector<Event> adjust_events( const std::vector<Event>&
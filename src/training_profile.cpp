@@ -0,0 +1,115 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <vector>
+#include <utility>
+
+#include "training_profile.hpp"
+#include "filesystem_operations.hpp"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+void TrainingProfile::add( const TrainingProfile& other ) {
+  network.add( other.network );
+  stream_reset.add( other.stream_reset );
+  stream.add( other.stream );
+  translator.add( other.translator );
+  validation.add( other.validation );
+  step_count += other.step_count;
+  event_count += other.event_count;
+}
+
+/**
+ * The phases in the order they are reported, named after the functions they
+ * time.
+ */
+static vector< pair<string, const PhaseCounter*> >
+get_phases( const TrainingProfile& profile ) {
+  return {
+    { "calculate_activations", &profile.network.activations },
+    { "calculate_extended_eligibility_traces",
+      &profile.network.eligibility_traces },
+    { "calculate_error_responsibilities",
+      &profile.network.error_responsibilities },
+    { "update_weights", &profile.network.weight_updates },
+    { "training_stream_reset", &profile.stream_reset },
+    { "advance_stream_until_update_time", &profile.stream },
+    { "translator", &profile.translator },
+    { "validation", &profile.validation }
+  };
+}
+
+/**
+ * Get the profile as JSON. seconds is the wall clock time the profile covers
+ * and is used for the rates.
+ */
+nlohmann::json TrainingProfile::get_json( double seconds ) const {
+  nlohmann::json profile_json;
+
+  profile_json["seconds"] = seconds;
+  profile_json["step_count"] = step_count;
+  profile_json["event_count"] = event_count;
+  profile_json["connection_update_count"] = network.connection_update_count;
+  profile_json["steps_per_second"] =
+    seconds > 0.0 ? step_count / seconds : 0.0;
+  profile_json["events_per_second"] =
+    seconds > 0.0 ? event_count / seconds : 0.0;
+  profile_json["connections_updated_per_second"] =
+    seconds > 0.0 ? network.connection_update_count / seconds : 0.0;
+
+  for( auto& phase : get_phases( *this ) ) {
+    nlohmann::json phase_json;
+    phase_json["call_count"] = phase.second->call_count;
+    phase_json["seconds"] = phase.second->get_seconds();
+
+    profile_json["phases"][phase.first] = phase_json;
+  }
+
+  return profile_json;
+}
+
+void TrainingProfile::print( ostream& out, double seconds ) const {
+  if( seconds <= 0.0 )
+    return;
+
+  out << step_count / seconds << " training steps per second" << endl;
+  out << network.connection_update_count / seconds
+      << " connections updated per second" << endl;
+  out << event_count / seconds << " training events per second" << endl;
+
+  for( auto& phase : get_phases( *this ) ) {
+    if( phase.second->call_count == 0 )
+      continue;
+
+    out << "  " << phase.first << ": " << phase.second->get_seconds()
+        << " s in " << phase.second->call_count << " calls ("
+        << phase.second->nanoseconds / phase.second->call_count
+        << " ns per call)" << endl;
+  }
+}
+
+/**
+ * Get the name of the stats file that belongs with a results file. It is a
+ * JSON file, but does not end in .json so that it is not mistaken for
+ * results.
+ */
+string TrainingProfile::get_stats_filename( const string& results_filename ) {
+  return replace_extension( results_filename, ".stats" );
+}
@@ -0,0 +1,60 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+#include "littlelstm/lstm_profile.hpp"
+#include "json/json.hpp"
+
+namespace larasynth {
+
+/**
+ * Where training spends its time: the network's phases, rebuilding the
+ * training stream before each pass through it, advancing the training stream
+ * (including presenting its events to the translator), translating between
+ * MIDI and network inputs and outputs, and validation. Validation time
+ * includes the time spent in the other phases while validating, except for
+ * rebuilding the stream. event_count is the number of stream events
+ * presented, in training and validation.
+ *
+ * The profile of a trainer with workers includes the workers' profiles, so
+ * phase times can add up to more than the wall clock time of training.
+ */
+struct TrainingProfile {
+  littlelstm::LstmProfile network;
+  littlelstm::PhaseCounter stream_reset;
+  littlelstm::PhaseCounter stream;
+  littlelstm::PhaseCounter translator;
+  littlelstm::PhaseCounter validation;
+  uint64_t step_count = 0;
+  uint64_t event_count = 0;
+
+  void add( const TrainingProfile& other );
+
+  nlohmann::json get_json( double seconds ) const;
+  void print( std::ostream& out, double seconds ) const;
+
+  static std::string get_stats_filename( const std::string&
+                                         results_filename );
+};
+
+}
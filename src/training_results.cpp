@@ -30,6 +30,8 @@ TrainingResults::TrainingResults( const string& filename,
   , _mode( mode )
   , _importer()
   , _exporter()
+  , _has_result( false )
+  , _trace_sample_limit( 0 )
 {
   if( _mode == READ_RESULTS ) {
     if( !is_regular_file( _filename ) ) {
@@ -60,6 +62,33 @@ TrainingResults::TrainingResults( const string& filename,
   }
 }
 
+/**
+ * Read the results of one group of grouped results, which are stored in the
+ * group's JSON filename.
+ */
+TrainingResults::TrainingResults( const string& filename, const json& json )
+  : _filename( filename )
+  , _mode( READ_RESULTS )
+  , _importer()
+  , _exporter()
+  , _json( json )
+  , _has_result( false )
+  , _trace_sample_limit( 0 )
+{
+  _importer.set_json( _json );
+}
+
+/**
+ * Grouped results hold a network for each group of controllers rather than
+ * one network, so the network, its configuration and its min/max must be
+ * read from the groups.
+ */
+void TrainingResults::check_single_network() {
+  if( is_grouped() )
+    throw TrainingResultsException( "The results hold a separate network "
+                                    "for each controller group." );
+}
+
 void TrainingResults::add_weights( const WeightsMap_t& weights ) {
   if( _json.find( "connections" ) == _json.end() ) {
     string error = "connections must be added to results before weights";
@@ -75,6 +104,8 @@ void TrainingResults::add_weights( const WeightsMap_t& weights ) {
 }
 
 WeightsMap_t TrainingResults::get_weights() {
+  check_single_network();
+
   WeightsMap_t weights_map;
 
   try {
@@ -103,6 +134,10 @@ void TrainingResults::add_network( const LstmNetwork& net ) {
 
   net.export_network( _exporter );
   _json = _exporter.get_json();
+
+  // a pruned network's levels can not be worked out from its connections
+  if( !net.get_levels().empty() )
+    _json["levels"] = net.get_levels();
 }
 
 void TrainingResults::add_connections( const vector< pair< Id_t, Id_t > >&
@@ -250,6 +285,8 @@ void TrainingResults::add_min_max( const MidiMinMax& min_max ) {
 }
 
 MidiMinMax TrainingResults::get_min_max() {
+  check_single_network();
+
   MidiMinMax min_max;
 
   size_t note_min = _json["note_min"];
@@ -275,22 +312,53 @@ MidiMinMax TrainingResults::get_min_max() {
   return min_max;
 }
 
+/**
+ * Get the trained network, set up to calculate its activation functions and
+ * its units the way it was trained.
+ */
 LstmNetwork TrainingResults::get_trained_network() {
-  return LstmNetwork( _importer );
+  check_single_network();
+
+  LstmNetwork net( _importer );
+
+  net.set_act_impl( get_act_impl() );
+  net.set_step_order( get_step_order() );
+
+  if( _json.find( "levels" ) != _json.end() ) {
+    try {
+      net.set_levels( _json["levels"].get< vector< vector<Id_t> > >() );
+    }
+    catch( const domain_error& e ) {
+      throw TrainingResultsException( e.what() );
+    }
+    catch( const out_of_range& e ) {
+      throw TrainingResultsException( _filename + ": " + e.what() );
+    }
+  }
+
+  return net;
 }
 
-void TrainingResults::add_result( const LstmResult& result ) {
+/**
+ * Add the summary of a validation result. The per-sample targets, outputs and
+ * cell states are not stored in the JSON; write() stores them in a separate
+ * columnar traces file (see ValidationTraces).
+ *
+ * @param trace_sample_limit Maximum number of samples to store in the traces
+ *                           file, 0 for no limit
+ */
+void TrainingResults::add_result( LstmResult result,
+                                  size_t trace_sample_limit ) {
   _json["epoch"] = result.get_epoch();
   _json["mse"] = result.get_mse();
 
   const vector<ctrl_values_t>& targets = result.get_targets();
-  const vector<ctrl_values_t>& outputs = result.get_outputs();
   const vector< map<size_t, double> >& cell_states = result.get_cell_states();
 
-  if( _json.find( "cell_count" ) == _json.end() )
+  if( _json.find( "cell_count" ) == _json.end() && !cell_states.empty() )
     _json["cell_count"] = cell_states[0].size();
 
-  if( _json.find( "ctrls" ) == _json.end() ) {
+  if( _json.find( "ctrls" ) == _json.end() && !targets.empty() ) {
     vector<event_data_t> ctrls;
     for( auto& kv : targets[0] )
       ctrls.push_back( kv.first );
@@ -300,26 +368,42 @@ void TrainingResults::add_result( const LstmResult& result ) {
     }
   }
 
-  _json["sample_count"] = targets.size();
+  _json["sample_count"] = result.get_sample_count();
 
-  for( size_t sample_i = 0; sample_i < targets.size(); ++sample_i ) {
-    for( event_data_t ctrl : _json["ctrls"] ) {
-      _json["targets"].push_back( targets[sample_i].at( ctrl ) );
-      _json["outputs"].push_back( outputs[sample_i].at( ctrl ) );
-    }
+  size_t stride = result.get_sample_stride() *
+    ValidationTraces::get_sample_stride( targets.size(), trace_sample_limit );
 
-    for( auto& kv : cell_states[sample_i] ) {
-      double value = kv.second;
+  _json["traces_file"] = get_basename( get_traces_filename() );
+  _json["trace_sample_stride"] = stride;
 
-      _json["cell_states"].push_back( value );
-    }
-  }
+  _result = std::move( result );
+  _has_result = true;
+  _trace_sample_limit = trace_sample_limit;
 }
 
 void TrainingResults::add_lstm_config( const LstmConfig& lstm_config ) {
   _json["lstm_config"]["block_counts"] = lstm_config.get_block_counts();
+  _json["lstm_config"]["block_types"] = json::array();
+  for( auto block_type : lstm_config.get_block_types() )
+    _json["lstm_config"]["block_types"].push_back(
+      block_type_to_string( block_type ) );
   _json["lstm_config"]["learning_rate"] = lstm_config.get_learning_rate();
   _json["lstm_config"]["momentum"] = lstm_config.get_momentum();
+  _json["lstm_config"]["optimizer"] =
+    optimizer_type_to_string( lstm_config.get_optimizer_config().type );
+  _json["lstm_config"]["output_updates"] =
+    lstm_config.get_optimizer_config().scale_output_updates ?
+    "scaled" : "gradient";
+  _json["lstm_config"]["second_moment_decay"] =
+    lstm_config.get_optimizer_config().second_moment_decay;
+  _json["lstm_config"]["learning_rate_schedule"] =
+    schedule_type_to_string( lstm_config.get_schedule_type() );
+  _json["lstm_config"]["activation_functions"] =
+    act_impl_to_string( lstm_config.get_act_impl() );
+  _json["lstm_config"]["step_order"] =
+    step_order_to_string( lstm_config.get_step_order() );
+  _json["lstm_config"]["step_thread_count"] =
+    lstm_config.get_step_thread_count();
 }
 
 void TrainingResults::add_repr_config( const RepresentationConfig&
@@ -348,6 +432,8 @@ void TrainingResults::add_repr_config( const RepresentationConfig&
 }
 
 RepresentationConfig TrainingResults::get_repr_config() {
+  check_single_network();
+
   feature_config_t feature_config;
 
   vector<unsigned long> ctrl_output_counts;
@@ -381,6 +467,104 @@ RepresentationConfig TrainingResults::get_repr_config() {
   return config;
 }
 
+vector<size_t> TrainingResults::get_block_counts() {
+  check_single_network();
+
+  try {
+    return _json["lstm_config"]["block_counts"].get< vector<size_t> >();
+  }
+  catch( const domain_error& e ) {
+    throw TrainingResultsException( e.what() );
+  }
+}
+
+/**
+ * Get the block type of each hidden layer. Results from before block types
+ * only have LSTM blocks.
+ */
+vector<lstm_block_t> TrainingResults::get_block_types() {
+  check_single_network();
+
+  vector<lstm_block_t> block_types;
+
+  try {
+    if( _json["lstm_config"].find( "block_types" ) ==
+        _json["lstm_config"].end() ) {
+      block_types.assign( get_block_counts().size(), LSTM_BLOCK );
+      return block_types;
+    }
+
+    for( string block_type :
+           _json["lstm_config"]["block_types"] ) {
+      block_types.push_back( string_to_block_type( block_type ) );
+
+      if( block_types.back() == NO_BLOCK_TYPE )
+        throw TrainingResultsException( "Unknown block type " + block_type );
+    }
+  }
+  catch( const domain_error& e ) {
+    throw TrainingResultsException( e.what() );
+  }
+
+  return block_types;
+}
+
+/**
+ * Get how the network calculated its activation functions while training.
+ * Results from before fast activation functions always used exact ones.
+ */
+lstm_act_impl_t TrainingResults::get_act_impl() {
+  check_single_network();
+
+  try {
+    if( _json["lstm_config"].find( "activation_functions" ) ==
+        _json["lstm_config"].end() )
+      return EXACT_ACT_FUNCS;
+
+    string act_impl = _json["lstm_config"]["activation_functions"];
+
+    if( string_to_act_impl( act_impl ) == NO_ACT_FUNCS )
+      throw TrainingResultsException( "Unknown activation functions " +
+                                      act_impl );
+
+    return string_to_act_impl( act_impl );
+  }
+  catch( const domain_error& e ) {
+    throw TrainingResultsException( e.what() );
+  }
+}
+
+/**
+ * Get the order the network calculated its units in while training. Results
+ * from before step_order trained in level order whenever they used more than
+ * one thread per step.
+ */
+lstm_step_order_t TrainingResults::get_step_order() {
+  check_single_network();
+
+  try {
+    json& lstm_json = _json["lstm_config"];
+
+    if( lstm_json.find( "step_order" ) == lstm_json.end() ) {
+      if( lstm_json.find( "step_thread_count" ) != lstm_json.end() &&
+          lstm_json["step_thread_count"].get<size_t>() != 1 )
+        return LEVEL_STEP_ORDER;
+
+      return UNIT_STEP_ORDER;
+    }
+
+    string step_order = lstm_json["step_order"];
+
+    if( string_to_step_order( step_order ) == NO_STEP_ORDER )
+      throw TrainingResultsException( "Unknown step order " + step_order );
+
+    return string_to_step_order( step_order );
+  }
+  catch( const domain_error& e ) {
+    throw TrainingResultsException( e.what() );
+  }
+}
+
 void TrainingResults::add_training_config( const TrainingConfig&
                                            training_config ) {
   json config_json;
@@ -411,15 +595,165 @@ void TrainingResults::add_training_config( const TrainingConfig&
   config_json["zero_network_on_reset"] =
     training_config.get_zero_network_on_reset();
   config_json["mse_threshold"] = training_config.get_mse_threshold();
+  config_json["warm_start_results"] =
+    training_config.get_warm_start_results();
   config_json["max_epoch_count"] = training_config.get_max_epoch_count();
+  config_json["validation_trace_sample_limit"] =
+    training_config.get_validation_trace_sample_limit();
+  config_json["thread_count"] = training_config.get_thread_count();
+  config_json["averaging_period"] = training_config.get_averaging_period();
+  config_json["seed"] = training_config.get_seed();
 
   _json["training_config"] = config_json;
 }
 
+/**
+ * Add the results of the network trained for one group of controllers (see
+ * GroupTrainer). The groups are written together in these results. Each
+ * group's MSE sums the squared errors of its own controllers, so the MSE of
+ * the groups together is the sum of their MSEs, and their epoch is the
+ * latest epoch of any group's best network.
+ */
+void TrainingResults::add_group( TrainingResults& group_results ) {
+  json group_json = group_results._json;
+
+  // the groups' validation traces are not written
+  group_json.erase( "traces_file" );
+  group_json.erase( "trace_sample_stride" );
+
+  vector<event_data_t> ctrls;
+
+  for( auto& kv : group_results.get_repr_config().get_ctrl_output_counts() )
+    ctrls.push_back( kv.first );
+
+  sort( ctrls.begin(), ctrls.end() );
+
+  double mse = 0.0;
+  size_t epoch = 0;
+
+  if( is_grouped() ) {
+    mse = _json["mse"];
+    epoch = _json["epoch"];
+  }
+
+  try {
+    mse += group_json["mse"].get<double>();
+    epoch = max( epoch, group_json["epoch"].get<size_t>() );
+  }
+  catch( const domain_error& e ) {
+    throw TrainingResultsException( "A result must be added to a group's "
+                                    "results before the group is added" );
+  }
+
+  _json["mse"] = mse;
+  _json["epoch"] = epoch;
+  _json["controller_groups"].push_back( ctrls );
+  _json["groups"].push_back( group_json );
+}
+
+size_t TrainingResults::get_group_count() {
+  return is_grouped() ? _json["groups"].size() : 0;
+}
+
+vector<event_data_t> TrainingResults::get_group_ctrls( size_t group_i ) {
+  try {
+    return _json["controller_groups"].at( group_i )
+      .get< vector<event_data_t> >();
+  }
+  catch( const exception& e ) {
+    throw TrainingResultsException( "Invalid controller group in " +
+                                    _filename );
+  }
+}
+
+/**
+ * Get the results of the network for one group of controllers.
+ */
+TrainingResults TrainingResults::get_group( size_t group_i ) {
+  if( group_i >= get_group_count() )
+    throw TrainingResultsException( "Invalid controller group in " +
+                                    _filename );
+
+  return TrainingResults( _filename, _json["groups"][group_i] );
+}
+
+/**
+ * Get the summary of these results for the results index.
+ */
+ResultsIndexEntry TrainingResults::get_index_entry() {
+  ResultsIndexEntry entry;
+
+  try {
+    entry.filename = get_basename( _filename );
+    entry.mse = _json["mse"];
+    entry.epoch = _json["epoch"];
+
+    if( _json.find( "timestamp" ) != _json.end() )
+      entry.timestamp = _json["timestamp"];
+
+    // grouped results list each group's controllers and architecture
+    if( is_grouped() ) {
+      ostringstream arch;
+
+      for( size_t i = 0; i < get_group_count(); ++i ) {
+        arch << ( i == 0 ? "" : "; " ) << "ctrls:";
+
+        bool first = true;
+        for( event_data_t ctrl : get_group_ctrls( i ) ) {
+          arch << ( first ? "" : "," ) << (unsigned int)ctrl;
+          first = false;
+        }
+
+        arch << " " << get_group( i ).get_index_entry().arch;
+      }
+
+      entry.arch = arch.str();
+
+      return entry;
+    }
+
+    ostringstream arch;
+    arch << "inputs:" << _json["arch_input_count"].get<size_t>()
+         << " blocks:";
+
+    bool first = true;
+    for( size_t block_count : _json["lstm_config"]["block_counts"] ) {
+      arch << ( first ? "" : "," ) << block_count;
+      first = false;
+    }
+
+    // block types are only listed when there are blocks other than LSTM
+    // blocks
+    vector<lstm_block_t> block_types = get_block_types();
+
+    if( count( block_types.begin(), block_types.end(), LSTM_BLOCK ) !=
+        (long)block_types.size() ) {
+      arch << " types:";
+
+      first = true;
+      for( auto block_type : block_types ) {
+        arch << ( first ? "" : "," ) << block_type_to_string( block_type );
+        first = false;
+      }
+    }
+
+    arch << " outputs:" << _json["arch_output_count"].get<size_t>();
+
+    entry.arch = arch.str();
+  }
+  catch( const domain_error& e ) {
+    throw TrainingResultsException( e.what() );
+  }
+
+  return entry;
+}
+
 void TrainingResults::write() {
   if( is_regular_file( _filename ) )
     throw TrainingResultsException( _filename + " already exists." );
 
+  _json["timestamp"] = get_timestamp_string();
+
   try {
     ofstream outfile( _filename );
     outfile << _json.dump( 1 );
@@ -427,4 +761,14 @@ void TrainingResults::write() {
   catch( const ios_base::failure& e ) {
     throw TrainingResultsException( e.what() );
   }
+
+  if( _has_result ) {
+    try {
+      ValidationTraces::write( get_traces_filename(), _result,
+                               _trace_sample_limit );
+    }
+    catch( const ValidationTracesException& e ) {
+      throw TrainingResultsException( e.what() );
+    }
+  }
 }
@@ -39,6 +39,9 @@ along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
 #include "json/json.hpp"
 #include "littlelstm/json_importer.hpp"
 #include "littlelstm/json_exporter.hpp"
+#include "validation_traces.hpp"
+#include "results_index.hpp"
+#include "time_utilities.hpp"
 
 namespace larasynth {
 
@@ -62,6 +65,8 @@ public:
                             training_results_mode mode );
 
   std::string get_filename() { return _filename; }
+  std::string get_traces_filename()
+  { return ValidationTraces::get_traces_filename( _filename ); }
 
   double get_mse() { return _json["mse"]; }
   littlelstm::WeightsMap_t get_weights();
@@ -70,14 +75,27 @@ public:
   MidiMinMax get_min_max();
   littlelstm::LstmNetwork get_trained_network();
   RepresentationConfig get_repr_config();
-
-  void add_result( const LstmResult& result );
+  std::vector<size_t> get_block_counts();
+  std::vector<littlelstm::lstm_block_t> get_block_types();
+  littlelstm::lstm_act_impl_t get_act_impl();
+  littlelstm::lstm_step_order_t get_step_order();
+
+  bool is_grouped() { return _json.find( "groups" ) != _json.end(); }
+  size_t get_group_count();
+  std::vector<event_data_t> get_group_ctrls( size_t group_i );
+  TrainingResults get_group( size_t group_i );
+
+  void add_result( LstmResult result,
+                   size_t trace_sample_limit = 0 );
   void add_weights( const littlelstm::WeightsMap_t& weights );
   void add_network( const littlelstm::LstmNetwork& net );
   void add_min_max( const MidiMinMax& min_max );
   void add_lstm_config( const LstmConfig& lstm_config );
   void add_repr_config( const RepresentationConfig& repr_config );
   void add_training_config( const TrainingConfig& training_config );
+  void add_group( TrainingResults& group_results );
+
+  ResultsIndexEntry get_index_entry();
 
   void write();
   nlohmann::json get_json() { return _json; }
@@ -85,6 +103,9 @@ public:
   void add_connections( const std::vector< std::pair<Id_t, Id_t> >&
                         connections );
 private:
+  TrainingResults( const std::string& filename, const nlohmann::json& json );
+
+  void check_single_network();
   void add_units_properties( const std::vector<littlelstm::LstmUnitProperties>&
                              units_properties );
   void add_gated_conns( const std::vector<littlelstm::LstmGatedConn>& conns );
@@ -98,6 +119,11 @@ private:
   littlelstm::JsonImporter _importer;
   littlelstm::JsonExporter _exporter;
   nlohmann::json _json;
+
+  // written to the traces file rather than the JSON
+  LstmResult _result;
+  bool _has_result;
+  size_t _trace_sample_limit;
 };
 
 }
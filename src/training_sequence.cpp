@@ -38,3 +38,9 @@ TrainingSequence::TrainingSequence( const TrainingSequence& other )
   , _count_min( other.get_count_min() )
   , _count_max( other.get_count_max() )
 {}
+
+TrainingSequence::TrainingSequence( TrainingSequence&& other )
+  : _events( std::move( other._events ) )
+  , _count_min( other._count_min )
+  , _count_max( other._count_max )
+{}
@@ -30,7 +30,11 @@ public:
   TrainingSequence();
   TrainingSequence( const std::vector<Event>& events );
   TrainingSequence( const TrainingSequence& other );
-  
+  TrainingSequence( TrainingSequence&& other );
+
+  TrainingSequence& operator=( const TrainingSequence& other ) = default;
+  TrainingSequence& operator=( TrainingSequence&& other ) = default;
+
   void add_event( Event event ) { _events.push_back( event ); }
 
   void set_count_min( std::size_t count ) { _count_min = count; }
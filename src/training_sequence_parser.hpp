@@ -42,6 +42,12 @@ public:
 
   TrainingSequence get_sequence() { return _sequence; }
 
+  /**
+   * Move the parsed sequence out of the parser. The parser's sequence is left
+   * empty.
+   */
+  TrainingSequence take_sequence() { return std::move( _sequence ); }
+
 private:
   size_t string_to_size_t( const std::string& str );
   void throw_exception( const std::string& error, const std::string& location );
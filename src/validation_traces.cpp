@@ -0,0 +1,250 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#include "validation_traces.hpp"
+
+using namespace std;
+using namespace larasynth;
+
+static const char VALIDATION_TRACES_MAGIC[8] = { 'L', 'A', 'R', 'A',
+                                                 'T', 'R', 'C', 'S' };
+static const uint32_t VALIDATION_TRACES_VERSION = 1;
+static const uint32_t VALIDATION_TRACES_BYTE_ORDER = 0x01020304;
+
+static size_t align_8( size_t offset ) {
+  return ( offset + 7 ) & ~(size_t)7;
+}
+
+ValidationTraces::ValidationTraces( const string& filename ) {
+  try {
+    _file.reset( new MappedFile( filename ) );
+  }
+  catch( const FilesystemException& e ) {
+    throw ValidationTracesException( e.what() );
+  }
+
+  if( _file->size() < sizeof( _header ) )
+    throw ValidationTracesException( filename + " is too small" );
+
+  memcpy( &_header, _file->data(), sizeof( _header ) );
+
+  if( memcmp( _header.magic, VALIDATION_TRACES_MAGIC,
+              sizeof( _header.magic ) ) != 0 ||
+      _header.byte_order != VALIDATION_TRACES_BYTE_ORDER ||
+      _header.version != VALIDATION_TRACES_VERSION )
+    throw ValidationTracesException( filename +
+                                     " is not a validation traces file" );
+
+  size_t size = _file->size();
+
+  // check each term before it is used in an offset so nothing overflows
+  if( _header.header_size < sizeof( _header ) ||
+      _header.header_size > size ||
+      _header.ctrl_count > 128 ||
+      _header.sample_count > size ||
+      _header.cell_count > size ||
+      get_cell_states_offset() > size ||
+      ( _header.sample_count != 0 &&
+        _header.cell_count > ( size - get_cell_states_offset() ) /
+        sizeof( double ) / _header.sample_count ) )
+    throw ValidationTracesException( filename + " is truncated" );
+}
+
+uint64_t ValidationTraces::read_u64( size_t offset ) const {
+  uint64_t value;
+  memcpy( &value, _file->data() + offset, sizeof( value ) );
+  return value;
+}
+
+size_t ValidationTraces::get_targets_offset() const {
+  return _header.header_size +
+    ( _header.ctrl_count + _header.cell_count ) * sizeof( uint64_t );
+}
+
+size_t ValidationTraces::get_outputs_offset() const {
+  return get_targets_offset() + _header.ctrl_count * _header.sample_count;
+}
+
+size_t ValidationTraces::get_cell_states_offset() const {
+  return align_8( get_outputs_offset() +
+                  _header.ctrl_count * _header.sample_count );
+}
+
+vector<event_data_t> ValidationTraces::get_ctrls() const {
+  vector<event_data_t> ctrls;
+
+  for( size_t i = 0; i < _header.ctrl_count; ++i )
+    ctrls.push_back( read_u64( _header.header_size +
+                               i * sizeof( uint64_t ) ) );
+
+  return ctrls;
+}
+
+vector<size_t> ValidationTraces::get_cell_ids() const {
+  vector<size_t> cell_ids;
+
+  size_t offset = _header.header_size + _header.ctrl_count * sizeof( uint64_t );
+
+  for( size_t i = 0; i < _header.cell_count; ++i )
+    cell_ids.push_back( read_u64( offset + i * sizeof( uint64_t ) ) );
+
+  return cell_ids;
+}
+
+vector<event_data_t> ValidationTraces::get_targets( size_t ctrl_i ) const {
+  const char* column = _file->data() + get_targets_offset() +
+    ctrl_i * _header.sample_count;
+
+  return vector<event_data_t>( column, column + _header.sample_count );
+}
+
+vector<event_data_t> ValidationTraces::get_outputs( size_t ctrl_i ) const {
+  const char* column = _file->data() + get_outputs_offset() +
+    ctrl_i * _header.sample_count;
+
+  return vector<event_data_t>( column, column + _header.sample_count );
+}
+
+vector<double> ValidationTraces::get_cell_states( size_t cell_i ) const {
+  vector<double> states( _header.sample_count );
+
+  if( !states.empty() )
+    memcpy( states.data(), _file->data() + get_cell_states_offset() +
+            cell_i * _header.sample_count * sizeof( double ),
+            states.size() * sizeof( double ) );
+
+  return states;
+}
+
+/**
+ * Get the stride needed to store at most max_sample_count of
+ * total_sample_count samples. A max_sample_count of 0 means no limit.
+ */
+size_t ValidationTraces::get_sample_stride( size_t total_sample_count,
+                                            size_t max_sample_count ) {
+  if( max_sample_count == 0 || total_sample_count <= max_sample_count )
+    return 1;
+
+  return ( total_sample_count + max_sample_count - 1 ) / max_sample_count;
+}
+
+string ValidationTraces::get_traces_filename( const string&
+                                              results_filename ) {
+  return replace_extension( results_filename, ".traces" );
+}
+
+/**
+ * Write the per-sample data in result to filename, one column at a time.
+ *
+ * @param max_sample_count Store at most this many samples, evenly spaced
+ *                         through the validation stream. 0 stores every
+ *                         sample.
+ */
+void ValidationTraces::write( const string& filename,
+                              const LstmResult& result,
+                              size_t max_sample_count ) {
+  const vector<ctrl_values_t>& targets = result.get_targets();
+  const vector<ctrl_values_t>& outputs = result.get_outputs();
+  const vector< map<size_t, double> >& cell_states = result.get_cell_states();
+
+  vector<event_data_t> ctrls;
+  vector<size_t> cell_ids;
+
+  if( !targets.empty() ) {
+    for( auto& kv : targets[0] )
+      ctrls.push_back( kv.first );
+    sort( ctrls.begin(), ctrls.end() );
+  }
+
+  if( !cell_states.empty() ) {
+    for( auto& kv : cell_states[0] )
+      cell_ids.push_back( kv.first );
+  }
+
+  // the result may already have kept only every get_sample_stride()th
+  // sample while validating
+  size_t kept_stride = get_sample_stride( targets.size(), max_sample_count );
+  size_t sample_count = ( targets.size() + kept_stride - 1 ) / kept_stride;
+
+  ValidationTracesHeader header;
+  memset( &header, 0, sizeof( header ) );
+
+  memcpy( header.magic, VALIDATION_TRACES_MAGIC, sizeof( header.magic ) );
+  header.version = VALIDATION_TRACES_VERSION;
+  header.byte_order = VALIDATION_TRACES_BYTE_ORDER;
+  header.header_size = sizeof( header );
+  header.total_sample_count = result.get_sample_count();
+  header.sample_count = sample_count;
+  header.sample_stride = result.get_sample_stride() * kept_stride;
+  header.ctrl_count = ctrls.size();
+  header.cell_count = cell_ids.size();
+
+  ofstream outfile( filename, ios::binary | ios::trunc );
+
+  if( !outfile )
+    throw ValidationTracesException( "Error opening " + filename );
+
+  outfile.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+
+  for( event_data_t ctrl : ctrls ) {
+    uint64_t value = ctrl;
+    outfile.write( reinterpret_cast<const char*>( &value ), sizeof( value ) );
+  }
+
+  for( size_t cell_id : cell_ids ) {
+    uint64_t value = cell_id;
+    outfile.write( reinterpret_cast<const char*>( &value ), sizeof( value ) );
+  }
+
+  vector<event_data_t> ctrl_column( sample_count );
+
+  for( auto samples : { &targets, &outputs } ) {
+    for( event_data_t ctrl : ctrls ) {
+      for( size_t i = 0; i < sample_count; ++i )
+        ctrl_column[i] = (*samples)[i * kept_stride].at( ctrl );
+
+      outfile.write( reinterpret_cast<const char*>( ctrl_column.data() ),
+                     ctrl_column.size() );
+    }
+  }
+
+  size_t offset = sizeof( header ) +
+    ( ctrls.size() + cell_ids.size() ) * sizeof( uint64_t ) +
+    2 * ctrls.size() * sample_count;
+
+  for( size_t i = offset; i < align_8( offset ); ++i )
+    outfile.put( '\0' );
+
+  vector<double> cell_column( sample_count );
+
+  for( size_t cell_id : cell_ids ) {
+    for( size_t i = 0; i < sample_count; ++i )
+      cell_column[i] = cell_states[i * kept_stride].at( cell_id );
+
+    outfile.write( reinterpret_cast<const char*>( cell_column.data() ),
+                   cell_column.size() * sizeof( double ) );
+  }
+
+  if( !outfile )
+    throw ValidationTracesException( "Error writing " + filename );
+}
@@ -0,0 +1,108 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <stdexcept>
+
+#include "lstm_result.hpp"
+#include "midi_types.hpp"
+#include "filesystem_operations.hpp"
+
+namespace larasynth {
+
+class ValidationTracesException : public std::runtime_error {
+public:
+  explicit ValidationTracesException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * Per-sample validation data (targets, outputs and cell states) stored in a
+ * columnar binary file next to the JSON training results. Each column holds
+ * one controller's targets or outputs, or one cell's states, for every stored
+ * sample, so a column can be read without touching the rest of the file.
+ *
+ * File layout, with integers in the byte order of the writing machine:
+ *
+ *   header        ValidationTracesHeader
+ *   ctrls         ctrl_count uint64s
+ *   cell IDs      cell_count uint64s
+ *   targets       ctrl_count columns of sample_count uint8s
+ *   outputs       ctrl_count columns of sample_count uint8s
+ *   (padding to an 8 byte boundary)
+ *   cell states   cell_count columns of sample_count doubles
+ *
+ * Long validation streams can be subsampled when writing. Only every
+ * sample_stride-th sample is stored, starting with the first.
+ */
+struct ValidationTracesHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t header_size;
+  uint64_t total_sample_count;
+  uint64_t sample_count;
+  uint64_t sample_stride;
+  uint64_t ctrl_count;
+  uint64_t cell_count;
+};
+
+class ValidationTraces {
+public:
+  explicit ValidationTraces( const std::string& filename );
+
+  size_t get_total_sample_count() const
+  { return _header.total_sample_count; }
+  size_t get_sample_count() const { return _header.sample_count; }
+  size_t get_sample_stride() const { return _header.sample_stride; }
+
+  std::vector<event_data_t> get_ctrls() const;
+  std::vector<size_t> get_cell_ids() const;
+
+  std::vector<event_data_t> get_targets( size_t ctrl_i ) const;
+  std::vector<event_data_t> get_outputs( size_t ctrl_i ) const;
+  std::vector<double> get_cell_states( size_t cell_i ) const;
+
+  static size_t get_sample_stride( size_t total_sample_count,
+                                   size_t max_sample_count );
+
+  static void write( const std::string& filename, const LstmResult& result,
+                     size_t max_sample_count = 0 );
+
+  static std::string get_traces_filename( const std::string&
+                                          results_filename );
+
+private:
+  uint64_t read_u64( size_t offset ) const;
+
+  size_t get_targets_offset() const;
+  size_t get_outputs_offset() const;
+  size_t get_cell_states_offset() const;
+
+  std::unique_ptr<MappedFile> _file;
+
+  ValidationTracesHeader _header;
+};
+
+}
@@ -0,0 +1,254 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "warm_start.hpp"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+WarmStart::WarmStart( TrainingResults& results,
+                      const RepresentationConfig& repr_config,
+                      const MidiMinMax& min_max,
+                      const vector<size_t>& block_counts,
+                      vector<lstm_block_t> block_types )
+  : _filename( results.get_filename() )
+  , _weight_count( 0 )
+{
+  RepresentationConfig old_repr_config = results.get_repr_config();
+  vector<size_t> old_block_counts = results.get_block_counts();
+  vector<lstm_block_t> old_block_types = results.get_block_types();
+
+  if( block_types.empty() )
+    block_types.assign( block_counts.size(), LSTM_BLOCK );
+
+  if( old_repr_config.get_input_feature_config() !=
+      repr_config.get_input_feature_config() ) {
+    string error = _filename + " was trained with different input features.";
+    throw WarmStartException( error );
+  }
+
+  if( old_block_counts.size() != block_counts.size() ) {
+    string error = _filename + " was trained with a different number of "
+      "hidden layers.";
+    throw WarmStartException( error );
+  }
+
+  for( size_t h = 0; h < block_counts.size(); ++h ) {
+    if( old_block_types[h] != block_types[h] ) {
+      ostringstream error;
+      error << _filename << " has "
+            << block_type_to_string( old_block_types[h] )
+            << " blocks in hidden layer " << h + 1 << ", not "
+            << block_type_to_string( block_types[h] ) << " blocks.";
+      throw WarmStartException( error.str() );
+    }
+
+    if( old_block_counts[h] > block_counts[h] ) {
+      ostringstream error;
+      error << _filename << " has " << old_block_counts[h] << " blocks in "
+            << "hidden layer " << h + 1 << ", which cannot be reduced to "
+            << block_counts[h] << ".";
+      throw WarmStartException( error.str() );
+    }
+  }
+
+  size_t feature_count = get_input_feature_count( repr_config );
+
+  LstmArchitecture old_arch( feature_count +
+                             old_repr_config.get_total_output_count(),
+                             old_repr_config.get_total_output_count(),
+                             old_block_counts, old_block_types );
+  LstmArchitecture arch( feature_count + repr_config.get_total_output_count(),
+                         repr_config.get_total_output_count(),
+                         block_counts, block_types );
+
+  if( results.get_connections().size() != old_arch.get_connections().size() ) {
+    string error = "The network in " + _filename + " does not match its "
+      "configuration.";
+    throw WarmStartException( error );
+  }
+
+  _unit_map = vector<Id_t>( old_arch.get_unit_count(), NO_UNIT );
+
+  for( size_t i = 0; i < feature_count; ++i )
+    _unit_map[old_arch.get_input_ids()[i]] = arch.get_input_ids()[i];
+
+  _unit_map[old_arch.get_bias_id()] = arch.get_bias_id();
+
+  map_controller_units( old_repr_config, repr_config, old_arch, arch );
+  check_ctrl_ranges( old_repr_config, results.get_min_max(), min_max );
+  map_hidden_units( old_arch, arch );
+
+  WeightsMap_t old_weights = results.get_weights();
+
+  for( auto& kv_out : old_weights ) {
+    for( auto& kv_in : kv_out.second ) {
+      if( kv_out.first >= _unit_map.size() ||
+          kv_in.first >= _unit_map.size() ) {
+        string error = "The network in " + _filename + " does not match its "
+          "configuration.";
+        throw WarmStartException( error );
+      }
+
+      _weights[_unit_map[kv_out.first]][_unit_map[kv_in.first]] =
+        kv_in.second;
+      ++_weight_count;
+    }
+  }
+}
+
+/**
+ * Set the trained weights in net, which must have been built from the
+ * representation and block counts given to the constructor.
+ */
+void WarmStart::apply( LstmNetwork& net ) const {
+  try {
+    net.set_weights( _weights );
+  }
+  catch( const out_of_range& e ) {
+    string error = "The network in " + _filename + " does not fit the "
+      "configured network.";
+    throw WarmStartException( error );
+  }
+}
+
+size_t WarmStart::get_input_feature_count( const RepresentationConfig&
+                                           repr_config ) {
+  feature_config_t feature_config = repr_config.get_input_feature_config();
+
+  size_t count = 0;
+
+  for( input_feature_t feature : input_feature_list ) {
+    if( feature_config[feature] )
+      count += input_feature_sizes.at( feature );
+  }
+
+  return count;
+}
+
+/**
+ * The controllers in the order their outputs appear in the network.
+ */
+vector<event_data_t>
+WarmStart::get_sorted_ctrls( const RepresentationConfig& repr_config ) {
+  vector<event_data_t> ctrls;
+
+  for( auto& kv : repr_config.get_ctrl_output_counts() )
+    ctrls.push_back( kv.first );
+
+  sort( ctrls.begin(), ctrls.end() );
+
+  return ctrls;
+}
+
+/**
+ * The outputs of a controller are spread over the range of values it takes
+ * in the training examples, so new examples that change the range change
+ * what the trained weights mean.
+ */
+void WarmStart::check_ctrl_ranges( const RepresentationConfig&
+                                   old_repr_config,
+                                   const MidiMinMax& old_min_max,
+                                   const MidiMinMax& min_max ) {
+  for( event_data_t ctrl : get_sorted_ctrls( old_repr_config ) ) {
+    if( old_min_max.get_ctrl_min( ctrl ) != min_max.get_ctrl_min( ctrl ) ||
+        old_min_max.get_ctrl_max( ctrl ) != min_max.get_ctrl_max( ctrl ) ) {
+      ostringstream error;
+      error << _filename << " was trained with values "
+            << (int)old_min_max.get_ctrl_min( ctrl ) << " to "
+            << (int)old_min_max.get_ctrl_max( ctrl ) << " for controller "
+            << (int)ctrl << ", but the training examples have values "
+            << (int)min_max.get_ctrl_min( ctrl ) << " to "
+            << (int)min_max.get_ctrl_max( ctrl ) << ".";
+      throw WarmStartException( error.str() );
+    }
+  }
+}
+
+/**
+ * Map the outputs of each controller, and the inputs its previous output is
+ * fed back through. Adding a controller shifts the outputs of the controllers
+ * after it.
+ */
+void WarmStart::map_controller_units( const RepresentationConfig&
+                                      old_repr_config,
+                                      const RepresentationConfig& repr_config,
+                                      const LstmArchitecture& old_arch,
+                                      const LstmArchitecture& arch ) {
+  unordered_map<event_data_t,size_t> output_counts =
+    repr_config.get_ctrl_output_counts();
+
+  unordered_map<event_data_t,size_t> begin_is;
+  size_t begin_i = 0;
+
+  for( event_data_t ctrl : get_sorted_ctrls( repr_config ) ) {
+    begin_is[ctrl] = begin_i;
+    begin_i += output_counts[ctrl];
+  }
+
+  size_t feature_count = get_input_feature_count( repr_config );
+  size_t old_begin_i = 0;
+
+  for( event_data_t ctrl : get_sorted_ctrls( old_repr_config ) ) {
+    size_t old_output_count = old_repr_config.get_ctrl_output_count( ctrl );
+
+    if( output_counts.count( ctrl ) == 0 ) {
+      ostringstream error;
+      error << _filename << " was trained with controller " << (int)ctrl
+            << ", which is no longer configured.";
+      throw WarmStartException( error.str() );
+    }
+
+    if( output_counts[ctrl] != old_output_count ) {
+      ostringstream error;
+      error << _filename << " has " << old_output_count << " outputs for "
+            << "controller " << (int)ctrl << " but " << output_counts[ctrl]
+            << " are configured.";
+      throw WarmStartException( error.str() );
+    }
+
+    for( size_t i = 0; i < old_output_count; ++i ) {
+      _unit_map[old_arch.get_output_ids()[old_begin_i + i]] =
+        arch.get_output_ids()[begin_is[ctrl] + i];
+
+      _unit_map[old_arch.get_input_ids()[feature_count + old_begin_i + i]] =
+        arch.get_input_ids()[feature_count + begin_is[ctrl] + i];
+    }
+
+    old_begin_i += old_output_count;
+  }
+}
+
+/**
+ * Map each block of the trained network to the block at the same position in
+ * the same hidden layer. Added blocks come after the trained ones.
+ */
+void WarmStart::map_hidden_units( const LstmArchitecture& old_arch,
+                                  const LstmArchitecture& arch ) {
+  for( Index_t h = 0; h < old_arch.get_hidden_layer_count(); ++h ) {
+    for( Index_t b = 0; b < old_arch.get_block_count( h ); ++b ) {
+      vector<Id_t> old_ids = old_arch.get_block_ids( h, b );
+      vector<Id_t> ids = arch.get_block_ids( h, b );
+
+      for( size_t i = 0; i < old_ids.size(); ++i )
+        _unit_map[old_ids[i]] = ids[i];
+    }
+  }
+}
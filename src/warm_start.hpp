@@ -0,0 +1,99 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+
+#include "training_results.hpp"
+#include "representation_config.hpp"
+#include "midi_min_max.hpp"
+#include "midi_types.hpp"
+#include "input_features.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "littlelstm/lstm_network.hpp"
+#include "littlelstm/lstm_types.hpp"
+
+namespace larasynth {
+
+class WarmStartException : public std::runtime_error {
+public:
+  explicit WarmStartException( const std::string& message )
+    : runtime_error( message ) {};
+};
+
+/**
+ * Carries the weights of a previously trained network over to a new network
+ * so training can continue from them instead of from random weights.
+ *
+ * The new network may have more controllers and more blocks in each hidden
+ * layer than the trained one. Units are matched by what they represent: input
+ * features, the outputs and fed back outputs of each controller, and the
+ * blocks of each hidden layer in order. Connections that only exist in the new
+ * network keep their random initial weights.
+ *
+ * The input features and the number of hidden layers must be the same, and
+ * every controller of the trained network must still be there with the same
+ * output count and the same range of values in the training examples, since
+ * the range decides what each of its outputs means.
+ */
+class WarmStart {
+public:
+  WarmStart( TrainingResults& results, const RepresentationConfig& repr_config,
+             const MidiMinMax& min_max,
+             const std::vector<size_t>& block_counts,
+             std::vector<littlelstm::lstm_block_t> block_types = {} );
+
+  void apply( littlelstm::LstmNetwork& net ) const;
+
+  size_t get_weight_count() const { return _weight_count; }
+
+  const std::vector<Id_t>& get_unit_map() const { return _unit_map; }
+
+private:
+  static size_t get_input_feature_count( const RepresentationConfig&
+                                         repr_config );
+  static std::vector<event_data_t>
+  get_sorted_ctrls( const RepresentationConfig& repr_config );
+
+  void check_ctrl_ranges( const RepresentationConfig& old_repr_config,
+                          const MidiMinMax& old_min_max,
+                          const MidiMinMax& min_max );
+  void map_controller_units( const RepresentationConfig& old_repr_config,
+                             const RepresentationConfig& repr_config,
+                             const littlelstm::LstmArchitecture& old_arch,
+                             const littlelstm::LstmArchitecture& arch );
+  void map_hidden_units( const littlelstm::LstmArchitecture& old_arch,
+                         const littlelstm::LstmArchitecture& arch );
+
+  std::string _filename;
+
+  // new unit ID for each unit ID of the trained network
+  std::vector<Id_t> _unit_map;
+
+  littlelstm::WeightsMap_t _weights;
+  size_t _weight_count;
+};
+
+}
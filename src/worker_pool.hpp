@@ -0,0 +1,107 @@
+/*
+Copyright 2016 Nathan Sommer
+
+This file is part of Larasynth.
+
+Larasynth is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Larasynth is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Larasynth.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+namespace larasynth {
+
+/**
+ * Get the number of worker threads to use for task_count independent tasks.
+ * This is the number of hardware threads, but never more than the number of
+ * tasks and never less than 1.
+ */
+inline size_t worker_thread_count( size_t task_count ) {
+  size_t hardware_count = std::thread::hardware_concurrency();
+
+  if( hardware_count == 0 )
+    hardware_count = 1;
+
+  return std::max( (size_t)1, std::min( hardware_count, task_count ) );
+}
+
+/**
+ * Run task( i ) for every i in [0, task_count) on a pool of worker threads.
+ * Each worker repeatedly claims the next unclaimed index, so tasks of uneven
+ * cost are balanced across the pool.
+ *
+ * Blocks until every task has finished. If any tasks throw, the exception
+ * from the task with the lowest index is rethrown on the calling thread, so
+ * errors are reported the same way regardless of scheduling.
+ *
+ * @param task_count Number of tasks
+ * @param task Function to run for each task index. Must be safe to call
+ *             concurrently for different indexes.
+ * @param thread_count Number of threads to use. 0 picks a count with
+ *                     worker_thread_count().
+ */
+inline void run_in_parallel( size_t task_count,
+                             const std::function<void(size_t)>& task,
+                             size_t thread_count = 0 ) {
+  if( task_count == 0 )
+    return;
+
+  if( thread_count == 0 )
+    thread_count = worker_thread_count( task_count );
+
+  std::vector<std::exception_ptr> errors( task_count );
+  std::atomic<size_t> next_i( 0 );
+
+  auto worker = [&]() {
+    size_t i;
+    while( ( i = next_i++ ) < task_count ) {
+      try {
+        task( i );
+      }
+      catch( ... ) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+
+  if( thread_count == 1 ) {
+    worker();
+  }
+  else {
+    std::vector<std::thread> threads;
+    threads.reserve( thread_count - 1 );
+
+    for( size_t t = 1; t < thread_count; ++t )
+      threads.emplace_back( worker );
+
+    // the calling thread does its share of the work too
+    worker();
+
+    for( auto& thread : threads )
+      thread.join();
+  }
+
+  for( auto& error : errors ) {
+    if( error )
+      std::rethrow_exception( error );
+  }
+}
+
+}
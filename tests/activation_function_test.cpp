@@ -0,0 +1,79 @@
+#include <cmath>
+#include <limits>
+
+#include "littlelstm/lstm_activation_function.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace littlelstm;
+
+/**
+ * The table must match the exact function at the start of each interval,
+ * which also checks the compile time exp().
+ */
+TEST( ActivationFunctionTest, Table ) {
+  for( int i = 0; i <= LOGISTIC_TABLE_INTERVALS; ++i ) {
+    double x = LOGISTIC_TABLE_MIN + i * LOGISTIC_TABLE_STEP;
+    EXPECT_NEAR( logistic( x ), logistic_fast( x ), 1e-15 );
+  }
+
+  EXPECT_NEAR( exp( -16.0 ), constexpr_exp( -16.0 ), 1e-20 );
+  EXPECT_NEAR( exp( 16.0 ), constexpr_exp( 16.0 ), 1e-7 );
+}
+
+TEST( ActivationFunctionTest, MaximumError ) {
+  double max_logistic_error = 0.0;
+  double max_centered_error = 0.0;
+
+  for( double x = -40.0; x <= 40.0; x += 1.0 / 1024.0 ) {
+    max_logistic_error = max( max_logistic_error,
+                              fabs( logistic( x ) - logistic_fast( x ) ) );
+    max_centered_error = max( max_centered_error,
+                              fabs( logistic_centered( x ) -
+                                    logistic_centered_fast( x ) ) );
+  }
+
+  EXPECT_LT( max_logistic_error, MAX_FAST_LOGISTIC_ERROR );
+  EXPECT_LT( max_centered_error, 2.0 * MAX_FAST_LOGISTIC_ERROR );
+}
+
+TEST( ActivationFunctionTest, Limits ) {
+  double infinity = numeric_limits<double>::infinity();
+  double nan = numeric_limits<double>::quiet_NaN();
+
+  EXPECT_NEAR( 0.0, logistic_fast( -infinity ), MAX_FAST_LOGISTIC_ERROR );
+  EXPECT_NEAR( 1.0, logistic_fast( infinity ), MAX_FAST_LOGISTIC_ERROR );
+  EXPECT_NEAR( 0.0, logistic_fast( -1e300 ), MAX_FAST_LOGISTIC_ERROR );
+  EXPECT_NEAR( 1.0, logistic_fast( 1e300 ), MAX_FAST_LOGISTIC_ERROR );
+  EXPECT_FALSE( std::isnan( logistic_fast( nan ) ) );
+  EXPECT_DOUBLE_EQ( 0.5, logistic_fast( 0.0 ) );
+  EXPECT_DOUBLE_EQ( 0.0, logistic_centered_fast( 0.0 ) );
+}
+
+TEST( ActivationFunctionTest, Monotonic ) {
+  double previous = logistic_fast( -20.0 );
+
+  for( double x = -20.0; x <= 20.0; x += 1.0 / 256.0 ) {
+    double value = logistic_fast( x );
+    ASSERT_LE( previous, value );
+    previous = value;
+  }
+}
+
+TEST( ActivationFunctionTest, Select ) {
+  EXPECT_EQ( logistic, get_act_func( LOGISTIC, EXACT_ACT_FUNCS ) );
+  EXPECT_EQ( logistic_fast, get_act_func( LOGISTIC, FAST_ACT_FUNCS ) );
+  EXPECT_EQ( logistic_centered_fast,
+             get_act_func( LOGISTIC_CENTERED, FAST_ACT_FUNCS ) );
+  EXPECT_EQ( identity, get_act_func( IDENTITY, FAST_ACT_FUNCS ) );
+
+  EXPECT_EQ( FAST_ACT_FUNCS, string_to_act_impl( "fast" ) );
+  EXPECT_EQ( "exact", act_impl_to_string( EXACT_ACT_FUNCS ) );
+  EXPECT_EQ( NO_ACT_FUNCS, string_to_act_impl( "slow" ) );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,146 @@
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+
+#include "compiled_model.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+class CompiledModelTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    results_file = "test_files/compiled_model_test.json";
+    remove_files();
+  }
+
+  virtual void TearDown() {
+    remove_files();
+  }
+
+  void remove_files() {
+    remove( CompiledModel::get_header_filename( results_file ).c_str() );
+    remove( CompiledModel::get_source_filename( results_file ).c_str() );
+    remove( CompiledModel::get_library_filename( results_file ).c_str() );
+  }
+
+  /**
+   * Compile net and check that the compiled network produces the same
+   * outputs.
+   */
+  void expect_same_outputs( LstmNetwork& net ) {
+    ASSERT_NO_THROW( CompiledModel::write( results_file, net ) );
+    ASSERT_NO_THROW( CompiledModel::build( results_file ) );
+
+    unique_ptr<CompiledNetwork> compiled;
+    ASSERT_NO_THROW( compiled = CompiledModel::load( results_file, net ) );
+
+    ASSERT_EQ( net.get_input_size(), compiled->get_input_size() );
+    ASSERT_EQ( net.get_output_size(), compiled->get_output_size() );
+
+    RandGen rand_gen( 5 );
+    vector<double> input( net.get_input_size() );
+
+    for( size_t step = 0; step < 50; ++step ) {
+      for( double& value : input )
+        value = rand_gen.uniform_real( -1.0, 1.0 );
+
+      net.feed_forward( input );
+      compiled->feed_forward( input );
+
+      vector<double> output = net.get_output();
+
+      for( size_t i = 0; i < output.size(); ++i )
+        ASSERT_NEAR( output[i], compiled->get_output()[i], 1e-9 );
+    }
+
+    net.zero_network();
+    compiled->zero_network();
+
+    net.feed_forward( input );
+    compiled->feed_forward( input );
+
+    EXPECT_NEAR( net.get_output()[0], compiled->get_output()[0], 1e-9 );
+  }
+
+  string results_file;
+};
+
+TEST_F( CompiledModelTest, Filenames ) {
+  EXPECT_EQ( "dir/results-1.hpp",
+             CompiledModel::get_header_filename( "dir/results-1.json" ) );
+  EXPECT_EQ( "dir/results-1.cpp",
+             CompiledModel::get_source_filename( "dir/results-1.json" ) );
+  EXPECT_EQ( "dir/results-1.so",
+             CompiledModel::get_library_filename( "dir/results-1.json" ) );
+  EXPECT_EQ( "lara_results_2017_01_02_03_04_05",
+             CompiledModel::get_namespace_name( "dir/results-2017-01-02-"
+                                                "03:04:05.json" ) );
+
+  EXPECT_THROW( CodeExporter( "1net", EXACT_ACT_FUNCS, {} ),
+                CodeExporterException );
+  EXPECT_THROW( CodeExporter( "a-net", EXACT_ACT_FUNCS, {} ),
+                CodeExporterException );
+}
+
+TEST_F( CompiledModelTest, UnitOrder ) {
+  LstmArchitecture arch( 3, 2, { 12, 4 } );
+  LstmNetwork net( arch, false );
+
+  expect_same_outputs( net );
+}
+
+TEST_F( CompiledModelTest, LevelOrder ) {
+  LstmArchitecture arch( 3, 2, { 12, 4 } );
+  LstmNetwork net( arch, false );
+  net.set_step_order( LEVEL_STEP_ORDER );
+
+  expect_same_outputs( net );
+}
+
+TEST_F( CompiledModelTest, FastActivationFunctions ) {
+  LstmArchitecture arch( 4, 3, { 6 } );
+  LstmNetwork net( arch, false );
+  net.set_act_impl( FAST_ACT_FUNCS );
+
+  expect_same_outputs( net );
+}
+
+/**
+ * A library that does not match the network and its settings must not be
+ * loaded.
+ */
+TEST_F( CompiledModelTest, Stale ) {
+  LstmArchitecture arch( 3, 2, { 4 } );
+  LstmNetwork net( arch, false );
+
+  EXPECT_THROW( CompiledModel::load( results_file, net ),
+                CompiledModelException );
+
+  CompiledModel::write( results_file, net );
+  CompiledModel::build( results_file );
+
+  EXPECT_NO_THROW( CompiledModel::load( results_file, net ) );
+
+  net.set_act_impl( FAST_ACT_FUNCS );
+  EXPECT_THROW( CompiledModel::load( results_file, net ),
+                CompiledModelException );
+  net.set_act_impl( EXACT_ACT_FUNCS );
+
+  net.set_step_order( LEVEL_STEP_ORDER );
+  EXPECT_THROW( CompiledModel::load( results_file, net ),
+                CompiledModelException );
+
+  LstmNetwork other( arch, false );
+  EXPECT_THROW( CompiledModel::load( results_file, other ),
+                CompiledModelException );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,60 @@
+#include "distillation_config.hpp"
+#include "config_parser.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+
+class DistillationConfigTest : public ::testing::Test {
+protected:
+  string prefix = "test_files/distillation_config_test/";
+};
+
+TEST_F( DistillationConfigTest, Defaults ) {
+  ConfigParser cp( prefix + "defaults/larasynth.conf" );
+
+  ConfigParameters params = cp.get_section_params( "distillation" );
+
+  DistillationConfig config( params );
+
+  EXPECT_EQ( "", config.get_teacher_results_filename() );
+  EXPECT_EQ( vector<size_t>( { 4 } ), config.get_block_counts() );
+  EXPECT_EQ( vector<littlelstm::lstm_block_t>( { littlelstm::LSTM_BLOCK } ),
+             config.get_block_types() );
+  EXPECT_EQ( 0.95, config.get_min_agreement() );
+  EXPECT_EQ( 1.1, config.get_max_mse_ratio() );
+  EXPECT_EQ( 1.0, config.get_soft_target_weight() );
+}
+
+TEST_F( DistillationConfigTest, Values ) {
+  ConfigParser cp( prefix + "values/larasynth.conf" );
+
+  ConfigParameters params = cp.get_section_params( "distillation" );
+
+  DistillationConfig config( params );
+
+  EXPECT_EQ( "results-2017-05-29-10:56:45.763129.json",
+             config.get_teacher_results_filename() );
+  EXPECT_EQ( vector<size_t>( { 8, 4 } ), config.get_block_counts() );
+  EXPECT_EQ( vector<littlelstm::lstm_block_t>(
+               { littlelstm::FORGET_GATE_BLOCK, littlelstm::LSTM_BLOCK } ),
+             config.get_block_types() );
+  EXPECT_EQ( 0.9, config.get_min_agreement() );
+  EXPECT_EQ( 1.5, config.get_max_mse_ratio() );
+  EXPECT_EQ( 0.5, config.get_soft_target_weight() );
+}
+
+TEST_F( DistillationConfigTest, NoBlockCounts ) {
+  ConfigParser cp( prefix + "no_block_counts/larasynth.conf" );
+
+  ConfigParameters params = cp.get_section_params( "distillation" );
+
+  EXPECT_THROW( DistillationConfig config( params ),
+                DistillationConfigException );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
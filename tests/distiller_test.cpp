@@ -0,0 +1,299 @@
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "distiller.hpp"
+#include "trainer.hpp"
+#include "lstm_trainer.hpp"
+#include "training_results.hpp"
+#include "model_file.hpp"
+#include "config_parser.hpp"
+#include "time_utilities.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "remove_results.hpp"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+/**
+ * A teacher that records each time the trainer feeds it forward or zeroes
+ * it, with the student's output and target at each update.
+ */
+class RecordingTeacher : public FeedForwardNetwork {
+public:
+  struct Update {
+    bool zeroed = false;
+    vector<double> input;
+    vector<double> output;
+    vector<double> student_output;
+    vector<double> target;
+  };
+
+  RecordingTeacher( const LstmNetwork& network, const LstmNetwork& student,
+                    MidiTranslator& translator )
+    : _network( network ), _student( student ), _translator( translator ) {}
+
+  void feed_forward( const vector<double>& input ) {
+    _network.feed_forward( input );
+
+    if( !recording )
+      return;
+
+    Update update;
+    update.input = input;
+    update.output = _network.get_output();
+    update.student_output = _student.get_output();
+    update.target = _translator.get_target();
+    updates.push_back( update );
+  }
+
+  const vector<double>& get_output() const { return _network.get_output(); }
+  size_t get_output_size() const { return _network.get_output_size(); }
+  size_t get_input_size() const { return _network.get_input_size(); }
+
+  void zero_network() {
+    _network.zero_network();
+
+    if( recording ) {
+      Update update;
+      update.zeroed = true;
+      updates.push_back( update );
+    }
+  }
+
+  bool recording = true;
+  vector<Update> updates;
+
+private:
+  LstmNetwork _network;
+  const LstmNetwork& _student;
+  MidiTranslator& _translator;
+};
+
+class DistillerTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    dir.process_directory();
+
+    ConfigParser cp( dir.get_config_file_path() );
+
+    ConfigParameters lstm_params = cp.get_section_params( "lstm" );
+    ConfigParameters midi_params = cp.get_section_params( "midi" );
+    ConfigParameters training_params = cp.get_section_params( "training" );
+    ConfigParameters repr_params = cp.get_section_params( "representation" );
+
+    lstm_config.reset( new LstmConfig( lstm_params ) );
+    midi_config.reset( new MidiConfig( midi_params ) );
+    training_config.reset( new TrainingConfig( training_params ) );
+    repr_config.reset( new RepresentationConfig( repr_params ) );
+
+    min_max.set_note_min( 0 );
+    min_max.set_note_max( 127 );
+    min_max.set_ctrl_min( 3, 0 );
+    min_max.set_ctrl_max( 3, 127 );
+
+    update_period = MICROSECONDS_PER_SECOND / repr_config->get_update_rate();
+
+    stream.reset( new TrainingEventStream(
+                    update_period,
+                    training_config->get_tempo_adjustment_factor(),
+                    training_config->get_tempo_jitter_factor(),
+                    training_config->get_mean_padding(),
+                    training_config->get_padding_stddev(),
+                    midi_config->get_ctrl_defaults() ) );
+    stream->add_examples( dir.get_training_example_filenames() );
+
+    translator.reset( new MidiTranslator(
+                        repr_config->get_ctrl_output_counts(),
+                        repr_config->get_input_feature_config(),
+                        midi_config->get_ctrl_defaults(), min_max, TRAIN ) );
+
+    Trainer::seed_random_numbers( dir.get_config_file_path() );
+
+    LstmArchitecture student_arch( translator->get_input_count(),
+                                   translator->get_output_count(), { 3 } );
+    LstmArchitecture teacher_arch( translator->get_input_count(),
+                                   translator->get_output_count(), { 6 } );
+
+    student.reset( new LstmNetwork( student_arch ) );
+    teacher.reset( new LstmNetwork( teacher_arch, false ) );
+
+    trainer.reset( new LstmTrainer( *student, *stream, *training_config,
+                                    *lstm_config, *translator,
+                                    update_period ) );
+  }
+
+  virtual void TearDown() {
+    remove_training_results( "test_files/distiller_test/training_results/" );
+  }
+
+  ConfigDirectory dir{ "test_files/distiller_test" };
+
+  unique_ptr<LstmConfig> lstm_config;
+  unique_ptr<MidiConfig> midi_config;
+  unique_ptr<TrainingConfig> training_config;
+  unique_ptr<RepresentationConfig> repr_config;
+  MidiMinMax min_max;
+  size_t update_period;
+
+  unique_ptr<TrainingEventStream> stream;
+  unique_ptr<MidiTranslator> translator;
+
+  unique_ptr<LstmNetwork> student;
+  unique_ptr<LstmNetwork> teacher;
+  unique_ptr<LstmTrainer> trainer;
+};
+
+/**
+ * Replaying the teacher's record on a copy of the student must give the
+ * student's outputs and weights: the teacher was zeroed with the student,
+ * including on resets, it was fed the student's inputs, and the student was
+ * taught soft_target_weight * teacher output + (1 - soft_target_weight) *
+ * target.
+ */
+TEST_F( DistillerTest, BlendedTarget ) {
+  double soft_target_weight = 0.25;
+
+  LstmNetwork reference = *student;
+
+  RecordingTeacher recording_teacher( *teacher, *student, *translator );
+  trainer->set_teacher( &recording_teacher, soft_target_weight );
+
+  for( size_t epoch = 0; epoch < 3; ++epoch )
+    trainer->run_training_epoch();
+
+  size_t zero_count = 0;
+  size_t update_count = 0;
+
+  for( auto& update : recording_teacher.updates ) {
+    if( update.zeroed ) {
+      reference.zero_network();
+      ++zero_count;
+      continue;
+    }
+
+    reference.feed_forward( update.input );
+    ASSERT_EQ( reference.get_output(), update.student_output );
+
+    vector<double> target( update.target.size() );
+
+    for( size_t i = 0; i < target.size(); ++i )
+      target[i] = soft_target_weight * update.output[i] +
+        ( 1.0 - soft_target_weight ) * update.target[i];
+
+    reference.backpropagate( target, lstm_config->get_learning_rate(),
+                             lstm_config->get_momentum() );
+    ++update_count;
+  }
+
+  EXPECT_EQ( trainer->get_step_count(), update_count );
+
+  // set_teacher() and the start of each epoch zero the teacher, so any more
+  // are resets
+  EXPECT_LT( 4, zero_count );
+
+  EXPECT_EQ( reference.get_connection_weights(),
+             student->get_connection_weights() );
+}
+
+/**
+ * ExamplePlayer::compare() runs the student and the teacher on their own
+ * outputs, so the next epoch must start both from zero.
+ */
+TEST_F( DistillerTest, InStepAfterCompare ) {
+  RecordingTeacher recording_teacher( *teacher, *student, *translator );
+  trainer->set_teacher( &recording_teacher, 1.0 );
+
+  trainer->run_training_epoch();
+
+  ExamplePlayer player( dir.get_training_example_filenames(), *midi_config,
+                        *repr_config, min_max );
+
+  recording_teacher.recording = false;
+  player.compare( recording_teacher, *student );
+  recording_teacher.recording = true;
+  recording_teacher.updates.clear();
+
+  LstmNetwork student_reference = *student;
+  LstmNetwork teacher_reference = *teacher;
+  student_reference.zero_network();
+  teacher_reference.zero_network();
+
+  trainer->run_training_epoch();
+
+  ASSERT_LE( 2, recording_teacher.updates.size() );
+  ASSERT_TRUE( recording_teacher.updates[0].zeroed );
+
+  const RecordingTeacher::Update& update = recording_teacher.updates[1];
+  ASSERT_FALSE( update.zeroed );
+
+  student_reference.feed_forward( update.input );
+  teacher_reference.feed_forward( update.input );
+
+  EXPECT_EQ( student_reference.get_output(), update.student_output );
+  EXPECT_EQ( teacher_reference.get_output(), update.output );
+}
+
+/**
+ * A student with easy thresholds must meet them and be written as training
+ * results and a model file that can be read back.
+ */
+TEST_F( DistillerTest, Distill ) {
+  volatile sig_atomic_t shutdown_flag = false;
+
+  string teacher_results_file = dir.get_new_training_results_filename();
+
+  {
+    ConfigParser cp( dir.get_config_file_path() );
+
+    Trainer::seed_random_numbers( dir.get_config_file_path() );
+    Trainer teacher_trainer( dir, cp, teacher_results_file, &shutdown_flag,
+                             false );
+    teacher_trainer.train( 5 );
+    teacher_trainer.write_results();
+  }
+
+  size_t callback_count = 0;
+
+  Distiller distiller( dir.get_directory_name(), teacher_results_file,
+                       &shutdown_flag,
+                       [&]( size_t, const NetworkComparison& ) {
+                         ++callback_count;
+                       } );
+
+  const DistillationReport& report = distiller.get_report();
+
+  EXPECT_TRUE( report.thresholds_met );
+  EXPECT_EQ( report.epoch_count, report.best_epoch );
+  EXPECT_EQ( report.epoch_count, callback_count );
+  EXPECT_LE( 0.5, report.comparison.all_ctrls_agreement );
+  EXPECT_GE( 10.0 * report.comparison.reference_mse, report.comparison.mse );
+  EXPECT_GT( report.teacher_connection_count,
+             report.student_connection_count );
+
+  ASSERT_EQ( Distiller::get_student_results_filename( teacher_results_file,
+                                                      { 3 },
+                                                      { LSTM_BLOCK } ),
+             distiller.get_student_results_filename() );
+
+  TrainingResults results( distiller.get_student_results_filename(),
+                           READ_RESULTS );
+
+  EXPECT_EQ( vector<size_t>( { 3 } ), results.get_block_counts() );
+  EXPECT_DOUBLE_EQ( report.comparison.mse, results.get_mse() );
+  EXPECT_EQ( report.student_connection_count,
+             results.get_trained_network().get_connection_weights().size() );
+
+  ModelFile model( ModelFile::get_model_filename(
+                     distiller.get_student_results_filename() ) );
+
+  EXPECT_EQ( report.student_connection_count,
+             model.get_trained_network().get_connection_weights().size() );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
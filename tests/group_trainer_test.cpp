@@ -0,0 +1,121 @@
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "group_trainer.hpp"
+#include "training_results.hpp"
+#include "results_index.hpp"
+#include "model_file.hpp"
+#include "filesystem_operations.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+
+class GroupTrainerTest : public ::testing::Test {
+protected:
+  GroupTrainerTest()
+    : directory( "test_files/group_trainer_test/" )
+    , results_dir( directory + "training_results/" ) {
+    remove_results();
+  }
+
+  ~GroupTrainerTest() {
+    remove_results();
+  }
+
+  void remove_results() {
+    vector<string> filenames;
+    vector<string> subdirs;
+
+    if( !is_directory( results_dir ) )
+      return;
+
+    get_directory_filenames_and_subdirs( results_dir, filenames, subdirs );
+
+    for( auto& filename : filenames )
+      remove( ( results_dir + filename ).c_str() );
+
+    remove( results_dir.c_str() );
+  }
+
+  string directory;
+  string results_dir;
+};
+
+TEST_F( GroupTrainerTest, TwoGroups ) {
+  volatile sig_atomic_t shutdown_flag = false;
+
+  ASSERT_TRUE( GroupTrainer::has_ctrl_groups( directory ) );
+  ASSERT_FALSE( GroupTrainer::has_ctrl_groups( "test_files/trainer_test" ) );
+
+  GroupTrainer trainer( directory, &shutdown_flag );
+
+  ASSERT_EQ( 2, trainer.get_group_count() );
+
+  // each network feeds back and predicts only its group's controllers
+  EXPECT_EQ( 1 + 8, trainer.get_trainer( 0 ).get_lstm_config()
+             .get_input_count() );
+  EXPECT_EQ( 4, trainer.get_trainer( 1 ).get_lstm_config()
+             .get_output_count() );
+
+  TrainingResults results( trainer.get_results_filename(), READ_RESULTS );
+
+  ASSERT_TRUE( results.is_grouped() );
+  ASSERT_EQ( 2, results.get_group_count() );
+  EXPECT_EQ( vector<event_data_t>( { 3 } ), results.get_group_ctrls( 0 ) );
+  EXPECT_EQ( vector<event_data_t>( { 7 } ), results.get_group_ctrls( 1 ) );
+
+  double mse = 0.0;
+
+  for( size_t i = 0; i < 2; ++i ) {
+    TrainingResults group_results = results.get_group( i );
+    littlelstm::LstmNetwork net = group_results.get_trained_network();
+    RepresentationConfig repr_config = group_results.get_repr_config();
+
+    EXPECT_EQ( repr_config.get_total_output_count(), net.get_output_size() );
+    EXPECT_EQ( trainer.get_trainer( i ).get_best_mse(),
+               group_results.get_mse() );
+
+    mse += group_results.get_mse();
+  }
+
+  EXPECT_DOUBLE_EQ( mse, results.get_mse() );
+
+  // every group has a model file, and the results have none of their own
+  string results_filename = trainer.get_results_filename();
+
+  ASSERT_FALSE( is_regular_file(
+                  ModelFile::get_model_filename( results_filename ) ) );
+  ASSERT_EQ( 2, ModelFile::get_group_model_count( results_filename ) );
+
+  for( size_t i = 0; i < 2; ++i ) {
+    ModelFile model( ModelFile::get_group_model_filename( results_filename,
+                                                          i ) );
+    littlelstm::LstmNetwork net = model.get_trained_network();
+
+    littlelstm::ConnectionWeights_t weights = net.get_connection_weights();
+    littlelstm::ConnectionWeights_t json_weights =
+      results.get_group( i ).get_trained_network().get_connection_weights();
+
+    // the JSON results keep fewer digits than the model file
+    ASSERT_EQ( json_weights.size(), weights.size() );
+    for( size_t w = 0; w < weights.size(); ++w )
+      EXPECT_NEAR( json_weights[w], weights[w], 1e-9 );
+
+    EXPECT_EQ( model.get_repr_config().get_total_output_count(),
+               net.get_output_size() );
+  }
+
+  ResultsIndex index( results_dir );
+  ASSERT_TRUE( index.has_entry( trainer.get_results_filename() ) );
+  EXPECT_EQ( "ctrls:3 inputs:9 blocks:4 outputs:8; "
+             "ctrls:7 inputs:5 blocks:4 outputs:4",
+             index.get_entry( trainer.get_results_filename() ).arch );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,113 @@
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "hyperparameter_search.hpp"
+#include "filesystem_operations.hpp"
+#include "remove_results.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+
+class HyperparameterSearchTest : public ::testing::Test {
+protected:
+  ~HyperparameterSearchTest() {
+    remove_training_results( "test_files/search_test/training_results/" );
+  }
+};
+
+TEST_F( HyperparameterSearchTest, SurvivorCount ) {
+  ASSERT_EQ( 4, HyperparameterSearch::get_survivor_count( 8, 2 ) );
+  ASSERT_EQ( 3, HyperparameterSearch::get_survivor_count( 9, 3 ) );
+  ASSERT_EQ( 1, HyperparameterSearch::get_survivor_count( 3, 2 ) );
+  ASSERT_EQ( 1, HyperparameterSearch::get_survivor_count( 1, 4 ) );
+}
+
+TEST_F( HyperparameterSearchTest, Leaderboard ) {
+  string directory = "test_files/search_test/";
+  volatile sig_atomic_t shutdown_flag = false;
+
+  HyperparameterSearch search( directory, &shutdown_flag );
+
+  ifstream leaderboard( search.get_leaderboard_filename() );
+  ASSERT_TRUE( leaderboard.good() );
+
+  vector<string> lines;
+  string line;
+  while( getline( leaderboard, line ) )
+    lines.push_back( line );
+
+  // header plus one line per trial
+  ASSERT_EQ( 5, lines.size() );
+  ASSERT_EQ( 0, lines[0].find( "rank\ttrial" ) );
+  ASSERT_EQ( 0, lines[1].find( "1\t" ) );
+
+  // the winner has results, every trial has its sampled parameters
+  string results_filename = lines[1].substr( lines[1].rfind( '\t' ) + 1 );
+  ASSERT_NE( "-", results_filename );
+  ASSERT_TRUE( is_regular_file( directory + "training_results/" +
+                                results_filename ) );
+
+  for( size_t i = 1; i < lines.size(); ++i )
+    ASSERT_NE( string::npos, lines[i].find( "learning_rate=" ) );
+}
+
+/**
+ * Read a leaderboard without the minutes and results columns, which differ
+ * between runs.
+ */
+vector<string> read_leaderboard_rankings( const string& filename ) {
+  ifstream leaderboard( filename );
+  vector<string> rankings;
+  string line;
+
+  while( getline( leaderboard, line ) ) {
+    istringstream iss( line );
+    string column;
+    string ranking;
+
+    for( size_t i = 0; getline( iss, column, '\t' ); ++i ) {
+      if( i != 4 && i != 7 )
+        ranking += column + "\t";
+    }
+
+    rankings.push_back( ranking );
+  }
+
+  return rankings;
+}
+
+/**
+ * Ensure a seeded search samples and trains its trials the same way every
+ * time, although the trials are set up on several threads.
+ */
+TEST_F( HyperparameterSearchTest, SameSeed ) {
+  string directory = "test_files/search_test/";
+  volatile sig_atomic_t shutdown_flag = false;
+
+  HyperparameterSearch first( directory, &shutdown_flag );
+  HyperparameterSearch second( directory, &shutdown_flag );
+
+  vector<string> first_rankings =
+    read_leaderboard_rankings( first.get_leaderboard_filename() );
+
+  ASSERT_EQ( 5, first_rankings.size() );
+  ASSERT_EQ( first_rankings,
+             read_leaderboard_rankings( second.get_leaderboard_filename() ) );
+}
+
+TEST_F( HyperparameterSearchTest, NoExamples ) {
+  string directory = "test_files/no_examples";
+  volatile sig_atomic_t shutdown_flag = false;
+
+  ASSERT_THROW( HyperparameterSearch( directory, &shutdown_flag ),
+                runtime_error );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,69 @@
+#include "learning_rate_schedule.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+
+TEST( LearningRateScheduleTest, Constant ) {
+  LearningRateSchedule schedule( CONSTANT_SCHEDULE, 0.1, 0.0, 0.5, 10, 2 );
+
+  EXPECT_EQ( 0.1, schedule.get_learning_rate( 1 ) );
+  EXPECT_EQ( 0.1, schedule.get_learning_rate( 1000 ) );
+
+  for( size_t i = 0; i < 10; ++i )
+    schedule.report_validation_mse( 1.0 );
+
+  EXPECT_EQ( 0.1, schedule.get_learning_rate( 1000 ) );
+}
+
+TEST( LearningRateScheduleTest, Step ) {
+  LearningRateSchedule schedule( STEP_SCHEDULE, 0.1, 0.02, 0.5, 10, 2 );
+
+  EXPECT_DOUBLE_EQ( 0.1, schedule.get_learning_rate( 1 ) );
+  EXPECT_DOUBLE_EQ( 0.1, schedule.get_learning_rate( 10 ) );
+  EXPECT_DOUBLE_EQ( 0.05, schedule.get_learning_rate( 11 ) );
+  EXPECT_DOUBLE_EQ( 0.025, schedule.get_learning_rate( 21 ) );
+
+  // never below the minimum
+  EXPECT_DOUBLE_EQ( 0.02, schedule.get_learning_rate( 31 ) );
+}
+
+TEST( LearningRateScheduleTest, Cosine ) {
+  LearningRateSchedule schedule( COSINE_SCHEDULE, 0.1, 0.0, 0.5, 10, 2 );
+
+  EXPECT_DOUBLE_EQ( 0.1, schedule.get_learning_rate( 1 ) );
+  EXPECT_DOUBLE_EQ( 0.05, schedule.get_learning_rate( 6 ) );
+  EXPECT_GT( 0.01, schedule.get_learning_rate( 10 ) );
+
+  // starts over
+  EXPECT_DOUBLE_EQ( 0.1, schedule.get_learning_rate( 11 ) );
+}
+
+TEST( LearningRateScheduleTest, Plateau ) {
+  LearningRateSchedule schedule( PLATEAU_SCHEDULE, 0.1, 0.0, 0.5, 10, 2 );
+
+  schedule.report_validation_mse( 1.0 );
+  schedule.report_validation_mse( 0.5 );
+  schedule.report_validation_mse( 0.6 );
+
+  EXPECT_DOUBLE_EQ( 0.1, schedule.get_learning_rate( 100 ) );
+
+  schedule.report_validation_mse( 0.5 );
+
+  EXPECT_DOUBLE_EQ( 0.05, schedule.get_learning_rate( 100 ) );
+
+  // the state carries over to a new schedule
+  LearningRateSchedule restored( PLATEAU_SCHEDULE, 0.1, 0.0, 0.5, 10, 2 );
+  restored.set_state( schedule.get_state() );
+
+  restored.report_validation_mse( 0.7 );
+  restored.report_validation_mse( 0.7 );
+
+  EXPECT_DOUBLE_EQ( 0.025, restored.get_learning_rate( 100 ) );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,90 @@
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "lexer.hpp"
+#include "tokens.hpp"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+
+TEST( LexerTest, TokenTypesAndValues ) {
+  string filename = "test_files/lexer_test/tokens.conf";
+  Lexer lexer( filename, { "ctrl" } );
+  Tokens tokens = lexer.get_tokens();
+
+  vector<token_t> types = {
+    L_SQUARE, ALPHANUMERIC, R_SQUARE,
+    ALPHANUMERIC, EQUALS, QUOTED_STRING,
+    ALPHANUMERIC, COLON, INTEGER, COMMA, MINUS, INTEGER, DOT, INTEGER, COMMA,
+    L_CURLY, INTEGER, COMMA, INTEGER, R_CURLY,
+    RESERVED_STRING, INTEGER, INTEGER, INTEGER
+  };
+
+  ASSERT_EQ( types.size(), tokens.size() );
+  EXPECT_TRUE( tokens.match( types ) );
+
+  EXPECT_EQ( filename + ":2", tokens.get_location() );
+
+  tokens.eat();
+  EXPECT_EQ( "section", tokens.eat() );
+  tokens.eat();
+  EXPECT_EQ( "name", tokens.eat() );
+  tokens.eat();
+  EXPECT_EQ( filename + ":3", tokens.get_location() );
+  EXPECT_EQ( "a \"quoted\" value", tokens.eat() );
+  EXPECT_TRUE( tokens.match( "values" ) );
+  EXPECT_EQ( filename + ":4", tokens.get_location() );
+
+  while( !tokens.match( RESERVED_STRING ) )
+    tokens.eat();
+
+  EXPECT_EQ( filename + ":6", tokens.get_location() );
+  EXPECT_EQ( "ctrl", tokens.eat() );
+  EXPECT_EQ( "64", tokens.eat() );
+}
+
+TEST( LexerTest, Lines ) {
+  Lexer lexer( "test_files/lexer_test/tokens.conf" );
+
+  vector<string> lines = lexer.get_lines();
+
+  ASSERT_EQ( 6, lines.size() );
+  EXPECT_EQ( "[section]", lines[1] );
+  EXPECT_EQ( "", lines[4] );
+}
+
+TEST( LexerTest, LongLine ) {
+  string filename = "test_files/lexer_test/long_line.seq";
+  size_t count = 100000;
+
+  {
+    ofstream outfile( filename );
+    for( size_t i = 0; i < count; ++i )
+      outfile << "on 60 100 " << i << " ";
+    outfile << endl;
+  }
+
+  Lexer lexer( filename, { "on" } );
+  Tokens tokens = lexer.get_tokens();
+
+  EXPECT_EQ( count * 4, tokens.size() );
+
+  remove( filename.c_str() );
+}
+
+TEST( LexerTest, MissingFile ) {
+  ASSERT_THROW( Lexer( "test_files/lexer_test/does_not_exist.conf" ),
+                LexerException );
+}
+
+TEST( LexerTest, UnexpectedSymbol ) {
+  ASSERT_THROW( Lexer( "test_files/lexer_test/unexpected_symbol.conf" ),
+                TokenException );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -21,11 +21,22 @@ TEST_F( LstmConfigTest, Defaults ) {
 
   EXPECT_EQ( 0.05, config.get_learning_rate() );
   EXPECT_EQ( 0.8, config.get_momentum() );
+  EXPECT_EQ( littlelstm::MOMENTUM_OPTIMIZER,
+             config.get_optimizer_config().type );
+  EXPECT_EQ( CONSTANT_SCHEDULE, config.get_schedule_type() );
+  EXPECT_EQ( littlelstm::EXACT_ACT_FUNCS, config.get_act_impl() );
+  EXPECT_EQ( 1, config.get_step_thread_count() );
+  EXPECT_EQ( littlelstm::UNIT_STEP_ORDER, config.get_step_order() );
+  EXPECT_EQ( 0.05,
+             config.get_learning_rate_schedule().get_learning_rate( 5000 ) );
 
   vector<size_t> block_counts = config.get_block_counts();
 
   ASSERT_EQ( 1, block_counts.size() );
   EXPECT_EQ( 17, block_counts[0] );
+
+  ASSERT_EQ( 1, config.get_block_types().size() );
+  EXPECT_EQ( littlelstm::LSTM_BLOCK, config.get_block_types()[0] );
 }
 
 TEST_F( LstmConfigTest, Values ) {
@@ -37,6 +48,9 @@ TEST_F( LstmConfigTest, Values ) {
 
   EXPECT_EQ( 0.05, config.get_learning_rate() );
   EXPECT_EQ( 0.9, config.get_momentum() );
+  EXPECT_EQ( 4, config.get_step_thread_count() );
+  EXPECT_EQ( littlelstm::LEVEL_STEP_ORDER, config.get_step_order() );
+  EXPECT_EQ( true, config.get_optimizer_config().scale_output_updates );
 
   vector<size_t> block_counts = config.get_block_counts();
 
@@ -45,6 +59,91 @@ TEST_F( LstmConfigTest, Values ) {
   EXPECT_EQ( 29, block_counts[1] );
 }
 
+TEST_F( LstmConfigTest, Optimizer ) {
+  ConfigParser cp( prefix + "optimizer/larasynth.conf" );
+
+  ConfigParameters params = cp.get_section_params( "lstm" );
+  
+  LstmConfig config( params );
+
+  EXPECT_EQ( littlelstm::RMSPROP_OPTIMIZER,
+             config.get_optimizer_config().type );
+  EXPECT_EQ( DEFAULT_RMSPROP_SECOND_MOMENT_DECAY,
+             config.get_optimizer_config().second_moment_decay );
+  EXPECT_EQ( false, config.get_optimizer_config().scale_output_updates );
+  EXPECT_EQ( COSINE_SCHEDULE, config.get_schedule_type() );
+
+  LearningRateSchedule schedule = config.get_learning_rate_schedule();
+
+  EXPECT_DOUBLE_EQ( 0.01, schedule.get_learning_rate( 1 ) );
+  EXPECT_DOUBLE_EQ( 0.0055, schedule.get_learning_rate( 101 ) );
+  EXPECT_DOUBLE_EQ( 0.01, schedule.get_learning_rate( 201 ) );
+}
+
+TEST_F( LstmConfigTest, UnknownOptimizer ) {
+  ConfigParser cp( prefix + "unknown_optimizer/larasynth.conf" );
+
+  ConfigParameters params = cp.get_section_params( "lstm" );
+
+  ASSERT_THROW( LstmConfig config( params ), LstmConfigException );
+}
+
+TEST_F( LstmConfigTest, UnknownOutputUpdates ) {
+  ConfigParser cp( prefix + "unknown_output_updates/larasynth.conf" );
+
+  ConfigParameters params = cp.get_section_params( "lstm" );
+
+  ASSERT_THROW( LstmConfig config( params ), LstmConfigException );
+}
+
+TEST_F( LstmConfigTest, FastActivationFunctions ) {
+  ConfigParser cp( prefix + "fast_activation_functions/larasynth.conf" );
+
+  ConfigParameters params = cp.get_section_params( "lstm" );
+
+  LstmConfig config( params );
+
+  EXPECT_EQ( littlelstm::FAST_ACT_FUNCS, config.get_act_impl() );
+}
+
+TEST_F( LstmConfigTest, UnknownActivationFunctions ) {
+  ConfigParser cp( prefix + "unknown_activation_functions/larasynth.conf" );
+
+  ConfigParameters params = cp.get_section_params( "lstm" );
+
+  ASSERT_THROW( LstmConfig config( params ), LstmConfigException );
+}
+
+TEST_F( LstmConfigTest, UnknownStepOrder ) {
+  ConfigParser cp( prefix + "unknown_step_order/larasynth.conf" );
+
+  ConfigParameters params = cp.get_section_params( "lstm" );
+
+  ASSERT_THROW( LstmConfig config( params ), LstmConfigException );
+}
+
+TEST_F( LstmConfigTest, BlockTypes ) {
+  ConfigParser cp( prefix + "block_types/larasynth.conf" );
+
+  ConfigParameters params = cp.get_section_params( "lstm" );
+
+  LstmConfig config( params );
+
+  ASSERT_EQ( 2, config.get_block_types().size() );
+  EXPECT_EQ( littlelstm::FORGET_GATE_BLOCK, config.get_block_types()[0] );
+  EXPECT_EQ( littlelstm::LSTM_BLOCK, config.get_block_types()[1] );
+}
+
+TEST_F( LstmConfigTest, InvalidBlockTypes ) {
+  for( string name : { "unknown_block_type", "block_types_count" } ) {
+    ConfigParser cp( prefix + name + "/larasynth.conf" );
+
+    ConfigParameters params = cp.get_section_params( "lstm" );
+
+    ASSERT_THROW( LstmConfig config( params ), LstmConfigException );
+  }
+}
+
 TEST_F( LstmConfigTest, UniformRandDouble ) {
   for( size_t i = 0; i < 100; ++i ) {
     ConfigParser cp( prefix + "uniform_rand_double/larasynth.conf" );
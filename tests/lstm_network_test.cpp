@@ -235,6 +235,377 @@ TEST( LstmNetworkTest, LearnOneTwoThree ) {
   ASSERT_EQ( true, perfect );
 }  
 
+/**
+ * Train network until it detects the following sequence within a training
+ * sequence, or give up after 5000 epochs. Returns whether it was learned.
+ *
+ * {1, 0, 0}
+ * {0, 1, 0}
+ * {0, 0, 1}
+ */
+bool learn_one_two_three( LstmNetwork& network, double learning_rate ) {
+  RandGen rand;
+
+  vector<double> input( 3 );
+  vector<double> output;
+
+  vector<double> target( 2 );
+
+  bool perfect = false;
+
+  for( size_t epoch = 0; epoch < 5000 && !perfect; ++epoch ) {
+    network.zero_network();
+    vector< pair<int, bool> > training_data = make_one_two_three_data( rand );
+
+    // train
+    for( auto& kv : training_data ) {
+      input = { 0, 0, 0 };
+      input[kv.first] = 1.0;
+
+      target[0] = 0.0;
+      target[1] = 0.0;
+
+      if( kv.second )
+        target[1] = 1.0;
+      else
+        target[0] = 1.0;
+
+      network.feed_forward( input );
+
+      output = network.get_output();
+
+      if( kv.second != ( output[0] < output[1] ) )
+        network.backpropagate( target, learning_rate, 0.8 );
+    }
+      
+    network.zero_network();
+    vector< pair<int, bool> > validation_data = make_one_two_three_data( rand );
+
+    // validate
+    size_t correct_count = 0;
+
+    for( auto& kv : training_data ) {
+      input = { 0, 0, 0 };
+      input[kv.first] = 1.0;
+
+      target[0] = 0.0;
+      target[1] = 0.0;
+
+      network.feed_forward( input );
+      output = network.get_output();
+
+      if( kv.second == ( output[0] < output[1] ) ) {
+        correct_count++;
+      }
+      else {
+        break;
+      }
+    }
+
+    if( correct_count == training_data.size() ) {
+      perfect = true;
+    }
+  }
+
+  return perfect;
+}
+
+TEST( LstmNetworkTest, AdaptiveOptimizers ) {
+  LstmArchitecture arch( 3, 2, { 3 } );
+
+  LstmNetwork rmsprop_network( arch );
+  rmsprop_network.set_optimizer( LstmOptimizerConfig( RMSPROP_OPTIMIZER,
+                                                      0.9 ) );
+  ASSERT_EQ( true, learn_one_two_three( rmsprop_network, 0.01 ) );
+
+  LstmNetwork adam_network( arch );
+  adam_network.set_optimizer( LstmOptimizerConfig( ADAM_OPTIMIZER, 0.999 ) );
+  ASSERT_EQ( true, learn_one_two_three( adam_network, 0.01 ) );
+
+  // the optimizer state is part of the network state
+  LstmNetworkState state;
+  adam_network.get_state( state );
+  ASSERT_EQ( adam_network.get_connection_weights().size(),
+             state.second_moments.size() );
+  ASSERT_LT( 0, state.optimizer_step_count );
+}
+
+/**
+ * With the momentum optimizer the weights into the output units change by
+ * their raw gradient, or by the learning rate times it when the output updates
+ * are scaled. The hidden weights change in the same way either way.
+ */
+TEST( LstmNetworkTest, OutputUpdates ) {
+  LstmArchitecture arch( 3, 2, { 3 } );
+
+  LstmNetwork gradient_network( arch );
+  LstmNetwork scaled_network( arch );
+  scaled_network.set_connection_weights(
+    gradient_network.get_connection_weights() );
+  scaled_network.set_optimizer( LstmOptimizerConfig( MOMENTUM_OPTIMIZER,
+                                                     0.999, true ) );
+
+  ConnectionWeights_t old_weights = gradient_network.get_connection_weights();
+
+  const double learning_rate = 0.1;
+
+  for( auto network : { &gradient_network, &scaled_network } ) {
+    network->feed_forward( { 1.0, 0.0, 0.0 } );
+    network->backpropagate( { 0.0, 1.0 }, learning_rate, 0.8 );
+  }
+
+  ConnectionWeights_t gradient_weights =
+    gradient_network.get_connection_weights();
+  ConnectionWeights_t scaled_weights = scaled_network.get_connection_weights();
+
+  auto connections = gradient_network.get_connections();
+  size_t output_conn_count = 0;
+
+  for( size_t i = 0; i < connections.size(); ++i ) {
+    double gradient_change = gradient_weights[i] - old_weights[i];
+    double scaled_change = scaled_weights[i] - old_weights[i];
+
+    if( arch.get_unit_properties( connections[i].second ).get_type() ==
+        OUTPUT_UNIT ) {
+      EXPECT_NEAR( learning_rate * gradient_change, scaled_change, 1e-12 );
+      if( gradient_change != 0.0 )
+        ++output_conn_count;
+    }
+    else {
+      EXPECT_DOUBLE_EQ( gradient_change, scaled_change );
+    }
+  }
+
+  ASSERT_LT( 0, output_conn_count );
+
+  LstmNetwork learning_network( arch );
+  learning_network.set_optimizer( LstmOptimizerConfig( MOMENTUM_OPTIMIZER,
+                                                       0.999, true ) );
+  ASSERT_EQ( true, learn_one_two_three( learning_network, 0.1 ) );
+}
+
+/**
+ * Ensure forget gate blocks only have a forget gate and a cell, fit in a
+ * network with LSTM blocks, and still learn.
+ */
+TEST( LstmNetworkTest, ForgetGateBlocks ) {
+  LstmArchitecture lstm_arch( 3, 2, { 4, 3 } );
+  LstmArchitecture arch( 3, 2, { 4, 3 }, { FORGET_GATE_BLOCK, LSTM_BLOCK } );
+
+  ASSERT_EQ( 3 + 2 + 1 + 4 * UNITS_PER_FORGET_GATE_BLOCK +
+             3 * UNITS_PER_BLOCK, arch.get_unit_count() );
+  ASSERT_EQ( FORGET_GATE_BLOCK, arch.get_block_type( 0 ) );
+  ASSERT_EQ( LSTM_BLOCK, arch.get_block_type( 1 ) );
+  ASSERT_LT( arch.get_connections().size(),
+             lstm_arch.get_connections().size() );
+
+  vector<Id_t> block_ids = arch.get_block_ids( 0, 0 );
+  ASSERT_EQ( 2, block_ids.size() );
+
+  const LstmUnitProperties& forget_gate =
+    arch.get_unit_properties( block_ids[0] );
+  const LstmUnitProperties& cell = arch.get_unit_properties( block_ids[1] );
+
+  ASSERT_EQ( FORGET_GATE, forget_gate.get_type() );
+  ASSERT_EQ( CELL, cell.get_type() );
+  ASSERT_EQ( forget_gate.get_id(), cell.get_self_conn_gater() );
+  ASSERT_TRUE( forget_gate.get_gated_conns().empty() );
+
+  ASSERT_EQ( 4, arch.get_block_ids( 1, 0 ).size() );
+
+  LstmArchitecture one_two_three_arch( 3, 2, { 6 }, { FORGET_GATE_BLOCK } );
+  LstmNetwork network( one_two_three_arch );
+
+  ASSERT_EQ( true, learn_one_two_three( network, 0.05 ) );
+}
+
+/**
+ * Ensure the fast activation functions keep the outputs of a network close to
+ * the exact ones over many steps, and that the network still learns with
+ * them.
+ */
+TEST( LstmNetworkTest, FastActivationFunctions ) {
+  LstmArchitecture arch( 3, 2, { 8, 8 } );
+  LstmNetwork exact_network( arch );
+  LstmNetwork fast_network( exact_network );
+
+  fast_network.set_act_impl( FAST_ACT_FUNCS );
+  ASSERT_EQ( FAST_ACT_FUNCS, fast_network.get_act_impl() );
+  ASSERT_EQ( EXACT_ACT_FUNCS, exact_network.get_act_impl() );
+
+  RandGen rand( 1 );
+  double max_difference = 0.0;
+
+  for( size_t i = 0; i < 1000; ++i ) {
+    vector<double> input = { rand.uniform_real( -1.0, 1.0 ),
+                             rand.uniform_real( -1.0, 1.0 ),
+                             rand.uniform_real( -1.0, 1.0 ) };
+
+    exact_network.feed_forward( input );
+    fast_network.feed_forward( input );
+
+    vector<double> exact_output = exact_network.get_output();
+    vector<double> fast_output = fast_network.get_output();
+
+    for( size_t j = 0; j < exact_output.size(); ++j )
+      max_difference = max( max_difference,
+                            fabs( exact_output[j] - fast_output[j] ) );
+  }
+
+  EXPECT_LT( max_difference, 1e-5 );
+
+  LstmNetwork network( arch );
+  network.set_act_impl( FAST_ACT_FUNCS );
+  ASSERT_EQ( true, learn_one_two_three( network, 0.05 ) );
+}
+
+/**
+ * Ensure level order puts the gates of each hidden layer in one level and its
+ * cells in the next, that the number of threads does not change the outputs,
+ * and that the network still learns in level order.
+ */
+TEST( LstmNetworkTest, StepThreads ) {
+  LstmArchitecture small_arch( 3, 2, { 4, 4 } );
+  LstmNetwork small_network( small_arch );
+
+  ASSERT_TRUE( small_network.get_levels().empty() );
+
+  small_network.set_step_order( LEVEL_STEP_ORDER );
+
+  const vector< vector<Id_t> >& levels = small_network.get_levels();
+
+  ASSERT_EQ( 5, levels.size() );
+  EXPECT_EQ( 12, levels[0].size() );
+  EXPECT_EQ( 4, levels[1].size() );
+  EXPECT_EQ( 12, levels[2].size() );
+  EXPECT_EQ( 4, levels[3].size() );
+  EXPECT_EQ( 2, levels[4].size() );
+
+  small_network.set_step_order( UNIT_STEP_ORDER );
+  ASSERT_TRUE( small_network.get_levels().empty() );
+
+  // large enough for the loops to be split between the threads
+  LstmArchitecture arch( 3, 2, { 32 } );
+  LstmNetwork two_thread_network( arch );
+  two_thread_network.set_step_order( LEVEL_STEP_ORDER );
+  LstmNetwork three_thread_network( two_thread_network );
+
+  two_thread_network.set_step_thread_count( 2 );
+  three_thread_network.set_step_thread_count( 3 );
+
+  // copies get their own threads
+  LstmNetwork copied_network( three_thread_network );
+  ASSERT_EQ( 3, copied_network.get_step_thread_count() );
+  ASSERT_EQ( LEVEL_STEP_ORDER, copied_network.get_step_order() );
+
+  RandGen rand( 2 );
+  vector<double> target = { 1.0, 0.0 };
+
+  for( size_t i = 0; i < 50; ++i ) {
+    vector<double> input = { rand.uniform_real( -1.0, 1.0 ),
+                             rand.uniform_real( -1.0, 1.0 ),
+                             rand.uniform_real( -1.0, 1.0 ) };
+
+    two_thread_network.feed_forward( input );
+    three_thread_network.feed_forward( input );
+    copied_network.feed_forward( input );
+
+    ASSERT_EQ( two_thread_network.get_output(),
+               three_thread_network.get_output() );
+    ASSERT_EQ( two_thread_network.get_output(),
+               copied_network.get_output() );
+
+    two_thread_network.backpropagate( target, 0.1, 0.8 );
+    three_thread_network.backpropagate( target, 0.1, 0.8 );
+    copied_network.backpropagate( target, 0.1, 0.8 );
+  }
+
+  ASSERT_EQ( two_thread_network.get_connection_weights(),
+             three_thread_network.get_connection_weights() );
+
+  LstmArchitecture one_two_three_arch( 3, 2, { 3 } );
+  LstmNetwork network( one_two_three_arch );
+  network.set_step_order( LEVEL_STEP_ORDER );
+  network.set_step_thread_count( 2 );
+  ASSERT_EQ( true, learn_one_two_three( network, 0.05 ) );
+}
+
+/**
+ * Ensure profiling counts the phases only while it is turned on.
+ */
+TEST( LstmNetworkTest, Profiling ) {
+  LstmArchitecture arch( 3, 2, { 4 } );
+  LstmNetwork network( arch );
+
+  vector<double> input = { 1.0, 0.0, 0.5 };
+  vector<double> target = { 1.0, 0.0 };
+
+  network.feed_forward( input );
+  network.backpropagate( target, 0.1, 0.8 );
+  ASSERT_EQ( 0, network.get_profile().activations.call_count );
+
+  network.set_profiling( true );
+
+  for( size_t i = 0; i < 3; ++i ) {
+    network.feed_forward( input );
+    network.backpropagate( target, 0.1, 0.8 );
+  }
+  network.feed_forward( input );
+
+  const LstmProfile& profile = network.get_profile();
+  ASSERT_EQ( 4, profile.activations.call_count );
+  ASSERT_EQ( 3, profile.eligibility_traces.call_count );
+  ASSERT_EQ( 3, profile.error_responsibilities.call_count );
+  ASSERT_EQ( 3, profile.weight_updates.call_count );
+  ASSERT_EQ( 3 * network.get_connection_weights().size(),
+             profile.connection_update_count );
+  ASSERT_LT( 0, profile.activations.nanoseconds );
+
+  network.reset_profile();
+  ASSERT_EQ( 0, network.get_profile().activations.call_count );
+}
+
+/**
+ * Ensure a weight snapshot restores the network to the same outputs after
+ * further training, and that the WeightsMap_t adapter agrees with it.
+ */
+TEST( LstmNetworkTest, ConnectionWeightsSnapshot ) {
+  LstmArchitecture arch( 3, 2, { 4, 3 } );
+  LstmNetwork network( arch );
+
+  vector<double> input = { 1.0, 0.0, 0.5 };
+  vector<double> target = { 1.0, 0.0 };
+
+  ConnectionWeights_t snapshot = network.get_connection_weights();
+  ASSERT_EQ( network.get_connections().size(), snapshot.size() );
+
+  network.feed_forward( input );
+  vector<double> before = network.get_output();
+
+  for( size_t i = 0; i < 10; ++i ) {
+    network.feed_forward( input );
+    network.backpropagate( target, 0.1, 0.8 );
+  }
+
+  ASSERT_NE( snapshot, network.get_connection_weights() );
+
+  network.set_connection_weights( snapshot );
+  network.zero_network();
+  network.feed_forward( input );
+
+  ASSERT_EQ( before, network.get_output() );
+  ASSERT_EQ( snapshot, network.get_connection_weights() );
+
+  WeightsMap_t weights_map = network.get_weights_map();
+  vector< pair<Id_t, Id_t> > connections = network.get_connections();
+  for( size_t i = 0; i < connections.size(); ++i )
+    ASSERT_EQ( snapshot[i],
+               weights_map[connections[i].second][connections[i].first] );
+
+  snapshot.pop_back();
+  ASSERT_THROW( network.set_connection_weights( snapshot ), out_of_range );
+}
+
 int main( int argc, char ** argv ) {
   ::testing::InitGoogleTest( &argc, argv );
   return RUN_ALL_TESTS();
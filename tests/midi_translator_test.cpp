@@ -249,6 +249,42 @@ TEST( MidiTranslatorTest, BasicTest ) {
 
 }
 
+/**
+ * A translator for a group of controllers ignores the defaults and changes
+ * of the other controllers.
+ */
+TEST( MidiTranslatorTest, ControllerGroup ) {
+  MidiMinMax min_max;
+
+  min_max.set_ctrl_min( 2, 0 );
+  min_max.set_ctrl_max( 2, 127 );
+
+  unordered_map<event_data_t,size_t> ctrl_output_counts( { { 2, 4 } } );
+  unordered_map<event_data_t,event_data_t> ctrl_defaults( { { 1, 64 },
+                                                            { 2, 127 },
+                                                            { 3, 0 } } );
+
+  feature_config_t feature_config;
+  feature_config[SOME_NOTE_ON] = true;
+
+  MidiTranslator trans( ctrl_output_counts, feature_config, ctrl_defaults,
+                        min_max, TRAIN );
+
+  EXPECT_EQ( 4, trans.get_output_count() );
+  EXPECT_EQ( 5, trans.get_input_count() );
+  EXPECT_EQ( ctrl_values_t( { { 2, 127 } } ), trans.get_target_ctrl_values() );
+
+  vector<double> target( 4, 0.0 );
+
+  trans.update_ctrl_value( 1, 10 );
+  trans.update_ctrl_value( 2, 5 );
+  trans.update_ctrl_values( { { 2, 5 }, { 3, 100 } } );
+  trans.fill_target( target );
+
+  EXPECT_EQ( vector<double>( { 1.0, 0.0, 0.0, 0.0 } ), target );
+  EXPECT_EQ( ctrl_values_t( { { 2, 0 } } ), trans.get_target_ctrl_values() );
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
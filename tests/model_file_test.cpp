@@ -0,0 +1,175 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include "model_file.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "littlelstm/json_exporter.hpp"
+#include "littlelstm/json_importer.hpp"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+class ModelFileTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    model_file = "test_files/training_results_test/results.model";
+    remove( model_file.c_str() );
+  }
+
+  virtual void TearDown() {
+    remove( model_file.c_str() );
+  }
+
+  string model_file;
+};
+
+/**
+ * A network exported to the binary format and imported again must have the
+ * same connections and weights, and must produce the same output.
+ */
+TEST( BinaryNetworkTest, RoundTrip ) {
+  LstmArchitecture arch( 3, 2, { 2, 3 } );
+  LstmNetwork net( arch );
+
+  BinaryExporter exporter;
+  net.export_network( exporter );
+  exporter.set_user_data( "user data" );
+
+  string bytes = exporter.get_bytes();
+
+  BinaryImporter importer( bytes.data(), bytes.size() );
+
+  EXPECT_EQ( "user data", importer.get_user_data() );
+
+  LstmNetwork imported( importer );
+
+  EXPECT_EQ( net.get_connections(), imported.get_connections() );
+  EXPECT_EQ( net.get_weights_map(), imported.get_weights_map() );
+
+  vector<double> input = { 1.0, 0.0, 0.5 };
+
+  for( size_t i = 0; i < 5; ++i ) {
+    net.feed_forward( input );
+    imported.feed_forward( input );
+    EXPECT_EQ( net.get_output(), imported.get_output() );
+  }
+}
+
+/**
+ * The binary and JSON formats must describe the same network.
+ */
+TEST( BinaryNetworkTest, MatchesJson ) {
+  LstmArchitecture arch( 4, 3, { 2 } );
+  LstmNetwork net( arch );
+
+  BinaryExporter binary_exporter;
+  JsonExporter json_exporter;
+
+  net.export_network( binary_exporter );
+  net.export_network( json_exporter );
+
+  string bytes = binary_exporter.get_bytes();
+
+  BinaryImporter binary_importer( bytes.data(), bytes.size() );
+  JsonImporter json_importer;
+  json_importer.set_json( json_exporter.get_json() );
+
+  EXPECT_EQ( json_importer.get_connections(),
+             binary_importer.get_connections() );
+  EXPECT_EQ( json_importer.get_weights(), binary_importer.get_weights() );
+  EXPECT_EQ( json_importer.get_connection_weights(),
+             binary_importer.get_connection_weights() );
+  EXPECT_EQ( json_importer.get_units_properties().size(),
+             binary_importer.get_units_properties().size() );
+}
+
+TEST( BinaryNetworkTest, InvalidData ) {
+  LstmArchitecture arch( 3, 2, { 2 } );
+  LstmNetwork net( arch );
+
+  BinaryExporter exporter;
+  net.export_network( exporter );
+
+  string bytes = exporter.get_bytes();
+
+  EXPECT_THROW( BinaryImporter( bytes.data(), 10 ), BinaryImporterException );
+  EXPECT_THROW( BinaryImporter( bytes.data(), bytes.size() - 8 ),
+                BinaryImporterException );
+
+  string bad_magic = bytes;
+  bad_magic[0] = 'X';
+
+  EXPECT_THROW( BinaryImporter( bad_magic.data(), bad_magic.size() ),
+                BinaryImporterException );
+
+  // a count that wraps around when multiplied by its record size must not
+  // pass the bounds check
+  string huge_count = bytes;
+  BinaryNetworkHeader header;
+  memcpy( &header, huge_count.data(), sizeof( header ) );
+  header.gated_conn_count = UINT64_MAX / 3 + 1;
+  memcpy( &huge_count[0], &header, sizeof( header ) );
+
+  EXPECT_THROW( BinaryImporter( huge_count.data(), huge_count.size() ),
+                BinaryImporterException );
+}
+
+TEST_F( ModelFileTest, WriteAndRead ) {
+  LstmArchitecture arch( 5, 4, { 3 } );
+  LstmNetwork net( arch );
+  net.set_act_impl( FAST_ACT_FUNCS );
+  net.set_step_order( LEVEL_STEP_ORDER );
+
+  MidiMinMax min_max;
+  min_max.set_note_min( 10 );
+  min_max.set_note_max( 100 );
+  min_max.set_ctrl_min( 1, 30 );
+  min_max.set_ctrl_max( 1, 50 );
+
+  feature_config_t feature_config;
+  feature_config[NOTE_STRUCK] = true;
+  feature_config[INTERVAL] = true;
+
+  RepresentationConfig repr_config( { 1, 4 }, 50, feature_config );
+
+  ASSERT_NO_THROW( ModelFile::write( model_file, net, min_max,
+                                     repr_config ) );
+
+  ModelFile model( model_file );
+
+  EXPECT_EQ( min_max, model.get_min_max() );
+
+  RepresentationConfig read_repr_config = model.get_repr_config();
+
+  EXPECT_EQ( repr_config.get_ctrl_output_counts(),
+             read_repr_config.get_ctrl_output_counts() );
+  EXPECT_EQ( repr_config.get_update_rate(),
+             read_repr_config.get_update_rate() );
+  EXPECT_EQ( repr_config.get_input_feature_config(),
+             read_repr_config.get_input_feature_config() );
+
+  LstmNetwork read_net = model.get_trained_network();
+
+  EXPECT_EQ( net.get_weights_map(), read_net.get_weights_map() );
+  EXPECT_EQ( FAST_ACT_FUNCS, read_net.get_act_impl() );
+  EXPECT_EQ( LEVEL_STEP_ORDER, read_net.get_step_order() );
+  EXPECT_EQ( net.get_levels(), read_net.get_levels() );
+}
+
+TEST_F( ModelFileTest, ModelFilename ) {
+  EXPECT_EQ( "dir/results-1.model",
+             ModelFile::get_model_filename( "dir/results-1.json" ) );
+}
+
+TEST_F( ModelFileTest, MissingFile ) {
+  EXPECT_THROW( ModelFile model( model_file ), ModelFileException );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,150 @@
+#include <string>
+#include <cstdio>
+
+#include "model_pruner.hpp"
+#include "trainer.hpp"
+#include "training_results.hpp"
+#include "model_file.hpp"
+#include "filesystem_operations.hpp"
+#include "remove_results.hpp"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+class ModelPrunerTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    dir.process_directory();
+
+    ConfigParser cp( dir.get_config_file_path() );
+    volatile sig_atomic_t shutdown_flag = false;
+
+    results_file = dir.get_new_training_results_filename();
+
+    Trainer::seed_random_numbers( dir.get_config_file_path() );
+    Trainer trainer( dir, cp, results_file, &shutdown_flag, false );
+    trainer.train( 3 );
+    trainer.write_results();
+  }
+
+  virtual void TearDown() {
+    remove_training_results( "test_files/model_pruner_test/"
+                             "training_results/" );
+  }
+
+  /**
+   * Play the training examples to a network the way ModelPruner measures
+   * its MSEs.
+   */
+  double calculate_mse( LstmNetwork& net ) {
+    ConfigParser cp( dir.get_config_file_path() );
+    ConfigParameters midi_params = cp.get_section_params( "midi" );
+    MidiConfig midi_config( midi_params );
+
+    TrainingResults results( results_file, READ_RESULTS );
+    RepresentationConfig repr_config = results.get_repr_config();
+
+    ExamplePlayer player( dir.get_training_example_filenames(), midi_config,
+                          repr_config, results.get_min_max() );
+
+    return player.calculate_mse( net );
+  }
+
+  ConfigDirectory dir{ "test_files/model_pruner_test" };
+  string results_file;
+};
+
+/**
+ * Without fine-tuning, the report's MSEs must be those of the trained and
+ * the pruned network, and the pruned results and model file must hold the
+ * pruned network in the levels it was trained in.
+ */
+TEST_F( ModelPrunerTest, Prune ) {
+  volatile sig_atomic_t shutdown_flag = false;
+
+  PruningConfig config;
+  config.sparsity = 0.5;
+  config.per_layer = true;
+
+  ModelPruner pruner( dir.get_directory_name(), results_file, config,
+                      &shutdown_flag );
+
+  const PruningReport& report = pruner.get_report();
+
+  TrainingResults results( results_file, READ_RESULTS );
+  LstmNetwork net = results.get_trained_network();
+
+  EXPECT_EQ( net.get_connection_weights().size(), report.connection_count );
+  EXPECT_NEAR( 0.5, report.get_sparsity(), 0.01 );
+  EXPECT_EQ( 0, report.fine_tune_epoch_count );
+  EXPECT_DOUBLE_EQ( calculate_mse( net ), report.mse );
+  EXPECT_EQ( report.pruned_mse, report.fine_tuned_mse );
+
+  ASSERT_EQ( ModelPruner::get_pruned_results_filename( results_file, 0.5 ),
+             pruner.get_pruned_results_filename() );
+
+  TrainingResults pruned_results( pruner.get_pruned_results_filename(),
+                                  READ_RESULTS );
+  LstmNetwork pruned_net = pruned_results.get_trained_network();
+
+  EXPECT_EQ( report.remaining_connection_count,
+             pruned_net.get_connection_weights().size() );
+  EXPECT_EQ( LEVEL_STEP_ORDER, pruned_net.get_step_order() );
+  EXPECT_EQ( net.get_levels(), pruned_net.get_levels() );
+  EXPECT_DOUBLE_EQ( report.pruned_mse, calculate_mse( pruned_net ) );
+  EXPECT_DOUBLE_EQ( report.pruned_mse, pruned_results.get_mse() );
+
+  ModelFile model( ModelFile::get_model_filename(
+                     pruner.get_pruned_results_filename() ) );
+  LstmNetwork model_net = model.get_trained_network();
+
+  EXPECT_EQ( report.remaining_connection_count,
+             model_net.get_connection_weights().size() );
+  EXPECT_EQ( net.get_levels(), model_net.get_levels() );
+  EXPECT_EQ( report.pruned_mse, calculate_mse( model_net ) );
+}
+
+/**
+ * Fine-tuning must run the requested epochs, never end up worse than the
+ * pruned network, and write the weights it reports the MSE of.
+ */
+TEST_F( ModelPrunerTest, FineTune ) {
+  volatile sig_atomic_t shutdown_flag = false;
+
+  PruningConfig config;
+  config.sparsity = 0.5;
+
+  ModelPruner pruned( dir.get_directory_name(), results_file, config,
+                      &shutdown_flag );
+
+  // existing results are never overwritten
+  remove( pruned.get_pruned_results_filename().c_str() );
+
+  config.fine_tune_epoch_count = 3;
+
+  ModelPruner fine_tuned( dir.get_directory_name(), results_file, config,
+                          &shutdown_flag );
+
+  const PruningReport& report = fine_tuned.get_report();
+
+  EXPECT_EQ( 3, report.fine_tune_epoch_count );
+  EXPECT_EQ( pruned.get_report().mse, report.mse );
+  EXPECT_EQ( pruned.get_report().pruned_mse, report.pruned_mse );
+  EXPECT_LE( report.fine_tuned_mse, report.pruned_mse );
+
+  TrainingResults results( fine_tuned.get_pruned_results_filename(),
+                           READ_RESULTS );
+  LstmNetwork net = results.get_trained_network();
+
+  EXPECT_EQ( report.remaining_connection_count,
+             net.get_connection_weights().size() );
+  EXPECT_DOUBLE_EQ( report.fine_tuned_mse, calculate_mse( net ) );
+  EXPECT_DOUBLE_EQ( report.fine_tuned_mse, results.get_mse() );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
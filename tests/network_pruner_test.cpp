@@ -0,0 +1,164 @@
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "littlelstm/network_pruner.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "random_inputs.hpp"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace littlelstm;
+
+/**
+ * The weight of each connection of net, or 0.0 if pruned doesn't have it.
+ */
+static ConnectionWeights_t remaining_weights( const LstmNetwork& net,
+                                              const LstmNetwork& pruned ) {
+  vector< pair<Id_t, Id_t> > conns = net.get_connections();
+  vector< pair<Id_t, Id_t> > pruned_conns = pruned.get_connections();
+
+  ConnectionWeights_t weights( conns.size(), 0.0 );
+
+  for( size_t i = 0; i < conns.size(); ++i ) {
+    auto it = find( pruned_conns.begin(), pruned_conns.end(), conns[i] );
+
+    if( it != pruned_conns.end() )
+      weights[i] = pruned.get_connection_weights()[it - pruned_conns.begin()];
+  }
+
+  return weights;
+}
+
+/**
+ * A pruned network must give the same outputs as the network with the
+ * pruned weights set to zero.
+ */
+static void expect_same_as_zeroed( LstmNetwork& net, LstmNetwork& pruned ) {
+  LstmNetwork zeroed = net;
+  zeroed.set_connection_weights( remaining_weights( net, pruned ) );
+
+  for( auto& input : random_inputs( net.get_input_size(), 50 ) ) {
+    zeroed.feed_forward( input );
+    pruned.feed_forward( input );
+
+    for( size_t i = 0; i < zeroed.get_output_size(); ++i )
+      ASSERT_NEAR( zeroed.get_output()[i], pruned.get_output()[i], 1e-12 );
+  }
+}
+
+TEST( NetworkPrunerTest, Global ) {
+  LstmArchitecture arch( 4, 3, { 8, 4 } );
+  LstmNetwork net( arch, false );
+
+  LstmNetwork pruned = NetworkPruner::prune( net, 0.5 );
+
+  size_t count = net.get_connection_weights().size();
+  ASSERT_EQ( count - count / 2, pruned.get_connection_weights().size() );
+
+  // every remaining weight is at least as large as every pruned weight
+  double min_remaining = INFINITY;
+  for( double weight : pruned.get_connection_weights() )
+    min_remaining = min( min_remaining, fabs( weight ) );
+
+  ConnectionWeights_t remaining = remaining_weights( net, pruned );
+  for( size_t i = 0; i < count; ++i ) {
+    if( remaining[i] == 0.0 ) {
+      EXPECT_LE( fabs( net.get_connection_weights()[i] ), min_remaining );
+    }
+  }
+
+  expect_same_as_zeroed( net, pruned );
+}
+
+TEST( NetworkPrunerTest, PerLayer ) {
+  LstmArchitecture arch( 4, 3, { 8, 4 } );
+  LstmNetwork net( arch, false );
+
+  vector<Index_t> unit_layers = NetworkPruner::get_unit_layers( arch );
+  ASSERT_EQ( arch.get_unit_count(), unit_layers.size() );
+  EXPECT_EQ( 2, unit_layers[arch.get_output_ids()[0]] );
+  EXPECT_EQ( 1, unit_layers[arch.get_block_ids( 1, 0 )[3]] );
+
+  LstmNetwork pruned = NetworkPruner::prune( net, 0.75, unit_layers );
+
+  vector<size_t> counts( 3, 0 );
+  vector<size_t> pruned_counts( 3, 0 );
+
+  for( auto& conn : net.get_connections() )
+    ++counts[unit_layers[conn.second]];
+  for( auto& conn : pruned.get_connections() )
+    ++pruned_counts[unit_layers[conn.second]];
+
+  for( size_t layer = 0; layer < 3; ++layer )
+    EXPECT_EQ( counts[layer] - counts[layer] * 3 / 4, pruned_counts[layer] );
+
+  expect_same_as_zeroed( net, pruned );
+}
+
+/**
+ * Removing a connection can turn the connection back the other way into a
+ * forward one, so a pruned network must keep the levels of the original
+ * instead of working them out again.
+ */
+TEST( NetworkPrunerTest, KeepsLevels ) {
+  LstmArchitecture arch( 3, 2, { 6, 6 } );
+  LstmNetwork net( arch, false );
+  net.set_step_order( LEVEL_STEP_ORDER );
+
+  LstmNetwork pruned = NetworkPruner::prune( net, 0.5 );
+
+  EXPECT_EQ( LEVEL_STEP_ORDER, pruned.get_step_order() );
+  EXPECT_EQ( net.get_levels(), pruned.get_levels() );
+
+  LstmNetwork recalculated = pruned;
+  recalculated.set_step_order( UNIT_STEP_ORDER );
+  recalculated.set_step_order( LEVEL_STEP_ORDER );
+  EXPECT_NE( net.get_levels(), recalculated.get_levels() );
+
+  expect_same_as_zeroed( net, pruned );
+
+  EXPECT_THROW( pruned.set_levels( { { 5, 6 } } ), out_of_range );
+}
+
+TEST( NetworkPrunerTest, NothingPruned ) {
+  LstmArchitecture arch( 2, 2, { 4 } );
+  LstmNetwork net( arch, false );
+  net.set_step_order( LEVEL_STEP_ORDER );
+
+  LstmNetwork pruned = NetworkPruner::prune( net, 0.0 );
+
+  EXPECT_EQ( net.get_connection_weights(), pruned.get_connection_weights() );
+  EXPECT_EQ( net.get_levels(), pruned.get_levels() );
+
+  expect_same_as_zeroed( net, pruned );
+
+  EXPECT_THROW( NetworkPruner::prune( net, 1.0 ), NetworkPrunerException );
+  EXPECT_THROW( NetworkPruner::prune( net, 0.5, { 0, 1 } ),
+                NetworkPrunerException );
+}
+
+/**
+ * A pruned network can be trained further without growing its connections
+ * back.
+ */
+TEST( NetworkPrunerTest, Training ) {
+  LstmArchitecture arch( 2, 2, { 4 } );
+  LstmNetwork net( arch, false );
+
+  LstmNetwork pruned = NetworkPruner::prune( net, 0.5, {}, true );
+  ConnectionWeights_t weights = pruned.get_connection_weights();
+
+  for( auto& input : random_inputs( 2, 20 ) ) {
+    pruned.feed_forward( input );
+    pruned.backpropagate( { 1.0, 0.0 }, 0.1, 0.0 );
+  }
+
+  EXPECT_EQ( weights.size(), pruned.get_connection_weights().size() );
+  EXPECT_NE( weights, pruned.get_connection_weights() );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,162 @@
+#include <string>
+#include <fstream>
+#include <cstdio>
+
+#include "quantized_model.hpp"
+#include "config_directory.hpp"
+#include "config_parser.hpp"
+#include "filesystem_operations.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+class QuantizedModelTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    dir.process_directory();
+
+    ConfigParser cp( dir.get_config_file_path() );
+
+    ConfigParameters midi_params = cp.get_section_params( "midi" );
+    ConfigParameters repr_params = cp.get_section_params( "representation" );
+
+    midi_config.reset( new MidiConfig( midi_params ) );
+    repr_config.reset( new RepresentationConfig( repr_params ) );
+
+    min_max.set_note_min( 0 );
+    min_max.set_note_max( 127 );
+    min_max.set_ctrl_min( 3, 0 );
+    min_max.set_ctrl_max( 3, 127 );
+
+    MidiTranslator translator( repr_config->get_ctrl_output_counts(),
+                               repr_config->get_input_feature_config(),
+                               midi_config->get_ctrl_defaults(), min_max,
+                               TRAIN );
+
+    LstmArchitecture arch( translator.get_input_count(),
+                           repr_config->get_total_output_count(), { 6 } );
+    net.reset( new LstmNetwork( arch, false ) );
+
+    remove( calibration_file.c_str() );
+  }
+
+  virtual void TearDown() {
+    remove( calibration_file.c_str() );
+  }
+
+  ConfigDirectory dir{ "test_files/quantized_model_test" };
+  string results_file = "test_files/quantized_model_test/results.json";
+  string calibration_file =
+    "test_files/quantized_model_test/results.calibration";
+
+  unique_ptr<MidiConfig> midi_config;
+  unique_ptr<RepresentationConfig> repr_config;
+  MidiMinMax min_max;
+  unique_ptr<LstmNetwork> net;
+};
+
+/**
+ * A calibration read back from its file must quantize the network like the
+ * calibration it was written from.
+ */
+TEST_F( QuantizedModelTest, CalibrationRoundTrip ) {
+  ExamplePlayer player( dir.get_training_example_filenames(), *midi_config,
+                        *repr_config, min_max );
+
+  QuantizationCalibration calibration =
+    QuantizedModel::calibrate( player, *net );
+
+  ASSERT_LT( 0, calibration.update_count );
+  ASSERT_EQ( net->get_input_size(), calibration.max_abs_inputs.size() );
+  ASSERT_EQ( 6, calibration.max_abs_states.size() );
+
+  EXPECT_THROW( QuantizedModel::read_calibration( results_file ),
+                QuantizedModelException );
+
+  QuantizedModel::write_calibration( results_file, calibration );
+
+  ASSERT_TRUE( is_regular_file( calibration_file ) );
+
+  QuantizationCalibration read_calibration =
+    QuantizedModel::read_calibration( results_file );
+
+  // the JSON holds 15 significant digits
+  EXPECT_EQ( calibration.update_count, read_calibration.update_count );
+  ASSERT_EQ( calibration.max_abs_inputs.size(),
+             read_calibration.max_abs_inputs.size() );
+  for( size_t i = 0; i < calibration.max_abs_inputs.size(); ++i )
+    EXPECT_NEAR( calibration.max_abs_inputs[i],
+                 read_calibration.max_abs_inputs[i], 1e-13 );
+
+  ASSERT_EQ( calibration.max_abs_states.size(),
+             read_calibration.max_abs_states.size() );
+  for( auto& kv : calibration.max_abs_states )
+    EXPECT_NEAR( kv.second, read_calibration.max_abs_states.at( kv.first ),
+                 1e-13 );
+
+  QuantizedNetwork quantized( *net, calibration, 16 );
+  unique_ptr<QuantizedNetwork> loaded =
+    QuantizedModel::load( results_file, *net, 16 );
+
+  EXPECT_EQ( 16, loaded->get_weight_bits() );
+
+  NetworkComparison comparison = player.compare( quantized, *loaded );
+
+  EXPECT_EQ( 1.0, comparison.all_ctrls_agreement );
+  EXPECT_GT( 1e-9, comparison.max_output_error );
+
+  {
+    ofstream outfile( calibration_file );
+    outfile << "{ \"update_count\": 1 }";
+  }
+
+  EXPECT_THROW( QuantizedModel::read_calibration( results_file ),
+                QuantizedModelException );
+}
+
+/**
+ * The report must describe the quantized weights and measure the agreement
+ * with the trained network over the same updates as the MSE.
+ */
+TEST_F( QuantizedModelTest, Report ) {
+  ExamplePlayer player( dir.get_training_example_filenames(), *midi_config,
+                        *repr_config, min_max );
+
+  QuantizationCalibration calibration =
+    QuantizedModel::calibrate( player, *net );
+
+  QuantizedNetwork quantized( *net, calibration, 16 );
+
+  QuantizationReport report = QuantizedModel::compare( player, *net,
+                                                       quantized );
+
+  EXPECT_EQ( 16, report.weight_bits );
+  EXPECT_EQ( quantized.get_weight_bytes(), report.weight_bytes );
+  EXPECT_EQ( calibration.update_count, report.comparison.update_count );
+
+  ASSERT_EQ( 1, report.comparison.ctrl_agreement.size() );
+  EXPECT_LT( 0.9, report.comparison.ctrl_agreement.at( 3 ) );
+  EXPECT_EQ( report.comparison.ctrl_agreement.at( 3 ),
+             report.comparison.all_ctrls_agreement );
+  EXPECT_LT( 0.0, report.comparison.max_output_error );
+  EXPECT_GT( 1e-2, report.comparison.max_output_error );
+
+  EXPECT_DOUBLE_EQ( player.calculate_mse( *net ),
+                    report.comparison.reference_mse );
+
+  // a network agrees with itself completely
+  LstmNetwork copy = *net;
+  NetworkComparison same = player.compare( *net, copy );
+
+  EXPECT_EQ( 1.0, same.all_ctrls_agreement );
+  EXPECT_EQ( 0.0, same.max_output_error );
+  EXPECT_EQ( same.reference_mse, same.mse );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,143 @@
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "littlelstm/quantized_network.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "random_inputs.hpp"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace littlelstm;
+
+static QuantizationCalibration
+calibrate( LstmNetwork& net, const vector< vector<double> >& inputs ) {
+  QuantizationCalibration calibration;
+
+  net.zero_network();
+
+  for( auto& input : inputs ) {
+    net.feed_forward( input );
+    calibration.record( input, net.get_cell_states() );
+  }
+
+  return calibration;
+}
+
+/**
+ * Feed both networks the same inputs and return the largest difference
+ * between their outputs.
+ */
+static double max_output_error( LstmNetwork& net, QuantizedNetwork& quantized,
+                                const vector< vector<double> >& inputs ) {
+  net.zero_network();
+  quantized.zero_network();
+
+  double max_error = 0.0;
+
+  for( auto& input : inputs ) {
+    net.feed_forward( input );
+    quantized.feed_forward( input );
+
+    for( size_t i = 0; i < net.get_output_size(); ++i )
+      max_error = max( max_error, fabs( net.get_output()[i] -
+                                        quantized.get_output()[i] ) );
+  }
+
+  return max_error;
+}
+
+TEST( QuantizationCalibrationTest, Record ) {
+  QuantizationCalibration calibration;
+
+  calibration.record( { 1.0, -3.0 }, { { 5, -0.5 } } );
+  calibration.record( { -2.0, 1.0 }, { { 5, 0.25 }, { 9, 2.0 } } );
+
+  EXPECT_EQ( 2, calibration.update_count );
+  EXPECT_EQ( vector<double>( { 2.0, 3.0 } ), calibration.max_abs_inputs );
+  EXPECT_EQ( 0.5, calibration.max_abs_states[5] );
+  EXPECT_EQ( 2.0, calibration.max_abs_states[9] );
+}
+
+TEST( QuantizedNetworkTest, SixteenBits ) {
+  LstmArchitecture arch( 4, 3, { 8, 4 } );
+  LstmNetwork net( arch, false );
+
+  vector< vector<double> > inputs = random_inputs( 4, 200, 3.0 );
+  QuantizationCalibration calibration = calibrate( net, inputs );
+
+  QuantizedNetwork quantized( net, calibration, 16 );
+
+  EXPECT_EQ( 16, quantized.get_weight_bits() );
+  EXPECT_EQ( net.get_input_size(), quantized.get_input_size() );
+  EXPECT_EQ( net.get_output_size(), quantized.get_output_size() );
+
+  EXPECT_GT( 1e-3, max_output_error( net, quantized, inputs ) );
+}
+
+TEST( QuantizedNetworkTest, EightBits ) {
+  LstmArchitecture arch( 4, 3, { 8, 4 } );
+  LstmNetwork net( arch, false );
+
+  vector< vector<double> > inputs = random_inputs( 4, 200, 3.0 );
+  QuantizationCalibration calibration = calibrate( net, inputs );
+
+  QuantizedNetwork quantized( net, calibration, 8 );
+  QuantizedNetwork quantized_16( net, calibration, 16 );
+
+  EXPECT_GT( 5e-3, max_output_error( net, quantized, inputs ) );
+  EXPECT_GT( quantized_16.get_weight_bytes(), quantized.get_weight_bytes() );
+}
+
+TEST( QuantizedNetworkTest, LevelOrder ) {
+  LstmArchitecture arch( 3, 2, { 6, 6 } );
+  LstmNetwork net( arch, false );
+  net.set_step_order( LEVEL_STEP_ORDER );
+
+  vector< vector<double> > inputs = random_inputs( 3, 100, 1.0 );
+  QuantizationCalibration calibration = calibrate( net, inputs );
+
+  QuantizedNetwork quantized( net, calibration, 16 );
+
+  EXPECT_GT( 1e-3, max_output_error( net, quantized, inputs ) );
+}
+
+TEST( QuantizedNetworkTest, ZeroNetwork ) {
+  LstmArchitecture arch( 2, 2, { 4 } );
+  LstmNetwork net( arch, false );
+
+  vector< vector<double> > inputs = random_inputs( 2, 20, 1.0 );
+  QuantizedNetwork quantized( net, calibrate( net, inputs ), 16 );
+
+  quantized.feed_forward( inputs[0] );
+  vector<double> first_output = quantized.get_output();
+
+  for( auto& input : inputs )
+    quantized.feed_forward( input );
+
+  quantized.zero_network();
+  quantized.feed_forward( inputs[0] );
+
+  EXPECT_EQ( first_output, quantized.get_output() );
+}
+
+TEST( QuantizedNetworkTest, Mismatch ) {
+  LstmArchitecture arch( 2, 2, { 4 } );
+  LstmNetwork net( arch, false );
+
+  QuantizationCalibration calibration;
+  calibration.record( { 1.0, 1.0, 1.0 }, {} );
+
+  EXPECT_THROW( QuantizedNetwork( net, calibration, 16 ),
+                QuantizedNetworkException );
+
+  calibration.max_abs_inputs.resize( 2 );
+
+  EXPECT_THROW( QuantizedNetwork( net, calibration, 4 ),
+                QuantizedNetworkException );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
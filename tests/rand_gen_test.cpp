@@ -1,6 +1,13 @@
-#include "rand_gen.h"
+#include <vector>
+#include <algorithm>
+#include <string>
+
+#include "rand_gen.hpp"
 #include "gtest/gtest.h"
 
+using namespace std;
+using namespace larasynth;
+
 TEST( RandTest, RandomDoubleZeroOneTest ) {
   RandGen rg;
 
@@ -31,21 +38,158 @@ TEST( RandTest, RandomSizeTTest ) {
   }
 }
 
+TEST( RandTest, RandomNegativeIntTest ) {
+  RandGen rg;
+  vector<size_t> counts( 3, 0 );
+
+  for( size_t i = 0; i < 3000; ++i ) {
+    int curr = rg.uniform_int( -1, 1 );
+    ASSERT_TRUE( curr >= -1 );
+    ASSERT_TRUE( curr <= 1 );
+    ++counts[curr + 1];
+  }
+
+  for( auto count : counts )
+    EXPECT_LT( 800, count );
+}
+
 TEST( RandTest, Normal ) {
   RandGen rg;
 
   double sum = 0.0;
+  double sum_of_squares = 0.0;
   size_t count = 100000;
 
-  for( size_t i = 0; i < count; ++i )
-    sum += rg.normal( 10.0, 5.0 );
+  for( size_t i = 0; i < count; ++i ) {
+    double value = rg.normal( 10.0, 5.0 );
+    sum += value;
+    sum_of_squares += value * value;
+  }
 
   double mean = sum / count;
+  double variance = sum_of_squares / count - mean * mean;
 
   EXPECT_TRUE( mean > 9.9 );
   EXPECT_TRUE( mean < 10.1 );
+  EXPECT_TRUE( variance > 24.0 );
+  EXPECT_TRUE( variance < 26.0 );
+}
+
+TEST( RandTest, SameSeed ) {
+  RandGen first( 7 );
+  RandGen second( 7 );
+  RandGen other( 8 );
+
+  bool differs = false;
+
+  for( size_t i = 0; i < 100; ++i ) {
+    double value = first.uniform_real( 0.0, 1.0 );
+    EXPECT_EQ( value, second.uniform_real( 0.0, 1.0 ) );
+    differs = differs || value != other.uniform_real( 0.0, 1.0 );
+  }
+
+  EXPECT_TRUE( differs );
+}
+
+/**
+ * The state includes the second normal value of each pair, so a restored
+ * generator continues exactly where the original left off.
+ */
+TEST( RandTest, State ) {
+  RandGen rg( 3 );
+  rg.normal( 0.0, 1.0 );
+
+  string state = rg.get_state();
+
+  RandGen restored;
+  restored.set_state( state );
+
+  for( size_t i = 0; i < 10; ++i ) {
+    EXPECT_EQ( rg.normal( 0.0, 1.0 ), restored.normal( 0.0, 1.0 ) );
+    EXPECT_EQ( rg.uniform_int( 0, 1000 ), restored.uniform_int( 0, 1000 ) );
+  }
+
+  EXPECT_THROW( restored.set_state( "not a state" ), runtime_error );
+}
+
+TEST( RandTest, GlobalSeed ) {
+  RandGen::set_global_seed( 42 );
+  RandGen first_a;
+  RandGen first_b;
+
+  RandGen::set_global_seed( 42 );
+  RandGen second_a;
+  RandGen second_b;
+
+  RandGen::set_global_seed( 42, 1 );
+  RandGen other_stream;
+
+  RandGen::set_global_seed( 0 );
+
+  double a = first_a.uniform_real( 0.0, 1.0 );
+  double b = first_b.uniform_real( 0.0, 1.0 );
+
+  EXPECT_EQ( a, second_a.uniform_real( 0.0, 1.0 ) );
+  EXPECT_EQ( b, second_b.uniform_real( 0.0, 1.0 ) );
+  EXPECT_NE( a, b );
+  EXPECT_NE( a, other_stream.uniform_real( 0.0, 1.0 ) );
+}
+
+/**
+ * Generators created in a StreamScope depend only on the scope's stream and
+ * their order within it, not on the generators created elsewhere.
+ */
+TEST( RandTest, StreamScope ) {
+  RandGen::set_global_seed( 42 );
+
+  double first_value;
+  {
+    RandGen::StreamScope stream( 3 );
+    RandGen first;
+    first_value = first.uniform_real( 0.0, 1.0 );
+  }
+
+  // a generator created outside the scopes does not shift their streams
+  RandGen outside;
+
+  double second_value;
+  double other_value;
+  {
+    RandGen::StreamScope stream( 3 );
+    RandGen second;
+    second_value = second.uniform_real( 0.0, 1.0 );
+  }
+  {
+    RandGen::StreamScope stream( 4 );
+    RandGen other;
+    other_value = other.uniform_real( 0.0, 1.0 );
+  }
+
+  RandGen::set_global_seed( 0 );
+
+  EXPECT_EQ( first_value, second_value );
+  EXPECT_NE( first_value, other_value );
+}
+
+TEST( RandTest, Shuffle ) {
+  RandGen first( 5 );
+  RandGen second( 5 );
+
+  vector<int> values;
+  for( int i = 0; i < 20; ++i )
+    values.push_back( i );
+
+  vector<int> shuffled = values;
+  vector<int> same = values;
+
+  shuffle( shuffled.begin(), shuffled.end(), *first.get_engine_ptr() );
+  shuffle( same.begin(), same.end(), *second.get_engine_ptr() );
+
+  EXPECT_EQ( shuffled, same );
+  EXPECT_NE( values, shuffled );
+  EXPECT_TRUE( is_permutation( values.begin(), values.end(),
+                               shuffled.begin() ) );
 }
-  
 
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest( &argc, argv );
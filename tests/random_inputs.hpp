@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "littlelstm/rand_gen.hpp"
+
+/**
+ * Random network inputs in [-range, range], the same for each seed.
+ */
+inline std::vector< std::vector<double> >
+random_inputs( size_t input_count, size_t step_count, double range = 1.0,
+               uint64_t seed = 7 ) {
+  littlelstm::RandGen rand_gen( seed );
+  std::vector< std::vector<double> > inputs(
+    step_count, std::vector<double>( input_count ) );
+
+  for( auto& input : inputs )
+    for( double& value : input )
+      value = rand_gen.uniform_real( -range, range );
+
+  return inputs;
+}
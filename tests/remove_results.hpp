@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "filesystem_operations.hpp"
+
+/**
+ * Remove a test project's training results directory and everything that
+ * training wrote to it, so that test runs do not leave results behind.
+ */
+inline void remove_training_results( const std::string& results_dir ) {
+  std::vector<std::string> filenames;
+  std::vector<std::string> subdirs;
+
+  if( !larasynth::is_directory( results_dir ) )
+    return;
+
+  larasynth::get_directory_filenames_and_subdirs( results_dir, filenames,
+                                                  subdirs );
+
+  for( auto& filename : filenames )
+    std::remove( ( results_dir + filename ).c_str() );
+
+  std::remove( results_dir.c_str() );
+}
@@ -31,6 +31,55 @@ TEST( RepresentationConfigTest, AllValues ) {
   EXPECT_TRUE( config.get_input_feature_config()[VELOCITY] );
   EXPECT_TRUE( config.get_input_feature_config()[INTERVAL] );
   cout << config.get_input_feature_config() << endl;
+
+  EXPECT_TRUE( config.get_ctrl_groups().empty() );
+}
+
+TEST( RepresentationConfigTest, ControllerGroups ) {
+  string conf_filename =
+    "test_files/representation_config_test/controller_groups/larasynth.conf";
+  ConfigParser cp( conf_filename );
+
+  ConfigParameters params = cp.get_section_params( "representation" );
+  RepresentationConfig config( params );
+
+  // ordered by group number, with the controllers of each group in order
+  vector< vector<event_data_t> > ctrl_groups = { { 3 }, { 8, 9 } };
+  EXPECT_EQ( ctrl_groups, config.get_ctrl_groups() );
+
+  RepresentationConfig group_config =
+    config.get_group_config( ctrl_groups[1] );
+
+  EXPECT_EQ( 2, group_config.get_ctrl_output_counts().size() );
+  EXPECT_EQ( 10, group_config.get_ctrl_output_count( 8 ) );
+  EXPECT_EQ( 4, group_config.get_ctrl_output_count( 9 ) );
+  EXPECT_EQ( 14, group_config.get_total_output_count() );
+  EXPECT_EQ( 40, group_config.get_update_rate() );
+  EXPECT_EQ( config.get_input_feature_config(),
+             group_config.get_input_feature_config() );
+  EXPECT_TRUE( group_config.get_ctrl_groups().empty() );
+
+  // a single group is the same as no groups
+  ConfigParser one_group_cp( "test_files/representation_config_test/"
+                             "one_controller_group/larasynth.conf" );
+  ConfigParameters one_group_params =
+    one_group_cp.get_section_params( "representation" );
+  RepresentationConfig one_group_config( one_group_params );
+
+  EXPECT_TRUE( one_group_config.get_ctrl_groups().empty() );
+}
+
+TEST( RepresentationConfigTest, InvalidControllerGroups ) {
+  for( string name : { "ungrouped_controller",
+                       "unknown_grouped_controller" } ) {
+    ConfigParser cp( "test_files/representation_config_test/" + name +
+                     "/larasynth.conf" );
+
+    ConfigParameters params = cp.get_section_params( "representation" );
+
+    ASSERT_THROW( RepresentationConfig config( params ),
+                  RepresentationConfigException );
+  }
 }
 
 int main(int argc, char **argv) {
@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "results_index.hpp"
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+
+class ResultsIndexTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    results_dir = "test_files/training_results_test/";
+    index_file = ResultsIndex::get_index_filename( results_dir );
+    remove( index_file.c_str() );
+  }
+
+  virtual void TearDown() {
+    remove( index_file.c_str() );
+    remove( ( index_file + ".lock" ).c_str() );
+  }
+
+  ResultsIndexEntry make_entry( const string& filename, double mse ) {
+    ResultsIndexEntry entry;
+    entry.filename = filename;
+    entry.mse = mse;
+    entry.epoch = 100;
+    entry.arch = "inputs:12 blocks:4,3 outputs:8";
+    entry.timestamp = "2017-05-29-13:46:04.399845";
+    return entry;
+  }
+
+  string results_dir;
+  string index_file;
+};
+
+TEST_F( ResultsIndexTest, MissingIndex ) {
+  ResultsIndex index( results_dir );
+
+  EXPECT_EQ( 0, index.get_entries().size() );
+  EXPECT_FALSE( index.has_entry( "results-1.json" ) );
+  EXPECT_THROW( index.get_entry( "results-1.json" ), ResultsIndexException );
+}
+
+TEST_F( ResultsIndexTest, AddAndReplaceEntries ) {
+  ResultsIndex::add_entry( results_dir,
+                           make_entry( results_dir + "results-1.json", 0.5 ) );
+  ResultsIndex::add_entry( results_dir, make_entry( "results-2.json",
+                                                    0.123456789012345 ) );
+  ResultsIndex::add_entry( results_dir, make_entry( "results-1.json", 0.25 ) );
+
+  ResultsIndex index( results_dir );
+
+  ASSERT_EQ( 2, index.get_entries().size() );
+
+  // entries can be looked up with or without the directory
+  ASSERT_TRUE( index.has_entry( results_dir + "results-1.json" ) );
+  EXPECT_EQ( 0.25, index.get_entry( "results-1.json" ).mse );
+
+  const ResultsIndexEntry& entry = index.get_entry( "results-2.json" );
+
+  EXPECT_EQ( 0.123456789012345, entry.mse );
+  EXPECT_EQ( 100, entry.epoch );
+  EXPECT_EQ( "inputs:12 blocks:4,3 outputs:8", entry.arch );
+  EXPECT_EQ( "2017-05-29-13:46:04.399845", entry.timestamp );
+}
+
+/**
+ * Entries added concurrently must all end up in the index.
+ */
+TEST_F( ResultsIndexTest, ConcurrentWriters ) {
+  vector<thread> threads;
+
+  for( size_t i = 0; i < 8; ++i ) {
+    threads.emplace_back( [this, i]() {
+        ResultsIndex::add_entry( results_dir,
+                                 make_entry( "results-" + to_string( i ) +
+                                             ".json", i ) );
+      } );
+  }
+
+  for( auto& t : threads )
+    t.join();
+
+  ResultsIndex index( results_dir );
+
+  EXPECT_EQ( 8, index.get_entries().size() );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest( &argc, argv );
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,100 @@
+#include <string>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <cstdio>
+
+#include "trace.hpp"
+#include "json/json.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+
+static const string TRACE_FILENAME = "test_files/trace_test.json";
+
+static nlohmann::json read_trace() {
+  ifstream trace_file( TRACE_FILENAME );
+  nlohmann::json trace;
+  trace_file >> trace;
+  remove( TRACE_FILENAME.c_str() );
+  return trace;
+}
+
+static void record_events( const char* thread_name, size_t count ) {
+  Tracer::get().set_thread_name( thread_name );
+
+  for( size_t i = 0; i < count; ++i )
+    TraceScope scope( "work" );
+}
+
+TEST( TraceTest, SeveralThreads ) {
+  Tracer::get().start( TRACE_FILENAME );
+  ASSERT_TRUE( Tracer::get().is_running() );
+
+  vector<thread> threads;
+  threads.emplace_back( record_events, "first", 100 );
+  threads.emplace_back( record_events, "second", 200 );
+
+  for( auto& t : threads )
+    t.join();
+
+  {
+    TraceScope scope( "main" );
+  }
+
+  Tracer::get().stop();
+  ASSERT_FALSE( Tracer::get().is_running() );
+
+  nlohmann::json trace = read_trace();
+
+  size_t work_count = 0;
+  size_t main_count = 0;
+  vector<string> thread_names;
+
+  for( auto& event : trace["traceEvents"] ) {
+    if( event["ph"] == "X" ) {
+      ASSERT_LE( 0.0, event["ts"].get<double>() );
+      ASSERT_LE( 0.0, event["dur"].get<double>() );
+
+      if( event["name"] == "work" )
+        ++work_count;
+      else if( event["name"] == "main" )
+        ++main_count;
+    }
+    else if( event["ph"] == "M" ) {
+      thread_names.push_back( event["args"]["name"].get<string>() );
+    }
+  }
+
+  ASSERT_EQ( 300, work_count );
+  ASSERT_EQ( 1, main_count );
+  ASSERT_EQ( 0, trace["otherData"]["dropped_event_count"].get<size_t>() );
+
+  // the second thread may reuse the first thread's buffer and name
+  ASSERT_FALSE( thread_names.empty() );
+}
+
+TEST( TraceTest, NotRunning ) {
+  {
+    TraceScope scope( "before" );
+  }
+
+  Tracer::get().start( TRACE_FILENAME );
+  Tracer::get().stop();
+
+  {
+    TraceScope scope( "after" );
+  }
+
+  nlohmann::json trace = read_trace();
+
+  for( auto& event : trace["traceEvents"] )
+    ASSERT_NE( "X", event["ph"] );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
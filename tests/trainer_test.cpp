@@ -1,6 +1,9 @@
 #include <string>
+#include <fstream>
 
 #include "trainer.hpp"
+#include "training_checkpoint.hpp"
+#include "filesystem_operations.hpp"
 
 #include "gtest/gtest.h"
 
@@ -13,6 +16,20 @@ TEST( LstmTrainerTest, SimpleSequence ) {
   volatile sig_atomic_t shutdown_flag = false;
 
   Trainer trainer( directory, &shutdown_flag );
+
+  // the training profile is written next to the results
+  ifstream stats_file(
+    TrainingProfile::get_stats_filename( trainer.get_results_filename() ) );
+  ASSERT_TRUE( stats_file.good() );
+
+  nlohmann::json stats;
+  stats_file >> stats;
+  ASSERT_LT( 0, stats["step_count"].get<size_t>() );
+  ASSERT_LT( 0, stats["event_count"].get<size_t>() );
+  ASSERT_LT( 0.0, stats["connections_updated_per_second"].get<double>() );
+  ASSERT_LT( 0, stats["phases"]["calculate_activations"]["call_count"]
+             .get<size_t>() );
+  ASSERT_LT( 0, stats["phases"]["validation"]["call_count"].get<size_t>() );
 }
 
 void construct_trainer( const string& directory ) {
@@ -22,6 +39,142 @@ void construct_trainer( const string& directory ) {
 }
 
 
+TEST( LstmTrainerTest, Resume ) {
+  string directory = "test_files/trainer_test";
+  string results_dir = directory + "/training_results/";
+  volatile sig_atomic_t shutdown_flag = true;
+
+  // interrupted before the first epoch, which leaves a checkpoint
+  Trainer interrupted( directory, &shutdown_flag );
+
+  string checkpoint = TrainingCheckpoint::find_latest_checkpoint( results_dir );
+  ASSERT_NE( "", checkpoint );
+  ASSERT_EQ( TrainingCheckpoint::get_checkpoint_filename(
+               interrupted.get_results_filename() ), checkpoint );
+
+  shutdown_flag = false;
+
+  // finishing the resumed run removes its checkpoint
+  Trainer resumed( directory, &shutdown_flag, true );
+
+  ASSERT_TRUE( resumed.is_finished() );
+  ASSERT_EQ( "", TrainingCheckpoint::find_latest_checkpoint( results_dir ) );
+  ASSERT_TRUE( is_regular_file( resumed.get_results_filename() ) );
+}
+
+/**
+ * Training that is checkpointed, interrupted and resumed must end up in
+ * exactly the same state as training that ran straight through.
+ */
+TEST( LstmTrainerTest, ResumeMatchesUninterrupted ) {
+  ConfigDirectory dir( "test_files/resume_test" );
+  dir.process_directory();
+
+  string checkpoint_filename = "test_files/resume_test/resume.checkpoint";
+  volatile sig_atomic_t shutdown_flag = false;
+
+  Trainer::seed_random_numbers( dir.get_config_file_path() );
+  ConfigParser uninterrupted_cp( dir.get_config_file_path() );
+  Trainer uninterrupted( dir, uninterrupted_cp, "", &shutdown_flag, false );
+  uninterrupted.train( 12 );
+
+  Trainer::seed_random_numbers( dir.get_config_file_path() );
+  ConfigParser interrupted_cp( dir.get_config_file_path() );
+  Trainer interrupted( dir, interrupted_cp, "", &shutdown_flag, false );
+  interrupted.train( 5 );
+
+  TrainingCheckpoint saved;
+  interrupted.save_checkpoint( saved );
+
+  {
+    ofstream outfile( checkpoint_filename, ios::binary );
+    outfile << saved.get_bytes();
+  }
+
+  TrainingCheckpoint read( checkpoint_filename );
+  remove( checkpoint_filename.c_str() );
+
+  // a run with other random numbers picks up the interrupted run's
+  ConfigParser resumed_cp( dir.get_config_file_path() );
+  Trainer resumed( dir, resumed_cp, "", &shutdown_flag, false );
+  resumed.restore_checkpoint( read );
+  resumed.train( 12 );
+
+  ASSERT_EQ( 12, uninterrupted.get_epoch() );
+  ASSERT_EQ( uninterrupted.get_epoch(), resumed.get_epoch() );
+  ASSERT_EQ( uninterrupted.get_best_mse(), resumed.get_best_mse() );
+
+  TrainingCheckpoint expected;
+  TrainingCheckpoint actual;
+  uninterrupted.save_checkpoint( expected );
+  resumed.save_checkpoint( actual );
+
+  EXPECT_EQ( expected.network_state.weights, actual.network_state.weights );
+  EXPECT_EQ( expected.network_state.weight_changes,
+             actual.network_state.weight_changes );
+  EXPECT_EQ( expected.network_state.activations,
+             actual.network_state.activations );
+  EXPECT_EQ( expected.network_state.traces, actual.network_state.traces );
+  EXPECT_EQ( expected.network_state.extended_traces,
+             actual.network_state.extended_traces );
+  EXPECT_EQ( expected.best_weights, actual.best_weights );
+  EXPECT_EQ( expected.trainer_rand_state, actual.trainer_rand_state );
+  EXPECT_EQ( expected.stream_rand_state, actual.stream_rand_state );
+}
+
+/**
+ * Two training runs with the same seed must train the same way.
+ */
+TEST( LstmTrainerTest, SameSeed ) {
+  ConfigDirectory dir( "test_files/resume_test" );
+  dir.process_directory();
+
+  volatile sig_atomic_t shutdown_flag = false;
+
+  Trainer::seed_random_numbers( dir.get_config_file_path() );
+  ConfigParser first_cp( dir.get_config_file_path() );
+  Trainer first( dir, first_cp, "", &shutdown_flag, false );
+  first.train( 8 );
+
+  Trainer::seed_random_numbers( dir.get_config_file_path() );
+  ConfigParser second_cp( dir.get_config_file_path() );
+  Trainer second( dir, second_cp, "", &shutdown_flag, false );
+  second.train( 8 );
+
+  ASSERT_EQ( 8, first.get_epoch() );
+  ASSERT_EQ( first.get_best_mse(), second.get_best_mse() );
+
+  TrainingCheckpoint first_state;
+  TrainingCheckpoint second_state;
+  first.save_checkpoint( first_state );
+  second.save_checkpoint( second_state );
+
+  EXPECT_EQ( first_state.network_state.weights,
+             second_state.network_state.weights );
+  EXPECT_EQ( first_state.best_weights, second_state.best_weights );
+}
+
+TEST( LstmTrainerTest, Parallel ) {
+  ConfigDirectory dir( "test_files/parallel_trainer_test" );
+  dir.process_directory();
+
+  ConfigParser cp( dir.get_config_file_path() );
+  volatile sig_atomic_t shutdown_flag = false;
+
+  Trainer trainer( dir, cp, dir.get_new_training_results_filename(),
+                   &shutdown_flag, false );
+
+  // each round runs averaging_period epochs on every worker, and training
+  // stops early if the example is learned perfectly
+  trainer.train( 5 );
+  ASSERT_EQ( 0, trainer.get_epoch() % 2 );
+  ASSERT_TRUE( trainer.get_epoch() == 6 || trainer.is_finished() );
+  ASSERT_LT( trainer.get_best_mse(), INFINITY );
+
+  trainer.train( 7 );
+  ASSERT_TRUE( trainer.get_epoch() == 8 || trainer.is_finished() );
+}
+
 TEST( LstmTrainerTest, NoExamples ) {
   string directory = "test_files/no_examples";
 
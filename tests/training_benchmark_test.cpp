@@ -0,0 +1,121 @@
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+
+#include "training_benchmark.hpp"
+#include "filesystem_operations.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+
+class TrainingBenchmarkTest : public ::testing::Test {
+protected:
+  TrainingBenchmarkTest()
+    : directory( "test_files/training_benchmark_test/" ) {
+    remove_project();
+  }
+
+  ~TrainingBenchmarkTest() {
+    remove_project();
+  }
+
+  void remove_project() {
+    string examples_dir = directory + "training_examples/";
+
+    for( size_t i = 0; i < 2; ++i )
+      remove( ( examples_dir + "synthetic-" + to_string( i ) + ".seq" )
+              .c_str() );
+
+    remove( examples_dir.c_str() );
+    remove( ( directory + "training_results/" ).c_str() );
+    remove( ( directory + "larasynth.conf" ).c_str() );
+    remove( ( directory + "training_benchmark.json" ).c_str() );
+    remove( directory.c_str() );
+  }
+
+  string directory;
+};
+
+/**
+ * The same seed must generate the same example, in time order, with roughly
+ * notes_per_second notes and a change of every controller with each note.
+ */
+TEST( SyntheticExampleTest, Generate ) {
+  TrainingBenchmarkConfig config;
+  config.example_seconds = 60.0;
+  config.notes_per_second = 2.0;
+  config.controller_count = 3;
+
+  vector<Event> events = TrainingBenchmark::generate_example( config, 0 );
+  vector<Event> same = TrainingBenchmark::generate_example( config, 0 );
+  vector<Event> other = TrainingBenchmark::generate_example( config, 1 );
+
+  ASSERT_EQ( events.size(), same.size() );
+  for( size_t i = 0; i < events.size(); ++i ) {
+    EXPECT_EQ( events[i].time(), same[i].time() );
+    EXPECT_EQ( events[i].message(), same[i].message() );
+  }
+
+  EXPECT_NE( events.size(), 0 );
+  EXPECT_FALSE( events.size() == other.size() &&
+                events[0].time() == other[0].time() );
+
+  size_t note_on_count = 0;
+  size_t ctrl_count = 0;
+  size_t last_on_time = 0;
+
+  for( auto& event : events ) {
+    if( event.type() == NOTE_ON ) {
+      EXPECT_LE( last_on_time, event.time() );
+      last_on_time = event.time();
+      ++note_on_count;
+    }
+    else if( event.type() == CTRL_CHANGE ) {
+      ++ctrl_count;
+    }
+  }
+
+  EXPECT_LT( 60, note_on_count );
+  EXPECT_GT( 180, note_on_count );
+  EXPECT_EQ( note_on_count * 3, ctrl_count );
+}
+
+TEST_F( TrainingBenchmarkTest, Run ) {
+  volatile sig_atomic_t shutdown_flag = false;
+
+  TrainingBenchmarkConfig config;
+  config.example_count = 2;
+  config.example_seconds = 5.0;
+  config.block_counts = { 4 };
+  config.epoch_count = 2;
+  config.epoch_count_before_validating = 1;
+
+  TrainingBenchmark benchmark( directory, config, &shutdown_flag );
+
+  const nlohmann::json& report = benchmark.get_report();
+
+  EXPECT_EQ( 2, report["epoch_count"].get<size_t>() );
+  EXPECT_LE( 2, report["validation_count"].get<size_t>() );
+  EXPECT_LT( 0.0, report["events_per_second"].get<double>() );
+  EXPECT_LT( 0.0, report["network_steps_per_second"].get<double>() );
+  EXPECT_LT( 0.0, report["epoch_seconds"]["stream_rebuild"].get<double>() );
+  EXPECT_LT( 0.0, report["epoch_seconds"]["validation"].get<double>() );
+  EXPECT_LT( 0, report["peak_rss_bytes"].get<size_t>() );
+
+  ifstream report_file( benchmark.get_report_filename() );
+  nlohmann::json written;
+  report_file >> written;
+  EXPECT_EQ( report["epoch_count"], written["epoch_count"] );
+
+  // an existing project is never overwritten
+  EXPECT_THROW( TrainingBenchmark( directory, config, &shutdown_flag ),
+                TrainingBenchmarkException );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,221 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "training_checkpoint.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "filesystem_operations.hpp"
+#include "rand_gen.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+class TrainingCheckpointTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    filename = "test_files/training_results_test/results-test.checkpoint";
+    remove( filename.c_str() );
+  }
+
+  virtual void TearDown() {
+    remove( filename.c_str() );
+  }
+
+  TrainingCheckpoint make_checkpoint() {
+    LstmArchitecture arch( 3, 2, { 4 } );
+    LstmNetwork net( arch );
+    net.set_optimizer( LstmOptimizerConfig( ADAM_OPTIMIZER, 0.99 ) );
+
+    TrainingCheckpoint checkpoint;
+    checkpoint.epoch = 120;
+    checkpoint.max_streak = 7;
+    checkpoint.training_minutes = 12.5;
+
+    larasynth::RandGen rand_gen;
+    rand_gen.uniform_real( 0.0, 1.0 );
+    checkpoint.trainer_rand_state = rand_gen.get_state();
+    checkpoint.stream_rand_state = "not checked here";
+
+    checkpoint.schedule_state.plateau_scale = 0.25;
+    checkpoint.schedule_state.best_mse = 0.5;
+    checkpoint.schedule_state.stale_validation_count = 3;
+
+    net.feed_forward( { 1.0, 0.0, 0.5 } );
+    net.backpropagate( { 1.0, 0.0 }, 0.01, 0.9 );
+    net.get_state( checkpoint.network_state );
+
+    checkpoint.translator_state.previous_target = { 0.0, 1.0 };
+    checkpoint.translator_state.last_event_type = NOTE_ON;
+    checkpoint.translator_state.last_pitch = 60;
+    checkpoint.translator_state.last_velocity = 100;
+    checkpoint.translator_state.last_interval = -3;
+
+    WorkerCheckpoint worker;
+    worker.trainer_rand_state = "worker trainer";
+    worker.stream_rand_state = "worker stream";
+    worker.network_state = checkpoint.network_state;
+    worker.translator_state = checkpoint.translator_state;
+    checkpoint.workers.push_back( worker );
+
+    checkpoint.best_mse = 0.25;
+    checkpoint.best_result = LstmResult( 100 );
+    checkpoint.best_result.set_mse( 0.25 );
+    checkpoint.best_result.add_sample( { { 3, 64 } }, { { 3, 60 } },
+                                       { { 10, 0.5 }, { 14, -1.5 } } );
+    checkpoint.best_result.set_sample_count( 3, 2 );
+    checkpoint.best_weights = net.get_connection_weights();
+
+    return checkpoint;
+  }
+
+  string filename;
+};
+
+TEST_F( TrainingCheckpointTest, WriteAndRead ) {
+  TrainingCheckpoint checkpoint = make_checkpoint();
+
+  {
+    CheckpointWriter writer;
+    writer.write( filename, checkpoint.get_bytes() );
+    writer.flush();
+  }
+
+  ASSERT_TRUE( is_regular_file( filename ) );
+  ASSERT_FALSE( is_regular_file( filename + ".tmp" ) );
+
+  TrainingCheckpoint read( filename );
+
+  EXPECT_EQ( 120, read.epoch );
+  EXPECT_EQ( 7, read.max_streak );
+  EXPECT_EQ( 12.5, read.training_minutes );
+  EXPECT_EQ( checkpoint.trainer_rand_state, read.trainer_rand_state );
+  EXPECT_EQ( checkpoint.stream_rand_state, read.stream_rand_state );
+
+  EXPECT_EQ( checkpoint.network_state.weights, read.network_state.weights );
+  EXPECT_EQ( checkpoint.network_state.weight_changes,
+             read.network_state.weight_changes );
+  EXPECT_EQ( checkpoint.network_state.second_moments,
+             read.network_state.second_moments );
+  EXPECT_EQ( 1, read.network_state.optimizer_step_count );
+
+  EXPECT_EQ( checkpoint.network_state.states, read.network_state.states );
+  EXPECT_EQ( checkpoint.network_state.old_states,
+             read.network_state.old_states );
+  EXPECT_EQ( checkpoint.network_state.activations,
+             read.network_state.activations );
+  EXPECT_EQ( checkpoint.network_state.traces, read.network_state.traces );
+  EXPECT_EQ( checkpoint.network_state.conn_gains,
+             read.network_state.conn_gains );
+  EXPECT_EQ( checkpoint.network_state.self_conn_gains,
+             read.network_state.self_conn_gains );
+  EXPECT_EQ( checkpoint.network_state.right_term_sums,
+             read.network_state.right_term_sums );
+  EXPECT_EQ( checkpoint.network_state.extended_traces,
+             read.network_state.extended_traces );
+  EXPECT_FALSE( read.network_state.extended_traces.empty() );
+
+  EXPECT_EQ( checkpoint.translator_state.previous_target,
+             read.translator_state.previous_target );
+  EXPECT_EQ( NOTE_ON, read.translator_state.last_event_type );
+  EXPECT_EQ( 60, read.translator_state.last_pitch );
+  EXPECT_EQ( 100, read.translator_state.last_velocity );
+  EXPECT_EQ( -3, read.translator_state.last_interval );
+
+  ASSERT_EQ( 1, read.workers.size() );
+  EXPECT_EQ( "worker trainer", read.workers[0].trainer_rand_state );
+  EXPECT_EQ( "worker stream", read.workers[0].stream_rand_state );
+  EXPECT_EQ( checkpoint.network_state.extended_traces,
+             read.workers[0].network_state.extended_traces );
+  EXPECT_EQ( -3, read.workers[0].translator_state.last_interval );
+
+  EXPECT_EQ( 0.25, read.schedule_state.plateau_scale );
+  EXPECT_EQ( 0.5, read.schedule_state.best_mse );
+  EXPECT_EQ( 3, read.schedule_state.stale_validation_count );
+
+  EXPECT_EQ( 0.25, read.best_mse );
+  EXPECT_EQ( 100, read.best_result.get_epoch() );
+  EXPECT_EQ( 0.25, read.best_result.get_mse() );
+  EXPECT_EQ( checkpoint.best_result.get_targets(),
+             read.best_result.get_targets() );
+  EXPECT_EQ( checkpoint.best_result.get_outputs(),
+             read.best_result.get_outputs() );
+  EXPECT_EQ( checkpoint.best_result.get_cell_states(),
+             read.best_result.get_cell_states() );
+  EXPECT_EQ( 3, read.best_result.get_sample_count() );
+  EXPECT_EQ( 2, read.best_result.get_sample_stride() );
+  EXPECT_EQ( checkpoint.best_weights, read.best_weights );
+
+  larasynth::RandGen expected;
+  larasynth::RandGen restored;
+  expected.set_state( checkpoint.trainer_rand_state );
+  restored.set_state( read.trainer_rand_state );
+  EXPECT_EQ( expected.uniform_real( 0.0, 1.0 ),
+             restored.uniform_real( 0.0, 1.0 ) );
+}
+
+TEST_F( TrainingCheckpointTest, LatestWins ) {
+  TrainingCheckpoint checkpoint = make_checkpoint();
+
+  CheckpointWriter writer;
+
+  for( size_t epoch = 1; epoch <= 20; ++epoch ) {
+    checkpoint.epoch = epoch;
+    writer.write( filename, checkpoint.get_bytes() );
+  }
+
+  writer.flush();
+
+  TrainingCheckpoint read( filename );
+  EXPECT_EQ( 20, read.epoch );
+}
+
+TEST_F( TrainingCheckpointTest, Truncated ) {
+  string bytes = make_checkpoint().get_bytes();
+
+  {
+    ofstream outfile( filename, ios::binary );
+    outfile.write( bytes.data(), bytes.size() / 2 );
+  }
+
+  ASSERT_THROW( TrainingCheckpoint read( filename ),
+                TrainingCheckpointException );
+}
+
+TEST_F( TrainingCheckpointTest, OtherVersion ) {
+  string bytes = make_checkpoint().get_bytes();
+
+  // the version follows the 8 byte magic string
+  bytes[8] += 1;
+
+  {
+    ofstream outfile( filename, ios::binary );
+    outfile.write( bytes.data(), bytes.size() );
+  }
+
+  ASSERT_THROW( TrainingCheckpoint read( filename ),
+                TrainingCheckpointException );
+}
+
+TEST_F( TrainingCheckpointTest, FindLatest ) {
+  string results_dir = "test_files/training_results_test/";
+
+  EXPECT_EQ( "", TrainingCheckpoint::find_latest_checkpoint( results_dir ) );
+
+  {
+    ofstream outfile( filename );
+  }
+
+  EXPECT_EQ( filename,
+             TrainingCheckpoint::find_latest_checkpoint( results_dir ) );
+  EXPECT_EQ( results_dir + "results-test.checkpoint",
+             TrainingCheckpoint::get_checkpoint_filename( results_dir +
+                                                          "results-test.json" ) );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
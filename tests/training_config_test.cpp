@@ -35,6 +35,7 @@ TEST_F( TrainingConfigTest, Defaults ) {
   EXPECT_EQ( 1.0, config.get_zero_network_on_reset() );
   EXPECT_EQ( 10000, config.get_max_epoch_count() );
   EXPECT_EQ( 0.0, config.get_mse_threshold() );
+  EXPECT_EQ( 10.0, config.get_checkpoint_minutes() );
 }
 
 TEST_F( TrainingConfigTest, Values ) {
@@ -0,0 +1,391 @@
+#include <cstring>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "training_coordinator.hpp"
+#include "trainer.hpp"
+#include "config_directory.hpp"
+#include "filesystem_operations.hpp"
+#include "remove_results.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+
+static const string DIRECTORY = "test_files/coordinator_test/";
+
+class TrainingCoordinatorTest : public ::testing::Test {
+protected:
+  ~TrainingCoordinatorTest() {
+    remove_training_results( DIRECTORY + "training_results/" );
+  }
+};
+
+void answer_rounds( size_t* shard_index, size_t* round_count ) {
+  TrainingWorkerConnection connection( DIRECTORY );
+  *shard_index = connection.get_shard_index();
+
+  TrainingRound round;
+
+  while( connection.receive_round( round ) ) {
+    EXPECT_EQ( connection.get_weight_count(), round.weights.size() );
+
+    TrainingRoundResult result;
+    result.weight_deltas.assign( round.weights.size(),
+                                 connection.get_shard_index() + 1.0 );
+    result.max_streak = round.max_streak + 1;
+    result.step_count = round.epoch_count;
+    result.learning_rate = round.schedule_state.plateau_scale;
+
+    connection.send_result( result );
+    ++*round_count;
+  }
+}
+
+TEST_F( TrainingCoordinatorTest, Rounds ) {
+  volatile sig_atomic_t shutdown_flag = false;
+  size_t shard_indexes[2];
+  size_t round_counts[2] = { 0, 0 };
+
+  thread first( answer_rounds, &shard_indexes[0], &round_counts[0] );
+  thread second( answer_rounds, &shard_indexes[1], &round_counts[1] );
+
+  {
+    TrainingCoordinator coordinator( DIRECTORY, 2, 3, &shutdown_flag );
+
+    TrainingRound round;
+    round.epoch = 4;
+    round.epoch_count = 3;
+    round.max_streak = 7;
+    round.schedule_state.plateau_scale = 0.5;
+    round.weights = { 1.0, 2.0, 3.0 };
+
+    for( size_t i = 0; i < 2; ++i ) {
+      vector<TrainingRoundResult> results = coordinator.run_round( round );
+
+      // results are in shard order
+      ASSERT_EQ( 2, results.size() );
+      for( size_t shard = 0; shard < 2; ++shard ) {
+        ASSERT_EQ( vector<double>( 3, shard + 1.0 ),
+                   results[shard].weight_deltas );
+        ASSERT_EQ( 8, results[shard].max_streak );
+        ASSERT_EQ( 3, results[shard].step_count );
+        ASSERT_EQ( 0.5, results[shard].learning_rate );
+      }
+    }
+  }
+
+  first.join();
+  second.join();
+
+  ASSERT_NE( shard_indexes[0], shard_indexes[1] );
+  ASSERT_EQ( 2, round_counts[0] );
+  ASSERT_EQ( 2, round_counts[1] );
+  ASSERT_FALSE( is_regular_file( TrainingCoordinator::get_socket_filename(
+                                   DIRECTORY ) ) );
+}
+
+/**
+ * Ensure a socket left behind by a coordinator is replaced, but a second
+ * coordinator does not take over the socket of one that is running.
+ */
+TEST_F( TrainingCoordinatorTest, CoordinatorAlreadyListening ) {
+  volatile sig_atomic_t shutdown_flag = false;
+  string filename = TrainingCoordinator::get_socket_filename( DIRECTORY );
+
+  // leave a socket behind that nothing listens on
+  sockaddr_un address;
+  memset( &address, 0, sizeof( address ) );
+  address.sun_family = AF_UNIX;
+  strncpy( address.sun_path, filename.c_str(),
+           sizeof( address.sun_path ) - 1 );
+
+  int stale_fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+  ASSERT_LE( 0, stale_fd );
+  ASSERT_EQ( 0, bind( stale_fd, (sockaddr*)&address, sizeof( address ) ) );
+  close( stale_fd );
+
+  size_t shard_index;
+  size_t round_count = 0;
+
+  thread worker( answer_rounds, &shard_index, &round_count );
+
+  {
+    TrainingCoordinator coordinator( DIRECTORY, 1, 1, &shutdown_flag );
+
+    EXPECT_THROW( TrainingCoordinator( DIRECTORY, 1, 1, &shutdown_flag ),
+                  TrainingCoordinatorException );
+
+    TrainingRound round;
+    round.weights = { 1.0 };
+
+    vector<TrainingRoundResult> results = coordinator.run_round( round );
+    EXPECT_EQ( 1, results.size() );
+  }
+
+  worker.join();
+
+  ASSERT_EQ( 0, shard_index );
+  ASSERT_EQ( 1, round_count );
+  ASSERT_NE( 0, access( filename.c_str(), F_OK ) );
+}
+
+/**
+ * Connect to the coordinator, retrying while it starts listening.
+ */
+int connect_to_coordinator() {
+  sockaddr_un address;
+  memset( &address, 0, sizeof( address ) );
+  address.sun_family = AF_UNIX;
+  strncpy( address.sun_path,
+           TrainingCoordinator::get_socket_filename( DIRECTORY ).c_str(),
+           sizeof( address.sun_path ) - 1 );
+
+  int fd = -1;
+
+  for( size_t attempt = 0; attempt < 100; ++attempt ) {
+    fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if( connect( fd, (sockaddr*)&address, sizeof( address ) ) == 0 )
+      break;
+
+    close( fd );
+    fd = -1;
+    this_thread::sleep_for( chrono::milliseconds( 100 ) );
+  }
+
+  return fd;
+}
+
+/**
+ * Connect to the coordinator and send a message claiming to be far larger
+ * than any the protocol carries.
+ */
+void send_oversized_request() {
+  int fd = connect_to_coordinator();
+  ASSERT_LE( 0, fd );
+
+  uint64_t size = UINT64_MAX;
+  ASSERT_EQ( (ssize_t)sizeof( size ), send( fd, &size, sizeof( size ), 0 ) );
+
+  // wait for the coordinator to close the connection
+  char byte;
+  recv( fd, &byte, 1, 0 );
+  close( fd );
+}
+
+/**
+ * A stray or corrupt size must be refused rather than allocated.
+ */
+TEST_F( TrainingCoordinatorTest, OversizedMessage ) {
+  volatile sig_atomic_t shutdown_flag = false;
+
+  thread sender( send_oversized_request );
+
+  EXPECT_THROW( TrainingCoordinator( DIRECTORY, 1, 1, &shutdown_flag ),
+                TrainingCoordinatorException );
+
+  sender.join();
+
+  ASSERT_FALSE( is_regular_file( TrainingCoordinator::get_socket_filename(
+                                   DIRECTORY ) ) );
+}
+
+/**
+ * Connect to the coordinator without ever sending anything, and hold the
+ * connection open until the coordinator gives up on it.
+ */
+void stay_silent( atomic<bool>* connected ) {
+  int fd = connect_to_coordinator();
+  *connected = true;
+  ASSERT_LE( 0, fd );
+
+  char byte;
+  recv( fd, &byte, 1, 0 );
+  close( fd );
+}
+
+/**
+ * A connection that never asks for a shard must not stop the coordinator
+ * from accepting the workers that connect after it.
+ */
+TEST_F( TrainingCoordinatorTest, SilentConnection ) {
+  volatile sig_atomic_t shutdown_flag = false;
+  atomic<bool> connected( false );
+  size_t shard_index;
+  size_t round_count = 0;
+
+  thread silent( stay_silent, &connected );
+  thread worker( [&]() {
+      while( !connected )
+        this_thread::sleep_for( chrono::milliseconds( 10 ) );
+      answer_rounds( &shard_index, &round_count );
+    } );
+
+  {
+    TrainingCoordinator coordinator( DIRECTORY, 1, 1, &shutdown_flag );
+
+    TrainingRound round;
+    round.weights = { 1.0 };
+
+    vector<TrainingRoundResult> results = coordinator.run_round( round );
+    EXPECT_EQ( 1, results.size() );
+  }
+
+  silent.join();
+  worker.join();
+
+  ASSERT_EQ( 0, shard_index );
+  ASSERT_EQ( 1, round_count );
+}
+
+/**
+ * Receive rounds without ever answering them, until the coordinator closes
+ * the connection.
+ */
+void never_answer() {
+  TrainingWorkerConnection connection( DIRECTORY );
+
+  TrainingRound round;
+
+  while( connection.receive_round( round ) ) {}
+}
+
+/**
+ * A worker that never answers must not hang the coordinator, which gives up
+ * on it after the round timeout, or when the shutdown flag is set.
+ */
+TEST_F( TrainingCoordinatorTest, HungWorker ) {
+  volatile sig_atomic_t shutdown_flag = false;
+
+  TrainingRound round;
+  round.weights = { 1.0 };
+
+  thread timed_out_worker( never_answer );
+
+  {
+    TrainingCoordinator coordinator( DIRECTORY, 1, 1, &shutdown_flag, 0.5 );
+
+    EXPECT_THROW( coordinator.run_round( round ),
+                  TrainingCoordinatorException );
+  }
+
+  timed_out_worker.join();
+
+  thread shut_down_worker( never_answer );
+
+  {
+    TrainingCoordinator coordinator( DIRECTORY, 1, 1, &shutdown_flag );
+
+    thread shutdown( [&]() {
+        this_thread::sleep_for( chrono::milliseconds( 500 ) );
+        shutdown_flag = true;
+      } );
+
+    EXPECT_THROW( coordinator.run_round( round ),
+                  TrainingCoordinatorException );
+
+    shutdown.join();
+  }
+
+  shut_down_worker.join();
+}
+
+TEST_F( TrainingCoordinatorTest, NoCoordinator ) {
+  ASSERT_THROW( TrainingWorkerConnection( DIRECTORY, 0.0 ),
+                TrainingCoordinatorException );
+}
+
+TEST_F( TrainingCoordinatorTest, WorkerProcesses ) {
+  volatile sig_atomic_t shutdown_flag = false;
+  vector<pid_t> pids;
+
+  // create the results directory before the workers and the coordinator
+  // race to create it
+  ConfigDirectory dir( DIRECTORY );
+  dir.process_directory();
+
+  for( size_t i = 0; i < 2; ++i ) {
+    pid_t pid = fork();
+    ASSERT_GE( pid, 0 );
+
+    if( pid == 0 ) {
+      try {
+        Trainer::train_as_worker( DIRECTORY );
+      }
+      catch( ... ) {
+        _exit( EXIT_FAILURE );
+      }
+      _exit( EXIT_SUCCESS );
+    }
+
+    pids.push_back( pid );
+  }
+
+  Trainer coordinator( DIRECTORY, &shutdown_flag, false, 2 );
+
+  for( pid_t pid : pids ) {
+    int status;
+    ASSERT_EQ( pid, waitpid( pid, &status, 0 ) );
+    ASSERT_TRUE( WIFEXITED( status ) );
+    ASSERT_EQ( EXIT_SUCCESS, WEXITSTATUS( status ) );
+  }
+
+  ASSERT_TRUE( coordinator.is_finished() );
+  ASSERT_EQ( 0, coordinator.get_epoch() % 2 );
+  ASSERT_TRUE( is_regular_file( coordinator.get_results_filename() ) );
+}
+
+/**
+ * Stop after receiving the first round without answering it.
+ */
+void stop_after_first_round() {
+  ConfigDirectory dir( DIRECTORY );
+  dir.process_directory();
+
+  TrainingWorkerConnection connection(
+    dir.get_training_results_directory_name() );
+
+  TrainingRound round;
+  connection.receive_round( round );
+}
+
+/**
+ * A worker that stops must not lose the best results trained so far.
+ */
+TEST_F( TrainingCoordinatorTest, WorkerStopped ) {
+  volatile sig_atomic_t shutdown_flag = false;
+
+  ConfigDirectory dir( DIRECTORY );
+  dir.process_directory();
+
+  vector<string> filenames_before;
+  vector<string> subdirs;
+  get_directory_filenames_and_subdirs(
+    dir.get_training_results_directory_name(), filenames_before, subdirs );
+
+  thread worker( stop_after_first_round );
+
+  EXPECT_THROW( Trainer( DIRECTORY, &shutdown_flag, false, 1 ),
+                TrainerException );
+
+  worker.join();
+
+  vector<string> filenames_after;
+  get_directory_filenames_and_subdirs(
+    dir.get_training_results_directory_name(), filenames_after, subdirs );
+
+  ASSERT_LT( filenames_before.size(), filenames_after.size() );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -34,6 +34,61 @@ TEST( TrainingEventStreamTest, OneSeqNoJitter ) {
   stream.reset( 1 );
 }
 
+/**
+ * Loading the examples on several threads must give the same min/max and the
+ * same events as loading them one at a time.
+ */
+TEST( TrainingEventStreamTest, ParallelLoadingMatchesSequential ) {
+  vector<string> filenames = { "test_files/training_event_stream_test/test.seq", "test_files/training_event_stream_test/test2.seq", "test_files/training_event_stream_test/test.seq" };
+
+  TrainingEventStream sequential( 100, 0.0, 0.0, 1.0, 0.0, { { 3, 0 } } );
+  TrainingEventStream parallel( 100, 0.0, 0.0, 1.0, 0.0, { { 3, 0 } } );
+
+  sequential.add_examples( filenames, 1 );
+  parallel.add_examples( filenames, 3 );
+
+  EXPECT_EQ( sequential.get_min_max(), parallel.get_min_max() );
+
+  // with the same random state both must play the same events
+  parallel.set_rand_state( sequential.get_rand_state() );
+  sequential.reset( 2 );
+  parallel.reset( 2 );
+
+  size_t event_count = 0;
+
+  while( sequential.has_next() ) {
+    ASSERT_TRUE( parallel.has_next() );
+
+    Event expected = sequential.get_next();
+    Event actual = parallel.get_next();
+
+    EXPECT_EQ( expected.time(), actual.time() );
+    EXPECT_EQ( expected.message(), actual.message() );
+    ++event_count;
+  }
+
+  EXPECT_FALSE( parallel.has_next() );
+  EXPECT_LT( 0, event_count );
+
+  MidiMinMax merged;
+
+  for( const string& filename : filenames ) {
+    TrainingEventStream single( 100, 0.0, 0.0, 1.0, 0.0, { { 3, 0 } } );
+    single.add_examples( { filename } );
+    merged.merge( single.get_min_max() );
+  }
+
+  EXPECT_EQ( sequential.get_min_max(), merged );
+}
+
+TEST( TrainingEventStreamTest, MissingExample ) {
+  vector<string> filenames = { "test_files/training_event_stream_test/test.seq", "test_files/training_event_stream_test/missing.seq" };
+
+  TrainingEventStream stream( 100, 0.5, 0.2, 1.0, 0.1, { { 3, 0 } } );
+
+  EXPECT_ANY_THROW( stream.add_examples( filenames, 2 ) );
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
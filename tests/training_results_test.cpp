@@ -1,4 +1,8 @@
+#include <fstream>
+
 #include "training_results.hpp"
+#include "config_parser.hpp"
+#include "littlelstm/lstm_architecture.hpp"
 #include "gtest/gtest.h"
 
 using namespace std;
@@ -9,11 +13,19 @@ class TrainingResultsTest : public ::testing::Test {
 protected:
   virtual void SetUp() {
     results_file = "test_files/training_results_test/results.json";
+    traces_file = "test_files/training_results_test/results.traces";
     if( is_regular_file( results_file ) )
       remove( results_file.c_str() );
+    if( is_regular_file( traces_file ) )
+      remove( traces_file.c_str() );
+  }
+
+  virtual void TearDown() {
+    remove( traces_file.c_str() );
   }
 
   string results_file;
+  string traces_file;
 };
 
 // TEST_F( TrainingResultsTest, WeightsTest ) {
@@ -75,6 +87,62 @@ TEST_F( TrainingResultsTest, MinMaxTest ) {
   } );
 }
 
+/**
+ * The network must be restored with the activation functions and step order
+ * it was trained with. Results from before step_order trained in level order
+ * whenever they used more than one thread per step.
+ */
+TEST_F( TrainingResultsTest, StepSettings ) {
+  ConfigParser cp( "test_files/training_results_test/settings/"
+                   "larasynth.conf" );
+  ConfigParameters params = cp.get_section_params( "lstm" );
+  LstmConfig lstm_config( params );
+
+  TrainingResults results( results_file, WRITE_RESULTS );
+
+  LstmArchitecture arch( 3, 2, { 4 } );
+
+  results.add_network( LstmNetwork( arch ) );
+  results.add_lstm_config( lstm_config );
+  results.write();
+
+  TrainingResults results_reader( results_file, READ_RESULTS );
+
+  EXPECT_EQ( FAST_ACT_FUNCS, results_reader.get_act_impl() );
+  EXPECT_EQ( LEVEL_STEP_ORDER, results_reader.get_step_order() );
+
+  LstmNetwork net = results_reader.get_trained_network();
+
+  EXPECT_EQ( FAST_ACT_FUNCS, net.get_act_impl() );
+  EXPECT_EQ( LEVEL_STEP_ORDER, net.get_step_order() );
+  EXPECT_FALSE( net.get_levels().empty() );
+
+  nlohmann::json results_json = results_reader.get_json();
+  results_json["lstm_config"].erase( "activation_functions" );
+  results_json["lstm_config"].erase( "step_order" );
+
+  {
+    ofstream outfile( results_file );
+    outfile << results_json;
+  }
+
+  TrainingResults old_reader( results_file, READ_RESULTS );
+
+  EXPECT_EQ( EXACT_ACT_FUNCS, old_reader.get_act_impl() );
+  EXPECT_EQ( LEVEL_STEP_ORDER, old_reader.get_step_order() );
+
+  results_json["lstm_config"]["step_thread_count"] = 1;
+
+  {
+    ofstream outfile( results_file );
+    outfile << results_json;
+  }
+
+  TrainingResults single_thread_reader( results_file, READ_RESULTS );
+
+  EXPECT_EQ( UNIT_STEP_ORDER, single_thread_reader.get_step_order() );
+}
+
 TEST_F( TrainingResultsTest, StatesTest ) {
   TrainingResults results( results_file, WRITE_RESULTS );
 
@@ -90,9 +158,7 @@ TEST_F( TrainingResultsTest, StatesTest ) {
   cell_states[5] = 0.5;
   cell_states[10] = 1.2;
 
-  result.add_target( target );
-  result.add_output( output );
-  result.add_cell_states( cell_states );
+  result.add_sample( target, output, cell_states );
 
   target[1] = 3;
   output[1] = 2;
@@ -100,15 +166,156 @@ TEST_F( TrainingResultsTest, StatesTest ) {
   cell_states[5] = 0.0;
   cell_states[10] = -0.5;
 
-  result.add_target( target );
-  result.add_output( output );
-  result.add_cell_states( cell_states );
+  result.add_sample( target, output, cell_states );
 
   EXPECT_NO_THROW( results.add_result( result ) );
 
   EXPECT_NO_THROW( results.write() );
 
   EXPECT_NO_THROW( TrainingResults results_reader( results_file, READ_RESULTS ) );
+
+  // the per-sample data goes to the traces file, not the JSON
+  TrainingResults results_reader( results_file, READ_RESULTS );
+  EXPECT_EQ( results_reader.get_json().count( "cell_states" ), 0 );
+  EXPECT_EQ( results_reader.get_json()["traces_file"], "results.traces" );
+
+  ValidationTraces traces( traces_file );
+
+  ASSERT_EQ( 2, traces.get_sample_count() );
+  EXPECT_EQ( vector<event_data_t>( { 1 } ), traces.get_ctrls() );
+  EXPECT_EQ( vector<size_t>( { 5, 10 } ), traces.get_cell_ids() );
+  EXPECT_EQ( vector<event_data_t>( { 2, 3 } ), traces.get_targets( 0 ) );
+  EXPECT_EQ( vector<event_data_t>( { 3, 2 } ), traces.get_outputs( 0 ) );
+  EXPECT_EQ( vector<double>( { 0.5, 0.0 } ), traces.get_cell_states( 0 ) );
+  EXPECT_EQ( vector<double>( { 1.2, -0.5 } ), traces.get_cell_states( 1 ) );
+}
+
+TEST_F( TrainingResultsTest, TracesSampleLimit ) {
+  LstmResult result( 1 );
+
+  for( size_t i = 0; i < 10; ++i ) {
+    ctrl_values_t target;
+    ctrl_values_t output;
+    map<size_t, double> cell_states;
+
+    target[7] = i;
+    target[1] = i + 100;
+    output[7] = 10 - i;
+    output[1] = i;
+    cell_states[3] = i * 0.5;
+
+    result.add_sample( target, output, cell_states );
+  }
+
+  ValidationTraces::write( traces_file, result, 4 );
+
+  ValidationTraces traces( traces_file );
+
+  EXPECT_EQ( 10, traces.get_total_sample_count() );
+  EXPECT_EQ( 3, traces.get_sample_stride() );
+  ASSERT_EQ( 4, traces.get_sample_count() );
+
+  EXPECT_EQ( vector<event_data_t>( { 1, 7 } ), traces.get_ctrls() );
+  EXPECT_EQ( vector<event_data_t>( { 100, 103, 106, 109 } ),
+             traces.get_targets( 0 ) );
+  EXPECT_EQ( vector<event_data_t>( { 0, 3, 6, 9 } ), traces.get_targets( 1 ) );
+  EXPECT_EQ( vector<event_data_t>( { 10, 7, 4, 1 } ), traces.get_outputs( 1 ) );
+  EXPECT_EQ( vector<double>( { 0.0, 1.5, 3.0, 4.5 } ),
+             traces.get_cell_states( 0 ) );
+}
+
+/**
+ * A result with a sample limit keeps evenly spaced samples while they are
+ * added, instead of keeping all of them until the traces are written.
+ */
+TEST_F( TrainingResultsTest, ResultSampleLimit ) {
+  LstmResult result( 1, 4 );
+
+  for( size_t i = 0; i < 10; ++i ) {
+    ctrl_values_t target;
+    ctrl_values_t output;
+    map<size_t, double> cell_states;
+
+    target[1] = i;
+    output[1] = 10 - i;
+    cell_states[3] = i * 0.5;
+
+    result.add_sample( target, output, cell_states );
+
+    ASSERT_GE( 4, result.get_targets().size() );
+  }
+
+  EXPECT_EQ( 10, result.get_sample_count() );
+  EXPECT_EQ( 4, result.get_sample_stride() );
+
+  ValidationTraces::write( traces_file, result, 4 );
+
+  ValidationTraces traces( traces_file );
+
+  EXPECT_EQ( 10, traces.get_total_sample_count() );
+  EXPECT_EQ( 4, traces.get_sample_stride() );
+  EXPECT_EQ( vector<event_data_t>( { 0, 4, 8 } ), traces.get_targets( 0 ) );
+  EXPECT_EQ( vector<event_data_t>( { 10, 6, 2 } ), traces.get_outputs( 0 ) );
+  EXPECT_EQ( vector<double>( { 0.0, 2.0, 4.0 } ),
+             traces.get_cell_states( 0 ) );
+}
+
+TEST_F( TrainingResultsTest, Groups ) {
+  feature_config_t feature_config;
+  feature_config[SOME_NOTE_ON] = true;
+
+  TrainingResults results( results_file, WRITE_RESULTS );
+
+  // one network for controller 1, and one for controllers 2 and 3
+  vector< vector<size_t> > ctrl_output_counts = { { 1, 4 },
+                                                  { 2, 3, 3, 5 } };
+  vector<double> mses = { 10.0, 15.0 };
+  vector<size_t> epochs = { 20, 30 };
+
+  for( size_t i = 0; i < 2; ++i ) {
+    RepresentationConfig repr_config( ctrl_output_counts[i], 10,
+                                      feature_config );
+    size_t output_count = repr_config.get_total_output_count();
+    LstmArchitecture arch( 1 + output_count, output_count, { 2 } );
+
+    LstmResult result( epochs[i] );
+    result.set_mse( mses[i] );
+
+    TrainingResults group_results( "", WRITE_RESULTS );
+    group_results.add_network( LstmNetwork( arch ) );
+    group_results.add_repr_config( repr_config );
+    group_results.add_result( result );
+
+    results.add_group( group_results );
+  }
+
+  EXPECT_NO_THROW( results.write() );
+
+  TrainingResults results_reader( results_file, READ_RESULTS );
+
+  ASSERT_TRUE( results_reader.is_grouped() );
+  ASSERT_EQ( 2, results_reader.get_group_count() );
+  EXPECT_EQ( 25.0, results_reader.get_mse() );
+  EXPECT_EQ( 30, results_reader.get_json()["epoch"].get<size_t>() );
+
+  EXPECT_EQ( vector<event_data_t>( { 1 } ),
+             results_reader.get_group_ctrls( 0 ) );
+  EXPECT_EQ( vector<event_data_t>( { 2, 3 } ),
+             results_reader.get_group_ctrls( 1 ) );
+
+  TrainingResults group_results = results_reader.get_group( 1 );
+  EXPECT_FALSE( group_results.is_grouped() );
+  EXPECT_EQ( 15.0, group_results.get_mse() );
+  EXPECT_EQ( 8, group_results.get_repr_config().get_total_output_count() );
+  EXPECT_EQ( 8, group_results.get_trained_network().get_output_size() );
+
+  // the groups' traces are not written
+  EXPECT_FALSE( is_regular_file( traces_file ) );
+
+  EXPECT_THROW( results_reader.get_trained_network(),
+                TrainingResultsException );
+  EXPECT_THROW( results_reader.get_repr_config(), TrainingResultsException );
+  EXPECT_THROW( results_reader.get_group( 2 ), TrainingResultsException );
 }
 
 int main(int argc, char **argv) {
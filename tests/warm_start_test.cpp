@@ -0,0 +1,147 @@
+#include <string>
+#include <vector>
+
+#include "warm_start.hpp"
+#include "training_results.hpp"
+#include "littlelstm/lstm_architecture.hpp"
+#include "littlelstm/lstm_network.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace larasynth;
+using namespace littlelstm;
+
+// the results were trained with controller 3 (8 outputs, values 10 to 100),
+// the "some note on" input feature and a single hidden layer of 2 blocks
+class WarmStartTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    results_file = "test_files/warm_start_test/results.json";
+    some_note_on[SOME_NOTE_ON] = true;
+    min_max.set_ctrl_min( 3, 10 );
+    min_max.set_ctrl_max( 3, 100 );
+  }
+
+  // a network with one input feature for the given controllers and blocks
+  LstmNetwork make_network( const RepresentationConfig& repr_config,
+                            const vector<size_t>& block_counts ) {
+    size_t output_count = repr_config.get_total_output_count();
+    LstmArchitecture arch( 1 + output_count, output_count, block_counts );
+
+    return LstmNetwork( arch );
+  }
+
+  // check every trained weight is in net at its mapped connection
+  void expect_weights_carried_over( const WarmStart& start,
+                                    const LstmNetwork& net ) {
+    TrainingResults results( results_file, READ_RESULTS );
+    WeightsMap_t old_weights = results.get_weights();
+    WeightsMap_t weights = net.get_weights_map();
+    const vector<Id_t>& unit_map = start.get_unit_map();
+
+    size_t count = 0;
+
+    for( auto& kv_out : old_weights ) {
+      for( auto& kv_in : kv_out.second ) {
+        Id_t out_id = unit_map[kv_out.first];
+        Id_t in_id = unit_map[kv_in.first];
+        ASSERT_NE( NO_UNIT, out_id );
+        ASSERT_NE( NO_UNIT, in_id );
+        EXPECT_EQ( kv_in.second, weights[out_id][in_id] );
+        ++count;
+      }
+    }
+
+    EXPECT_EQ( count, start.get_weight_count() );
+  }
+
+  string results_file;
+  feature_config_t some_note_on;
+  MidiMinMax min_max;
+};
+
+TEST_F( WarmStartTest, SameArchitecture ) {
+  TrainingResults results( results_file, READ_RESULTS );
+  RepresentationConfig repr_config( { 3, 8 }, 10, some_note_on );
+  LstmNetwork net = make_network( repr_config, { 2 } );
+
+  WarmStart start( results, repr_config, min_max, { 2 } );
+  start.apply( net );
+
+  EXPECT_EQ( net.get_connection_weights().size(), start.get_weight_count() );
+  EXPECT_EQ( results.get_weights(), net.get_weights_map() );
+}
+
+TEST_F( WarmStartTest, MoreBlocksAndControllers ) {
+  TrainingResults results( results_file, READ_RESULTS );
+
+  // controller 1 comes before controller 3, so the outputs and fed back
+  // inputs of controller 3 move
+  RepresentationConfig repr_config( { 1, 4, 3, 8 }, 10, some_note_on );
+  LstmNetwork net = make_network( repr_config, { 4 } );
+
+  WarmStart start( results, repr_config, min_max, { 4 } );
+  start.apply( net );
+
+  EXPECT_LT( start.get_weight_count(), net.get_connection_weights().size() );
+  expect_weights_carried_over( start, net );
+
+  // old layout: 9 inputs, bias 9, blocks 10-17, outputs 18-25
+  // new layout: 13 inputs, bias 13, blocks 14-29, outputs 30-41
+  const vector<Id_t>& unit_map = start.get_unit_map();
+  EXPECT_EQ( 0, unit_map[0] );
+  EXPECT_EQ( 5, unit_map[1] );
+  EXPECT_EQ( 13, unit_map[9] );
+  EXPECT_EQ( 14, unit_map[10] );
+  EXPECT_EQ( 41, unit_map[25] );
+}
+
+TEST_F( WarmStartTest, Incompatible ) {
+  TrainingResults results( results_file, READ_RESULTS );
+
+  feature_config_t other_features;
+  other_features[NOTE_STRUCK] = true;
+
+  RepresentationConfig same( { 3, 8 }, 10, some_note_on );
+  RepresentationConfig other_feature( { 3, 8 }, 10, other_features );
+  RepresentationConfig other_output_count( { 3, 4 }, 10, some_note_on );
+  RepresentationConfig missing_ctrl( { 1, 8 }, 10, some_note_on );
+
+  EXPECT_THROW( WarmStart( results, other_feature, min_max, { 2 } ),
+                WarmStartException );
+  EXPECT_THROW( WarmStart( results, other_output_count, min_max, { 2 } ),
+                WarmStartException );
+  EXPECT_THROW( WarmStart( results, missing_ctrl, min_max, { 2 } ),
+                WarmStartException );
+  EXPECT_THROW( WarmStart( results, same, min_max, { 1 } ),
+                WarmStartException );
+  EXPECT_THROW( WarmStart( results, same, min_max, { 2, 2 } ),
+                WarmStartException );
+  EXPECT_THROW( WarmStart( results, same, min_max, { 2 },
+                           { FORGET_GATE_BLOCK } ),
+                WarmStartException );
+}
+
+/**
+ * New training examples that widen a controller's range change what its
+ * outputs mean, so the trained weights cannot be carried over.
+ */
+TEST_F( WarmStartTest, WidenedControllerRange ) {
+  TrainingResults results( results_file, READ_RESULTS );
+  RepresentationConfig repr_config( { 1, 4, 3, 8 }, 10, some_note_on );
+
+  // a new controller can have any range
+  min_max.set_ctrl_min( 1, 0 );
+  min_max.set_ctrl_max( 1, 127 );
+  EXPECT_NO_THROW( WarmStart( results, repr_config, min_max, { 2 } ) );
+
+  min_max.set_ctrl_min( 3, 0 );
+  EXPECT_THROW( WarmStart( results, repr_config, min_max, { 2 } ),
+                WarmStartException );
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}